@@ -59,6 +59,7 @@
 	#include <fcntl.h>
 	#include <direct.h>
 	#include <errno.h>
+	#include <io.h>
 	#include <process.h>
 	#include <shellapi.h>
 	#include <wincrypt.h>
@@ -66,6 +67,13 @@
 	#error NOT IMPLEMENTED
 #endif
 
+#if defined(CONF_PLATFORM_LINUX)
+	#include <poll.h>
+	#include <sys/epoll.h>
+	#include <sys/prctl.h>
+	#include <sys/timerfd.h>
+#endif
+
 #if defined(CONF_PLATFORM_SOLARIS)
 	#include <sys/filio.h>
 #endif
@@ -604,6 +612,17 @@ int io_flush(IOHANDLE io)
 	return 0;
 }
 
+int io_sync(IOHANDLE io)
+{
+	if(fflush((FILE*)io) != 0)
+		return 1;
+#if defined(CONF_FAMILY_WINDOWS)
+	return _commit(_fileno((FILE*)io)) != 0;
+#else
+	return fsync(fileno((FILE*)io)) != 0;
+#endif
+}
+
 struct THREAD_RUN
 {
 	void (*threadfunc)(void *);
@@ -800,14 +819,9 @@ void set_new_tick()
 }
 
 /* -----  time ----- */
-int64 time_get()
+int64 time_get_impl()
 {
 	static int64 last = 0;
-	if(!new_tick)
-		return last;
-	if(new_tick != -1)
-		new_tick = 0;
-
 #if defined(CONF_FAMILY_UNIX)
 	struct timeval val;
 	gettimeofday(&val, NULL);
@@ -827,6 +841,18 @@ int64 time_get()
 #endif
 }
 
+int64 time_get()
+{
+	static int64 last = 0;
+	if(!new_tick)
+		return last;
+	if(new_tick != -1)
+		new_tick = 0;
+
+	last = time_get_impl();
+	return last;
+}
+
 int64 time_freq()
 {
 #if defined(CONF_FAMILY_UNIX)
@@ -2145,6 +2171,129 @@ int net_socket_read_wait(NETSOCKET sock, int time)
 	return 0;
 }
 
+#if defined(CONF_PLATFORM_LINUX)
+static int net_socket_poll(NETSOCKET sock)
+{
+	struct pollfd fds[2];
+	int num = 0;
+	if(sock->ipv4sock >= 0)
+	{
+		fds[num].fd = sock->ipv4sock;
+		fds[num++].events = POLLIN;
+	}
+	if(sock->ipv6sock >= 0)
+	{
+		fds[num].fd = sock->ipv6sock;
+		fds[num++].events = POLLIN;
+	}
+	return poll(fds, num, 0) > 0;
+}
+#endif
+
+int net_socket_read_wait_until(NETSOCKET sock, int64 deadline, int busy_us)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	/* one epoll set with the socket and a timer, rebuilt when the socket changes */
+	static int epoll_fd = -1;
+	static int timer_fd = -1;
+	static NETSOCKET epoll_sock = NULL;
+	static int epoll_failed = 0;
+
+	if(!epoll_failed && epoll_fd < 0)
+	{
+		/* wake up when asked to, not up to 50us later */
+		prctl(PR_SET_TIMERSLACK, 1);
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+		struct epoll_event ev = {0};
+		ev.events = EPOLLIN;
+		ev.data.fd = timer_fd;
+		if(epoll_fd < 0 || timer_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0)
+		{
+			dbg_msg("net", "timed socket wait unavailable (%s), using select", strerror(errno));
+			if(epoll_fd >= 0)
+				close(epoll_fd);
+			if(timer_fd >= 0)
+				close(timer_fd);
+			epoll_fd = -1;
+			timer_fd = -1;
+			epoll_failed = 1;
+		}
+	}
+
+	if(epoll_failed)
+	{
+		int64 wait = (deadline - time_get_impl()) * 1000000 / time_freq() + 1;
+		return wait > 0 ? net_socket_read_wait(sock, (int)wait) : 1;
+	}
+
+	if(epoll_sock != sock)
+	{
+		if(epoll_sock)
+		{
+			if(epoll_sock->ipv4sock >= 0)
+				epoll_ctl(epoll_fd, EPOLL_CTL_DEL, epoll_sock->ipv4sock, NULL);
+			if(epoll_sock->ipv6sock >= 0)
+				epoll_ctl(epoll_fd, EPOLL_CTL_DEL, epoll_sock->ipv6sock, NULL);
+		}
+		struct epoll_event ev = {0};
+		ev.events = EPOLLIN;
+		if(sock->ipv4sock >= 0)
+		{
+			ev.data.fd = sock->ipv4sock;
+			epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock->ipv4sock, &ev);
+		}
+		if(sock->ipv6sock >= 0)
+		{
+			ev.data.fd = sock->ipv6sock;
+			epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock->ipv6sock, &ev);
+		}
+		epoll_sock = sock;
+	}
+
+	int64 wait = (deadline - time_get_impl()) * 1000000 / time_freq() - busy_us;
+	if(wait > 0)
+	{
+		/* the timer runs on the monotonic clock, time_get_impl may not */
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		int64 wake = (int64)now.tv_sec * 1000000000 + now.tv_nsec + wait * 1000;
+		struct itimerspec spec = {{0, 0}, {0, 0}};
+		spec.it_value.tv_sec = wake / 1000000000;
+		spec.it_value.tv_nsec = wake % 1000000000;
+		timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+		struct epoll_event events[3];
+		int num = epoll_wait(epoll_fd, events, 3, -1);
+		int timer = 0;
+		for(int i = 0; i < num; i++)
+		{
+			if(events[i].data.fd != timer_fd)
+				return 1;
+			timer = 1;
+		}
+		if(timer)
+		{
+			uint64_t expirations;
+			(void)!read(timer_fd, &expirations, sizeof(expirations));
+		}
+		else
+			return 0; /* interrupted, the caller loops anyway */
+	}
+
+	/* spin through the rest */
+	while(time_get_impl() < deadline)
+	{
+		if(net_socket_poll(sock))
+			return 1;
+	}
+	return net_socket_poll(sock);
+#else
+	int64 wait = (deadline - time_get_impl()) * 1000000 / time_freq() + 1;
+	return wait > 0 ? net_socket_read_wait(sock, (int)wait) : 1;
+#endif
+}
+
 int time_timestamp()
 {
 	return time(0);
@@ -358,6 +358,18 @@ int io_close(IOHANDLE io);
 */
 int io_flush(IOHANDLE io);
 
+/*
+	Function: io_sync
+		Empties all buffers and waits until the data is on the disk.
+
+	Parameters:
+		io - Handle to the file.
+
+	Returns:
+		Returns 0 on success.
+*/
+int io_sync(IOHANDLE io);
+
 
 /*
 	Function: io_stdin
@@ -488,6 +500,19 @@ void set_new_tick();
 */
 int64 time_get();
 
+/*
+	Function: time_get_impl
+		Fetches a fresh sample from the high resolution timer.
+
+	Returns:
+		Current value of the timer.
+
+	Remarks:
+		Unlike <time_get> this never returns the value cached for the
+		current tick, use it for measuring durations inside a tick.
+*/
+int64 time_get_impl();
+
 /*
 	Function: time_freq
 		Returns the frequency of the high resolution timer.
@@ -1365,6 +1390,25 @@ int net_would_block();
 
 int net_socket_read_wait(NETSOCKET sock, int time);
 
+/*
+	Function: net_socket_read_wait_until
+		Waits until the socket has data or the deadline has passed.
+
+	Parameters:
+		sock - Socket to wait on.
+		deadline - Time to return at, in <time_get_impl> units.
+		busy_us - Microseconds before the deadline to stop sleeping and
+			poll the socket instead.
+
+	Returns:
+		1 if the socket has data, 0 if the deadline passed.
+
+	Remarks:
+		On Linux this sleeps on a monotonic timerfd together with the
+		socket, elsewhere it falls back to <net_socket_read_wait>.
+*/
+int net_socket_read_wait_until(NETSOCKET sock, int64 deadline, int busy_us);
+
 void mem_debug_dump(IOHANDLE file);
 
 void swap_endian(void *data, unsigned elem_size, unsigned num);
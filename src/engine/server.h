@@ -14,7 +14,28 @@ protected:
 	int m_CurrentGameTick;
 	int m_TickSpeed;
 
+	// vanilla clients only see VANILLA_MAX_CLIENTS ids, these map them both ways
+	int m_aIdMap[MAX_CLIENTS * VANILLA_MAX_CLIENTS];
+	int m_aReverseIdMap[MAX_CLIENTS * MAX_CLIENTS];
+	bool m_aDDNetClient[MAX_CLIENTS];
+
+	// the last m_NumBots slots belong to server side bots
+	int m_NumBots;
+
+	int m_OverloadLevel;
+
 public:
+	// what the server sheds while it can't keep up, each level includes the ones below
+	enum
+	{
+		OVERLOAD_NONE=0,
+		OVERLOAD_SPECTATOR_SNAPS, // spectators get every 4th snapshot
+		OVERLOAD_PLAYER_MAPS, // id maps are updated every 4th tick
+		OVERLOAD_INFO_EVENTS, // server info requests are limited harder, events per snap are capped
+		OVERLOAD_BOTS, // bots plan with a quarter of their budget
+		NUM_OVERLOAD_LEVELS,
+	};
+
 	/*
 		Structure: CClientInfo
 	*/
@@ -27,17 +48,27 @@ public:
 
 	int Tick() const { return m_CurrentGameTick; }
 	int TickSpeed() const { return m_TickSpeed; }
+	int NumBots() const { return m_NumBots; }
+	// players only get the slots below the bots
+	int NumPlayerSlots() const { return MAX_CLIENTS-m_NumBots; }
+	bool IsBot(int ClientID) const { return ClientID >= MAX_CLIENTS-m_NumBots && ClientID < MAX_CLIENTS; }
+	int OverloadLevel() const { return m_OverloadLevel; }
+	virtual class CProfiler *Profiler() = 0;
+	virtual class CMetrics *Metrics() = 0;
 
 	virtual int MaxClients() const = 0;
 	virtual const char *ClientName(int ClientID) = 0;
 	virtual const char *ClientClan(int ClientID) = 0;
 	virtual int ClientCountry(int ClientID) = 0;
+	virtual int ClientInfoVersion(int ClientID) = 0;
 	virtual bool ClientIngame(int ClientID) = 0;
 	virtual int GetClientInfo(int ClientID, CClientInfo *pInfo) = 0;
 	virtual void GetClientAddr(int ClientID, char *pAddrStr, int Size) = 0;
 	virtual void RestrictRconOutput(int ClientID) = 0;
 
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID) = 0;
+	// a message for everybody, before the ids are translated per client
+	virtual void SendStreamMsg(CMsgPacker *pMsg, int Flags) = 0;
 
 	template<class T>
 	int SendPackMsg(T *pMsg, int Flags, int ClientID)
@@ -46,6 +77,9 @@ public:
 		T tmp;
 		if (ClientID == -1)
 		{
+			CMsgPacker Packer(pMsg->MsgID());
+			if(!pMsg->Pack(&Packer))
+				SendStreamMsg(&Packer, Flags);
 			for(int i = 0; i < MAX_CLIENTS; i++)
 				if(ClientIngame(i))
 				{
@@ -101,30 +135,35 @@ public:
 
 	bool Translate(int& target, int client)
 	{
-		CClientInfo info;
-		GetClientInfo(client, &info);
-		if (info.m_ClientVersion >= VERSION_DDNET_OLD)
+		if (m_aDDNetClient[client])
 			return true;
-		int* map = GetIdMap(client);
-		bool found = false;
-		for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+		if (target < 0 || target >= MAX_CLIENTS)
 		{
-			if (target == map[i])
+			// not a client, only matches an unused slot
+			int* map = GetIdMap(client);
+			for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
 			{
-				target = i;
-				found = true;
-				break;
+				if (target == map[i])
+				{
+					target = i;
+					return true;
+				}
 			}
+			return false;
 		}
-		return found;
+		int id = m_aReverseIdMap[client * MAX_CLIENTS + target];
+		if (id == -1)
+			return false;
+		target = id;
+		return true;
 	}
 
 	bool ReverseTranslate(int& target, int client)
 	{
-		CClientInfo info;
-		GetClientInfo(client, &info);
-		if (info.m_ClientVersion >= VERSION_DDNET_OLD)
+		if (m_aDDNetClient[client])
 			return true;
+		if (target < 0 || target >= VANILLA_MAX_CLIENTS)
+			return false;
 		int* map = GetIdMap(client);
 		if (map[target] == -1)
 			return false;
@@ -132,6 +171,24 @@ public:
 		return true;
 	}
 
+	int* GetIdMap(int ClientID) { return m_aIdMap + VANILLA_MAX_CLIENTS * ClientID; }
+
+	// call after changing the id map of a client
+	void UpdateReverseIdMap(int ClientID)
+	{
+		int* map = GetIdMap(ClientID);
+		int* rmap = m_aReverseIdMap + MAX_CLIENTS * ClientID;
+		for (int i = 0; i < MAX_CLIENTS; i++)
+			rmap[i] = -1;
+		// backwards, so the first slot wins like in a forward search
+		for (int i = VANILLA_MAX_CLIENTS - 1; i >= 0; i--)
+			if (map[i] >= 0 && map[i] < MAX_CLIENTS)
+				rmap[map[i]] = i;
+	}
+
+	void SetClientDDNet(int ClientID, bool DDNet) { m_aDDNetClient[ClientID] = DDNet; }
+	bool IsDDNetClient(int ClientID) const { return m_aDDNetClient[ClientID]; }
+
 	virtual void SetClientName(int ClientID, char const *pName) = 0;
 	virtual void SetClientClan(int ClientID, char const *pClan) = 0;
 	virtual void SetClientCountry(int ClientID, int Country) = 0;
@@ -164,7 +221,6 @@ public:
 
 	virtual void GetClientAddr(int ClientID, NETADDR *pAddr) = 0;
 
-	virtual int* GetIdMap(int ClientID) = 0;
 	virtual void ExpireServerInfo() = 0;
 };
 
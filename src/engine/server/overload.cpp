@@ -0,0 +1,44 @@
+#include "overload.h"
+
+COverloadGovernor::COverloadGovernor()
+{
+	Reset();
+	m_NumChanges = 0;
+}
+
+void COverloadGovernor::Reset()
+{
+	m_Level = IServer::OVERLOAD_NONE;
+	m_Load = 0.0f;
+	m_AboveTicks = 0;
+	m_BelowTicks = 0;
+}
+
+bool COverloadGovernor::Update(float Load, int High, int Low, int TickSpeed)
+{
+	m_Load += (Load - m_Load) * 0.1f;
+
+	m_AboveTicks = m_Load*100 > High ? m_AboveTicks+1 : 0;
+	m_BelowTicks = m_Load*100 < Low ? m_BelowTicks+1 : 0;
+
+	// step up after half a second above, down after five seconds below
+	int OldLevel = m_Level;
+	if(m_AboveTicks > TickSpeed/2 && m_Level < IServer::NUM_OVERLOAD_LEVELS-1)
+		m_Level++;
+	else if(m_BelowTicks > TickSpeed*5 && m_Level > IServer::OVERLOAD_NONE)
+		m_Level--;
+
+	if(m_Level == OldLevel)
+		return false;
+
+	m_AboveTicks = 0;
+	m_BelowTicks = 0;
+	m_NumChanges++;
+	return true;
+}
+
+const char *COverloadGovernor::LevelName(int Level)
+{
+	static const char *s_apNames[] = {"none", "spectator_snaps", "player_maps", "info_events", "bots"};
+	return s_apNames[Level];
+}
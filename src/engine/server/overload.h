@@ -0,0 +1,36 @@
+#ifndef ENGINE_SERVER_OVERLOAD_H
+#define ENGINE_SERVER_OVERLOAD_H
+
+#include <base/system.h>
+#include <engine/server.h>
+
+/*
+	Decides how much work the server sheds when ticks fall behind. The
+	load is how much of the tick period had passed once the ticks and the
+	snapshot of a main loop pass were done. Levels go up one at a time
+	while the smoothed load stays above the high mark and come back down
+	only after it stayed below the low mark for a while. The levels are
+	listed in IServer.
+*/
+class COverloadGovernor
+{
+	int m_Level;
+	float m_Load;
+	int m_AboveTicks;
+	int m_BelowTicks;
+
+public:
+	COverloadGovernor();
+
+	void Reset();
+	// returns true if the level changed
+	bool Update(float Load, int High, int Low, int TickSpeed);
+
+	int Level() const { return m_Level; }
+	float Load() const { return m_Load; }
+	static const char *LevelName(int Level);
+
+	int64 m_NumChanges;
+};
+
+#endif
@@ -302,12 +302,57 @@ void CServer::CClient::Reset()
 CServer::CServer()
 {
 	for(int i = 0; i < MAX_CLIENTS; i++)
-		m_aDemoRecorder[i] = CDemoRecorder(&m_SnapshotDelta, true);
-	m_aDemoRecorder[MAX_CLIENTS] = CDemoRecorder(&m_SnapshotDelta, false);
+		m_aDemoRecorder[i] = CDemoRecorder(&m_SnapshotDelta, true, &m_DemoWriter);
+	m_aDemoRecorder[MAX_CLIENTS] = CDemoRecorder(&m_SnapshotDelta, false, &m_DemoWriter);
 
 	m_TickSpeed = SERVER_TICK_SPEED;
+	m_NumBots = 1;
+	m_OverloadLevel = OVERLOAD_NONE;
+
+	m_Profiler.AddPhase("input");
+	m_Profiler.AddPhase("tick");
+	m_Profiler.AddPhase("snapshot");
+	m_Profiler.AddPhase("rcon_commands");
+	m_Profiler.AddPhase("register");
+	m_Profiler.AddPhase("server_info");
+	m_Profiler.AddPhase("network");
+	m_Profiler.AddPhase("tick_start_late");
+	m_LastProfilerLog = 0;
+
+	static const double s_aTickBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.02, 0.05};
+	static const double s_aSnapBounds[] = {64, 128, 256, 512, 1024, 2048, 4096, 8192};
+	m_Metrics.AddHistogram("teeware_tick_duration_seconds", "Time spent applying input and running one game tick", s_aTickBounds, sizeof(s_aTickBounds)/sizeof(s_aTickBounds[0]));
+	m_Metrics.AddHistogram("teeware_snapshot_bytes", "Compressed snapshot size per client", s_aSnapBounds, sizeof(s_aSnapBounds)/sizeof(s_aSnapBounds[0]));
+	m_Metrics.AddCounter("teeware_sent_packets_total", "UDP packets sent");
+	m_Metrics.AddCounter("teeware_sent_bytes_total", "UDP bytes sent");
+	m_Metrics.AddCounter("teeware_recv_packets_total", "UDP packets received");
+	m_Metrics.AddCounter("teeware_recv_bytes_total", "UDP bytes received");
+	m_Metrics.AddCounter("teeware_resent_chunks_total", "Vital chunks sent again");
+	m_Metrics.AddCounter("teeware_drops_total", "Clients dropped");
+	m_Metrics.AddCounter("teeware_ban_hits_total", "Packets rejected from banned addresses");
+	m_Metrics.AddCounter("teeware_info_requests_served_total", "Server info requests answered");
+	m_Metrics.AddCounter("teeware_info_requests_throttled_total", "Server info requests dropped by the rate limit");
+	m_Metrics.AddGauge("teeware_clients", "Connected clients");
+	m_Metrics.AddGauge("teeware_players", "Clients in game");
+	m_Metrics.AddGauge("teeware_overload_level", "Current overload level");
+	m_Metrics.AddCounter("teeware_overload_changes_total", "Overload level changes");
+	static const double s_aJitterBounds[] = {0.00001, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.005, 0.01};
+	m_Metrics.AddHistogram("teeware_tick_jitter_seconds", "How late ticks started", s_aJitterBounds, sizeof(s_aJitterBounds)/sizeof(s_aJitterBounds[0]));
+	m_Metrics.AddGauge("teeware_demo_queue_bytes", "Demo data waiting for the writer thread");
+	m_Metrics.AddCounter("teeware_demo_frames_dropped_total", "Demo frames dropped because the writer fell behind");
+	m_Metrics.AddCounter("teeware_demo_degraded_total", "Times demo recording fell back to keyframes only");
+	m_Metrics.AddGauge("teeware_demo_stream_readers", "Connections to the live demo stream");
+	m_Metrics.AddCounter("teeware_demo_stream_dropped_total", "Live demo stream readers dropped for falling behind");
 
 	m_pGameServer = 0;
+	m_InfoVersion = 0;
+
+	for(int i = 0; i < MAX_CLIENTS * VANILLA_MAX_CLIENTS; i++)
+		m_aIdMap[i] = -1;
+	for(int i = 0; i < MAX_CLIENTS * MAX_CLIENTS; i++)
+		m_aReverseIdMap[i] = -1;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		m_aDDNetClient[i] = false;
 
 	m_CurrentGameTick = 0;
 	m_RunServer = 1;
@@ -360,6 +405,7 @@ int CServer::TrySetClientName(int ClientID, const char *pName)
 
 	// set the client name
 	str_copy(m_aClients[ClientID].m_aName, pName, MAX_NAME_LENGTH);
+	ClientInfoChanged(ClientID);
 	return 0;
 }
 
@@ -367,7 +413,7 @@ int CServer::TrySetClientName(int ClientID, const char *pName)
 
 void CServer::SetClientName(int ClientID, const char *pName)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and ClientID < MAX_CLIENTS-1))
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and !IsBot(ClientID)))
 		return;
 
 	if(!pName)
@@ -389,23 +435,25 @@ void CServer::SetClientName(int ClientID, const char *pName)
 
 void CServer::SetClientClan(int ClientID, const char *pClan)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and ClientID < MAX_CLIENTS-1) || !pClan)
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and !IsBot(ClientID)) || !pClan)
 		return;
 
 	str_copy(m_aClients[ClientID].m_aClan, pClan, MAX_CLAN_LENGTH);
+	ClientInfoChanged(ClientID);
 }
 
 void CServer::SetClientCountry(int ClientID, int Country)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and ClientID < MAX_CLIENTS-1))
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and !IsBot(ClientID)))
 		return;
 
 	m_aClients[ClientID].m_Country = Country;
+	ClientInfoChanged(ClientID);
 }
 
 void CServer::SetClientScore(int ClientID, int Score)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and ClientID < MAX_CLIENTS-1))
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State < CClient::STATE_READY and !IsBot(ClientID)))
 		return;
 	if(m_aClients[ClientID].m_Score != Score)
 		ExpireServerInfo();
@@ -456,6 +504,7 @@ int CServer::Init()
 		m_aClients[i].m_aName[0] = 0;
 		m_aClients[i].m_aClan[0] = 0;
 		m_aClients[i].m_Country = -1;
+		ClientInfoChanged(i);
 		m_aClients[i].m_Snapshots.Init();
 		m_aClients[i].m_Traffic = 0;
 		m_aClients[i].m_TrafficSince = 0;
@@ -505,9 +554,9 @@ void CServer::GetClientAddr(int ClientID, char *pAddrStr, int Size)
 
 const char *CServer::ClientName(int ClientID)
 {
-	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and ClientID < MAX_CLIENTS-1)))
+	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and !IsBot(ClientID))))
 		return "(invalid)";
-	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or ClientID >= MAX_CLIENTS-1)
+	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or IsBot(ClientID))
 		return m_aClients[ClientID].m_aName;
 	else
 		return "(connecting)";
@@ -516,19 +565,30 @@ const char *CServer::ClientName(int ClientID)
 
 const char *CServer::ClientClan(int ClientID)
 {
-	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and ClientID < MAX_CLIENTS-1)))
+	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and !IsBot(ClientID))))
 		return "";
-	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or ClientID >= MAX_CLIENTS-1)
+	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or IsBot(ClientID))
 		return m_aClients[ClientID].m_aClan;
 	else
 		return "";
 }
 
+int CServer::ClientInfoVersion(int ClientID)
+{
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+		return -1;
+
+	// ClientName/ClientClan/ClientCountry also depend on the state
+	int Visible = m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY ? 0 :
+		m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME || IsBot(ClientID) ? 2 : 1;
+	return m_aClients[ClientID].m_InfoVersion*3 + Visible;
+}
+
 int CServer::ClientCountry(int ClientID)
 {
-	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and ClientID < MAX_CLIENTS-1)))
+	if((ClientID < 0 || ClientID >= MAX_CLIENTS || (m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY and !IsBot(ClientID))))
 		return -1;
-	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or ClientID >= MAX_CLIENTS-1)
+	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or IsBot(ClientID))
 		return m_aClients[ClientID].m_Country;
 	else
 		return -1;
@@ -536,7 +596,7 @@ int CServer::ClientCountry(int ClientID)
 
 bool CServer::ClientIngame(int ClientID)
 {
-	return ClientID >= 0 && ClientID < MAX_CLIENTS && (m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or ClientID >= MAX_CLIENTS-1);
+	return ClientID >= 0 && ClientID < MAX_CLIENTS && (m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME or IsBot(ClientID));
 }
 
 int CServer::MaxClients() const
@@ -618,12 +678,19 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 	return 0;
 }
 
+void CServer::SendStreamMsg(CMsgPacker *pMsg, int Flags)
+{
+	// the stream is public, it only gets what everybody gets
+	if(!(Flags&MSGFLAG_NORECORD))
+		m_DemoStream.OnMessage(pMsg->Data(), pMsg->Size());
+}
+
 void CServer::DoSnapshot()
 {
 	GameServer()->OnPreSnap();
 
-	// create snapshot for demo recording
-	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
+	// create snapshot for demo recording and the live stream
+	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording() || m_DemoStream.Active())
 	{
 		char aData[CSnapshot::MAX_SIZE];
 		int SnapshotSize;
@@ -638,7 +705,10 @@ void CServer::DoSnapshot()
 		mem_copy(aExtraInfoRemoved, aData, SnapshotSize);
 		SnapshotRemoveExtraInfo(aExtraInfoRemoved);
 		// write snapshot
-		m_aDemoRecorder[MAX_CLIENTS].RecordSnapshot(Tick(), aExtraInfoRemoved, SnapshotSize);
+		if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
+			m_aDemoRecorder[MAX_CLIENTS].RecordSnapshot(Tick(), aExtraInfoRemoved, SnapshotSize);
+		if(m_DemoStream.Active())
+			m_DemoStream.OnSnapshot(Tick(), aExtraInfoRemoved, SnapshotSize);
 	}
 
 	// create snapshots for all clients
@@ -656,6 +726,11 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick()%10) != 0)
 			continue;
 
+		// spectators can do with fewer snapshots while we're overloaded
+		// snapshots are only taken every 2nd tick unless sv_high_bandwidth is set
+		if(m_OverloadLevel >= OVERLOAD_SPECTATOR_SNAPS && (Tick()%(g_Config.m_SvHighBandwidth ? 4 : 8)) != 0 && !GameServer()->IsClientPlayer(i))
+			continue;
+
 		{
 			char aData[CSnapshot::MAX_SIZE];
 			CSnapshot *pData = (CSnapshot*)aData;	// Fix compiler warning for strict-aliasing
@@ -676,14 +751,13 @@ void CServer::DoSnapshot()
 			// finish snapshot
 			SnapshotSize = m_SnapshotBuilder.Finish(pData);
 
+			// for antiping: if the projectile netobjects contains extra data, this is removed and the original content restored before recording demo
+			unsigned char aExtraInfoRemoved[CSnapshot::MAX_SIZE];
+			bool DemoNetSnapshot = false;
 			if(m_aDemoRecorder[i].IsRecording())
 			{
-				// for antiping: if the projectile netobjects contains extra data, this is removed and the original content restored before recording demo
-				unsigned char aExtraInfoRemoved[CSnapshot::MAX_SIZE];
 				mem_copy(aExtraInfoRemoved, aData, SnapshotSize);
-				SnapshotRemoveExtraInfo(aExtraInfoRemoved);
-				// write snapshot
-				m_aDemoRecorder[i].RecordSnapshot(Tick(), aExtraInfoRemoved, SnapshotSize);
+				DemoNetSnapshot = !SnapshotRemoveExtraInfo(aExtraInfoRemoved);
 			}
 
 			Crc = pData->Crc();
@@ -712,15 +786,23 @@ void CServer::DoSnapshot()
 
 			// create delta
 			DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+			int CompSize = DeltaSize ? CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData)) : 0;
+
+			// write snapshot, the demo shares the packed delta when it has the same base
+			if(m_aDemoRecorder[i].IsRecording())
+			{
+				if(!DemoNetSnapshot || !m_aDemoRecorder[i].RecordNetDelta(Tick(), aExtraInfoRemoved, SnapshotSize, DeltaTick, aCompData, CompSize))
+					m_aDemoRecorder[i].RecordSnapshot(Tick(), aExtraInfoRemoved, SnapshotSize, DemoNetSnapshot);
+			}
 
 			if(DeltaSize)
 			{
 				// compress it
-				int SnapshotSize;
+				int SnapshotSize = CompSize;
 				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
 				int NumPackets;
 
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
+				m_Metrics.Observe(METRIC_SNAPSHOT_BYTES, SnapshotSize);
 				NumPackets = (SnapshotSize+MaxSize-1)/MaxSize;
 
 				for(int n = 0, Left = SnapshotSize; Left; n++)
@@ -788,6 +870,7 @@ int CServer::NewClientNoAuthCallback(int ClientID, bool Reset, void *pUser)
 		pThis->m_aClients[ClientID].m_aName[0] = 0;
 		pThis->m_aClients[ClientID].m_aClan[0] = 0;
 		pThis->m_aClients[ClientID].m_Country = -1;
+		pThis->ClientInfoChanged(ClientID);
 		pThis->m_aClients[ClientID].m_Authed = AUTHED_NO;
 		pThis->m_aClients[ClientID].m_AuthTries = 0;
 		pThis->m_aClients[ClientID].m_pRconCmdToSend = 0;
@@ -807,6 +890,7 @@ int CServer::NewClientCallback(int ClientID, void *pUser)
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
 	pThis->m_aClients[ClientID].m_aClan[0] = 0;
 	pThis->m_aClients[ClientID].m_Country = -1;
+	pThis->ClientInfoChanged(ClientID);
 	pThis->m_aClients[ClientID].m_Authed = AUTHED_NO;
 	pThis->m_aClients[ClientID].m_AuthTries = 0;
 	pThis->m_aClients[ClientID].m_pRconCmdToSend = 0;
@@ -835,6 +919,7 @@ int CServer::DelClientCallback(int ClientID, const char *pReason, void *pUser)
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
 	pThis->m_aClients[ClientID].m_aClan[0] = 0;
 	pThis->m_aClients[ClientID].m_Country = -1;
+	pThis->ClientInfoChanged(ClientID);
 	pThis->m_aClients[ClientID].m_Authed = AUTHED_NO;
 	pThis->m_aClients[ClientID].m_AuthTries = 0;
 	pThis->m_aClients[ClientID].m_pRconCmdToSend = 0;
@@ -1153,7 +1238,10 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 			{
 				CGameContext *GameServer = (CGameContext *) m_pGameServer;
 				if (GameServer->m_apPlayers[ClientID] && GameServer->m_apPlayers[ClientID]->m_ClientVersion < VERSION_DDNET_OLD)
+				{
 					GameServer->m_apPlayers[ClientID]->m_ClientVersion = VERSION_DDNET_OLD;
+					SetClientDDNet(ClientID, true);
+				}
 			} else
 			if((pPacket->m_Flags&NET_CHUNKFLAG_VITAL) != 0 && Unpacker.Error() == 0 && m_aClients[ClientID].m_Authed)
 			{
@@ -1298,7 +1386,10 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 
 void CServer::SendServerInfoConnless(const NETADDR *pAddr, int Token, int Type)
 {
-	const int MaxRequests = g_Config.m_SvServerInfoPerSecond;
+	// browsers ask again, the players on the server come first
+	int MaxRequests = g_Config.m_SvServerInfoPerSecond;
+	if(m_OverloadLevel >= OVERLOAD_INFO_EVENTS)
+		MaxRequests = max(1, MaxRequests/4);
 	int64_t Now = Tick();
 	if(abs(Now - m_ServerInfoFirstRequest) <= TickSpeed())
 	{
@@ -1318,6 +1409,7 @@ void CServer::SendServerInfoConnless(const NETADDR *pAddr, int Token, int Type)
 	}
 
 	bool SendResponse = m_ServerInfoNumRequests <= MaxRequests && !m_ServerInfoHighLoad;
+	m_Metrics.Inc(SendResponse ? METRIC_INFO_SERVED : METRIC_INFO_THROTTLED);
 	if(!SendResponse) {
 		constexpr int MaxRecords = 50;
 		constexpr int MaxRecordsTime = 20; // Seconds
@@ -1733,6 +1825,63 @@ void CServer::PumpNetwork(bool PacketWaiting)
 
 	m_ServerBan.Update();
 	m_Econ.Update();
+	m_MetricsServer.Update(&m_Metrics);
+	m_DemoStream.Update();
+}
+
+void CServer::UpdateMetrics()
+{
+	NETSTATS Stats;
+	net_stats(&Stats);
+	m_Metrics.Set(METRIC_SENT_PACKETS, Stats.sent_packets);
+	m_Metrics.Set(METRIC_SENT_BYTES, Stats.sent_bytes);
+	m_Metrics.Set(METRIC_RECV_PACKETS, Stats.recv_packets);
+	m_Metrics.Set(METRIC_RECV_BYTES, Stats.recv_bytes);
+	m_Metrics.Set(METRIC_RESENT_CHUNKS, CNetConnection::ms_NumResentChunks);
+	m_Metrics.Set(METRIC_DROPS, m_NetServer.m_NumDrops);
+	m_Metrics.Set(METRIC_BAN_HITS, m_NetServer.m_NumBanHits);
+
+	int Clients = 0, Players = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClients[i].m_State == CClient::STATE_EMPTY)
+			continue;
+		Clients++;
+		if(m_aClients[i].m_State == CClient::STATE_INGAME)
+			Players++;
+	}
+	m_Metrics.Set(METRIC_CLIENTS, Clients);
+	m_Metrics.Set(METRIC_PLAYERS, Players);
+	m_Metrics.Set(METRIC_OVERLOAD_LEVEL, m_OverloadLevel);
+	m_Metrics.Set(METRIC_OVERLOAD_CHANGES, m_Overload.m_NumChanges);
+	m_Metrics.Set(METRIC_DEMO_QUEUE_BYTES, m_DemoWriter.QueuedBytes());
+	m_Metrics.Set(METRIC_DEMO_DROPPED, m_DemoWriter.m_NumDropped);
+	m_Metrics.Set(METRIC_DEMO_DEGRADED, m_DemoWriter.m_NumDegraded);
+	m_Metrics.Set(METRIC_DEMO_STREAM_READERS, m_DemoStream.NumConnections());
+	m_Metrics.Set(METRIC_DEMO_STREAM_DROPPED, m_DemoStream.m_NumDropped);
+}
+
+void CServer::UpdateOverload(bool Active)
+{
+	// an empty server sleeps between ticks, nothing to shed there
+	int OldLevel = m_Overload.Level();
+	if(g_Config.m_SvOverload && Active)
+	{
+		// how much of the current tick had passed when we were done with it
+		float Load = (time_get_impl() - TickStartTime(m_CurrentGameTick)) / (float)(time_freq()/TickSpeed());
+		m_Overload.Update(Load, g_Config.m_SvOverloadHigh, g_Config.m_SvOverloadLow, TickSpeed());
+	}
+	else
+		m_Overload.Reset();
+
+	m_OverloadLevel = m_Overload.Level();
+	if(m_OverloadLevel != OldLevel)
+	{
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "overload level %d -> %d (%s), load %d%%", OldLevel, m_OverloadLevel,
+			COverloadGovernor::LevelName(m_OverloadLevel), (int)(m_Overload.Load()*100));
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
 }
 
 char *CServer::GetMapName()
@@ -1830,6 +1979,8 @@ int CServer::Run()
 		return -1;
 	}
 
+	m_DemoWriter.Init(g_Config.m_SvDemoBuffer*1024);
+
 	// start server
 	NETADDR BindAddr;
 	if(g_Config.m_Bindaddr[0] && net_host_lookup(g_Config.m_Bindaddr, &BindAddr, NETTYPE_ALL) == 0)
@@ -1845,7 +1996,8 @@ int CServer::Run()
 		BindAddr.port = g_Config.m_SvPort;
 	}
 
-	if(!m_NetServer.Open(BindAddr, &m_ServerBan, g_Config.m_SvMaxClients, g_Config.m_SvMaxClientsPerIP, 0))
+	m_NumBots = g_Config.m_SvBots;
+	if(!m_NetServer.Open(BindAddr, &m_ServerBan, min(g_Config.m_SvMaxClients, MAX_CLIENTS-m_NumBots), g_Config.m_SvMaxClientsPerIP, 0))
 	{
 		dbg_msg("server", "couldn't open socket. port %d might already be in use", g_Config.m_SvPort);
 		return -1;
@@ -1866,7 +2018,42 @@ int CServer::Run()
 	str_format(aBuf, sizeof(aBuf), "server name is '%s'", g_Config.m_SvName);
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
+	if(g_Config.m_SvMetricsPort)
+	{
+		NETADDR MetricsAddr;
+		if(!g_Config.m_SvMetricsBindaddr[0] || net_host_lookup(g_Config.m_SvMetricsBindaddr, &MetricsAddr, NETTYPE_ALL) != 0)
+		{
+			mem_zero(&MetricsAddr, sizeof(MetricsAddr));
+			MetricsAddr.type = NETTYPE_ALL;
+		}
+		MetricsAddr.port = g_Config.m_SvMetricsPort;
+
+		if(m_MetricsServer.Open(MetricsAddr))
+			str_format(aBuf, sizeof(aBuf), "metrics bound to %s:%d", g_Config.m_SvMetricsBindaddr, g_Config.m_SvMetricsPort);
+		else
+			str_format(aBuf, sizeof(aBuf), "couldn't open metrics socket. port might already be in use");
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+
+	if(g_Config.m_SvDemoStreamPort)
+	{
+		NETADDR StreamAddr;
+		if(!g_Config.m_SvDemoStreamBindaddr[0] || net_host_lookup(g_Config.m_SvDemoStreamBindaddr, &StreamAddr, NETTYPE_ALL) != 0)
+		{
+			mem_zero(&StreamAddr, sizeof(StreamAddr));
+			StreamAddr.type = NETTYPE_ALL;
+		}
+		StreamAddr.port = g_Config.m_SvDemoStreamPort;
+
+		if(m_DemoStream.Open(StreamAddr, &m_SnapshotDelta))
+			str_format(aBuf, sizeof(aBuf), "demo stream bound to %s:%d", g_Config.m_SvDemoStreamBindaddr, g_Config.m_SvDemoStreamPort);
+		else
+			str_format(aBuf, sizeof(aBuf), "couldn't open demo stream socket. port might already be in use");
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+
 	GameServer()->OnInit();
+	m_DemoStream.SetMap(GameServer()->NetVersion(), m_aCurrentMap, m_CurrentMapCrc, m_pCurrentMapData, m_CurrentMapSize);
 	str_format(aBuf, sizeof(aBuf), "version %s", GameServer()->NetVersion());
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
@@ -1926,6 +2113,7 @@ int CServer::Run()
 					m_ServerInfoFirstRequest = 0;
 					Kernel()->ReregisterInterface(GameServer());
 					GameServer()->OnInit();
+					m_DemoStream.SetMap(GameServer()->NetVersion(), m_aCurrentMap, m_CurrentMapCrc, m_pCurrentMapData, m_CurrentMapSize);
 					UpdateServerInfo(true);
 				}
 				else
@@ -1941,44 +2129,87 @@ int CServer::Run()
 				m_CurrentGameTick++;
 				NewTicks++;
 
-				// apply new input
-				for(int c = 0; c < MAX_CLIENTS; c++)
+				int64 TickStart = time_get_impl();
+
+				// how late the first tick of this pass started, an empty server sleeps through ticks
+				if(NewTicks == 1 && !NonActive)
 				{
-					if (c == MAX_CLIENTS-1) // bot player. bugfix for the bot's "jittery", teleport-ish movement
-						GameServer()->OnClientPredictedInput(c, NULL);
+					int64 Late = TickStart - TickStartTime(m_CurrentGameTick);
+					m_Profiler.Add(PROFILE_JITTER, Late);
+					m_Metrics.Observe(METRIC_TICK_JITTER, Late/(double)time_freq());
+				}
 
-					if(m_aClients[c].m_State != CClient::STATE_INGAME)
-						continue;
-					for(int i = 0; i < 200; i++)
+				// apply new input
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_INPUT);
+					for(int c = 0; c < MAX_CLIENTS; c++)
 					{
-						if(m_aClients[c].m_aInputs[i].m_GameTick == Tick())
+						if (IsBot(c)) // bot player. bugfix for the bot's "jittery", teleport-ish movement
+							GameServer()->OnClientPredictedInput(c, NULL);
+
+						if(m_aClients[c].m_State != CClient::STATE_INGAME)
+							continue;
+						for(int i = 0; i < 200; i++)
 						{
-							GameServer()->OnClientPredictedInput(c, m_aClients[c].m_aInputs[i].m_aData);
-							break;
+							if(m_aClients[c].m_aInputs[i].m_GameTick == Tick())
+							{
+								GameServer()->OnClientPredictedInput(c, m_aClients[c].m_aInputs[i].m_aData);
+								break;
+							}
 						}
 					}
 				}
 
-				GameServer()->OnTick();
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_TICK);
+					GameServer()->OnTick();
+				}
+				m_Metrics.Observe(METRIC_TICK_DURATION, (time_get_impl()-TickStart)/(double)time_freq());
 			}
 
 			// snap game
 			if(NewTicks)
 			{
 				if(g_Config.m_SvHighBandwidth || (m_CurrentGameTick%2) == 0)
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_SNAP);
 					DoSnapshot();
+				}
 
-				UpdateClientRconCommands();
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_RCONCOMMANDS);
+					UpdateClientRconCommands();
+				}
 
 				// master server stuff
-				m_pRegister->Update();
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_REGISTER);
+					m_pRegister->Update();
+				}
 
 				if(m_ServerInfoNeedsUpdate)
+				{
+					CProfileScope Scope(&m_Profiler, PROFILE_SERVERINFO);
 					UpdateServerInfo();
+				}
+
+				UpdateOverload(!NonActive);
+				UpdateMetrics();
+
+				m_Profiler.m_Enabled = g_Config.m_SvProfiler;
+				m_Profiler.Update(t, g_Config.m_SvProfilerWindow);
+				if(g_Config.m_SvProfilerLog && t > m_LastProfilerLog + g_Config.m_SvProfilerLog*time_freq())
+				{
+					m_LastProfilerLog = t;
+					m_Profiler.Report(Console());
+				}
 			}
 
 			if(!NonActive)
+			{
+				CProfileScope Scope(&m_Profiler, PROFILE_NETWORK);
 				PumpNetwork(PacketWaiting);
+			}
 
 			NonActive = true;
 
@@ -2016,9 +2247,14 @@ int CServer::Run()
 
 				set_new_tick();
 				t = time_get();
-				int x = (TickStartTime(m_CurrentGameTick + 1) - t) * 1000000 / time_freq() + 1;
+				if(g_Config.m_SvTickPrecise)
+					PacketWaiting = net_socket_read_wait_until(m_NetServer.Socket(), TickStartTime(m_CurrentGameTick + 1), g_Config.m_SvTickBusyPoll);
+				else
+				{
+					int x = (TickStartTime(m_CurrentGameTick + 1) - t) * 1000000 / time_freq() + 1;
 
-				PacketWaiting = x > 0 ? net_socket_read_wait(m_NetServer.Socket(), x) : true;
+					PacketWaiting = x > 0 ? net_socket_read_wait(m_NetServer.Socket(), x) : true;
+				}
 			}
 		}
 	}
@@ -2031,8 +2267,15 @@ int CServer::Run()
 	m_NetServer.Close();
 	m_pRegister->OnShutdown();
 	m_Econ.Shutdown();
+	m_MetricsServer.Shutdown();
+	m_DemoStream.Shutdown();
 	m_Http.Shutdown();
 
+	// let the writer finish the demos that are still open
+	for(int i = 0; i < MAX_CLIENTS+1; i++)
+		m_aDemoRecorder[i].Stop();
+	m_DemoWriter.Shutdown();
+
 	GameServer()->OnShutdown();
 	m_pMap->Unload();
 
@@ -2217,6 +2460,12 @@ void CServer::ConLogout(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConPerfReport(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pServer = (CServer *)pUser;
+	pServer->m_Profiler.Report(pServer->Console());
+}
+
 void CServer::ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -2339,6 +2588,7 @@ void CServer::RegisterCommands()
 	Console()->Register("status", "", CFGFLAG_SERVER, ConStatus, this, "List players");
 	Console()->Register("shutdown", "", CFGFLAG_SERVER, ConShutdown, this, "Shut down");
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon");
+	Console()->Register("perf_report", "", CFGFLAG_SERVER, ConPerfReport, this, "Show p50/p99/max durations of the server tick phases");
 
 	Console()->Register("record", "?s[file]", CFGFLAG_SERVER|CFGFLAG_STORE, ConRecord, this, "Record to a file");
 	Console()->Register("stoprecord", "", CFGFLAG_SERVER, ConStopRecord, this, "Stop recording");
@@ -2532,11 +2782,6 @@ char *CServer::GetAnnouncementLine(char const *pFileName)
 	return 0;
 }
 
-int* CServer::GetIdMap(int ClientID)
-{
-	return (int*)(IdMap + VANILLA_MAX_CLIENTS * ClientID);
-}
-
 // DDNet
 enum
 {
@@ -9,9 +9,12 @@
 
 #include <engine/map.h>
 #include <engine/shared/demo.h>
+#include <engine/shared/demostream.h>
+#include <engine/shared/demowriter.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
 #include <engine/shared/network.h>
+#include <engine/server/overload.h>
 #include <engine/server/register.h>
 #include <engine/shared/console.h>
 #include <base/math.h>
@@ -19,6 +22,8 @@
 #include <engine/shared/econ.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/http.h>
+#include <engine/shared/metrics.h>
+#include <engine/shared/profiler.h>
 
 class CSnapIDPool
 {
@@ -82,6 +87,8 @@ class CServer : public IServer
 
 public:
 	class IGameServer *GameServer() { return m_pGameServer; }
+	CProfiler *Profiler() { return &m_Profiler; }
+	CMetrics *Metrics() { return &m_Metrics; }
 	class IConsole *Console() { return m_pConsole; }
 	class IStorage *Storage() { return m_pStorage; }
 
@@ -138,6 +145,7 @@ public:
 		char m_aName[MAX_NAME_LENGTH];
 		char m_aClan[MAX_CLAN_LENGTH];
 		int m_Country;
+		int m_InfoVersion; // changes whenever name, clan or country do
 		int m_Score;
 		int m_Authed;
 		int m_AuthTries;
@@ -158,7 +166,9 @@ public:
 	};
 
 	CClient m_aClients[MAX_CLIENTS];
-	int IdMap[MAX_CLIENTS * VANILLA_MAX_CLIENTS];
+	int m_InfoVersion;
+
+	void ClientInfoChanged(int ClientID) { m_aClients[ClientID].m_InfoVersion = ++m_InfoVersion; }
 
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
@@ -168,6 +178,51 @@ public:
 	CServerBan m_ServerBan;
 	CHttp m_Http;
 
+	enum
+	{
+		PROFILE_INPUT=0,
+		PROFILE_TICK,
+		PROFILE_SNAP,
+		PROFILE_RCONCOMMANDS,
+		PROFILE_REGISTER,
+		PROFILE_SERVERINFO,
+		PROFILE_NETWORK,
+		PROFILE_JITTER,
+	};
+	CProfiler m_Profiler;
+	int64 m_LastProfilerLog;
+
+	enum
+	{
+		METRIC_TICK_DURATION=0,
+		METRIC_SNAPSHOT_BYTES,
+		METRIC_SENT_PACKETS,
+		METRIC_SENT_BYTES,
+		METRIC_RECV_PACKETS,
+		METRIC_RECV_BYTES,
+		METRIC_RESENT_CHUNKS,
+		METRIC_DROPS,
+		METRIC_BAN_HITS,
+		METRIC_INFO_SERVED,
+		METRIC_INFO_THROTTLED,
+		METRIC_CLIENTS,
+		METRIC_PLAYERS,
+		METRIC_OVERLOAD_LEVEL,
+		METRIC_OVERLOAD_CHANGES,
+		METRIC_TICK_JITTER,
+		METRIC_DEMO_QUEUE_BYTES,
+		METRIC_DEMO_DROPPED,
+		METRIC_DEMO_DEGRADED,
+		METRIC_DEMO_STREAM_READERS,
+		METRIC_DEMO_STREAM_DROPPED,
+	};
+	CMetrics m_Metrics;
+	CMetricsServer m_MetricsServer;
+	void UpdateMetrics();
+
+	COverloadGovernor m_Overload;
+	void UpdateOverload(bool Active);
+
 	IEngineMap *m_pMap;
 
 	int64 m_GameStartTime;
@@ -190,7 +245,9 @@ public:
 
 	int m_GeneratedRconPassword;
 
+	CDemoWriter m_DemoWriter;
 	CDemoRecorder m_aDemoRecorder[MAX_CLIENTS+1];
+	CDemoStream m_DemoStream;
 
 	int m_RconRestrict;
 
@@ -207,6 +264,7 @@ public:
 
 	virtual void SetClientName(int ClientID, const char *pName);
 	virtual void SetClientClan(int ClientID, char const *pClan);
+	virtual int ClientInfoVersion(int ClientID);
 	virtual void SetClientCountry(int ClientID, int Country);
 	virtual void SetClientScore(int ClientID, int Score);
 
@@ -234,6 +292,7 @@ public:
 	int MaxClients() const;
 
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID);
+	virtual void SendStreamMsg(CMsgPacker *pMsg, int Flags);
 
 	void DoSnapshot();
 
@@ -285,6 +344,7 @@ public:
 	static void ConStopRecord(IConsole::IResult *pResult, void *pUser);
 	static void ConMapReload(IConsole::IResult *pResult, void *pUser);
 	static void ConLogout(IConsole::IResult *pResult, void *pUser);
+	static void ConPerfReport(IConsole::IResult *pResult, void *pUser);
 	static void ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainCommandAccessUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -312,7 +372,6 @@ public:
 	unsigned m_AnnouncementLastLine;
 	void RestrictRconOutput(int ClientID) { m_RconRestrict = ClientID; }
 
-	virtual int* GetIdMap(int ClientID);
 
 	// DDNet
 	void SendCapabilities(int ClientID);
@@ -136,6 +136,7 @@ MACRO_CONFIG_INT(SvPort, sv_port, 8303, 0, 0, CFGFLAG_SERVER, "Port to use for t
 MACRO_CONFIG_INT(SvExternalPort, sv_external_port, 0, 0, 0, CFGFLAG_SERVER, "External port to report to the master servers")
 MACRO_CONFIG_STR(SvMap, sv_map, 128, "WarioWare", CFGFLAG_SERVER, "Map to use on the server")
 MACRO_CONFIG_INT(SvMaxClients, sv_max_clients, MAX_CLIENTS, 1, MAX_CLIENTS-1, CFGFLAG_SERVER, "Maximum number of clients that are allowed on a server")
+MACRO_CONFIG_INT(SvBots, sv_bots, 1, 1, 16, CFGFLAG_SERVER, "Number of slots at the top kept for server side bots (needs a restart)")
 MACRO_CONFIG_INT(SvMaxClientsPerIP, sv_max_clients_per_ip, 4, 1, MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients with the same IP that can connect to the server")
 MACRO_CONFIG_INT(SvHighBandwidth, sv_high_bandwidth, 0, 0, 1, CFGFLAG_SERVER, "Use high bandwidth mode. Doubles the bandwidth required for the server. LAN use only")
 MACRO_CONFIG_STR(SvRegister, sv_register, 16, "1", CFGFLAG_SERVER, "Register server with master server for public listing, can also accept a comma-separated list of protocols to register on, like 'ipv4,ipv6'")
@@ -154,6 +155,7 @@ MACRO_CONFIG_STR(SvMapDownloadUrl, sv_map_download_url, 256, "", CFGFLAG_SERVER,
 
 MACRO_CONFIG_INT(SvPlayerDemoRecord, sv_player_demo_record, 0, 0, 1, CFGFLAG_SERVER, "Automatically record demos for each player")
 MACRO_CONFIG_INT(SvDemoChat, sv_demo_chat, 0, 0, 1, CFGFLAG_SERVER, "Record chat for demos")
+MACRO_CONFIG_INT(SvDemoBuffer, sv_demo_buffer, 4096, 0, 65536, CFGFLAG_SERVER, "Size of the demo write queue in KiB (0 = write demos on the main thread)")
 MACRO_CONFIG_INT(SvServerInfoPerSecond, sv_server_info_per_second, 50, 1, 1000, CFGFLAG_SERVER, "Maximum number of complete server info responses that are sent out per second")
 MACRO_CONFIG_INT(SvVanConnPerSecond, sv_van_conn_per_second, 10, 1, 1000, CFGFLAG_SERVER, "Antispoof specific ratelimit")
 
@@ -229,6 +231,11 @@ MACRO_CONFIG_INT(SvSqlCreateTables, sv_sql_create_tables, 1, 0, 1, CFGFLAG_SERVE
 MACRO_CONFIG_STR(SvSqlDatabase, sv_sql_database, 16, "teeworlds", CFGFLAG_SERVER, "SQL Database name")
 MACRO_CONFIG_STR(SvSqlServerName, sv_sql_servername, 5, "UNK", CFGFLAG_SERVER, "SQL Server name that is inserted into record table")
 MACRO_CONFIG_STR(SvSqlPrefix, sv_sql_prefix, 16, "record", CFGFLAG_SERVER, "SQL Database table prefix")
+MACRO_CONFIG_INT(SvSqlWorkers, sv_sql_workers, 2, 1, 8, CFGFLAG_SERVER, "Number of SQL worker threads, each keeps its own connection")
+MACRO_CONFIG_INT(SvSqlQueueSize, sv_sql_queue_size, 256, 16, 4096, CFGFLAG_SERVER, "Maximum number of queued SQL requests")
+MACRO_CONFIG_INT(SvSqlBatchInterval, sv_sql_batch_interval, 1000, 50, 60000, CFGFLAG_SERVER, "Milliseconds between writing the spooled finishes to the database")
+MACRO_CONFIG_INT(SvSqlBatchSize, sv_sql_batch_size, 64, 1, 256, CFGFLAG_SERVER, "Maximum number of spooled finishes written in one transaction")
+MACRO_CONFIG_STR(SvSqlSpool, sv_sql_spool, 128, "sql_spool.dat", CFGFLAG_SERVER, "File that keeps finishes until they are in the database")
 MACRO_CONFIG_INT(SvSaveGames, sv_savegames, 1, 0, 1, CFGFLAG_SERVER, "Enables savegames (/save and /load)")
 MACRO_CONFIG_INT(SvSaveGamesDelay, sv_savegames_delay, 60, 0, 10000, CFGFLAG_SERVER, "Delay in seconds for loading a savegame")
 #endif
@@ -351,6 +358,26 @@ MACRO_CONFIG_STR(SvClientSuggestionBot, sv_client_suggestion_bot, 128, "Your cli
 MACRO_CONFIG_INT(SvNetlimit, sv_netlimit, 0, 0, 10000, CFGFLAG_SERVER, "Netlimit: Maximum amount of traffic a client is allowed to use (in kb/s)")
 MACRO_CONFIG_INT(SvNetlimitAlpha, sv_netlimit_alpha, 50, 1, 100, CFGFLAG_SERVER, "Netlimit: Alpha of Exponention moving average")
 
+// profiler
+MACRO_CONFIG_INT(SvProfiler, sv_profiler, 1, 0, 1, CFGFLAG_SERVER, "Time the phases of every server tick")
+MACRO_CONFIG_INT(SvProfilerWindow, sv_profiler_window, 10, 1, 3600, CFGFLAG_SERVER, "Length of a profiler window in seconds, reports cover the last one to two windows")
+MACRO_CONFIG_INT(SvProfilerLog, sv_profiler_log, 0, 0, 3600, CFGFLAG_SERVER, "Print the profiler report every this many seconds (0 = never)")
+
+// tick scheduling
+MACRO_CONFIG_INT(SvTickPrecise, sv_tick_precise, 1, 0, 1, CFGFLAG_SERVER, "Wait for the next tick on a precise timer instead of a select timeout")
+MACRO_CONFIG_INT(SvTickBusyPoll, sv_tick_busy_poll, 0, 0, 5000, CFGFLAG_SERVER, "Microseconds before a tick to stop sleeping and poll the socket (needs sv_tick_precise)")
+
+// overload
+MACRO_CONFIG_INT(SvOverload, sv_overload, 1, 0, 1, CFGFLAG_SERVER, "Shed work step by step when ticks fall behind")
+MACRO_CONFIG_INT(SvOverloadHigh, sv_overload_high, 80, 1, 1000, CFGFLAG_SERVER, "Tick load in percent of the tick period above which the overload level goes up")
+MACRO_CONFIG_INT(SvOverloadLow, sv_overload_low, 50, 0, 1000, CFGFLAG_SERVER, "Tick load in percent of the tick period below which the overload level goes down")
+
+// metrics
+MACRO_CONFIG_INT(SvMetricsPort, sv_metrics_port, 0, 0, 65535, CFGFLAG_SERVER, "Port to serve Prometheus metrics over HTTP on (0 = disabled)")
+MACRO_CONFIG_STR(SvMetricsBindaddr, sv_metrics_bindaddr, 128, "localhost", CFGFLAG_SERVER, "Address to bind the metrics endpoint to")
+MACRO_CONFIG_INT(SvDemoStreamPort, sv_demo_stream_port, 0, 0, 65535, CFGFLAG_SERVER, "Port to publish the server demo live on for spectator relays (0 = disabled)")
+MACRO_CONFIG_STR(SvDemoStreamBindaddr, sv_demo_stream_bindaddr, 128, "localhost", CFGFLAG_SERVER, "Address to bind the live demo stream to")
+
 MACRO_CONFIG_INT(ClUnpredictedShadow, cl_unpredicted_shadow, 0, 0, 1, CFGFLAG_CLIENT|CFGFLAG_SAVE, "Show unpredicted shadow tee to estimate your delay")
 MACRO_CONFIG_INT(ClPredictDDRace, cl_predict_ddrace, 1, 0, 1, CFGFLAG_CLIENT|CFGFLAG_SAVE, "Predict some DDRace tiles")
 MACRO_CONFIG_INT(ClShowNinja, cl_show_ninja, 1, 0, 1, CFGFLAG_CLIENT|CFGFLAG_SAVE, "Show ninja skin")
@@ -10,6 +10,7 @@
 
 #include "compression.h"
 #include "demo.h"
+#include "demowriter.h"
 #include "memheap.h"
 #include "network.h"
 #include "snapshot.h"
@@ -20,11 +21,17 @@ static const unsigned char gs_OldVersion = 3;
 static const unsigned char gs_VersionTickCompression = 5; // demo files with this version or higher will use `CHUNKTICKFLAG_TICK_COMPRESSED`
 static const int gs_LengthOffset = 152;
 static const int gs_NumMarkersOffset = 176;
+// the last two timeline marker slots point to the keyframe index
+static const int gs_IndexSlot = MAX_TIMELINE_MARKERS-2;
+static const int gs_IndexMagic = 0x54574958; // "TWIX"
+static const int gs_IndexVersion = 1;
 
 
-CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool DelayedMapData)
+CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool DelayedMapData, class CDemoWriter *pWriter)
 {
 	m_File = 0;
+	m_pWriter = pWriter;
+	m_pIndex = 0;
 	m_LastTickMarker = -1;
 	m_pSnapshotDelta = pSnapshotDelta;
 	m_DelayedMapData = DelayedMapData;
@@ -47,6 +54,7 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 
 	CDemoHeader Header;
 	CTimelineMarkers TimelineMarkers;
+	mem_zero(&TimelineMarkers, sizeof(TimelineMarkers));
 	if(m_File)
 		return -1;
 
@@ -85,24 +93,9 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	}
 
 	// write header
-	mem_zero(&Header, sizeof(Header));
-	mem_copy(Header.m_aMarker, gs_aHeaderMarker, sizeof(Header.m_aMarker));
-	Header.m_Version = gs_ActVersion;
-	str_copy(Header.m_aNetversion, pNetVersion, sizeof(Header.m_aNetversion));
-	str_copy(Header.m_aMapName, pMap, sizeof(Header.m_aMapName));
 	if(!m_DelayedMapData)
 		MapSize = io_length(MapFile);
-	Header.m_aMapSize[0] = (MapSize>>24)&0xff;
-	Header.m_aMapSize[1] = (MapSize>>16)&0xff;
-	Header.m_aMapSize[2] = (MapSize>>8)&0xff;
-	Header.m_aMapSize[3] = (MapSize)&0xff;
-	Header.m_aMapCrc[0] = (Crc>>24)&0xff;
-	Header.m_aMapCrc[1] = (Crc>>16)&0xff;
-	Header.m_aMapCrc[2] = (Crc>>8)&0xff;
-	Header.m_aMapCrc[3] = (Crc)&0xff;
-	str_copy(Header.m_aType, pType, sizeof(Header.m_aType));
-	// Header.m_Length - add this on stop
-	str_timestamp(Header.m_aTimestamp, sizeof(Header.m_aTimestamp));
+	FillHeader(&Header, pNetVersion, pMap, MapSize, Crc, pType);
 	io_write(DemoFile, &Header, sizeof(Header));
 	io_write(DemoFile, &TimelineMarkers, sizeof(TimelineMarkers)); // fill this on stop
 
@@ -126,8 +119,10 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 
 	m_LastKeyFrame = -1;
 	m_LastTickMarker = -1;
+	m_LastSnapshotTick = -1;
 	m_FirstTick = -1;
 	m_NumTimelineMarkers = 0;
+	m_pIndex = new CDemoIndex();
 
 	char aBuf[256];
 	str_format(aBuf, sizeof(aBuf), "Recording to '%s'", pFilename);
@@ -137,192 +132,338 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	return 0;
 }
 
-/*
-	Tickmarker
-		7	= Always set
-		6	= Keyframe flag
-		0-5	= Delta tick
-
-	Normal
-		7 = Not set
-		5-6	= Type
-		0-4	= Size
-*/
+void CDemoRecorder::FillHeader(CDemoHeader *pHeader, const char *pNetVersion, const char *pMap, unsigned MapSize, unsigned Crc, const char *pType)
+{
+	mem_zero(pHeader, sizeof(*pHeader));
+	mem_copy(pHeader->m_aMarker, gs_aHeaderMarker, sizeof(pHeader->m_aMarker));
+	pHeader->m_Version = gs_ActVersion;
+	str_copy(pHeader->m_aNetversion, pNetVersion, sizeof(pHeader->m_aNetversion));
+	str_copy(pHeader->m_aMapName, pMap, sizeof(pHeader->m_aMapName));
+	pHeader->m_aMapSize[0] = (MapSize>>24)&0xff;
+	pHeader->m_aMapSize[1] = (MapSize>>16)&0xff;
+	pHeader->m_aMapSize[2] = (MapSize>>8)&0xff;
+	pHeader->m_aMapSize[3] = (MapSize)&0xff;
+	pHeader->m_aMapCrc[0] = (Crc>>24)&0xff;
+	pHeader->m_aMapCrc[1] = (Crc>>16)&0xff;
+	pHeader->m_aMapCrc[2] = (Crc>>8)&0xff;
+	pHeader->m_aMapCrc[3] = (Crc)&0xff;
+	str_copy(pHeader->m_aType, pType, sizeof(pHeader->m_aType));
+	// m_aLength - add this on stop
+	str_timestamp(pHeader->m_aTimestamp, sizeof(pHeader->m_aTimestamp));
+}
 
-enum
+int CDemoRecorder::PackTickMarker(int Tick, int LastTick, int Keyframe, unsigned char *pMarker)
 {
-	CHUNKTYPEFLAG_TICKMARKER = 0x80,
-	CHUNKTICKFLAG_KEYFRAME = 0x40, // only when tickmarker is set
-	CHUNKTICKFLAG_TICK_COMPRESSED = 0x20, // when we store the tick value in the first chunk
+	if(LastTick == -1 || Tick-LastTick > CHUNKMASK_TICK || Tick-LastTick < 0 || Keyframe)
+	{
+		pMarker[0] = CHUNKTYPEFLAG_TICKMARKER;
+		pMarker[1] = (Tick>>24)&0xff;
+		pMarker[2] = (Tick>>16)&0xff;
+		pMarker[3] = (Tick>>8)&0xff;
+		pMarker[4] = (Tick)&0xff;
 
-	CHUNKMASK_TICK = 0x1f,
-	CHUNKMASK_TICK_LEGACY = 0x3f,
-	CHUNKMASK_TYPE = 0x60,
-	CHUNKMASK_SIZE = 0x1f,
+		if(Keyframe)
+			pMarker[0] |= CHUNKTICKFLAG_KEYFRAME;
 
-	CHUNKTYPE_SNAPSHOT = 1,
-	CHUNKTYPE_MESSAGE = 2,
-	CHUNKTYPE_DELTA = 3,
+		return 5;
+	}
 
-	CHUNKFLAG_BIGSIZE = 0x10
-};
+	pMarker[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick-LastTick);
+	return 1;
+}
 
-void CDemoRecorder::WriteTickMarker(int Tick, int Keyframe)
+int CDemoRecorder::PackChunk(int Type, const void *pData, int Size, int Packing, unsigned char *pOut, int OutSize)
 {
-	if(m_LastTickMarker == -1 || Tick-m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
-	{
-		unsigned char aChunk[5];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
-		aChunk[1] = (Tick>>24)&0xff;
-		aChunk[2] = (Tick>>16)&0xff;
-		aChunk[3] = (Tick>>8)&0xff;
-		aChunk[4] = (Tick)&0xff;
+	char aBuffer[64*1024];
+	char aBuffer2[64*1024];
 
-		if(Keyframe)
-			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
+	if(Packing == CHUNKDATA_COMPRESSED)
+		mem_copy(aBuffer2, pData, Size);
+	else if(Packing == CHUNKDATA_INTPACKED)
+		Size = CNetBase::Compress(pData, Size, aBuffer2, sizeof(aBuffer2));
+	else
+	{
+		/* pad the data with 0 so we get an alignment of 4,
+		else the compression won't work and miss some bytes */
+		mem_copy(aBuffer2, pData, Size);
+		while(Size&3)
+			aBuffer2[Size++] = 0;
+		Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
+		if(Size < 0)
+			return -1;
+		Size = CNetBase::Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
+	}
+	if(Size < 0 || Size+3 > OutSize)
+		return -1;
 
-		io_write(m_File, aChunk, sizeof(aChunk));
+	int HeaderSize;
+	pOut[0] = ((Type&0x3)<<5);
+	if(Size < 30)
+	{
+		pOut[0] |= Size;
+		HeaderSize = 1;
+	}
+	else if(Size < 256)
+	{
+		pOut[0] |= 30;
+		pOut[1] = Size&0xff;
+		HeaderSize = 2;
 	}
 	else
 	{
-		unsigned char aChunk[1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick-m_LastTickMarker);
-		io_write(m_File, aChunk, sizeof(aChunk));
+		pOut[0] |= 31;
+		pOut[1] = Size&0xff;
+		pOut[2] = Size>>8;
+		HeaderSize = 3;
 	}
 
-	m_LastTickMarker = Tick;
-	if(m_FirstTick < 0)
-		m_FirstTick = Tick;
+	mem_copy(pOut+HeaderSize, aBuffer2, Size);
+	return HeaderSize+Size;
 }
 
-void CDemoRecorder::Write(int Type, const void *pData, int Size)
+void CDemoRecorder::WriteChunk(IOHANDLE File, int Type, const void *pData, int Size, int Packing)
 {
-	char aBuffer[64*1024];
-	char aBuffer2[64*1024];
-	unsigned char aChunk[3];
+	unsigned char aChunk[64*1024+3];
+	int ChunkSize = PackChunk(Type, pData, Size, Packing, aChunk, sizeof(aChunk));
+	if(ChunkSize > 0)
+		io_write(File, aChunk, ChunkSize);
+}
 
+// Tick < 0 writes no tickmarker, Type < 0 writes only the tickmarker
+bool CDemoRecorder::Write(int Tick, int Keyframe, int Type, const void *pData, int Size, int Packing)
+{
 	if(!m_File)
-		return;
+		return false;
 
 	if(Size > 64*1024)
-		return;
-
-	/* pad the data with 0 so we get an alignment of 4,
-	else the compression won't work and miss some bytes */
-	mem_copy(aBuffer2, pData, Size);
-	while(Size&3)
-		aBuffer2[Size++] = 0;
-	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
-	if(Size < 0)
-		return;
-	Size = CNetBase::Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
+		Type = -1;
+	if(Type < 0)
+		Size = 0;
 
+	unsigned char aMarker[5] = {0};
+	int MarkerSize = Tick >= 0 ? PackTickMarker(Tick, m_LastTickMarker, Keyframe, aMarker) : 0;
+	if(!MarkerSize && Type < 0)
+		return false;
 
-	aChunk[0] = ((Type&0x3)<<5);
-	if(Size < 30)
+	if(m_pWriter && m_pWriter->IsRunning())
 	{
-		aChunk[0] |= Size;
-		io_write(m_File, aChunk, 1);
+		if(!m_pWriter->Write(m_File, Keyframe ? m_pIndex : 0, Tick, aMarker, MarkerSize, Type, pData, Size, Packing))
+			return false;
 	}
 	else
 	{
-		if(Size < 256)
-		{
-			aChunk[0] |= 30;
-			aChunk[1] = Size&0xff;
-			io_write(m_File, aChunk, 2);
-		}
-		else
-		{
-			aChunk[0] |= 31;
-			aChunk[1] = Size&0xff;
-			aChunk[2] = Size>>8;
-			io_write(m_File, aChunk, 3);
-		}
+		if(Keyframe && m_pIndex)
+			m_pIndex->Add(Tick, io_tell(m_File));
+		if(MarkerSize)
+			io_write(m_File, aMarker, MarkerSize);
+		if(Type >= 0)
+			WriteChunk(m_File, Type, pData, Size, Packing);
 	}
 
-	io_write(m_File, aBuffer2, Size);
+	if(Tick >= 0)
+	{
+		m_LastTickMarker = Tick;
+		if(m_FirstTick < 0)
+			m_FirstTick = Tick;
+	}
+	return true;
 }
 
-void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size, bool NetSnapshot)
 {
 	if(m_LastKeyFrame == -1 || (Tick-m_LastKeyFrame) > SERVER_TICK_SPEED*5)
 	{
-		// write full tickmarker
-		WriteTickMarker(Tick, 1);
-
-		// write snapshot
-		Write(CHUNKTYPE_SNAPSHOT, pData, Size);
-
-		m_LastKeyFrame = Tick;
-		mem_copy(m_aLastSnapshotData, pData, Size);
+		// write full tickmarker and snapshot
+		if(Write(Tick, 1, CHUNKTYPE_SNAPSHOT, pData, Size))
+		{
+			m_LastKeyFrame = Tick;
+			mem_copy(m_aLastSnapshotData, pData, Size);
+			m_LastSnapshotTick = NetSnapshot ? Tick : -1;
+		}
 	}
 	else
 	{
+		// the writer fell behind, only keep keyframes until it caught up
+		if(m_pWriter && m_pWriter->IsRunning() && m_pWriter->Congested())
+		{
+			m_pWriter->m_NumDropped++;
+			return;
+		}
+
 		// create delta, prepend tick
 		char aDeltaData[CSnapshot::MAX_SIZE+sizeof(int)];
-		int DeltaSize;
-
-		// write tickmarker
-		WriteTickMarker(Tick, 0);
-
-		DeltaSize = m_pSnapshotDelta->CreateDelta((CSnapshot*)m_aLastSnapshotData, (CSnapshot*)pData, &aDeltaData);
+		int DeltaSize = m_pSnapshotDelta->CreateDelta((CSnapshot*)m_aLastSnapshotData, (CSnapshot*)pData, &aDeltaData);
 		if(DeltaSize)
 		{
 			// record delta
-			Write(CHUNKTYPE_DELTA, aDeltaData, DeltaSize);
-			mem_copy(m_aLastSnapshotData, pData, Size);
+			if(Write(Tick, 0, CHUNKTYPE_DELTA, aDeltaData, DeltaSize))
+			{
+				mem_copy(m_aLastSnapshotData, pData, Size);
+				m_LastSnapshotTick = NetSnapshot ? Tick : -1;
+			}
 		}
+		else if(Write(Tick, 0, -1, 0, 0))
+			m_LastSnapshotTick = NetSnapshot ? Tick : -1;
+	}
+}
+
+bool CDemoRecorder::RecordNetDelta(int Tick, const void *pData, int Size, int DeltaTick, const void *pPackedDelta, int PackedSize)
+{
+	if(!m_File || DeltaTick < 0 || DeltaTick != m_LastSnapshotTick)
+		return false;
+	if(m_LastKeyFrame == -1 || (Tick-m_LastKeyFrame) > SERVER_TICK_SPEED*5)
+		return false;
+
+	if(m_pWriter && m_pWriter->IsRunning() && m_pWriter->Congested())
+	{
+		m_pWriter->m_NumDropped++;
+		return true;
 	}
+
+	// an empty delta means nothing changed, the tickmarker is enough
+	if(Write(Tick, 0, PackedSize ? CHUNKTYPE_DELTA : -1, pPackedDelta, PackedSize, CHUNKDATA_INTPACKED))
+	{
+		if(PackedSize)
+			mem_copy(m_aLastSnapshotData, pData, Size);
+		m_LastSnapshotTick = Tick;
+	}
+	return true;
 }
 
 void CDemoRecorder::RecordMessage(const void *pData, int Size)
 {
-	Write(CHUNKTYPE_MESSAGE, pData, Size);
+	if(m_pWriter && m_pWriter->IsRunning() && m_pWriter->Congested())
+	{
+		m_pWriter->m_NumDropped++;
+		return;
+	}
+
+	Write(-1, 0, CHUNKTYPE_MESSAGE, pData, Size);
 }
 
-int CDemoRecorder::Stop(bool Finalize)
+void CDemoRecorder::RecordTickMarker(int Tick, int Keyframe)
 {
-	if(!m_File)
-		return -1;
+	if(Write(Tick, Keyframe, -1, 0, 0) && Keyframe)
+		m_LastKeyFrame = Tick;
+}
+
+void CDemoRecorder::RecordChunk(int Type, const void *pData, int Size)
+{
+	Write(-1, 0, Type, pData, Size, CHUNKDATA_COMPRESSED);
+}
+
+void CDemoRecorder::WriteFinish(IOHANDLE File, int Length, int NumMarkers, const int *pMarkers, unsigned MapSize, const unsigned char *pMapData, CDemoIndex *pIndex)
+{
+	// append the keyframe index, thinned out if it doesn't fit into one chunk
+	long IndexPos = -1;
+	int NumKeyFrames = pIndex ? (int)pIndex->m_vKeyFrames.size() : 0;
+	if(NumKeyFrames)
+	{
+		static const int s_MaxKeyFrames = 4096; // keeps the packed chunk well below 64 KiB
+		int Step = (NumKeyFrames+s_MaxKeyFrames-1)/s_MaxKeyFrames;
+		int aIndex[4+2*s_MaxKeyFrames];
+		int Size = 0;
+		aIndex[Size++] = gs_IndexVersion;
+		aIndex[Size++] = pIndex->m_FirstTick;
+		aIndex[Size++] = pIndex->m_LastTick;
+		aIndex[Size++] = (NumKeyFrames+Step-1)/Step;
+		for(int i = 0; i < NumKeyFrames; i += Step)
+		{
+			aIndex[Size++] = pIndex->m_vKeyFrames[i].m_Tick;
+			aIndex[Size++] = (int)pIndex->m_vKeyFrames[i].m_Filepos;
+		}
+
+		io_seek(File, 0, IOSEEK_END);
+		IndexPos = io_tell(File);
+		WriteChunk(File, CHUNKTYPE_INDEX, aIndex, Size*sizeof(int));
+	}
 
 	// add the demo length to the header
-	io_seek(m_File, gs_LengthOffset, IOSEEK_START);
-	int DemoLength = Length();
+	io_seek(File, gs_LengthOffset, IOSEEK_START);
 	char aLength[4];
-	aLength[0] = (DemoLength>>24)&0xff;
-	aLength[1] = (DemoLength>>16)&0xff;
-	aLength[2] = (DemoLength>>8)&0xff;
-	aLength[3] = (DemoLength)&0xff;
-	io_write(m_File, aLength, sizeof(aLength));
+	aLength[0] = (Length>>24)&0xff;
+	aLength[1] = (Length>>16)&0xff;
+	aLength[2] = (Length>>8)&0xff;
+	aLength[3] = (Length)&0xff;
+	io_write(File, aLength, sizeof(aLength));
 
 	// add the timeline markers to the header
-	io_seek(m_File, gs_NumMarkersOffset, IOSEEK_START);
+	io_seek(File, gs_NumMarkersOffset, IOSEEK_START);
 	char aNumMarkers[4];
-	aNumMarkers[0] = (m_NumTimelineMarkers>>24)&0xff;
-	aNumMarkers[1] = (m_NumTimelineMarkers>>16)&0xff;
-	aNumMarkers[2] = (m_NumTimelineMarkers>>8)&0xff;
-	aNumMarkers[3] = (m_NumTimelineMarkers)&0xff;
-	io_write(m_File, aNumMarkers, sizeof(aNumMarkers));
-	for(int i = 0; i < m_NumTimelineMarkers; i++)
-	{
-		int Marker = m_aTimelineMarkers[i];
+	aNumMarkers[0] = (NumMarkers>>24)&0xff;
+	aNumMarkers[1] = (NumMarkers>>16)&0xff;
+	aNumMarkers[2] = (NumMarkers>>8)&0xff;
+	aNumMarkers[3] = (NumMarkers)&0xff;
+	io_write(File, aNumMarkers, sizeof(aNumMarkers));
+	for(int i = 0; i < NumMarkers; i++)
+	{
+		int Marker = pMarkers[i];
 		char aMarker[4];
 		aMarker[0] = (Marker>>24)&0xff;
 		aMarker[1] = (Marker>>16)&0xff;
 		aMarker[2] = (Marker>>8)&0xff;
 		aMarker[3] = (Marker)&0xff;
-		io_write(m_File, aMarker, sizeof(aMarker));
+		io_write(File, aMarker, sizeof(aMarker));
 	}
 
-	if(Finalize && m_DelayedMapData)
+	if(IndexPos >= 0)
 	{
-		io_seek(m_File, gs_NumMarkersOffset + sizeof(CTimelineMarkers), IOSEEK_START);
-		io_write(m_File, m_pMapData, m_MapSize);
+		int aSlots[2] = {gs_IndexMagic, (int)IndexPos};
+		io_seek(File, gs_NumMarkersOffset + 4 + gs_IndexSlot*4, IOSEEK_START);
+		for(int i = 0; i < 2; i++)
+		{
+			char aSlot[4];
+			aSlot[0] = (aSlots[i]>>24)&0xff;
+			aSlot[1] = (aSlots[i]>>16)&0xff;
+			aSlot[2] = (aSlots[i]>>8)&0xff;
+			aSlot[3] = (aSlots[i])&0xff;
+			io_write(File, aSlot, sizeof(aSlot));
+		}
+	}
+
+	if(pMapData)
+	{
+		io_seek(File, gs_NumMarkersOffset + sizeof(CTimelineMarkers), IOSEEK_START);
+		io_write(File, pMapData, MapSize);
+	}
+
+	io_close(File);
+}
+
+int CDemoRecorder::Stop(bool Finalize)
+{
+	if(!m_File)
+		return -1;
+
+	bool WriteMap = Finalize && m_DelayedMapData;
+	m_pIndex->m_FirstTick = m_FirstTick;
+	m_pIndex->m_LastTick = m_LastTickMarker;
+	if(m_pWriter && m_pWriter->IsRunning())
+	{
+		// the map might be unloaded before the writer gets here
+		CDemoWriter::CFinishInfo Info;
+		Info.m_Length = Length();
+		Info.m_NumMarkers = m_NumTimelineMarkers;
+		mem_copy(Info.m_aMarkers, m_aTimelineMarkers, sizeof(Info.m_aMarkers));
+		Info.m_MapSize = 0;
+		Info.m_pMapData = 0;
+		Info.m_pIndex = m_pIndex;
+		if(WriteMap && m_pMapData)
+		{
+			Info.m_MapSize = m_MapSize;
+			Info.m_pMapData = (unsigned char *)mem_alloc(m_MapSize, 1);
+			mem_copy(Info.m_pMapData, m_pMapData, m_MapSize);
+		}
+		m_pWriter->Finish(m_File, &Info);
+	}
+	else
+	{
+		WriteFinish(m_File, Length(), m_NumTimelineMarkers, m_aTimelineMarkers, m_MapSize, WriteMap ? m_pMapData : 0, m_pIndex);
+		delete m_pIndex;
 	}
 
-	io_close(m_File);
 	m_File = 0;
+	m_pIndex = 0;
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", "Stopped recording");
 
 	return 0;
@@ -330,7 +471,7 @@ int CDemoRecorder::Stop(bool Finalize)
 
 void CDemoRecorder::AddDemoMarker()
 {
-	if(m_LastTickMarker < 0 || m_NumTimelineMarkers >= MAX_TIMELINE_MARKERS)
+	if(m_LastTickMarker < 0 || m_NumTimelineMarkers >= gs_IndexSlot)
 		return;
 
 	// not more than 1 marker in a second
@@ -426,6 +567,47 @@ int CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
 	return 0;
 }
 
+bool CDemoPlayer::LoadIndex()
+{
+	if(m_Info.m_Header.m_Version <= gs_OldVersion || m_Info.m_Info.m_NumTimelineMarkers > gs_IndexSlot)
+		return false;
+
+	int aSlots[2];
+	for(int i = 0; i < 2; i++)
+	{
+		const char *pSlot = m_Info.m_TimelineMarkers.m_aTimelineMarkers[gs_IndexSlot+i];
+		aSlots[i] = ((pSlot[0]<<24)&0xFF000000) | ((pSlot[1]<<16)&0xFF0000) | ((pSlot[2]<<8)&0xFF00) | (pSlot[3]&0xFF);
+	}
+	long StartPos = io_tell(m_File);
+	if(aSlots[0] != gs_IndexMagic || aSlots[1] < StartPos || aSlots[1] >= io_length(m_File))
+		return false;
+
+	static char aCompressed[CSnapshot::MAX_SIZE];
+	static int aIndex[CSnapshot::MAX_SIZE/sizeof(int)];
+	int ChunkType, ChunkSize, ChunkTick = 0;
+	int Size = -1;
+	io_seek(m_File, aSlots[1], IOSEEK_START);
+	if(!ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick) && ChunkType == CHUNKTYPE_INDEX &&
+		ChunkSize > 0 && io_read(m_File, aCompressed, ChunkSize) == (unsigned)ChunkSize)
+		Size = DecompressChunk(aCompressed, ChunkSize, aIndex, sizeof(aIndex));
+	io_seek(m_File, StartPos, IOSEEK_START);
+
+	int Num = Size >= (int)(4*sizeof(int)) ? aIndex[3] : -1;
+	if(aIndex[0] != gs_IndexVersion || Num < 0 || Size < (int)((4+2*Num)*sizeof(int)))
+		return false;
+
+	m_Info.m_Info.m_FirstTick = aIndex[1];
+	m_Info.m_Info.m_LastTick = aIndex[2];
+	m_Info.m_SeekablePoints = Num;
+	m_pKeyFrames = (CKeyFrame*)mem_alloc(max(Num, 1)*sizeof(CKeyFrame), 1);
+	for(int i = 0; i < Num; i++)
+	{
+		m_pKeyFrames[i].m_Tick = aIndex[4+i*2];
+		m_pKeyFrames[i].m_Filepos = aIndex[4+i*2+1];
+	}
+	return true;
+}
+
 void CDemoPlayer::ScanFile()
 {
 	long StartPos;
@@ -698,8 +880,11 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 
 		// save map
 		MapFile = pStorage->OpenFile(aMapFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
-		io_write(MapFile, pMapData, MapSize);
-		io_close(MapFile);
+		if(MapFile)
+		{
+			io_write(MapFile, pMapData, MapSize);
+			io_close(MapFile);
+		}
 
 		// free data
 		mem_free(pMapData);
@@ -725,8 +910,9 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 		}
 	}
 
-	// scan the file for interessting points
-	ScanFile();
+	// scan the file for interessting points, unless the demo brings its index
+	if(!LoadIndex())
+		ScanFile();
 
 	// reset slice markers
 	g_Config.m_ClDemoSliceBegin = -1;
@@ -796,6 +982,87 @@ int CDemoPlayer::SetPos(float Percent)
 	return 0;
 }
 
+int CDemoPlayer::SeekKeyFrame(int Tick)
+{
+	if(!m_File || !m_Info.m_SeekablePoints)
+		return -1;
+
+	// binary search for the last keyframe at or before the tick
+	int Low = 0, High = m_Info.m_SeekablePoints-1;
+	while(Low < High)
+	{
+		int Mid = (Low+High+1)/2;
+		if(m_pKeyFrames[Mid].m_Tick <= Tick)
+			Low = Mid;
+		else
+			High = Mid-1;
+	}
+
+	io_seek(m_File, m_pKeyFrames[Low].m_Filepos, IOSEEK_START);
+	m_Info.m_NextTick = -1;
+	m_Info.m_Info.m_CurrentTick = -1;
+	m_Info.m_PreviousTick = -1;
+	return m_pKeyFrames[Low].m_Tick;
+}
+
+int CDemoPlayer::ReadRawChunk(int *pType, int *pSize, int *pTick, void *pData, int DataSize)
+{
+	if(ReadChunkHeader(pType, pSize, pTick))
+		return -1;
+	if(*pSize > DataSize || (*pSize && io_read(m_File, pData, *pSize) != (unsigned)*pSize))
+		return -1;
+	return 0;
+}
+
+int CDemoPlayer::DecompressChunk(const void *pData, int Size, void *pOutput, int OutputSize)
+{
+	char aDecompressed[CSnapshot::MAX_SIZE];
+	Size = CNetBase::Decompress(pData, Size, aDecompressed, sizeof(aDecompressed));
+	if(Size < 0)
+		return -1;
+	return CVariableInt::Decompress(aDecompressed, Size, pOutput, OutputSize);
+}
+
+int CDemoPlayer::UnpackChunkHeader(const unsigned char *pData, int DataSize, int *pType, int *pSize, int *pTick)
+{
+	if(DataSize < 1)
+		return 0;
+
+	*pSize = 0;
+	int Chunk = pData[0];
+	if(Chunk&CHUNKTYPEFLAG_TICKMARKER)
+	{
+		*pType = Chunk&(CHUNKTYPEFLAG_TICKMARKER|CHUNKTICKFLAG_KEYFRAME);
+		if(Chunk&CHUNKTICKFLAG_TICK_COMPRESSED)
+		{
+			*pTick += Chunk&CHUNKMASK_TICK;
+			return 1;
+		}
+		if(DataSize < 5)
+			return 0;
+		*pTick = (pData[1]<<24) | (pData[2]<<16) | (pData[3]<<8) | pData[4];
+		return 5;
+	}
+
+	*pType = (Chunk&CHUNKMASK_TYPE)>>5;
+	*pSize = Chunk&CHUNKMASK_SIZE;
+	if(*pSize == 30)
+	{
+		if(DataSize < 2)
+			return 0;
+		*pSize = pData[1];
+		return 2;
+	}
+	if(*pSize == 31)
+	{
+		if(DataSize < 3)
+			return 0;
+		*pSize = (pData[2]<<8) | pData[1];
+		return 3;
+	}
+	return 1;
+}
+
 void CDemoPlayer::SetSpeed(float Speed)
 {
 	m_Info.m_Info.m_Speed = Speed;
@@ -928,52 +1195,102 @@ void CDemoEditor::Slice(const char *pDemo, const char *pDst, int StartTick, int
 	class CDemoPlayer DemoPlayer(m_pSnapshotDelta);
 	class CDemoRecorder DemoRecorder(m_pSnapshotDelta);
 
-	m_pDemoPlayer = &DemoPlayer;
-	m_pDemoRecorder = &DemoRecorder;
-
-	m_pDemoPlayer->SetListner(this);
-
-	m_SliceFrom = StartTick;
-	m_SliceTo = EndTick;
-	m_Stop = false;
-
-	if (m_pDemoPlayer->Load(m_pStorage, m_pConsole, pDemo, IStorage::TYPE_ALL) == -1)
+	if(DemoPlayer.Load(m_pStorage, m_pConsole, pDemo, IStorage::TYPE_ALL) == -1)
 		return;
 
-	const CDemoPlayer::CMapInfo *pMapInfo = m_pDemoPlayer->GetMapInfo();
-	if (m_pDemoRecorder->Start(m_pStorage, m_pConsole, pDst, m_pNetVersion, pMapInfo->m_aName, pMapInfo->m_Crc, "client") == -1)
+	const CDemoPlayer::CMapInfo *pMapInfo = DemoPlayer.GetMapInfo();
+	if(DemoRecorder.Start(m_pStorage, m_pConsole, pDst, m_pNetVersion, pMapInfo->m_aName, pMapInfo->m_Crc, DemoPlayer.Info()->m_Header.m_aType) == -1)
+	{
+		DemoPlayer.Stop();
 		return;
+	}
 
+	if(StartTick != -1)
+		DemoPlayer.SeekKeyFrame(StartTick);
 
-	m_pDemoPlayer->Play();
-	const CDemoPlayer::CPlaybackInfo *pInfo = m_pDemoPlayer->Info();
+	/*
+		Snapshots are only decoded up to the first tick of the slice,
+		which becomes the first keyframe. Everything after it refers to
+		that snapshot already, so the chunks are copied as they are.
+	*/
+	static char aChunk[CSnapshot::MAX_SIZE];
+	static char aData[CSnapshot::MAX_SIZE];
+	static char aSnapshot[CSnapshot::MAX_SIZE];
+	static char aNewSnapshot[CSnapshot::MAX_SIZE];
+	int SnapshotSize = -1;
+	int PendingTick = -1;
+	bool Copy = StartTick == -1;
+	int ChunkType, ChunkSize, ChunkTick = 0;
+
+	while(!DemoPlayer.ReadRawChunk(&ChunkType, &ChunkSize, &ChunkTick, aChunk, sizeof(aChunk)))
+	{
+		if(ChunkType&CHUNKTYPEFLAG_TICKMARKER)
+		{
+			// nothing changed in the first tick, the last snapshot is still valid
+			if(PendingTick != -1 && SnapshotSize >= 0)
+			{
+				DemoRecorder.RecordSnapshot(PendingTick, aSnapshot, SnapshotSize);
+				PendingTick = -1;
+				Copy = true;
+			}
 
-	while (m_pDemoPlayer->IsPlaying() && !m_Stop) {
-		m_pDemoPlayer->Update(false);
+			if(EndTick != -1 && ChunkTick > EndTick)
+				break;
+			if(Copy)
+				DemoRecorder.RecordTickMarker(ChunkTick, ChunkType&CHUNKTICKFLAG_KEYFRAME);
+			else if(StartTick == -1 || ChunkTick >= StartTick)
+				PendingTick = ChunkTick;
+			continue;
+		}
 
-		if (pInfo->m_Info.m_Paused)
-			break;
-	}
+		// the old index is rebuilt by the recorder
+		if(ChunkType == CHUNKTYPE_INDEX)
+			continue;
 
-	m_pDemoRecorder->Stop();
-}
+		if(Copy)
+		{
+			DemoRecorder.RecordChunk(ChunkType, aChunk, ChunkSize);
+			continue;
+		}
 
-void CDemoEditor::OnDemoPlayerSnapshot(void *pData, int Size)
-{
-	const CDemoPlayer::CPlaybackInfo *pInfo = m_pDemoPlayer->Info();
+		if(ChunkType == CHUNKTYPE_SNAPSHOT || ChunkType == CHUNKTYPE_DELTA)
+		{
+			int DataSize = CDemoPlayer::DecompressChunk(aChunk, ChunkSize, aData, sizeof(aData));
+			if(DataSize < 0)
+				break;
 
-	if (m_SliceTo != -1 && pInfo->m_Info.m_CurrentTick > m_SliceTo)
-		m_Stop = true;
-	else if (m_SliceFrom == -1 || pInfo->m_Info.m_CurrentTick >= m_SliceFrom)
-		m_pDemoRecorder->RecordSnapshot(pInfo->m_Info.m_CurrentTick, pData, Size);
-}
+			if(ChunkType == CHUNKTYPE_DELTA)
+			{
+				if(SnapshotSize < 0)
+					continue;
+				DataSize = m_pSnapshotDelta->UnpackDelta((CSnapshot*)aSnapshot, (CSnapshot*)aNewSnapshot, aData, DataSize);
+				if(DataSize < 0)
+					continue;
+				mem_copy(aSnapshot, aNewSnapshot, DataSize);
+			}
+			else
+				mem_copy(aSnapshot, aData, DataSize);
+			SnapshotSize = DataSize;
 
-void CDemoEditor::OnDemoPlayerMessage(void *pData, int Size)
-{
-	const CDemoPlayer::CPlaybackInfo *pInfo = m_pDemoPlayer->Info();
+			if(PendingTick != -1)
+			{
+				DemoRecorder.RecordSnapshot(PendingTick, aSnapshot, SnapshotSize);
+				PendingTick = -1;
+				Copy = true;
+			}
+		}
+		else if(PendingTick != -1 && SnapshotSize >= 0)
+		{
+			DemoRecorder.RecordSnapshot(PendingTick, aSnapshot, SnapshotSize);
+			PendingTick = -1;
+			Copy = true;
+			DemoRecorder.RecordChunk(ChunkType, aChunk, ChunkSize);
+		}
+	}
+
+	if(PendingTick != -1 && SnapshotSize >= 0)
+		DemoRecorder.RecordSnapshot(PendingTick, aSnapshot, SnapshotSize);
 
-	if (m_SliceTo != -1 && pInfo->m_Info.m_CurrentTick > m_SliceTo)
-		m_Stop = true;
-	else if (m_SliceFrom == -1 || pInfo->m_Info.m_CurrentTick >= m_SliceFrom)
-		m_pDemoRecorder->RecordMessage(pData, Size);
+	DemoPlayer.Stop();
+	DemoRecorder.Stop();
 }
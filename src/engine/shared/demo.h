@@ -8,6 +8,62 @@
 
 #include "snapshot.h"
 
+#include <vector>
+
+/*
+	Tickmarker
+		7	= Always set
+		6	= Keyframe flag
+		0-5	= Delta tick
+
+	Normal
+		7 = Not set
+		5-6	= Type
+		0-4	= Size
+*/
+
+enum
+{
+	CHUNKTYPEFLAG_TICKMARKER = 0x80,
+	CHUNKTICKFLAG_KEYFRAME = 0x40, // only when tickmarker is set
+	CHUNKTICKFLAG_TICK_COMPRESSED = 0x20, // when we store the tick value in the first chunk
+
+	CHUNKMASK_TICK = 0x1f,
+	CHUNKMASK_TICK_LEGACY = 0x3f,
+	CHUNKMASK_TYPE = 0x60,
+	CHUNKMASK_SIZE = 0x1f,
+
+	CHUNKTYPE_INDEX = 0, // skipped by players that don't know it
+	CHUNKTYPE_SNAPSHOT = 1,
+	CHUNKTYPE_MESSAGE = 2,
+	CHUNKTYPE_DELTA = 3,
+
+	CHUNKFLAG_BIGSIZE = 0x10
+};
+
+// keyframe positions, appended to the demo on stop
+class CDemoIndex
+{
+public:
+	struct CKeyFrame
+	{
+		long m_Filepos;
+		int m_Tick;
+	};
+
+	std::vector<CKeyFrame> m_vKeyFrames;
+	int m_FirstTick;
+	int m_LastTick;
+
+	void Add(int Tick, long Filepos)
+	{
+		CKeyFrame KeyFrame;
+		KeyFrame.m_Filepos = Filepos;
+		KeyFrame.m_Tick = Tick;
+		m_vKeyFrames.push_back(KeyFrame);
+	}
+};
+
 class CDemoRecorder : public IDemoRecorder
 {
 	class IConsole *m_pConsole;
@@ -16,25 +72,47 @@ class CDemoRecorder : public IDemoRecorder
 	int m_LastKeyFrame;
 	int m_FirstTick;
 	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
+	int m_LastSnapshotTick; // tick of the network snapshot m_aLastSnapshotData equals, -1 if none
 	class CSnapshotDelta *m_pSnapshotDelta;
 	int m_NumTimelineMarkers;
 	int m_aTimelineMarkers[MAX_TIMELINE_MARKERS];
 	bool m_DelayedMapData;
 	unsigned int m_MapSize;
 	unsigned char *m_pMapData;
+	class CDemoWriter *m_pWriter;
+	CDemoIndex *m_pIndex;
 
-	void WriteTickMarker(int Tick, int Keyframe);
-	void Write(int Type, const void *pData, int Size);
+	bool Write(int Tick, int Keyframe, int Type, const void *pData, int Size, int Packing = 0);
 public:
-	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool DelayedMapData = false);
+	enum
+	{
+		CHUNKDATA_RAW=0,
+		CHUNKDATA_INTPACKED, // still needs the huffman pass
+		CHUNKDATA_COMPRESSED, // copied from another demo
+	};
+
+	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool DelayedMapData = false, class CDemoWriter *pWriter = 0);
 	CDemoRecorder() {}
 
+	// chunk encoding, shared with the live demo stream
+	static void FillHeader(CDemoHeader *pHeader, const char *pNetVersion, const char *pMap, unsigned MapSize, unsigned Crc, const char *pType);
+	static int PackTickMarker(int Tick, int LastTick, int Keyframe, unsigned char *pMarker);
+	static int PackChunk(int Type, const void *pData, int Size, int Packing, unsigned char *pOut, int OutSize);
+	static void WriteChunk(IOHANDLE File, int Type, const void *pData, int Size, int Packing = CHUNKDATA_RAW);
+	static void WriteFinish(IOHANDLE File, int Length, int NumMarkers, const int *pMarkers, unsigned MapSize, const unsigned char *pMapData, CDemoIndex *pIndex);
+
 	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetversion, const char *pMap, unsigned MapCrc, const char *pType, unsigned int MapSize = 0, unsigned char *pMapData = 0);
 	int Stop(bool Finalize = false);
 	void AddDemoMarker();
 
-	void RecordSnapshot(int Tick, const void *pData, int Size);
+	// NetSnapshot: pData is exactly what was sent to the client this tick
+	void RecordSnapshot(int Tick, const void *pData, int Size, bool NetSnapshot = false);
+	// reuses the int packed network delta, false if it doesn't apply to the last recorded snapshot
+	bool RecordNetDelta(int Tick, const void *pData, int Size, int DeltaTick, const void *pPackedDelta, int PackedSize);
 	void RecordMessage(const void *pData, int Size);
+	// used by the demo editor to copy chunks without decoding them
+	void RecordTickMarker(int Tick, int Keyframe);
+	void RecordChunk(int Type, const void *pData, int Size);
 
 	bool IsRecording() const { return m_File != 0; }
 
@@ -109,6 +187,7 @@ private:
 
 	int ReadChunkHeader(int *pType, int *pSize, int *pTick);
 	void DoTick();
+	bool LoadIndex();
 	void ScanFile();
 	int NextFrame();
 
@@ -133,30 +212,28 @@ public:
 
 	int Update(bool RealTime=true);
 
+	// raw access for the demo editor
+	int SeekKeyFrame(int Tick);
+	int ReadRawChunk(int *pType, int *pSize, int *pTick, void *pData, int DataSize);
+	static int DecompressChunk(const void *pData, int Size, void *pOutput, int OutputSize);
+	// parses a chunk header from memory, returns its length or 0 if more data is needed
+	static int UnpackChunkHeader(const unsigned char *pData, int DataSize, int *pType, int *pSize, int *pTick);
+
 	const CPlaybackInfo *Info() const { return &m_Info; }
 	virtual bool IsPlaying() const { return m_File != 0; }
 	const CMapInfo *GetMapInfo() { return &m_MapInfo; };
 };
 
-class CDemoEditor : public IDemoEditor, public CDemoPlayer::IListner
+class CDemoEditor : public IDemoEditor
 {
-	CDemoPlayer *m_pDemoPlayer;
-	CDemoRecorder *m_pDemoRecorder;
 	IConsole *m_pConsole;
 	IStorage *m_pStorage;
 	class CSnapshotDelta *m_pSnapshotDelta;
 	const char *m_pNetVersion;
 
-	bool m_Stop;
-	int m_SliceFrom;
-	int m_SliceTo;
-
 public:
 	virtual void Init(const char *pNetVersion, class CSnapshotDelta *pSnapshotDelta, class IConsole *pConsole, class IStorage *pStorage);
 	virtual void Slice(const char *pDemo, const char *pDst, int StartTick, int EndTick);
-
-	virtual void OnDemoPlayerSnapshot(void *pData, int Size);
-	virtual void OnDemoPlayerMessage(void *pData, int Size);
 };
 
 #endif
@@ -0,0 +1,273 @@
+#include <base/math.h>
+
+#include "demo.h"
+#include "demostream.h"
+
+CDemoStream::CDemoStream()
+{
+	m_Ready = false;
+	m_pSnapshotDelta = 0;
+	m_pMapData = 0;
+	m_MapSize = 0;
+	m_LastTick = -1;
+	m_NumDropped = 0;
+	mem_zero(&m_Header, sizeof(m_Header));
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		m_aConnections[i].m_Active = false;
+}
+
+bool CDemoStream::Open(NETADDR BindAddr, CSnapshotDelta *pSnapshotDelta)
+{
+	m_pSnapshotDelta = pSnapshotDelta;
+	m_Socket = net_tcp_create(BindAddr);
+	if(!m_Socket)
+		return false;
+	if(net_tcp_listen(m_Socket, MAX_CONNECTIONS))
+	{
+		net_tcp_close(m_Socket);
+		return false;
+	}
+	net_set_non_blocking(m_Socket);
+	m_Ready = true;
+	return true;
+}
+
+void CDemoStream::SetMap(const char *pNetVersion, const char *pMap, unsigned Crc, const unsigned char *pMapData, unsigned MapSize)
+{
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		if(m_aConnections[i].m_Active)
+			Close(&m_aConnections[i], "map change");
+
+	CDemoRecorder::FillHeader(&m_Header, pNetVersion, pMap, MapSize, Crc, "server");
+	m_pMapData = pMapData;
+	m_MapSize = MapSize;
+	m_LastTick = -1;
+}
+
+void CDemoStream::Close(CConnection *pConn, const char *pReason)
+{
+	dbg_msg("demostream", "reader %d closed (%s)", (int)(pConn-m_aConnections), pReason);
+	net_tcp_close(pConn->m_Socket);
+	pConn->m_Active = false;
+	pConn->m_vPending.clear();
+}
+
+void CDemoStream::Append(CConnection *pConn, const void *pData, int Size)
+{
+	if(!pConn->m_Active)
+		return;
+	if(pConn->m_PendingPos == (int)pConn->m_vPending.size())
+	{
+		pConn->m_vPending.clear();
+		pConn->m_PendingPos = 0;
+	}
+	if((int)pConn->m_vPending.size()-pConn->m_PendingPos+Size > MAX_PENDING)
+	{
+		m_NumDropped++;
+		Close(pConn, "too slow");
+		return;
+	}
+	pConn->m_vPending.insert(pConn->m_vPending.end(), (const unsigned char *)pData, (const unsigned char *)pData+Size);
+}
+
+void CDemoStream::Flush(CConnection *pConn)
+{
+	while(pConn->m_Active)
+	{
+		const unsigned char *pData;
+		int Size;
+		if(pConn->m_PendingPos < (int)pConn->m_vPending.size())
+		{
+			pData = &pConn->m_vPending[pConn->m_PendingPos];
+			Size = pConn->m_vPending.size()-pConn->m_PendingPos;
+		}
+		else if(!pConn->m_Live && pConn->m_MapSent < m_MapSize)
+		{
+			pData = m_pMapData+pConn->m_MapSent;
+			Size = min(m_MapSize-pConn->m_MapSent, 64u*1024u);
+		}
+		else
+		{
+			if(!pConn->m_Live)
+			{
+				// snapshots can only be deltas after a keyframe
+				pConn->m_Live = true;
+				pConn->m_NeedKeyFrame = true;
+			}
+			pConn->m_vPending.clear();
+			pConn->m_PendingPos = 0;
+			return;
+		}
+
+		int Bytes = net_tcp_send(pConn->m_Socket, pData, Size);
+		if(Bytes < 0)
+		{
+			if(!net_would_block())
+				Close(pConn, "send failed");
+			return;
+		}
+
+		if(pConn->m_PendingPos < (int)pConn->m_vPending.size())
+			pConn->m_PendingPos += Bytes;
+		else
+			pConn->m_MapSent += Bytes;
+
+		if(Bytes < Size)
+			return;
+	}
+}
+
+void CDemoStream::Update()
+{
+	if(!m_Ready)
+		return;
+
+	NETSOCKET Socket;
+	NETADDR Addr;
+	while(net_tcp_accept(m_Socket, &Socket, &Addr) > 0)
+	{
+		CConnection *pConn = 0;
+		for(int i = 0; i < MAX_CONNECTIONS && !pConn; i++)
+			if(!m_aConnections[i].m_Active)
+				pConn = &m_aConnections[i];
+		if(!pConn || !m_pMapData)
+		{
+			net_tcp_close(Socket);
+			continue;
+		}
+
+		char aAddrStr[NETADDR_MAXSTRSIZE];
+		net_addr_str(&Addr, aAddrStr, sizeof(aAddrStr), true);
+		dbg_msg("demostream", "reader %d connected addr=%s", (int)(pConn-m_aConnections), aAddrStr);
+
+		net_set_non_blocking(Socket);
+		pConn->m_Active = true;
+		pConn->m_Live = false;
+		pConn->m_NeedKeyFrame = false;
+		pConn->m_Socket = Socket;
+		pConn->m_MapSent = 0;
+		pConn->m_PendingPos = 0;
+		pConn->m_vPending.clear();
+
+		// the timeline markers stay empty, the stream has no end to fill them in
+		CTimelineMarkers TimelineMarkers;
+		mem_zero(&TimelineMarkers, sizeof(TimelineMarkers));
+		Append(pConn, &m_Header, sizeof(m_Header));
+		Append(pConn, &TimelineMarkers, sizeof(TimelineMarkers));
+	}
+
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+	{
+		CConnection *pConn = &m_aConnections[i];
+		if(!pConn->m_Active)
+			continue;
+
+		// readers don't talk back, this only notices them leaving
+		char aBuf[256];
+		int Bytes = net_tcp_recv(pConn->m_Socket, aBuf, sizeof(aBuf));
+		if(Bytes == 0 || (Bytes < 0 && !net_would_block()))
+		{
+			Close(pConn, "disconnected");
+			continue;
+		}
+
+		Flush(pConn);
+	}
+}
+
+void CDemoStream::Shutdown()
+{
+	if(!m_Ready)
+		return;
+
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		if(m_aConnections[i].m_Active)
+			Close(&m_aConnections[i], "shutdown");
+	net_tcp_close(m_Socket);
+	m_Ready = false;
+}
+
+bool CDemoStream::Active() const
+{
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		if(m_aConnections[i].m_Active && m_aConnections[i].m_Live)
+			return true;
+	return false;
+}
+
+int CDemoStream::NumConnections() const
+{
+	int Num = 0;
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		if(m_aConnections[i].m_Active)
+			Num++;
+	return Num;
+}
+
+void CDemoStream::OnSnapshot(int Tick, const void *pData, int Size)
+{
+	unsigned char aMarker[5];
+	int MarkerSize = CDemoRecorder::PackTickMarker(Tick, m_LastTick, 0, aMarker);
+	unsigned char aKeyMarker[5];
+	int KeyMarkerSize = CDemoRecorder::PackTickMarker(Tick, -1, 1, aKeyMarker);
+
+	// pack each chunk once, at most every reader needs one of the two
+	int KeyFrameSize = 0;
+	int DeltaSize = 0;
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+	{
+		CConnection *pConn = &m_aConnections[i];
+		if(!pConn->m_Active || !pConn->m_Live)
+			continue;
+
+		if(pConn->m_NeedKeyFrame || m_LastTick < 0)
+		{
+			if(!KeyFrameSize)
+				KeyFrameSize = CDemoRecorder::PackChunk(CHUNKTYPE_SNAPSHOT, pData, Size, CDemoRecorder::CHUNKDATA_RAW, m_aKeyFrame, sizeof(m_aKeyFrame));
+			if(KeyFrameSize < 0)
+				continue;
+			Append(pConn, aKeyMarker, KeyMarkerSize);
+			Append(pConn, m_aKeyFrame, KeyFrameSize);
+			pConn->m_NeedKeyFrame = false;
+			continue;
+		}
+
+		if(!DeltaSize)
+		{
+			char aDeltaData[CSnapshot::MAX_SIZE];
+			int Delta = m_pSnapshotDelta->CreateDelta((CSnapshot *)m_aLastSnapshot, (CSnapshot *)pData, aDeltaData);
+			DeltaSize = Delta ? CDemoRecorder::PackChunk(CHUNKTYPE_DELTA, aDeltaData, Delta, CDemoRecorder::CHUNKDATA_RAW, m_aDelta, sizeof(m_aDelta)) : -2;
+		}
+		if(DeltaSize == -1)
+		{
+			// resync with a keyframe next time
+			pConn->m_NeedKeyFrame = true;
+			continue;
+		}
+		Append(pConn, aMarker, MarkerSize);
+		if(DeltaSize > 0)
+			Append(pConn, m_aDelta, DeltaSize);
+	}
+
+	mem_copy(m_aLastSnapshot, pData, Size);
+	m_LastTick = Tick;
+}
+
+void CDemoStream::OnMessage(const void *pData, int Size)
+{
+	unsigned char aChunk[MAX_CHUNK_SIZE];
+	int ChunkSize = 0;
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+	{
+		CConnection *pConn = &m_aConnections[i];
+		// nothing before the reader has a snapshot to apply it to
+		if(!pConn->m_Active || !pConn->m_Live || pConn->m_NeedKeyFrame)
+			continue;
+
+		if(!ChunkSize)
+			ChunkSize = CDemoRecorder::PackChunk(CHUNKTYPE_MESSAGE, pData, Size, CDemoRecorder::CHUNKDATA_RAW, aChunk, sizeof(aChunk));
+		if(ChunkSize < 0)
+			return;
+		Append(pConn, aChunk, ChunkSize);
+	}
+}
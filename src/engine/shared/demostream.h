@@ -0,0 +1,76 @@
+#ifndef ENGINE_SHARED_DEMOSTREAM_H
+#define ENGINE_SHARED_DEMOSTREAM_H
+
+#include <base/system.h>
+
+#include <engine/demo.h>
+
+#include "snapshot.h"
+
+#include <vector>
+
+/*
+	Publishes the server demo live over TCP. A new connection gets the
+	demo header and the map first, then a keyframe and from there on the
+	same deltas and messages as everybody else, so every reader sees a
+	demo file that never ends. Readers that fall too far behind are
+	dropped and have to reconnect. Polled from the main loop.
+*/
+class CDemoStream
+{
+	enum
+	{
+		MAX_CONNECTIONS=16,
+		MAX_PENDING=4*1024*1024,
+		MAX_CHUNK_SIZE=64*1024+8,
+	};
+
+	struct CConnection
+	{
+		bool m_Active;
+		bool m_Live; // header and map are sent
+		bool m_NeedKeyFrame;
+		NETSOCKET m_Socket;
+		unsigned m_MapSent;
+		int m_PendingPos;
+		std::vector<unsigned char> m_vPending;
+	};
+
+	bool m_Ready;
+	NETSOCKET m_Socket;
+	CConnection m_aConnections[MAX_CONNECTIONS];
+	class CSnapshotDelta *m_pSnapshotDelta;
+
+	CDemoHeader m_Header;
+	const unsigned char *m_pMapData;
+	unsigned m_MapSize;
+
+	int m_LastTick;
+	unsigned char m_aLastSnapshot[CSnapshot::MAX_SIZE];
+	unsigned char m_aKeyFrame[MAX_CHUNK_SIZE];
+	unsigned char m_aDelta[MAX_CHUNK_SIZE];
+
+	void Close(CConnection *pConn, const char *pReason);
+	void Append(CConnection *pConn, const void *pData, int Size);
+	void Flush(CConnection *pConn);
+
+public:
+	int64 m_NumDropped; // readers dropped for falling behind
+
+	CDemoStream();
+
+	bool Open(NETADDR BindAddr, class CSnapshotDelta *pSnapshotDelta);
+	// drops all readers, the map data has to stay valid until the next call
+	void SetMap(const char *pNetVersion, const char *pMap, unsigned Crc, const unsigned char *pMapData, unsigned MapSize);
+	void Update();
+	void Shutdown();
+
+	// true if somebody is waiting for snapshots
+	bool Active() const;
+	int NumConnections() const;
+
+	void OnSnapshot(int Tick, const void *pData, int Size);
+	void OnMessage(const void *pData, int Size);
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include <base/math.h>
+
+#include "demo.h"
+#include "demowriter.h"
+
+static const int gs_EntryAlign = 8;
+
+static int AlignEntry(int Size)
+{
+	return (Size + gs_EntryAlign - 1) & ~(gs_EntryAlign - 1);
+}
+
+CDemoWriter::CDemoWriter()
+{
+	m_pBuffer = 0;
+	m_BufferSize = 0;
+	m_Head = 0;
+	m_Tail = 0;
+	m_NumCommitted = 0;
+	m_NumWritten = 0;
+	m_Quit = false;
+	m_pThread = 0;
+	m_Congested = false;
+	m_NumDropped = 0;
+	m_NumDegraded = 0;
+}
+
+CDemoWriter::~CDemoWriter()
+{
+	Shutdown();
+}
+
+void CDemoWriter::Init(int BufferSize)
+{
+	if(m_pThread || BufferSize <= 0)
+		return;
+
+	m_BufferSize = AlignEntry(max(BufferSize, 2*CSnapshot::MAX_SIZE));
+	m_pBuffer = (unsigned char *)mem_alloc(m_BufferSize, gs_EntryAlign);
+	m_Head = 0;
+	m_Tail = 0;
+	m_NumCommitted = 0;
+	m_NumWritten = 0;
+	m_Quit = false;
+	m_Congested = false;
+	semaphore_init(&m_Semaphore);
+	m_pThread = thread_init(WriterThread, this);
+}
+
+void CDemoWriter::Shutdown()
+{
+	if(!m_pThread)
+		return;
+
+	{
+		CLockScope ls(m_Lock);
+		m_Quit = true;
+	}
+	semaphore_signal(&m_Semaphore);
+
+	thread_wait(m_pThread);
+	m_pThread = 0;
+	semaphore_destroy(&m_Semaphore);
+	mem_free(m_pBuffer);
+	m_pBuffer = 0;
+}
+
+CDemoWriter::CEntry *CDemoWriter::Reserve(int Size)
+{
+	Size = AlignEntry(Size);
+	if(Size > m_BufferSize/2)
+		return 0;
+
+	CLockScope ls(m_Lock);
+	int Pos = m_Head;
+	int Needed = Size;
+	if(Pos + Size > m_BufferSize)
+		Needed += m_BufferSize - Pos;
+
+	// keep one slot free so a full buffer never looks empty
+	if(Used() + Needed > m_BufferSize - gs_EntryAlign)
+		return 0;
+
+	if(Pos + Size > m_BufferSize)
+	{
+		((CEntry *)(m_pBuffer + Pos))->m_Op = OP_WRAP;
+		Pos = 0;
+	}
+
+	CEntry *pEntry = (CEntry *)(m_pBuffer + Pos);
+	pEntry->m_Size = Size;
+	return pEntry;
+}
+
+void CDemoWriter::Commit(CEntry *pEntry)
+{
+	{
+		CLockScope ls(m_Lock);
+		m_Head = ((unsigned char *)pEntry - m_pBuffer + pEntry->m_Size) % m_BufferSize;
+		m_NumCommitted++;
+	}
+	semaphore_signal(&m_Semaphore);
+}
+
+bool CDemoWriter::Write(IOHANDLE File, CDemoIndex *pIndex, int Tick, const unsigned char *pMarker, int MarkerSize, int Type, const void *pData, int Size, int Packing)
+{
+	CEntry *pEntry = Reserve(sizeof(CEntry) + Size);
+	if(!pEntry)
+	{
+		m_NumDropped++;
+		return false;
+	}
+
+	pEntry->m_Op = OP_CHUNK;
+	pEntry->m_File = File;
+	pEntry->m_pIndex = pIndex;
+	pEntry->m_Tick = Tick;
+	pEntry->m_Type = Type;
+	pEntry->m_Packing = Packing;
+	pEntry->m_DataSize = Size;
+	pEntry->m_MarkerSize = MarkerSize;
+	if(MarkerSize)
+		mem_copy(pEntry->m_aMarker, pMarker, MarkerSize);
+	if(Size)
+		mem_copy(pEntry + 1, pData, Size);
+	Commit(pEntry);
+	return true;
+}
+
+void CDemoWriter::Finish(IOHANDLE File, const CFinishInfo *pInfo)
+{
+	CFinish Finish;
+	Finish.m_File = File;
+	Finish.m_Info = *pInfo;
+	{
+		CLockScope ls(m_Lock);
+		Finish.m_After = m_NumCommitted;
+		m_Finishes.push_back(Finish);
+	}
+	semaphore_signal(&m_Semaphore);
+}
+
+bool CDemoWriter::Congested()
+{
+	int Queued = QueuedBytes();
+	if(!m_Congested && Queued > m_BufferSize/2)
+	{
+		m_Congested = true;
+		m_NumDegraded++;
+	}
+	else if(m_Congested && Queued < m_BufferSize/4)
+		m_Congested = false;
+	return m_Congested;
+}
+
+int CDemoWriter::QueuedBytes()
+{
+	if(!m_pThread)
+		return 0;
+	CLockScope ls(m_Lock);
+	return Used();
+}
+
+void CDemoWriter::WriterThread(void *pUser)
+{
+	((CDemoWriter *)pUser)->RunLoop();
+}
+
+void CDemoWriter::RunLoop()
+{
+	while(1)
+	{
+		// one wakeup per ring entry, finish or quit, so there is always
+		// something to do here: a finish that isn't due yet waits for entries
+		semaphore_wait(&m_Semaphore);
+
+		CEntry *pEntry = 0;
+		CFinish Finish;
+		bool HaveFinish = false;
+		{
+			CLockScope ls(m_Lock);
+			if(!m_Finishes.empty() && m_Finishes.front().m_After <= m_NumWritten)
+			{
+				Finish = m_Finishes.front();
+				m_Finishes.pop_front();
+				HaveFinish = true;
+			}
+			else if(m_NumWritten < m_NumCommitted)
+			{
+				if(((CEntry *)(m_pBuffer + m_Tail))->m_Op == OP_WRAP)
+					m_Tail = 0;
+				pEntry = (CEntry *)(m_pBuffer + m_Tail);
+			}
+			else if(m_Quit)
+				break;
+		}
+
+		if(HaveFinish)
+		{
+			CFinishInfo *pInfo = &Finish.m_Info;
+			CDemoRecorder::WriteFinish(Finish.m_File, pInfo->m_Length, pInfo->m_NumMarkers, pInfo->m_aMarkers, pInfo->m_MapSize, pInfo->m_pMapData, pInfo->m_pIndex);
+			if(pInfo->m_pMapData)
+				mem_free(pInfo->m_pMapData);
+			delete pInfo->m_pIndex;
+			continue;
+		}
+		if(!pEntry)
+			continue;
+
+		// the producer never touches the entry until the tail moved past it
+		if(pEntry->m_Op == OP_CHUNK)
+		{
+			if(pEntry->m_pIndex)
+				pEntry->m_pIndex->Add(pEntry->m_Tick, io_tell(pEntry->m_File));
+			if(pEntry->m_MarkerSize)
+				io_write(pEntry->m_File, pEntry->m_aMarker, pEntry->m_MarkerSize);
+			if(pEntry->m_Type >= 0)
+				CDemoRecorder::WriteChunk(pEntry->m_File, pEntry->m_Type, pEntry + 1, pEntry->m_DataSize, pEntry->m_Packing);
+		}
+
+		{
+			CLockScope ls(m_Lock);
+			m_Tail = (m_Tail + pEntry->m_Size) % m_BufferSize;
+			m_NumWritten++;
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef ENGINE_SHARED_DEMOWRITER_H
+#define ENGINE_SHARED_DEMOWRITER_H
+
+#include <base/lock.h>
+#include <base/system.h>
+
+#include <engine/demo.h>
+
+#include <atomic>
+#include <deque>
+
+/*
+	Background writer for demo recorders. Recorders copy raw frames into
+	one bounded ring buffer, the writer thread compresses them and writes
+	them out. When the buffer fills up past half, recorders only hand in
+	keyframes until it drained to a quarter again, so a stalling disk
+	costs demo frames instead of ticks.
+*/
+class CDemoWriter
+{
+	enum
+	{
+		OP_CHUNK=0,
+		OP_WRAP,
+	};
+
+	struct CEntry
+	{
+		int m_Op;
+		int m_Size; // whole entry, aligned
+		IOHANDLE m_File;
+		class CDemoIndex *m_pIndex; // set for keyframes
+		int m_Tick;
+		int m_Type; // chunk type, -1 for a lone tick marker
+		int m_Packing;
+		int m_DataSize;
+		int m_MarkerSize;
+		unsigned char m_aMarker[5];
+	};
+
+	unsigned char *m_pBuffer;
+	int m_BufferSize;
+	CLock m_Lock;
+	SEMAPHORE m_Semaphore;
+	int m_Head GUARDED_BY(m_Lock);
+	int m_Tail GUARDED_BY(m_Lock);
+	int64 m_NumCommitted GUARDED_BY(m_Lock);
+	int64 m_NumWritten GUARDED_BY(m_Lock);
+	void *m_pThread;
+	bool m_Congested;
+
+	static void WriterThread(void *pUser);
+	void RunLoop();
+
+	int Used() REQUIRES(m_Lock) { return (m_Head - m_Tail + m_BufferSize) % m_BufferSize; }
+	CEntry *Reserve(int Size);
+	void Commit(CEntry *pEntry);
+
+public:
+	struct CFinishInfo
+	{
+		int m_Length;
+		int m_NumMarkers;
+		int m_aMarkers[MAX_TIMELINE_MARKERS];
+		unsigned m_MapSize;
+		unsigned char *m_pMapData; // owned by the writer, freed after writing
+		class CDemoIndex *m_pIndex; // owned by the writer as well
+	};
+
+private:
+	// finishes don't go through the ring, so they never wait for room
+	struct CFinish
+	{
+		IOHANDLE m_File;
+		CFinishInfo m_Info;
+		int64 m_After; // ring entries written before it
+	};
+	std::deque<CFinish> m_Finishes GUARDED_BY(m_Lock);
+	bool m_Quit GUARDED_BY(m_Lock);
+
+public:
+	CDemoWriter();
+	~CDemoWriter();
+
+	void Init(int BufferSize);
+	void Shutdown();
+	bool IsRunning() const { return m_pThread != 0; }
+
+	// false if there was no room, the frame is dropped then
+	bool Write(IOHANDLE File, class CDemoIndex *pIndex, int Tick, const unsigned char *pMarker, int MarkerSize, int Type, const void *pData, int Size, int Packing);
+	// queues the header fixups and the close after the frames already queued
+	void Finish(IOHANDLE File, const CFinishInfo *pInfo);
+
+	// recorders should only write keyframes
+	bool Congested();
+	int QueuedBytes();
+
+	std::atomic<int64> m_NumDropped;
+	int64 m_NumDegraded;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "metrics.h"
+
+CMetrics::CMetrics()
+{
+	m_NumMetrics = 0;
+}
+
+int CMetrics::Add(const char *pName, const char *pHelp, int Type)
+{
+	for(int i = 0; i < m_NumMetrics; i++)
+		if(str_comp(m_aMetrics[i].m_aName, pName) == 0)
+			return m_aMetrics[i].m_Type == Type ? i : -1;
+
+	if(m_NumMetrics == MAX_METRICS)
+		return -1;
+
+	CMetric *pMetric = &m_aMetrics[m_NumMetrics];
+	mem_zero(pMetric, sizeof(*pMetric));
+	str_copy(pMetric->m_aName, pName, sizeof(pMetric->m_aName));
+	str_copy(pMetric->m_aHelp, pHelp, sizeof(pMetric->m_aHelp));
+	pMetric->m_Type = Type;
+	return m_NumMetrics++;
+}
+
+int CMetrics::AddHistogram(const char *pName, const char *pHelp, const double *pBounds, int NumBounds)
+{
+	dbg_assert(NumBounds <= MAX_BUCKETS, "too many histogram buckets");
+	int Metric = Add(pName, pHelp, TYPE_HISTOGRAM);
+	if(Metric >= 0 && m_aMetrics[Metric].m_NumBounds == 0)
+	{
+		m_aMetrics[Metric].m_NumBounds = NumBounds;
+		mem_copy(m_aMetrics[Metric].m_aBounds, pBounds, NumBounds*sizeof(double));
+	}
+	return Metric;
+}
+
+void CMetrics::Observe(int Metric, double Value)
+{
+	if(Metric < 0)
+		return;
+
+	CMetric *pMetric = &m_aMetrics[Metric];
+	int b = 0;
+	while(b < pMetric->m_NumBounds && Value > pMetric->m_aBounds[b])
+		b++;
+	pMetric->m_aBuckets[b]++;
+	pMetric->m_Count++;
+	pMetric->m_Value += Value;
+}
+
+int CMetrics::Render(char *pBuf, int BufSize) const
+{
+	static const char *s_apTypes[] = {"counter", "gauge", "histogram"};
+
+	int Len = 0;
+	pBuf[0] = 0;
+	for(int i = 0; i < m_NumMetrics; i++)
+	{
+		const CMetric *pMetric = &m_aMetrics[i];
+		str_format(pBuf+Len, BufSize-Len, "# HELP %s %s\n# TYPE %s %s\n", pMetric->m_aName, pMetric->m_aHelp, pMetric->m_aName, s_apTypes[pMetric->m_Type]);
+		Len += str_length(pBuf+Len);
+
+		if(pMetric->m_Type != TYPE_HISTOGRAM)
+		{
+			str_format(pBuf+Len, BufSize-Len, "%s %.17g\n", pMetric->m_aName, pMetric->m_Value);
+			Len += str_length(pBuf+Len);
+			continue;
+		}
+
+		int64 Cumulative = 0;
+		for(int b = 0; b < pMetric->m_NumBounds; b++)
+		{
+			Cumulative += pMetric->m_aBuckets[b];
+			str_format(pBuf+Len, BufSize-Len, "%s_bucket{le=\"%g\"} %lld\n", pMetric->m_aName, pMetric->m_aBounds[b], Cumulative);
+			Len += str_length(pBuf+Len);
+		}
+		str_format(pBuf+Len, BufSize-Len, "%s_bucket{le=\"+Inf\"} %lld\n%s_sum %.17g\n%s_count %lld\n",
+			pMetric->m_aName, pMetric->m_Count, pMetric->m_aName, pMetric->m_Value, pMetric->m_aName, pMetric->m_Count);
+		Len += str_length(pBuf+Len);
+	}
+	return Len;
+}
+
+CMetricsServer::CMetricsServer()
+{
+	m_Ready = false;
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		m_aConnections[i].m_Active = false;
+}
+
+bool CMetricsServer::Open(NETADDR BindAddr)
+{
+	m_Socket = net_tcp_create(BindAddr);
+	if(!m_Socket)
+		return false;
+	if(net_tcp_listen(m_Socket, MAX_CONNECTIONS))
+	{
+		net_tcp_close(m_Socket);
+		return false;
+	}
+	net_set_non_blocking(m_Socket);
+	m_Ready = true;
+	return true;
+}
+
+void CMetricsServer::Close(CConnection *pConn)
+{
+	net_tcp_close(pConn->m_Socket);
+	pConn->m_Active = false;
+}
+
+void CMetricsServer::Update(const CMetrics *pMetrics)
+{
+	if(!m_Ready)
+		return;
+
+	NETSOCKET Socket;
+	NETADDR Addr;
+	while(net_tcp_accept(m_Socket, &Socket, &Addr) > 0)
+	{
+		CConnection *pConn = 0;
+		for(int i = 0; i < MAX_CONNECTIONS && !pConn; i++)
+			if(!m_aConnections[i].m_Active)
+				pConn = &m_aConnections[i];
+		if(!pConn)
+		{
+			net_tcp_close(Socket);
+			continue;
+		}
+
+		net_set_non_blocking(Socket);
+		pConn->m_Active = true;
+		pConn->m_Socket = Socket;
+		pConn->m_Start = time_get();
+		pConn->m_RecvLen = 0;
+		pConn->m_SendLen = 0;
+		pConn->m_SendPos = 0;
+	}
+
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+	{
+		CConnection *pConn = &m_aConnections[i];
+		if(!pConn->m_Active)
+			continue;
+
+		if(time_get() > pConn->m_Start + TIMEOUT*time_freq())
+		{
+			Close(pConn);
+			continue;
+		}
+
+		// read the request header, the request itself doesn't matter
+		if(!pConn->m_SendLen)
+		{
+			int Bytes = net_tcp_recv(pConn->m_Socket, pConn->m_aBuf+pConn->m_RecvLen, BUFFER_SIZE-1-pConn->m_RecvLen);
+			if(Bytes == 0 || (Bytes < 0 && !net_would_block()))
+			{
+				Close(pConn);
+				continue;
+			}
+			if(Bytes > 0)
+			{
+				pConn->m_RecvLen += Bytes;
+				pConn->m_aBuf[pConn->m_RecvLen] = 0;
+			}
+			if(!str_find(pConn->m_aBuf, "\r\n\r\n") && !str_find(pConn->m_aBuf, "\n\n") && pConn->m_RecvLen < BUFFER_SIZE-1)
+				continue;
+
+			// leave room for the header in front of the body
+			static const int HEADER_SIZE = 128;
+			int BodyLen = pMetrics->Render(pConn->m_aBuf+HEADER_SIZE, BUFFER_SIZE-HEADER_SIZE);
+			char aHeader[HEADER_SIZE];
+			str_format(aHeader, sizeof(aHeader), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n", BodyLen);
+			int HeaderLen = str_length(aHeader);
+			pConn->m_SendPos = HEADER_SIZE-HeaderLen;
+			mem_copy(pConn->m_aBuf+pConn->m_SendPos, aHeader, HeaderLen);
+			pConn->m_SendLen = HEADER_SIZE+BodyLen;
+		}
+
+		int Bytes = net_tcp_send(pConn->m_Socket, pConn->m_aBuf+pConn->m_SendPos, pConn->m_SendLen-pConn->m_SendPos);
+		if(Bytes < 0 && !net_would_block())
+		{
+			Close(pConn);
+			continue;
+		}
+		if(Bytes > 0)
+			pConn->m_SendPos += Bytes;
+		if(pConn->m_SendPos >= pConn->m_SendLen)
+			Close(pConn);
+	}
+}
+
+void CMetricsServer::Shutdown()
+{
+	if(!m_Ready)
+		return;
+
+	for(int i = 0; i < MAX_CONNECTIONS; i++)
+		if(m_aConnections[i].m_Active)
+			Close(&m_aConnections[i]);
+	net_tcp_close(m_Socket);
+	m_Ready = false;
+}
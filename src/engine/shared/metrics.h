@@ -0,0 +1,97 @@
+#ifndef ENGINE_SHARED_METRICS_H
+#define ENGINE_SHARED_METRICS_H
+
+#include <base/system.h>
+
+/*
+	Counters, gauges and histograms rendered in the Prometheus text
+	format. Metrics are registered once by name, registering a name again
+	returns the existing metric. Rendering writes into a caller supplied
+	buffer and never allocates.
+*/
+class CMetrics
+{
+public:
+	enum
+	{
+		MAX_METRICS=64,
+		MAX_BUCKETS=16,
+
+		TYPE_COUNTER=0,
+		TYPE_GAUGE,
+		TYPE_HISTOGRAM,
+	};
+
+private:
+	struct CMetric
+	{
+		char m_aName[64];
+		char m_aHelp[128];
+		int m_Type;
+		double m_Value; // counter and gauge value, histogram sum
+		int m_NumBounds;
+		double m_aBounds[MAX_BUCKETS];
+		int64 m_aBuckets[MAX_BUCKETS+1];
+		int64 m_Count;
+	};
+
+	CMetric m_aMetrics[MAX_METRICS];
+	int m_NumMetrics;
+
+	int Add(const char *pName, const char *pHelp, int Type);
+
+public:
+	CMetrics();
+
+	int AddCounter(const char *pName, const char *pHelp) { return Add(pName, pHelp, TYPE_COUNTER); }
+	int AddGauge(const char *pName, const char *pHelp) { return Add(pName, pHelp, TYPE_GAUGE); }
+	// pBounds are the ascending upper bounds, an +Inf bucket is added
+	int AddHistogram(const char *pName, const char *pHelp, const double *pBounds, int NumBounds);
+
+	void Inc(int Metric, double Value = 1) { if(Metric >= 0) m_aMetrics[Metric].m_Value += Value; }
+	void Set(int Metric, double Value) { if(Metric >= 0) m_aMetrics[Metric].m_Value = Value; }
+	void Observe(int Metric, double Value);
+
+	// returns the number of bytes written
+	int Render(char *pBuf, int BufSize) const;
+};
+
+/*
+	Minimal HTTP endpoint answering every request with the rendered
+	metrics. Polled from the main loop.
+*/
+class CMetricsServer
+{
+	enum
+	{
+		MAX_CONNECTIONS=4,
+		BUFFER_SIZE=32*1024,
+		TIMEOUT=5,
+	};
+
+	struct CConnection
+	{
+		bool m_Active;
+		NETSOCKET m_Socket;
+		int64 m_Start;
+		int m_RecvLen;
+		int m_SendPos;
+		int m_SendLen;
+		char m_aBuf[BUFFER_SIZE];
+	};
+
+	bool m_Ready;
+	NETSOCKET m_Socket;
+	CConnection m_aConnections[MAX_CONNECTIONS];
+
+	void Close(CConnection *pConn);
+
+public:
+	CMetricsServer();
+
+	bool Open(NETADDR BindAddr);
+	void Update(const CMetrics *pMetrics);
+	void Shutdown();
+};
+
+#endif
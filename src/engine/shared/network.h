@@ -205,6 +205,8 @@ public:
 	bool m_TimeoutProtected;
 	bool m_TimeoutSituation;
 
+	static int64 ms_NumResentChunks;
+
 	void Reset(bool Rejoin=false);
 	void Init(NETSOCKET Socket, bool BlockCloseMsg);
 	int Connect(const NETADDR *pAddr, int NumAddrs);
@@ -359,6 +361,9 @@ public:
 	int NetType() const { return net_socket_type(m_Socket); }
 	int MaxClients() const { return m_MaxClients; }
 
+	int64 m_NumBanHits;
+	int64 m_NumDrops;
+
 	//
 	void SetMaxClientsPerIP(int Max);
 
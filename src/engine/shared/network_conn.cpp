@@ -4,6 +4,8 @@
 #include "network.h"
 #include <base/system.h>
 
+int64 CNetConnection::ms_NumResentChunks = 0;
+
 SECURITY_TOKEN ToSecurityToken(unsigned char *pData)
 {
 	return (int)pData[0] | (pData[1] << 8) | (pData[2] << 16) | (pData[3] << 24);
@@ -183,6 +185,7 @@ void CNetConnection::SendControl(int ControlMsg, const void *pExtra, int ExtraSi
 void CNetConnection::ResendChunk(CNetChunkResend *pResend)
 {
 	QueueChunkEx(pResend->m_Flags | NET_CHUNKFLAG_RESEND, pResend->m_DataSize, pResend->m_pData, pResend->m_Sequence);
+	ms_NumResentChunks++;
 	pResend->m_LastSendTime = time_get();
 }
 
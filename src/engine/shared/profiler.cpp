@@ -0,0 +1,95 @@
+#include <base/math.h>
+#include <engine/console.h>
+
+#include "profiler.h"
+
+CProfiler::CProfiler()
+{
+	mem_zero(m_aPhases, sizeof(m_aPhases));
+	m_NumPhases = 0;
+	m_CurWindow = 0;
+	m_WindowStart = 0;
+	m_Enabled = true;
+}
+
+int CProfiler::Bucket(int64 Time)
+{
+	if(Time < 8)
+		return Time < 0 ? 0 : (int)Time;
+
+	int Msb = 3;
+	while(Time >> (Msb+1))
+		Msb++;
+	return (Msb-2)*8 + (int)((Time >> (Msb-3))&7);
+}
+
+int64 CProfiler::BucketLimit(int Bucket)
+{
+	// smallest value of the next bucket
+	Bucket++;
+	if(Bucket < 8)
+		return Bucket;
+	int Msb = Bucket/8+2;
+	return (int64)(8+Bucket%8) << (Msb-3);
+}
+
+int CProfiler::AddPhase(const char *pName)
+{
+	for(int i = 0; i < m_NumPhases; i++)
+		if(str_comp(m_aPhases[i].m_aName, pName) == 0)
+			return i;
+
+	if(m_NumPhases == MAX_PHASES)
+		return -1;
+	str_copy(m_aPhases[m_NumPhases].m_aName, pName, sizeof(m_aPhases[m_NumPhases].m_aName));
+	return m_NumPhases++;
+}
+
+void CProfiler::Update(int64 Now, int WindowSeconds)
+{
+	if(Now < m_WindowStart + WindowSeconds*time_freq())
+		return;
+
+	m_CurWindow ^= 1;
+	m_WindowStart = Now;
+	for(int i = 0; i < m_NumPhases; i++)
+		mem_zero(&m_aPhases[i].m_aWindows[m_CurWindow], sizeof(CWindow));
+}
+
+void CProfiler::Report(IConsole *pConsole)
+{
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "profiler %s, times in microseconds", m_Enabled ? "enabled" : "disabled");
+	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "perf", aBuf);
+
+	int64 Freq = time_freq();
+	for(int i = 0; i < m_NumPhases; i++)
+	{
+		const CWindow *pA = &m_aPhases[i].m_aWindows[0];
+		const CWindow *pB = &m_aPhases[i].m_aWindows[1];
+		unsigned Count = pA->m_Count + pB->m_Count;
+		if(!Count)
+			continue;
+
+		int64 Max = max(pA->m_Max, pB->m_Max);
+		unsigned P50 = (Count+1)/2;
+		unsigned P99 = Count - Count/100;
+		int64 Time50 = 0, Time99 = 0;
+		unsigned Sum = 0;
+		for(int b = 0; b < NUM_BUCKETS && Sum < P99; b++)
+		{
+			Sum += pA->m_aBuckets[b] + pB->m_aBuckets[b];
+			if(!Time50 && Sum >= P50)
+				Time50 = BucketLimit(b);
+			if(Sum >= P99)
+				Time99 = BucketLimit(b);
+		}
+		// bucket limits may overshoot the largest sample
+		Time50 = min(Time50, Max);
+		Time99 = min(Time99, Max);
+
+		str_format(aBuf, sizeof(aBuf), "%-20s n=%u p50=%lld p99=%lld max=%lld", m_aPhases[i].m_aName, Count,
+			Time50*1000000/Freq, Time99*1000000/Freq, Max*1000000/Freq);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "perf", aBuf);
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef ENGINE_SHARED_PROFILER_H
+#define ENGINE_SHARED_PROFILER_H
+
+#include <base/system.h>
+
+/*
+	Per phase duration histograms for the server main loop. Samples go to
+	log-linear buckets (8 per power of two), so p50/p99 are exact to 12.5%.
+	Two windows are kept and swapped every window length, reports cover the
+	last one to two windows. Only used from the main thread.
+*/
+class CProfiler
+{
+public:
+	enum
+	{
+		MAX_PHASES=64,
+		NUM_BUCKETS=512,
+	};
+
+private:
+	struct CWindow
+	{
+		unsigned m_aBuckets[NUM_BUCKETS];
+		unsigned m_Count;
+		int64 m_Max;
+	};
+
+	struct CPhase
+	{
+		char m_aName[64];
+		CWindow m_aWindows[2];
+	};
+
+	CPhase m_aPhases[MAX_PHASES];
+	int m_NumPhases;
+	int m_CurWindow;
+	int64 m_WindowStart;
+
+	static int Bucket(int64 Time);
+	static int64 BucketLimit(int Bucket);
+
+public:
+	CProfiler();
+
+	bool m_Enabled;
+
+	// returns the existing phase if the name is already known
+	int AddPhase(const char *pName);
+	void Add(int Phase, int64 Time)
+	{
+		CWindow *pWindow = &m_aPhases[Phase].m_aWindows[m_CurWindow];
+		pWindow->m_aBuckets[Bucket(Time)]++;
+		pWindow->m_Count++;
+		if(Time > pWindow->m_Max)
+			pWindow->m_Max = Time;
+	}
+
+	void Update(int64 Now, int WindowSeconds);
+	void Report(class IConsole *pConsole);
+};
+
+class CProfileScope
+{
+	CProfiler *m_pProfiler;
+	int m_Phase;
+	int64 m_Start;
+
+public:
+	CProfileScope(CProfiler *pProfiler, int Phase)
+	{
+		m_pProfiler = pProfiler;
+		m_Phase = Phase;
+		m_Start = pProfiler->m_Enabled && Phase >= 0 ? time_get_impl() : 0;
+	}
+	~CProfileScope()
+	{
+		if(m_Start)
+			m_pProfiler->Add(m_Phase, time_get_impl()-m_Start);
+	}
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <base/vmath.h>
 
 #include <math.h>
+#include <algorithm>
 #include <engine/map.h>
 #include <engine/kernel.h>
 
@@ -31,6 +32,7 @@ CCollision::CCollision()
 	m_pDoor = 0;
 	m_pSwitchers = 0;
 	m_pTune = 0;
+	m_pTileMask = 0;
 	
 	m_Time = 0.0;
 }
@@ -173,14 +175,22 @@ void CCollision::Init(class CLayers *pLayers)
 		for (int i = 0; i < m_NumSwitchers+1; ++i)
 		{
 			m_pSwitchers[i].m_Initial = true;
+			m_pSwitchers[i].m_Status = -1;
 			for (int j = 0; j < MAX_CLIENTS; ++j)
 			{
-				m_pSwitchers[i].m_Status[j] = true;
 				m_pSwitchers[i].m_EndTick[j] = 0;
 				m_pSwitchers[i].m_Type[j] = 0;
+				m_pSwitchers[i].m_TimerTick[j] = 0;
 			}
 		}
 	}
+
+	m_pTileMask = new unsigned char[m_Width*m_Height];
+	for(int i = 0; i < m_Width*m_Height; i++)
+		UpdateTileMask(i);
+
+	// headbot
+	InitQuadSets();
 }
 
 int CCollision::GetTile(int x, int y)
@@ -492,6 +502,8 @@ void CCollision::Dest()
 		delete[] m_pDoor;
 	if(m_pSwitchers)
 		delete[] m_pSwitchers;
+	if(m_pTileMask)
+		delete[] m_pTileMask;
 	m_pTiles = 0;
 	m_Width = 0;
 	m_Height = 0;
@@ -503,6 +515,61 @@ void CCollision::Dest()
 	m_pTune = 0;
 	m_pDoor = 0;
 	m_pSwitchers = 0;
+	m_pTileMask = 0;
+	m_vSwitchTimers.clear();
+	m_vQuadSets.clear();
+}
+
+void CCollision::ScheduleSwitch(int Number, int Team)
+{
+	// standing on the tile moves the end tick every tick, the live entry follows it
+	SSwitchers *pSwitcher = &m_pSwitchers[Number];
+	if(pSwitcher->m_TimerTick[Team] && pSwitcher->m_TimerTick[Team] <= pSwitcher->m_EndTick[Team])
+		return;
+	pSwitcher->m_TimerTick[Team] = pSwitcher->m_EndTick[Team];
+
+	CSwitchTimer Timer;
+	Timer.m_EndTick = pSwitcher->m_EndTick[Team];
+	Timer.m_Number = Number;
+	Timer.m_Team = Team;
+	m_vSwitchTimers.push_back(Timer);
+	std::push_heap(m_vSwitchTimers.begin(), m_vSwitchTimers.end(), SwitchTimerCompare);
+}
+
+void CCollision::TickSwitchers(int Tick)
+{
+	while(!m_vSwitchTimers.empty() && m_vSwitchTimers.front().m_EndTick <= Tick)
+	{
+		CSwitchTimer Timer = m_vSwitchTimers.front();
+		std::pop_heap(m_vSwitchTimers.begin(), m_vSwitchTimers.end(), SwitchTimerCompare);
+		m_vSwitchTimers.pop_back();
+
+		SSwitchers *pSwitcher = &m_pSwitchers[Timer.m_Number];
+		// replaced by an earlier entry
+		if(pSwitcher->m_TimerTick[Timer.m_Team] != Timer.m_EndTick)
+			continue;
+		if(pSwitcher->m_EndTick[Timer.m_Team] > Tick)
+		{
+			Timer.m_EndTick = pSwitcher->m_EndTick[Timer.m_Team];
+			pSwitcher->m_TimerTick[Timer.m_Team] = Timer.m_EndTick;
+			m_vSwitchTimers.push_back(Timer);
+			std::push_heap(m_vSwitchTimers.begin(), m_vSwitchTimers.end(), SwitchTimerCompare);
+			continue;
+		}
+		pSwitcher->m_TimerTick[Timer.m_Team] = 0;
+		if(pSwitcher->m_Type[Timer.m_Team] == TILE_SWITCHTIMEDOPEN)
+		{
+			pSwitcher->SetStatus(Timer.m_Team, false);
+			pSwitcher->m_EndTick[Timer.m_Team] = 0;
+			pSwitcher->m_Type[Timer.m_Team] = TILE_SWITCHCLOSE;
+		}
+		else if(pSwitcher->m_Type[Timer.m_Team] == TILE_SWITCHTIMEDCLOSE)
+		{
+			pSwitcher->SetStatus(Timer.m_Team, true);
+			pSwitcher->m_EndTick[Timer.m_Team] = 0;
+			pSwitcher->m_Type[Timer.m_Team] = TILE_SWITCHOPEN;
+		}
+	}
 }
 
 int CCollision::IsSolid(int x, int y)
@@ -1055,6 +1122,7 @@ void CCollision::SetCollisionAt(float x, float y, int flag)
 	int Ny = clamp(round_to_int(y)/32, 0, m_Height-1);
 
 	m_pTiles[Ny * m_Width + Nx].m_Index = flag;
+	UpdateTileMask(Ny * m_Width + Nx);
 }
 
 void CCollision::SetDCollisionAt(float x, float y, int Type, int Flags, int Number)
@@ -1067,6 +1135,24 @@ void CCollision::SetDCollisionAt(float x, float y, int Type, int Flags, int Numb
 	m_pDoor[Ny * m_Width + Nx].m_Index = Type;
 	m_pDoor[Ny * m_Width + Nx].m_Flags = Flags;
 	m_pDoor[Ny * m_Width + Nx].m_Number = Number;
+	UpdateTileMask(Ny * m_Width + Nx);
+}
+
+void CCollision::UpdateTileMask(int Index)
+{
+	// everything below TILE_THROUGH is plain collision after Init
+	int Mask = 0;
+	if(GetTileIndex(Index) >= TILE_THROUGH || GetFTileIndex(Index) >= TILE_THROUGH)
+		Mask |= TILEMASK_TILE;
+	if(GetDTileIndex(Index))
+		Mask |= TILEMASK_DOOR;
+	if(IsSwitch(Index))
+		Mask |= TILEMASK_SWITCH;
+	if(m_pTele && m_pTele[Index].m_Type)
+		Mask |= TILEMASK_TELE;
+	if(IsSpeedup(Index))
+		Mask |= TILEMASK_SPEEDUP;
+	m_pTileMask[Index] = Mask;
 }
 
 int CCollision::GetDTileIndex(int Index)
@@ -1293,51 +1379,133 @@ static void Rotate(vec2 *pCenter, vec2 *pPoint, float Rotation)
 	pPoint->y = (x * sinf(Rotation) + y * cosf(Rotation) + pCenter->y);
 }
 
-bool CCollision::GetQuadAt(const char *name, float x, float y)
+void CCollision::InitQuadSets()
 {
+	m_vQuadSets.clear();
+
 	for(int i = 0; i < m_pLayers->NumGroups(); i++)
 	{
 		CMapItemGroup *pGroup = m_pLayers->GetGroup(i);
 		for(int l = 0; l < pGroup->m_NumLayers; l++)
 		{
 			CMapItemLayer *pLayer = m_pLayers->GetLayer(pGroup->m_StartLayer+l);
-			
-			if(pLayer->m_Type == LAYERTYPE_QUADS)
-			{
-				CMapItemLayerQuads *pQLayer = (CMapItemLayerQuads *)pLayer;
-			
-				const CQuad *pQuads = (const CQuad *) m_pLayers->Map()->GetDataSwapped(pQLayer->m_Data);
+			if(pLayer->m_Type != LAYERTYPE_QUADS)
+				continue;
+
+			CMapItemLayerQuads *pQLayer = (CMapItemLayerQuads *)pLayer;
+			if(pQLayer->m_Version < 2 || pQLayer->m_NumQuads <= 0)
+				continue;
 
-				for(int q = 0; q < pQLayer->m_NumQuads; q++)
+			char aName[12];
+			IntsToStr(pQLayer->m_aName, 3, aName);
+			if(!aName[0])
+				continue;
+
+			// layers sharing a name are merged into one set
+			CQuadSet *pSet = 0;
+			for(unsigned s = 0; s < m_vQuadSets.size(); s++)
+			{
+				if(!str_comp(m_vQuadSets[s].m_aName, aName))
 				{
-					vec2 Position(0.0f, 0.0f);
-					float Angle = 0.0f;
-					if(pQuads[q].m_PosEnv >= 0)
-					{
-						GetAnimationTransform(m_Time + (static_cast<double>(pQuads->m_PosEnvOffset)/1000.), pQuads[q].m_PosEnv, m_pLayers, Position, Angle);
-					}
-					
-					vec2 p0 = Position + vec2(fx2f(pQuads[q].m_aPoints[0].x), fx2f(pQuads[q].m_aPoints[0].y));
-					vec2 p1 = Position + vec2(fx2f(pQuads[q].m_aPoints[1].x), fx2f(pQuads[q].m_aPoints[1].y));
-					vec2 p2 = Position + vec2(fx2f(pQuads[q].m_aPoints[2].x), fx2f(pQuads[q].m_aPoints[2].y));
-					vec2 p3 = Position + vec2(fx2f(pQuads[q].m_aPoints[3].x), fx2f(pQuads[q].m_aPoints[3].y));
-					
-					if(Angle != 0)
-					{
-						vec2 center(fx2f(pQuads[q].m_aPoints[4].x), fx2f(pQuads[q].m_aPoints[4].y));
-						Rotate(&center, &p0, Angle);
-						Rotate(&center, &p1, Angle);
-						Rotate(&center, &p2, Angle);
-						Rotate(&center, &p3, Angle);
-					}
-					
-					char aName[12];
-					IntsToStr(pQLayer->m_aName, 3, aName);
-					
-					if(!str_comp(name, aName)) return InsideQuad(p0, p1, p2, p3, vec2(x, y));
+					pSet = &m_vQuadSets[s];
+					break;
 				}
 			}
+			if(!pSet)
+			{
+				m_vQuadSets.emplace_back();
+				pSet = &m_vQuadSets.back();
+				str_copy(pSet->m_aName, aName, sizeof(pSet->m_aName));
+				pSet->m_Used = false;
+			}
+
+			const CQuad *pQuads = (const CQuad *) m_pLayers->Map()->GetDataSwapped(pQLayer->m_Data);
+			for(int q = 0; q < pQLayer->m_NumQuads; q++)
+			{
+				CIndexedQuad Quad;
+				Quad.m_pQuad = &pQuads[q];
+				pSet->m_vQuads.push_back(Quad);
+			}
 		}
 	}
+}
+
+void CCollision::UpdateQuadSet(CQuadSet *pSet)
+{
+	for(unsigned q = 0; q < pSet->m_vQuads.size(); q++)
+	{
+		CIndexedQuad *pQuad = &pSet->m_vQuads[q];
+		const CQuad *pSrc = pQuad->m_pQuad;
+
+		vec2 Position(0.0f, 0.0f);
+		float Angle = 0.0f;
+		if(pSrc->m_PosEnv >= 0)
+			GetAnimationTransform(m_Time + (static_cast<double>(pSrc->m_PosEnvOffset)/1000.), pSrc->m_PosEnv, m_pLayers, Position, Angle);
+
+		vec2 Center(fx2f(pSrc->m_aPoints[4].x), fx2f(pSrc->m_aPoints[4].y));
+		for(int p = 0; p < 4; p++)
+		{
+			pQuad->m_aPoints[p] = Position + vec2(fx2f(pSrc->m_aPoints[p].x), fx2f(pSrc->m_aPoints[p].y));
+			if(Angle != 0)
+				Rotate(&Center, &pQuad->m_aPoints[p], Angle);
+		}
+
+		pQuad->m_Min = pQuad->m_Max = pQuad->m_aPoints[0];
+		for(int p = 1; p < 4; p++)
+		{
+			pQuad->m_Min.x = min(pQuad->m_Min.x, pQuad->m_aPoints[p].x);
+			pQuad->m_Min.y = min(pQuad->m_Min.y, pQuad->m_aPoints[p].y);
+			pQuad->m_Max.x = max(pQuad->m_Max.x, pQuad->m_aPoints[p].x);
+			pQuad->m_Max.y = max(pQuad->m_Max.y, pQuad->m_aPoints[p].y);
+		}
+	}
+}
+
+void CCollision::SetTime(double time)
+{
+	m_Time = time;
+
+	// only sets somebody asked for are animated
+	for(unsigned s = 0; s < m_vQuadSets.size(); s++)
+		if(m_vQuadSets[s].m_Used)
+			UpdateQuadSet(&m_vQuadSets[s]);
+}
+
+int CCollision::GetQuadSet(const char *pName)
+{
+	for(unsigned s = 0; s < m_vQuadSets.size(); s++)
+	{
+		if(!str_comp(m_vQuadSets[s].m_aName, pName))
+		{
+			if(!m_vQuadSets[s].m_Used)
+			{
+				m_vQuadSets[s].m_Used = true;
+				UpdateQuadSet(&m_vQuadSets[s]);
+			}
+			return s;
+		}
+	}
+	return -1;
+}
+
+bool CCollision::InsideQuadSet(int Set, vec2 Pos)
+{
+	if(Set < 0 || Set >= (int)m_vQuadSets.size())
+		return false;
+
+	const CQuadSet *pSet = &m_vQuadSets[Set];
+	for(unsigned q = 0; q < pSet->m_vQuads.size(); q++)
+	{
+		const CIndexedQuad *pQuad = &pSet->m_vQuads[q];
+		if(Pos.x < pQuad->m_Min.x || Pos.x > pQuad->m_Max.x || Pos.y < pQuad->m_Min.y || Pos.y > pQuad->m_Max.y)
+			continue;
+		if(InsideQuad(pQuad->m_aPoints[0], pQuad->m_aPoints[1], pQuad->m_aPoints[2], pQuad->m_aPoints[3], Pos))
+			return true;
+	}
 	return false;
-}
\ No newline at end of file
+}
+
+bool CCollision::GetQuadAt(const char *name, float x, float y)
+{
+	return InsideQuadSet(GetQuadSet(name), vec2(x, y));
+}
@@ -3,10 +3,12 @@
 #ifndef GAME_COLLISION_H
 #define GAME_COLLISION_H
 
+#include <base/system.h>
 #include <base/vmath.h>
 #include <engine/shared/protocol.h>
 
 #include <list>
+#include <vector>
 
 class CCollision
 {
@@ -30,6 +32,16 @@ public:
 		COLFLAG_TELE=32
 	};
 
+	// per map index, which layers carry something characters react to
+	enum
+	{
+		TILEMASK_TILE=1, // game or front layer
+		TILEMASK_DOOR=2,
+		TILEMASK_SWITCH=4,
+		TILEMASK_TELE=8,
+		TILEMASK_SPEEDUP=16,
+	};
+
 	CCollision();
 	void Init(class CLayers *pLayers);
 	bool CheckPoint(float x, float y) { return IsSolid(round_to_int(x), round_to_int(y)); }
@@ -101,10 +113,14 @@ public:
 
 	int IsCheckpoint(int Index);
 	int IsFCheckpoint(int Index);
+
+	int GetTileMask(int Index) { return Index < 0 ? 0 : m_pTileMask[Index]; }
 	
 	// headbot
 	bool GetQuadAt(const char *name, float x, float y);
-	void SetTime(double time) { m_Time = time; }
+	int GetQuadSet(const char *pName);
+	bool InsideQuadSet(int Set, vec2 Pos);
+	void SetTime(double time);
 
 	int IsMover(int x, int y, int* Flags);
 
@@ -125,20 +141,60 @@ private:
 	class CSwitchTile *m_pSwitch;
 	class CTuneTile *m_pTune;
 	class CDoorTile *m_pDoor;
+	unsigned char *m_pTileMask;
+	void UpdateTileMask(int Index);
 	struct SSwitchers
 	{
-		bool m_Status[MAX_CLIENTS];
+		int64 m_Status; // one bit per team
 		bool m_Initial;
 		int m_EndTick[MAX_CLIENTS];
 		int m_Type[MAX_CLIENTS];
+		int m_TimerTick[MAX_CLIENTS]; // end tick of the live heap entry, 0 if none
+
+		// teams without a slot (super) see the initial state
+		bool Status(int Team) const { return Team >= 0 && Team < MAX_CLIENTS ? (m_Status>>Team)&1 : m_Initial; }
+		void SetStatus(int Team, bool Status) { if(Status) m_Status |= (int64)1<<Team; else m_Status &= ~((int64)1<<Team); }
 	};
+
+	// running timed switches as a min-heap on the end tick, one live entry
+	// per switch and team that is pushed back when the end tick moved later
+	struct CSwitchTimer
+	{
+		int m_EndTick;
+		int m_Number;
+		int m_Team;
+	};
+	std::vector<CSwitchTimer> m_vSwitchTimers;
+	static bool SwitchTimerCompare(const CSwitchTimer &a, const CSwitchTimer &b) { return a.m_EndTick > b.m_EndTick; }
 	
 	// headbot
 	double m_Time;
 
+	// quads of a named quad layer, transformed once per tick in SetTime
+	struct CIndexedQuad
+	{
+		const struct CQuad *m_pQuad;
+		vec2 m_aPoints[4];
+		vec2 m_Min;
+		vec2 m_Max;
+	};
+	struct CQuadSet
+	{
+		char m_aName[12];
+		bool m_Used;
+		std::vector<CIndexedQuad> m_vQuads;
+	};
+	std::vector<CQuadSet> m_vQuadSets;
+
+	void InitQuadSets();
+	void UpdateQuadSet(CQuadSet *pSet);
+
 public:
 
 	SSwitchers* m_pSwitchers;
+	// call after setting a timed type and end tick on a switcher
+	void ScheduleSwitch(int Number, int Team);
+	void TickSwitchers(int Tick);
 };
 
 void ThroughOffset(vec2 Pos0, vec2 Pos1, int *Ox, int *Oy);
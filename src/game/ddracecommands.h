@@ -47,6 +47,12 @@ CONSOLE_COMMAND("mutes", "", CFGFLAG_SERVER, ConMutes, this, "");
 
 CONSOLE_COMMAND("freezehammer", "v[id]", CFGFLAG_SERVER, ConFreezeHammer, this, "Gives a player Freeze Hammer")
 CONSOLE_COMMAND("unfreezehammer", "v[id]", CFGFLAG_SERVER, ConUnFreezeHammer, this, "Removes Freeze Hammer from a player")
+CONSOLE_COMMAND("map_update_stats", "", CFGFLAG_SERVER, ConMapUpdateStats, this, "Shows and resets the cost of the vanilla id map updates")
+CONSOLE_COMMAND("event_stats", "", CFGFLAG_SERVER, ConEventStats, this, "Shows and resets the number of culled and dropped events")
+CONSOLE_COMMAND("bot_stats", "", CFGFLAG_SERVER, ConBotStats, this, "Shows and resets how often and how long each bot was updated")
+#if defined(CONF_SQL)
+CONSOLE_COMMAND("sql_spool", "", CFGFLAG_SERVER, ConSqlSpool, this, "Shows how many finishes are waiting to be written to the database")
+#endif
 #undef CONSOLE_COMMAND
 
 #endif
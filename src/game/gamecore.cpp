@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "gamecore.h"
+#include "mapindex.h"
 
 #include <engine/shared/config.h>
 #include <engine/server/server.h>
@@ -61,7 +62,7 @@ void CCharacterCore::Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore
 {
 	m_pWorld = pWorld;
 	m_pCollision = pCollision;
-	m_pTeleOuts = NULL;
+	m_pMapIndex = NULL;
 
 	m_pTeams = pTeams;
 	m_Id = -1;
@@ -71,11 +72,11 @@ void CCharacterCore::Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore
 	m_Jumps = 2;
 }
 
-void CCharacterCore::Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore* pTeams, std::map<int, std::vector<vec2> > *pTeleOuts)
+void CCharacterCore::Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore* pTeams, const CMapIndex *pMapIndex)
 {
 	m_pWorld = pWorld;
 	m_pCollision = pCollision;
-	m_pTeleOuts = pTeleOuts;
+	m_pMapIndex = pMapIndex;
 
 	m_pTeams = pTeams;
 	m_Id = -1;
@@ -326,14 +327,14 @@ void CCharacterCore::Tick(bool UseInput, bool IsClient)
 				m_HookState = HOOK_RETRACT_START;
 			}
 
-			if(GoingThroughTele && m_pTeleOuts && m_pTeleOuts->size() && (*m_pTeleOuts)[teleNr-1].size())
+			if(GoingThroughTele && m_pMapIndex && m_pMapIndex->NumTeleOuts(teleNr))
 			{
 				m_TriggeredEvents = 0;
 				m_HookedPlayer = -1;
 
 				m_NewHook = true;
-				int Num = (*m_pTeleOuts)[teleNr-1].size();
-				m_HookPos = (*m_pTeleOuts)[teleNr-1][(Num==1)?0:rand() % Num]+TargetDirection*PhysSize*1.5f;
+				int Num = m_pMapIndex->NumTeleOuts(teleNr);
+				m_HookPos = m_pMapIndex->TeleOuts(teleNr)[(Num==1)?0:rand() % Num]+TargetDirection*PhysSize*1.5f;
 				m_HookDir = TargetDirection;
 				m_HookTeleBase = m_HookPos;
 			}
@@ -703,7 +704,7 @@ bool CCharacterCore::IsRightTeam(int MapIndex)
 {
 	if(Collision()->m_pSwitchers)
 		if(m_pTeams->Team(m_Id) != (m_pTeams->m_IsDDRace16 ? VANILLA_TEAM_SUPER : TEAM_SUPER))
-			return Collision()->m_pSwitchers[Collision()->GetDTileNumber(MapIndex)].m_Status[m_pTeams->Team(m_Id)];
+			return Collision()->m_pSwitchers[Collision()->GetDTileNumber(MapIndex)].Status(m_pTeams->Team(m_Id));
 	return false;
 }
 
@@ -770,8 +771,9 @@ void ExtractExtraInfo(const CNetObj_Projectile *pProj, int *Owner, bool *Explosi
 		*Freeze = (Data>>13) & 1;
 }
 
-void SnapshotRemoveExtraInfo(unsigned char *pData)
+bool SnapshotRemoveExtraInfo(unsigned char *pData)
 {
+	bool Removed = false;
 	CSnapshot *pSnap = (CSnapshot*) pData;
 	for(int Index = 0; Index < pSnap->NumItems(); Index++)
 	{
@@ -788,7 +790,9 @@ void SnapshotRemoveExtraInfo(unsigned char *pData)
 				pProj->m_Y = Pos.y;
 				pProj->m_VelX = (int)(Vel.x*100.0f);
 				pProj->m_VelY = (int)(Vel.y*100.0f);
+				Removed = true;
 			}
 		}
 	}
+	return Removed;
 }
@@ -184,7 +184,7 @@ class CCharacterCore
 	friend class CCharacter;
 	CWorldCore *m_pWorld;
 	CCollision *m_pCollision;
-	std::map<int, std::vector<vec2> > *m_pTeleOuts;
+	const class CMapIndex *m_pMapIndex;
 public:
 	vec2 m_Pos;
 	vec2 m_Vel;
@@ -212,7 +212,7 @@ public:
 	int m_TriggeredEvents;
 
 	void Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore* pTeams);
-	void Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore* pTeams, std::map<int, std::vector<vec2> > *pTeleOuts);
+	void Init(CWorldCore *pWorld, CCollision *pCollision, CTeamsCore* pTeams, const class CMapIndex *pMapIndex);
 	void Reset();
 	void Tick(bool UseInput, bool IsClient);
 	void Move();
@@ -299,6 +299,6 @@ inline CInputCount CountInput(int Prev, int Cur)
 bool UseExtraInfo(const CNetObj_Projectile *pProj);
 void ExtractInfo(const CNetObj_Projectile *pProj, vec2 *StartPos, vec2 *StartVel, bool IsDDNet);
 void ExtractExtraInfo(const CNetObj_Projectile *pProj, int *Owner, bool *Explosive, int *Bouncing, bool *Freeze);
-void SnapshotRemoveExtraInfo(unsigned char *pData);
+bool SnapshotRemoveExtraInfo(unsigned char *pData);
 
 #endif
@@ -0,0 +1,84 @@
+#include <stdlib.h>
+
+#include <game/collision.h>
+#include <game/mapitems.h>
+
+#include "mapindex.h"
+
+template<typename T>
+void CMapIndex::CBuckets<T>::Build(const std::vector<std::pair<int, T> > &vPairs)
+{
+	for(int i = 0; i <= NUM_KEYS; i++)
+		m_aStart[i] = 0;
+	for(unsigned i = 0; i < vPairs.size(); i++)
+		m_aStart[vPairs[i].first+1]++;
+	for(int i = 0; i < NUM_KEYS; i++)
+		m_aStart[i+1] += m_aStart[i];
+
+	int aNext[NUM_KEYS];
+	for(int i = 0; i < NUM_KEYS; i++)
+		aNext[i] = m_aStart[i];
+	m_vData.resize(vPairs.size());
+	for(unsigned i = 0; i < vPairs.size(); i++)
+		m_vData[aNext[vPairs[i].first]++] = vPairs[i].second;
+}
+
+void CMapIndex::Init(CCollision *pCollision)
+{
+	std::vector<std::pair<int, vec2> > vTiles;
+	std::vector<std::pair<int, vec2> > vTeleOuts;
+	std::vector<std::pair<int, vec2> > vTeleCheckOuts;
+	std::vector<std::pair<int, int> > vTeleIns;
+	std::vector<std::pair<int, int> > vEvilTeleIns;
+
+	int Width = pCollision->GetWidth();
+	int Height = pCollision->GetHeight();
+	CTile *pGame = pCollision->GameLayer();
+	CTeleTile *pTele = pCollision->TeleLayer();
+
+	for(int i = 0; i < Width*Height; i++)
+	{
+		vec2 Pos(i % Width * 32 + 16, i / Width * 32 + 16);
+
+		int Index = pGame[i].m_Index;
+		if(Index != TILE_AIR && Index != TILE_SOLID && Index != TILE_NOHOOK)
+			vTiles.push_back(std::make_pair(Index, Pos));
+
+		if(pTele && pTele[i].m_Number > 0)
+		{
+			int Key = pTele[i].m_Number-1;
+			if(pTele[i].m_Type == TILE_TELEOUT)
+				vTeleOuts.push_back(std::make_pair(Key, Pos));
+			else if(pTele[i].m_Type == TILE_TELECHECKOUT)
+				vTeleCheckOuts.push_back(std::make_pair(Key, Pos));
+			else if(pTele[i].m_Type == TILE_TELEIN)
+				vTeleIns.push_back(std::make_pair(Key, i));
+			else if(pTele[i].m_Type == TILE_TELEINEVIL)
+				vEvilTeleIns.push_back(std::make_pair(Key, i));
+		}
+	}
+
+	m_Tiles.Build(vTiles);
+	m_TeleOuts.Build(vTeleOuts);
+	m_TeleCheckOuts.Build(vTeleCheckOuts);
+	m_TeleIns.Build(vTeleIns);
+	m_EvilTeleIns.Build(vEvilTeleIns);
+}
+
+bool CMapIndex::RandomTeleOut(int Number, vec2 *pPos) const
+{
+	int Num = NumTeleOuts(Number);
+	if(!Num)
+		return false;
+	*pPos = TeleOuts(Number)[rand() % Num];
+	return true;
+}
+
+bool CMapIndex::RandomTeleCheckOut(int Number, vec2 *pPos) const
+{
+	int Num = NumTeleCheckOuts(Number);
+	if(!Num)
+		return false;
+	*pPos = TeleCheckOuts(Number)[rand() % Num];
+	return true;
+}
@@ -0,0 +1,60 @@
+#ifndef GAME_MAPINDEX_H
+#define GAME_MAPINDEX_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+/*
+	Positions of the map's entity tiles and teleporters, collected in one
+	pass over the layers when the map is loaded. Every key owns a flat run
+	inside one array, so a lookup is two loads and no allocation.
+*/
+class CMapIndex
+{
+	template<typename T>
+	class CBuckets
+	{
+	public:
+		enum { NUM_KEYS=256 };
+
+		int m_aStart[NUM_KEYS+1];
+		std::vector<T> m_vData;
+
+		// (key, value) pairs in map order to the flat runs, keeps the order
+		void Build(const std::vector<std::pair<int, T> > &vPairs);
+		int Num(int Key) const { return Key >= 0 && Key < NUM_KEYS ? m_aStart[Key+1] - m_aStart[Key] : 0; }
+		const T *Data(int Key) const { return Num(Key) ? &m_vData[m_aStart[Key]] : 0; }
+	};
+
+	CBuckets<vec2> m_Tiles;
+	CBuckets<vec2> m_TeleOuts;
+	CBuckets<vec2> m_TeleCheckOuts;
+	CBuckets<int> m_TeleIns;
+	CBuckets<int> m_EvilTeleIns;
+
+public:
+	void Init(class CCollision *pCollision);
+
+	// centers of the game layer tiles with this index (air, solid and nohook are not indexed)
+	int NumTiles(int Index) const { return m_Tiles.Num(Index); }
+	const vec2 *Tiles(int Index) const { return m_Tiles.Data(Index); }
+
+	// tele numbers start at 1 like on the tele layer
+	int NumTeleOuts(int Number) const { return m_TeleOuts.Num(Number-1); }
+	const vec2 *TeleOuts(int Number) const { return m_TeleOuts.Data(Number-1); }
+	int NumTeleCheckOuts(int Number) const { return m_TeleCheckOuts.Num(Number-1); }
+	const vec2 *TeleCheckOuts(int Number) const { return m_TeleCheckOuts.Data(Number-1); }
+
+	// a random tele out of this number, false if there is none
+	bool RandomTeleOut(int Number, vec2 *pPos) const;
+	bool RandomTeleCheckOut(int Number, vec2 *pPos) const;
+
+	// map indices of the tele ins, by the number they had when the map was loaded
+	int NumTeleIns(int Number) const { return m_TeleIns.Num(Number-1); }
+	const int *TeleIns(int Number) const { return m_TeleIns.Data(Number-1); }
+	int NumEvilTeleIns(int Number) const { return m_EvilTeleIns.Num(Number-1); }
+	const int *EvilTeleIns(int Number) const { return m_EvilTeleIns.Data(Number-1); }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include <engine/shared/config.h>
+
+#include "gamecontext.h"
+#include "botmanager.h"
+#include "gamemodes/WarioWare.h"
+
+CBotManager::CBotManager()
+{
+	m_pGameServer = 0;
+	m_NumBots = 0;
+	m_Next = 0;
+	mem_zero(m_aBots, sizeof(m_aBots));
+}
+
+void CBotManager::Init(CGameContext *pGameServer, int NumBots)
+{
+	m_pGameServer = pGameServer;
+	m_NumBots = NumBots;
+	m_Next = 0;
+	mem_zero(m_aBots, sizeof(m_aBots));
+
+	for(int i = 0; i < m_NumBots; i++)
+	{
+		int ClientID = CBotManager::ClientID(i);
+		pGameServer->OnClientConnected(ClientID); // need these dummies for microgames
+		CPlayer *pPlayer = pGameServer->m_apPlayers[ClientID];
+		pPlayer->SetTeam(TEAM_SPECTATORS, false);
+		pPlayer->setVoluntarySpectator(true);
+
+		char aName[MAX_NAME_LENGTH];
+		FormatName(i, "bot", aName, sizeof(aName));
+		pGameServer->Server()->SetClientName(ClientID, aName);
+
+		str_copy(pPlayer->m_TeeInfos.m_aSkinName, "itsabot", sizeof(pPlayer->m_TeeInfos.m_aSkinName));
+		str_copy(pPlayer->original_skin, "itsabot", sizeof(pPlayer->original_skin));
+		pPlayer->original_color = 0;
+		pPlayer->original_body_color = 0;
+	}
+}
+
+void CBotManager::FormatName(int BotID, const char *pBase, char *pBuf, int Size)
+{
+	if(BotID == 0)
+		str_copy(pBuf, pBase, Size);
+	else
+		str_format(pBuf, Size, "%s(%d)", pBase, BotID);
+}
+
+void CBotManager::Tick()
+{
+	CGameControllerWarioWare *pController = (CGameControllerWarioWare *)m_pGameServer->m_pController;
+	if(pController->isInGame() and pController->inMicroGame())
+	{
+		Microgame *pGame = pController->getMicroGame();
+		int BudgetUs = g_Config.m_WwBotTickBudget;
+		if(m_pGameServer->Server()->OverloadLevel() >= IServer::OVERLOAD_BOTS)
+			BudgetUs = BudgetUs ? max(BudgetUs/4, 1) : 500;
+		int64 Budget = BudgetUs*time_freq()/1000000;
+		int64 Start = time_get_impl();
+		int Done = 0;
+
+		// at least one bot gets a turn every tick
+		for(; Done < m_NumBots; Done++)
+		{
+			int64 Now = time_get_impl();
+			if(Done > 0 && Budget > 0 && Now-Start >= Budget)
+				break;
+
+			CBot *pBot = &m_aBots[m_Next];
+			pGame->OnBotInput(m_Next, &pBot->m_Input);
+			pBot->m_Time += time_get_impl()-Now;
+			pBot->m_Updates++;
+			m_Next = (m_Next+1) % m_NumBots;
+		}
+
+		for(int i = Done; i < m_NumBots; i++)
+			m_aBots[(m_Next+i-Done) % m_NumBots].m_Skipped++;
+	}
+
+	for(int i = 0; i < m_NumBots; i++)
+	{
+		CPlayer *pPlayer = m_pGameServer->m_apPlayers[ClientID(i)];
+		if(pPlayer)
+			pPlayer->OnDirectInput(&m_aBots[i].m_Input);
+	}
+}
+
+void CBotManager::PrintStats()
+{
+	char aBuf[128];
+	for(int i = 0; i < m_NumBots; i++)
+	{
+		const CBot *pBot = &m_aBots[i];
+		int64 AvgUs = pBot->m_Updates ? pBot->m_Time*1000000/time_freq()/pBot->m_Updates : 0;
+		str_format(aBuf, sizeof(aBuf), "bot %d (id=%d): updates=%d skipped=%d avg=%dus",
+			i, ClientID(i), pBot->m_Updates, pBot->m_Skipped, (int)AvgUs);
+		m_pGameServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bots", aBuf);
+	}
+}
+
+void CBotManager::ResetStats()
+{
+	for(int i = 0; i < m_NumBots; i++)
+	{
+		m_aBots[i].m_Time = 0;
+		m_aBots[i].m_Updates = 0;
+		m_aBots[i].m_Skipped = 0;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef GAME_SERVER_BOTMANAGER_H
+#define GAME_SERVER_BOTMANAGER_H
+
+#include <base/system.h>
+#include <engine/shared/protocol.h>
+#include <game/generated/protocol.h>
+
+/*
+	Server side bots. Bots take the last client slots, BotID 0 being
+	MAX_CLIENTS-1. Every tick the active microgame refreshes the bot inputs
+	round robin until the tick budget is used up, bots that didn't get a
+	turn keep steering with their last input.
+*/
+class CBotManager
+{
+	struct CBot
+	{
+		CNetObj_PlayerInput m_Input;
+		int64 m_Time;
+		int m_Updates;
+		int m_Skipped;
+	};
+
+	class CGameContext *m_pGameServer;
+	CBot m_aBots[MAX_CLIENTS];
+	int m_NumBots;
+	int m_Next;
+
+public:
+	CBotManager();
+
+	void Init(class CGameContext *pGameServer, int NumBots);
+	void Tick();
+
+	int NumBots() const { return m_NumBots; }
+	static int ClientID(int BotID) { return MAX_CLIENTS-1-BotID; }
+	static int BotID(int ClientID) { return MAX_CLIENTS-1-ClientID; }
+	CNetObj_PlayerInput *Input(int ClientID) { return &m_aBots[BotID(ClientID)].m_Input; }
+	// "bot" for the first one, "bot(1)" and so on for the others
+	static void FormatName(int BotID, const char *pBase, char *pBuf, int Size);
+
+	void PrintStats();
+	void ResetStats();
+};
+
+#endif
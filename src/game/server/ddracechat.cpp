@@ -894,6 +894,7 @@ void CGameContext::ConShowOthers(IConsole::IResult *pResult, void *pUserData)
 			pPlayer->m_ShowOthers = pResult->GetInteger(0);
 		else
 			pPlayer->m_ShowOthers = !pPlayer->m_ShowOthers;
+		pSelf->InvalidateTeamMasks();
 	}
 	else
 		pSelf->Console()->Print(
@@ -921,6 +922,7 @@ void CGameContext::ConSpecTeam(IConsole::IResult *pResult, void *pUserData)
 		pPlayer->m_SpecTeam = pResult->GetInteger(0);
 	else
 		pPlayer->m_SpecTeam = !pPlayer->m_SpecTeam;
+	pSelf->InvalidateTeamMasks();
 }
 
 bool CheckClientID(int ClientID)
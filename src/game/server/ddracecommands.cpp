@@ -4,6 +4,7 @@
 #include <engine/server/server.h>
 #include <game/server/teams.h>
 #include <game/server/gamemodes/DDRace.h>
+#include <game/server/gamemodes/WarioWare.h>
 #include <game/version.h>
 #include <game/generated/nethash.cpp>
 #if defined(CONF_SQL)
@@ -273,10 +274,9 @@ void CGameContext::ConToTeleporter(IConsole::IResult *pResult, void *pUserData)
 	CGameContext *pSelf = (CGameContext *) pUserData;
 	unsigned int TeleTo = pResult->GetInteger(0);
 
-	if (((CGameControllerDDRace*)pSelf->m_pController)->m_TeleOuts[TeleTo-1].size())
+	vec2 TelePos;
+	if (((CGameControllerWarioWare*)pSelf->m_pController)->m_MapIndex.RandomTeleOut(TeleTo, &TelePos))
 	{
-		int Num = ((CGameControllerDDRace*)pSelf->m_pController)->m_TeleOuts[TeleTo-1].size();
-		vec2 TelePos = ((CGameControllerDDRace*)pSelf->m_pController)->m_TeleOuts[TeleTo-1][(!Num)?Num:rand() % Num];
 		CCharacter* pChr = pSelf->GetPlayerChar(pResult->m_ClientID);
 		if (pChr)
 		{
@@ -293,10 +293,9 @@ void CGameContext::ConToCheckTeleporter(IConsole::IResult *pResult, void *pUserD
 	CGameContext *pSelf = (CGameContext *) pUserData;
 	unsigned int TeleTo = pResult->GetInteger(0);
 
-	if (((CGameControllerDDRace*)pSelf->m_pController)->m_TeleCheckOuts[TeleTo-1].size())
+	vec2 TelePos;
+	if (((CGameControllerWarioWare*)pSelf->m_pController)->m_MapIndex.RandomTeleCheckOut(TeleTo, &TelePos))
 	{
-		int Num = ((CGameControllerDDRace*)pSelf->m_pController)->m_TeleCheckOuts[TeleTo-1].size();
-		vec2 TelePos = ((CGameControllerDDRace*)pSelf->m_pController)->m_TeleCheckOuts[TeleTo-1][(!Num)?Num:rand() % Num];
 		CCharacter* pChr = pSelf->GetPlayerChar(pResult->m_ClientID);
 		if (pChr)
 		{
@@ -365,6 +364,7 @@ void CGameContext::ConForcePause(IConsole::IResult *pResult, void *pUserData)
 
 	pPlayer->m_ForcePauseTime = Seconds*pServ->TickSpeed();
 	pPlayer->m_Paused = CPlayer::PAUSED_FORCE;
+	pSelf->InvalidateTeamMasks();
 }
 
 void CGameContext::Mute(IConsole::IResult *pResult, NETADDR *Addr, int Secs,
@@ -530,3 +530,53 @@ void CGameContext::ConUnFreezeHammer(IConsole::IResult *pResult, void *pUserData
 
 	pChr->m_FreezeHammer = false;
 }
+
+void CGameContext::ConMapUpdateStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *) pUserData;
+	CGameWorld *pWorld = &pSelf->m_World;
+
+	int Clients = pWorld->m_MapUpdateComputed + pWorld->m_MapUpdateSkipped;
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%d updates, %d/%d client maps recomputed, %.2fus per update, %.2fus per recomputed client",
+		pWorld->m_MapUpdates, pWorld->m_MapUpdateComputed, Clients,
+		pWorld->m_MapUpdates ? pWorld->m_MapUpdateTime*1000000.0/time_freq()/pWorld->m_MapUpdates : 0.0,
+		pWorld->m_MapUpdateComputed ? pWorld->m_MapUpdateTime*1000000.0/time_freq()/pWorld->m_MapUpdateComputed : 0.0);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "mapupdate", aBuf);
+
+	pWorld->m_MapUpdateTime = 0;
+	pWorld->m_MapUpdates = 0;
+	pWorld->m_MapUpdateComputed = 0;
+	pWorld->m_MapUpdateSkipped = 0;
+}
+
+void CGameContext::ConEventStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *) pUserData;
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%lld events culled, %lld events dropped",
+		(long long)pSelf->m_Events.m_NumCulled, (long long)pSelf->m_Events.m_NumDropped);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "events", aBuf);
+
+	pSelf->m_Events.m_NumCulled = 0;
+	pSelf->m_Events.m_NumDropped = 0;
+}
+
+void CGameContext::ConBotStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *) pUserData;
+
+	pSelf->m_Bots.PrintStats();
+	pSelf->m_Bots.ResetStats();
+}
+
+#if defined(CONF_SQL)
+void CGameContext::ConSqlSpool(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *) pUserData;
+
+	if(pSelf->m_pScore)
+		pSelf->m_pScore->PrintSpool(pSelf->Console());
+}
+#endif
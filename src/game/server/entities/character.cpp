@@ -47,7 +47,7 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 	m_Pos = Pos;
 
 	m_Core.Reset();
-	m_Core.Init(&GameServer()->m_World.m_Core, GameServer()->Collision(), &((CGameControllerWarioWare*)GameServer()->m_pController)->m_Teams.m_Core, &((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts);
+	m_Core.Init(&GameServer()->m_World.m_Core, GameServer()->Collision(), &((CGameControllerWarioWare*)GameServer()->m_pController)->m_Teams.m_Core, &((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex);
 	m_Core.m_ActiveWeapon = WEAPON_GUN;
 	m_Core.m_Pos = m_Pos;
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = &m_Core;
@@ -88,6 +88,7 @@ void CCharacter::Destroy()
 {
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
 	m_Alive = false;
+	Teams()->InvalidateTeamMasks();
 }
 
 void CCharacter::SetWeapon(int W)
@@ -107,6 +108,7 @@ void CCharacter::SetWeapon(int W)
 void CCharacter::SetSolo(bool Solo)
 {
 	Teams()->m_Core.SetSolo(m_pPlayer->GetCID(), Solo);
+	Teams()->InvalidateTeamMasks();
 
 	if(Solo)
 		m_NeededFaketuning |= FAKETUNE_SOLO;
@@ -790,7 +792,7 @@ void CCharacter::TickDefered()
 	// advance the dummy
 	{
 		CWorldCore TempWorld;
-		m_ReckoningCore.Init(&TempWorld, GameServer()->Collision(), &((CGameControllerWarioWare*)GameServer()->m_pController)->m_Teams.m_Core, &((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts);
+		m_ReckoningCore.Init(&TempWorld, GameServer()->Collision(), &((CGameControllerWarioWare*)GameServer()->m_pController)->m_Teams.m_Core, &((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex);
 		m_ReckoningCore.m_Id = m_pPlayer->GetCID();
 		m_ReckoningCore.Tick(false, false);
 		m_ReckoningCore.Move();
@@ -929,6 +931,7 @@ void CCharacter::Die(int Killer, int Weapon, float respawnSecs)
 	m_pPlayer->m_DieTick = Server()->Tick() + (Server()->TickSpeed() * respawnSecs);
 
 	m_Alive = false;
+	Teams()->InvalidateTeamMasks();
 	GameServer()->m_World.RemoveEntity(this);
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
 	GameServer()->CreateDeath(m_Pos, m_pPlayer->GetCID(), Teams()->TeamMask(Team(), -1, m_pPlayer->GetCID()));
@@ -1380,6 +1383,233 @@ void CCharacter::HandleSkippableTiles(int Index)
 	}
 }
 
+void CCharacter::HandleFreezeTiles()
+{
+	if(((m_TileIndex == TILE_FREEZE) || (m_TileFIndex == TILE_FREEZE)) && !m_Super && !m_DeepFreeze)
+		Freeze();
+	else if(((m_TileIndex == TILE_UNFREEZE) || (m_TileFIndex == TILE_UNFREEZE)) && !m_DeepFreeze)
+		UnFreeze();
+}
+
+void CCharacter::HandleDeepFreezeTiles()
+{
+	if(((m_TileIndex == TILE_DFREEZE) || (m_TileFIndex == TILE_DFREEZE)) && !m_Super && !m_DeepFreeze)
+		m_DeepFreeze = true;
+	else if(((m_TileIndex == TILE_DUNFREEZE) || (m_TileFIndex == TILE_DUNFREEZE)) && !m_Super && m_DeepFreeze)
+		m_DeepFreeze = false;
+}
+
+void CCharacter::HandleEndlessHookTiles()
+{
+	if(((m_TileIndex == TILE_EHOOK_START) || (m_TileFIndex == TILE_EHOOK_START)) && !m_EndlessHook)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "Endless hook has been activated");
+		m_EndlessHook = true;
+	}
+	else if(((m_TileIndex == TILE_EHOOK_END) || (m_TileFIndex == TILE_EHOOK_END)) && m_EndlessHook)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "Endless hook has been deactivated");
+		m_EndlessHook = false;
+	}
+}
+
+void CCharacter::HandleHitTiles()
+{
+	if(((m_TileIndex == TILE_HIT_END) || (m_TileFIndex == TILE_HIT_END)) && m_Hit != (DISABLE_HIT_GRENADE|DISABLE_HIT_HAMMER|DISABLE_HIT_RIFLE|DISABLE_HIT_SHOTGUN))
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't hit others");
+		m_Hit = DISABLE_HIT_GRENADE|DISABLE_HIT_HAMMER|DISABLE_HIT_RIFLE|DISABLE_HIT_SHOTGUN;
+		m_NeededFaketuning |= FAKETUNE_NOHAMMER;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+	else if(((m_TileIndex == TILE_HIT_START) || (m_TileFIndex == TILE_HIT_START)) && m_Hit != HIT_ALL)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can hit others");
+		m_Hit = HIT_ALL;
+		m_NeededFaketuning &= ~FAKETUNE_NOHAMMER;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+}
+
+void CCharacter::HandleCollideTiles()
+{
+	if(((m_TileIndex == TILE_NPC_END) || (m_TileFIndex == TILE_NPC_END)) && m_Core.m_Collision)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't collide with others");
+		m_Core.m_Collision = false;
+		m_NeededFaketuning |= FAKETUNE_NOCOLL;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+	else if(((m_TileIndex == TILE_NPC_START) || (m_TileFIndex == TILE_NPC_START)) && !m_Core.m_Collision)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can collide with others");
+		m_Core.m_Collision = true;
+		m_NeededFaketuning &= ~FAKETUNE_NOCOLL;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+}
+
+void CCharacter::HandleHookTiles()
+{
+	if(((m_TileIndex == TILE_NPH_END) || (m_TileFIndex == TILE_NPH_END)) && m_Core.m_Hook)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't hook others");
+		m_Core.m_Hook = false;
+		m_NeededFaketuning |= FAKETUNE_NOHOOK;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+	else if(((m_TileIndex == TILE_NPH_START) || (m_TileFIndex == TILE_NPH_START)) && !m_Core.m_Hook)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can hook others");
+		m_Core.m_Hook = true;
+		m_NeededFaketuning &= ~FAKETUNE_NOHOOK;
+		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+	}
+}
+
+void CCharacter::HandleSuperJumpTiles()
+{
+	if(((m_TileIndex == TILE_SUPER_START) || (m_TileFIndex == TILE_SUPER_START)) && !m_SuperJump)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You have unlimited air jumps");
+		m_SuperJump = true;
+		if (m_Core.m_Jumps == 0)
+		{
+			m_NeededFaketuning &= ~FAKETUNE_NOJUMP;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+		}
+	}
+	else if(((m_TileIndex == TILE_SUPER_END) || (m_TileFIndex == TILE_SUPER_END)) && m_SuperJump)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You don't have unlimited air jumps");
+		m_SuperJump = false;
+		if (m_Core.m_Jumps == 0)
+		{
+			m_NeededFaketuning |= FAKETUNE_NOJUMP;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+		}
+	}
+}
+
+void CCharacter::HandleWallJumpTiles()
+{
+	if((m_TileIndex == TILE_WALLJUMP) || (m_TileFIndex == TILE_WALLJUMP))
+	{
+		if(m_Core.m_Vel.y > 0 && m_Core.m_Colliding && m_Core.m_LeftWall)
+		{
+			m_Core.m_LeftWall = false;
+			m_Core.m_JumpedTotal = m_Core.m_Jumps - 1;
+			m_Core.m_Jumped = 1;
+		}
+	}
+}
+
+void CCharacter::HandleJetpackTiles()
+{
+	if(((m_TileIndex == TILE_JETPACK_START) || (m_TileFIndex == TILE_JETPACK_START)) && !m_Jetpack)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You have a jetpack gun");
+		m_Jetpack = true;
+	}
+	else if(((m_TileIndex == TILE_JETPACK_END) || (m_TileFIndex == TILE_JETPACK_END)) && m_Jetpack)
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You lost your jetpack gun");
+		m_Jetpack = false;
+	}
+
+	// unlock team
+	else if((m_TileIndex == TILE_UNLOCK_TEAM) || (m_TileFIndex == TILE_UNLOCK_TEAM))
+	{
+		Teams()->SetTeamLock(Team(), false);
+	}
+}
+
+void CCharacter::HandleSoloTiles()
+{
+	if(((m_TileIndex == TILE_SOLO_START) || (m_TileFIndex == TILE_SOLO_START)) && !Teams()->m_Core.GetSolo(m_pPlayer->GetCID()))
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You are now in a solo part.");
+		SetSolo(true);
+	}
+	else if(((m_TileIndex == TILE_SOLO_END) || (m_TileFIndex == TILE_SOLO_END)) && Teams()->m_Core.GetSolo(m_pPlayer->GetCID()))
+	{
+		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You are now out of the solo part.");
+		SetSolo(false);
+	}
+}
+
+void CCharacter::HandleRefillJumpsTiles()
+{
+	if(((m_TileIndex == TILE_REFILL_JUMPS) || (m_TileFIndex == TILE_REFILL_JUMPS)) && !m_LastRefillJumps)
+	{
+		m_Core.m_JumpedTotal = 0;
+		m_Core.m_Jumped = 0;
+		m_LastRefillJumps = true;
+	}
+}
+
+void CCharacter::HandleWarioWareTiles()
+{
+	CGameControllerWarioWare* Controller = (CGameControllerWarioWare*)GameServer()->m_pController;
+	if(((m_TileIndex == TILE_WARIOWARE_WIN) || (m_TileFIndex == TILE_WARIOWARE_WIN)))
+	{
+		int tile = (m_TileIndex == TILE_WARIOWARE_WIN) ? m_TileIndex : m_TileFIndex;
+		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
+			Controller->winMicroGame(m_pPlayer->GetCID());
+	}
+	else if(((m_TileIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN) || (m_TileFIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN)))
+	{
+		int tile = (m_TileIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN) ? m_TileIndex : m_TileFIndex;
+		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
+			Controller->winMicroGame(m_pPlayer->GetCID());
+	}
+	else if(((m_TileIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN) || (m_TileFIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN)))
+	{
+		int tile = (m_TileIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN) ? m_TileIndex : m_TileFIndex;
+		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
+			Controller->winMicroGame(m_pPlayer->GetCID());
+	}
+}
+
+const CCharacter::CTileHandler CCharacter::ms_aTileHandlers[NUM_TILEHANDLERS] = {
+	{&CCharacter::HandleFreezeTiles, {TILE_FREEZE, TILE_UNFREEZE}},
+	{&CCharacter::HandleDeepFreezeTiles, {TILE_DFREEZE, TILE_DUNFREEZE}},
+	{&CCharacter::HandleEndlessHookTiles, {TILE_EHOOK_START, TILE_EHOOK_END}},
+	{&CCharacter::HandleHitTiles, {TILE_HIT_START, TILE_HIT_END}},
+	{&CCharacter::HandleCollideTiles, {TILE_NPC_START, TILE_NPC_END}},
+	{&CCharacter::HandleHookTiles, {TILE_NPH_START, TILE_NPH_END}},
+	{&CCharacter::HandleSuperJumpTiles, {TILE_SUPER_START, TILE_SUPER_END}},
+	{&CCharacter::HandleWallJumpTiles, {TILE_WALLJUMP}},
+	{&CCharacter::HandleJetpackTiles, {TILE_JETPACK_START, TILE_JETPACK_END, TILE_UNLOCK_TEAM}},
+	{&CCharacter::HandleSoloTiles, {TILE_SOLO_START, TILE_SOLO_END}},
+	{&CCharacter::HandleRefillJumpsTiles, {TILE_REFILL_JUMPS}},
+	{&CCharacter::HandleWarioWareTiles, {TILE_WARIOWARE_WIN, TILE_WARIOWARE_REACHEND_NADE1_WIN, TILE_WARIOWARE_REACHEND_NADE2_WIN}},
+};
+
+int CCharacter::TileHandlers(int Tile)
+{
+	static int s_aHandlers[256];
+	static bool s_Init = false;
+	if(!s_Init)
+	{
+		mem_zero(s_aHandlers, sizeof(s_aHandlers));
+		for(int h = 0; h < NUM_TILEHANDLERS; h++)
+			for(int t = 0; t < 3 && ms_aTileHandlers[h].m_aTiles[t]; t++)
+				s_aHandlers[ms_aTileHandlers[h].m_aTiles[t]] |= 1<<h;
+		s_Init = true;
+	}
+	return s_aHandlers[Tile&255];
+}
+
+void CCharacter::ClearTileIndices()
+{
+	m_TileIndex = m_TileFlags = m_TileFIndex = m_TileFFlags = m_TileSIndex = m_TileSFlags = 0;
+	m_TileIndexL = m_TileFlagsL = m_TileFIndexL = m_TileFFlagsL = m_TileSIndexL = m_TileSFlagsL = 0;
+	m_TileIndexR = m_TileFlagsR = m_TileFIndexR = m_TileFFlagsR = m_TileSIndexR = m_TileSFlagsR = 0;
+	m_TileIndexT = m_TileFlagsT = m_TileFIndexT = m_TileFFlagsT = m_TileSIndexT = m_TileSFlagsT = 0;
+	m_TileIndexB = m_TileFlagsB = m_TileFIndexB = m_TileFFlagsB = m_TileSIndexB = m_TileSFlagsB = 0;
+}
+
 void CCharacter::HandleTiles(int Index)
 {
 	CGameControllerWarioWare* Controller = (CGameControllerWarioWare*)GameServer()->m_pController;
@@ -1391,6 +1621,27 @@ void CCharacter::HandleTiles(int Index)
 	int MapIndexT = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x, m_Pos.y + (m_ProximityRadius / 2) + Offset));
 	int MapIndexB = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x, m_Pos.y - (m_ProximityRadius / 2) - Offset));
 	//dbg_msg("","N%d L%d R%d B%d T%d",MapIndex,MapIndexL,MapIndexR,MapIndexB,MapIndexT);
+	//Sensitivity
+	int S1 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x + m_ProximityRadius / 3.f, m_Pos.y - m_ProximityRadius / 3.f));
+	int S2 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x + m_ProximityRadius / 3.f, m_Pos.y + m_ProximityRadius / 3.f));
+	int S3 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x - m_ProximityRadius / 3.f, m_Pos.y - m_ProximityRadius / 3.f));
+	int S4 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x - m_ProximityRadius / 3.f, m_Pos.y + m_ProximityRadius / 3.f));
+
+	// most tiles do nothing, bail out before looking at any layer
+	int Mask = GameServer()->Collision()->GetTileMask(MapIndex);
+	int NearMask = GameServer()->Collision()->GetTileMask(MapIndexL) | GameServer()->Collision()->GetTileMask(MapIndexR) |
+		GameServer()->Collision()->GetTileMask(MapIndexT) | GameServer()->Collision()->GetTileMask(MapIndexB) |
+		GameServer()->Collision()->GetTileMask(S1) | GameServer()->Collision()->GetTileMask(S2) |
+		GameServer()->Collision()->GetTileMask(S3) | GameServer()->Collision()->GetTileMask(S4);
+	if(!Mask && !(NearMask&(CCollision::TILEMASK_TILE|CCollision::TILEMASK_DOOR)))
+	{
+		ClearTileIndices();
+		m_LastRefillJumps = false;
+		m_LastPenalty = false;
+		m_LastBonus = false;
+		return;
+	}
+
 	m_TileIndex = GameServer()->Collision()->GetTileIndex(MapIndex);
 	m_TileFlags = GameServer()->Collision()->GetTileFlags(MapIndex);
 	m_TileIndexL = GameServer()->Collision()->GetTileIndex(MapIndexL);
@@ -1411,22 +1662,17 @@ void CCharacter::HandleTiles(int Index)
 	m_TileFFlagsB = GameServer()->Collision()->GetFTileFlags(MapIndexB);
 	m_TileFIndexT = GameServer()->Collision()->GetFTileIndex(MapIndexT);
 	m_TileFFlagsT = GameServer()->Collision()->GetFTileFlags(MapIndexT);//
-	m_TileSIndex = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndex)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndex) : 0 : 0;
-	m_TileSFlags = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndex)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndex) : 0 : 0;
-	m_TileSIndexL = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexL)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexL) : 0 : 0;
-	m_TileSFlagsL = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexL)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexL) : 0 : 0;
-	m_TileSIndexR = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexR)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexR) : 0 : 0;
-	m_TileSFlagsR = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexR)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexR) : 0 : 0;
-	m_TileSIndexB = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexB)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexB) : 0 : 0;
-	m_TileSFlagsB = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexB)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexB) : 0 : 0;
-	m_TileSIndexT = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexT)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexT) : 0 : 0;
-	m_TileSFlagsT = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexT)].m_Status[Team()])?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexT) : 0 : 0;
+	m_TileSIndex = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndex)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndex) : 0 : 0;
+	m_TileSFlags = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndex)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndex) : 0 : 0;
+	m_TileSIndexL = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexL)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexL) : 0 : 0;
+	m_TileSFlagsL = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexL)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexL) : 0 : 0;
+	m_TileSIndexR = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexR)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexR) : 0 : 0;
+	m_TileSFlagsR = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexR)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexR) : 0 : 0;
+	m_TileSIndexB = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexB)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexB) : 0 : 0;
+	m_TileSFlagsB = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexB)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexB) : 0 : 0;
+	m_TileSIndexT = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexT)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileIndex(MapIndexT) : 0 : 0;
+	m_TileSFlagsT = (GameServer()->Collision()->m_pSwitchers && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetDTileNumber(MapIndexT)].Status(Team()))?(Team() != TEAM_SUPER)? GameServer()->Collision()->GetDTileFlags(MapIndexT) : 0 : 0;
 	//dbg_msg("Tiles","%d, %d, %d, %d, %d", m_TileSIndex, m_TileSIndexL, m_TileSIndexR, m_TileSIndexB, m_TileSIndexT);
-	//Sensitivity
-	int S1 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x + m_ProximityRadius / 3.f, m_Pos.y - m_ProximityRadius / 3.f));
-	int S2 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x + m_ProximityRadius / 3.f, m_Pos.y + m_ProximityRadius / 3.f));
-	int S3 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x - m_ProximityRadius / 3.f, m_Pos.y - m_ProximityRadius / 3.f));
-	int S4 = GameServer()->Collision()->GetPureMapIndex(vec2(m_Pos.x - m_ProximityRadius / 3.f, m_Pos.y + m_ProximityRadius / 3.f));
 	int Tile1 = GameServer()->Collision()->GetTileIndex(S1);
 	int Tile2 = GameServer()->Collision()->GetTileIndex(S2);
 	int Tile3 = GameServer()->Collision()->GetTileIndex(S3);
@@ -1498,6 +1744,7 @@ void CCharacter::HandleTiles(int Index)
 	if(tcp)
 		m_TeleCheckpoint = tcp;
 
+
 	// start
 	if(((m_TileIndex == TILE_BEGIN) || (m_TileFIndex == TILE_BEGIN) || FTile1 == TILE_BEGIN || FTile2 == TILE_BEGIN || FTile3 == TILE_BEGIN || FTile4 == TILE_BEGIN || Tile1 == TILE_BEGIN || Tile2 == TILE_BEGIN || Tile3 == TILE_BEGIN || Tile4 == TILE_BEGIN) && (m_DDRaceState == DDRACE_NONE || m_DDRaceState == DDRACE_FINISHED || (m_DDRaceState == DDRACE_STARTED && !Team())))
 	{
@@ -1536,149 +1783,13 @@ void CCharacter::HandleTiles(int Index)
 	if(((m_TileIndex == TILE_END) || (m_TileFIndex == TILE_END) || FTile1 == TILE_END || FTile2 == TILE_END || FTile3 == TILE_END || FTile4 == TILE_END || Tile1 == TILE_END || Tile2 == TILE_END || Tile3 == TILE_END || Tile4 == TILE_END) && m_DDRaceState == DDRACE_STARTED)
 		Controller->m_Teams.OnCharacterFinish(m_pPlayer->GetCID());
 
-	// freeze
-	if(((m_TileIndex == TILE_FREEZE) || (m_TileFIndex == TILE_FREEZE)) && !m_Super && !m_DeepFreeze)
-		Freeze();
-	else if(((m_TileIndex == TILE_UNFREEZE) || (m_TileFIndex == TILE_UNFREEZE)) && !m_DeepFreeze)
-		UnFreeze();
-
-	// deep freeze
-	if(((m_TileIndex == TILE_DFREEZE) || (m_TileFIndex == TILE_DFREEZE)) && !m_Super && !m_DeepFreeze)
-		m_DeepFreeze = true;
-	else if(((m_TileIndex == TILE_DUNFREEZE) || (m_TileFIndex == TILE_DUNFREEZE)) && !m_Super && m_DeepFreeze)
-		m_DeepFreeze = false;
-
-	// endless hook
-	if(((m_TileIndex == TILE_EHOOK_START) || (m_TileFIndex == TILE_EHOOK_START)) && !m_EndlessHook)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "Endless hook has been activated");
-		m_EndlessHook = true;
-	}
-	else if(((m_TileIndex == TILE_EHOOK_END) || (m_TileFIndex == TILE_EHOOK_END)) && m_EndlessHook)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "Endless hook has been deactivated");
-		m_EndlessHook = false;
-	}
-
-	// hit others
-	if(((m_TileIndex == TILE_HIT_END) || (m_TileFIndex == TILE_HIT_END)) && m_Hit != (DISABLE_HIT_GRENADE|DISABLE_HIT_HAMMER|DISABLE_HIT_RIFLE|DISABLE_HIT_SHOTGUN))
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't hit others");
-		m_Hit = DISABLE_HIT_GRENADE|DISABLE_HIT_HAMMER|DISABLE_HIT_RIFLE|DISABLE_HIT_SHOTGUN;
-		m_NeededFaketuning |= FAKETUNE_NOHAMMER;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-	else if(((m_TileIndex == TILE_HIT_START) || (m_TileFIndex == TILE_HIT_START)) && m_Hit != HIT_ALL)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can hit others");
-		m_Hit = HIT_ALL;
-		m_NeededFaketuning &= ~FAKETUNE_NOHAMMER;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-
-	// collide with others
-	if(((m_TileIndex == TILE_NPC_END) || (m_TileFIndex == TILE_NPC_END)) && m_Core.m_Collision)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't collide with others");
-		m_Core.m_Collision = false;
-		m_NeededFaketuning |= FAKETUNE_NOCOLL;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-	else if(((m_TileIndex == TILE_NPC_START) || (m_TileFIndex == TILE_NPC_START)) && !m_Core.m_Collision)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can collide with others");
-		m_Core.m_Collision = true;
-		m_NeededFaketuning &= ~FAKETUNE_NOCOLL;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-
-	// hook others
-	if(((m_TileIndex == TILE_NPH_END) || (m_TileFIndex == TILE_NPH_END)) && m_Core.m_Hook)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You can't hook others");
-		m_Core.m_Hook = false;
-		m_NeededFaketuning |= FAKETUNE_NOHOOK;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-	else if(((m_TileIndex == TILE_NPH_START) || (m_TileFIndex == TILE_NPH_START)) && !m_Core.m_Hook)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can hook others");
-		m_Core.m_Hook = true;
-		m_NeededFaketuning &= ~FAKETUNE_NOHOOK;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-
-	// unlimited air jumps
-	if(((m_TileIndex == TILE_SUPER_START) || (m_TileFIndex == TILE_SUPER_START)) && !m_SuperJump)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You have unlimited air jumps");
-		m_SuperJump = true;
-		if (m_Core.m_Jumps == 0)
-		{
-			m_NeededFaketuning &= ~FAKETUNE_NOJUMP;
-			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-		}
-	}
-	else if(((m_TileIndex == TILE_SUPER_END) || (m_TileFIndex == TILE_SUPER_END)) && m_SuperJump)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You don't have unlimited air jumps");
-		m_SuperJump = false;
-		if (m_Core.m_Jumps == 0)
-		{
-			m_NeededFaketuning |= FAKETUNE_NOJUMP;
-			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-		}
-	}
-
-	// walljump
-	if((m_TileIndex == TILE_WALLJUMP) || (m_TileFIndex == TILE_WALLJUMP))
-	{
-		if(m_Core.m_Vel.y > 0 && m_Core.m_Colliding && m_Core.m_LeftWall)
-		{
-			m_Core.m_LeftWall = false;
-			m_Core.m_JumpedTotal = m_Core.m_Jumps - 1;
-			m_Core.m_Jumped = 1;
-		}
-	}
-
-	// jetpack gun
-	if(((m_TileIndex == TILE_JETPACK_START) || (m_TileFIndex == TILE_JETPACK_START)) && !m_Jetpack)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You have a jetpack gun");
-		m_Jetpack = true;
-	}
-	else if(((m_TileIndex == TILE_JETPACK_END) || (m_TileFIndex == TILE_JETPACK_END)) && m_Jetpack)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You lost your jetpack gun");
-		m_Jetpack = false;
-	}
-
-	// unlock team
-	else if((m_TileIndex == TILE_UNLOCK_TEAM) || (m_TileFIndex == TILE_UNLOCK_TEAM))
-	{
-		Teams()->SetTeamLock(Team(), false);
-	}
-
-	// solo part
-	if(((m_TileIndex == TILE_SOLO_START) || (m_TileFIndex == TILE_SOLO_START)) && !Teams()->m_Core.GetSolo(m_pPlayer->GetCID()))
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You are now in a solo part.");
-		SetSolo(true);
-	}
-	else if(((m_TileIndex == TILE_SOLO_END) || (m_TileFIndex == TILE_SOLO_END)) && Teams()->m_Core.GetSolo(m_pPlayer->GetCID()))
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(), "You are now out of the solo part.");
-		SetSolo(false);
-	}
+	// freeze, endless hook, solo, ...
+	int Handlers = TileHandlers(m_TileIndex) | TileHandlers(m_TileFIndex);
+	for(int h = 0; h < TILEHANDLER_WARIOWARE; h++)
+		if(Handlers&(1<<h))
+			(this->*ms_aTileHandlers[h].m_pfnHandler)();
 
-	// refill jumps
-	if(((m_TileIndex == TILE_REFILL_JUMPS) || (m_TileFIndex == TILE_REFILL_JUMPS)) && !m_LastRefillJumps)
-	{
-		m_Core.m_JumpedTotal = 0;
-		m_Core.m_Jumped = 0;
-		m_LastRefillJumps = true;
-	}
-	if((m_TileIndex != TILE_REFILL_JUMPS) && (m_TileFIndex != TILE_REFILL_JUMPS))
+	if(!(Handlers&(1<<TILEHANDLER_REFILLJUMPS)))
 	{
 		m_LastRefillJumps = false;
 	}
@@ -1716,108 +1827,111 @@ void CCharacter::HandleTiles(int Index)
 		m_Core.m_JumpedTotal = 0;
 	}
 
-	if(((m_TileIndex == TILE_WARIOWARE_WIN) || (m_TileFIndex == TILE_WARIOWARE_WIN)))
-	{
-		int tile = (m_TileIndex == TILE_WARIOWARE_WIN) ? m_TileIndex : m_TileFIndex;
-		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
-			Controller->winMicroGame(m_pPlayer->GetCID());
-	}
-	else if(((m_TileIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN) || (m_TileFIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN)))
-	{
-		int tile = (m_TileIndex == TILE_WARIOWARE_REACHEND_NADE1_WIN) ? m_TileIndex : m_TileFIndex;
-		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
-			Controller->winMicroGame(m_pPlayer->GetCID());
-	}
-	else if(((m_TileIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN) || (m_TileFIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN)))
-	{
-		int tile = (m_TileIndex == TILE_WARIOWARE_REACHEND_NADE2_WIN) ? m_TileIndex : m_TileFIndex;
-		if (Controller->isInGame() and Controller->inMicroGame() and Controller->getMicroGame()->OnWinMicrogame(m_pPlayer->GetCID(), tile))
-			Controller->winMicroGame(m_pPlayer->GetCID());
-	}
+	if(Handlers&(1<<TILEHANDLER_WARIOWARE))
+		HandleWarioWareTiles();
 
 	// handle switch tiles
-	if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHOPEN && Team() != TEAM_SUPER)
-	{
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()] = true;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = 0;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHOPEN;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHTIMEDOPEN && Team() != TEAM_SUPER)
-	{
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()] = true;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex)*Server()->TickSpeed() ;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHTIMEDOPEN;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHTIMEDCLOSE && Team() != TEAM_SUPER)
-	{
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()] = false;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex)*Server()->TickSpeed();
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHTIMEDCLOSE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHCLOSE && Team() != TEAM_SUPER)
-	{
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()] = false;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = 0;
-		GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHCLOSE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_FREEZE && Team() != TEAM_SUPER)
-	{
-		if(GameServer()->Collision()->GetSwitchNumber(MapIndex) == 0 || GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()])
-			Freeze(GameServer()->Collision()->GetSwitchDelay(MapIndex));
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_DFREEZE && Team() != TEAM_SUPER && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()])
-	{
-		m_DeepFreeze = true;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_DUNFREEZE && Team() != TEAM_SUPER && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Status[Team()])
-	{
-		m_DeepFreeze = false;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_START && m_Hit&DISABLE_HIT_HAMMER && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_HAMMER)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can hammer hit others");
-		m_Hit &= ~DISABLE_HIT_HAMMER;
-		m_NeededFaketuning &= ~FAKETUNE_NOHAMMER;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_END && !(m_Hit&DISABLE_HIT_HAMMER) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_HAMMER)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't hammer hit others");
-		m_Hit |= DISABLE_HIT_HAMMER;
-		m_NeededFaketuning |= FAKETUNE_NOHAMMER;
-		GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_START && m_Hit&DISABLE_HIT_SHOTGUN && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_SHOTGUN)
+	int SwitchType = (Mask&CCollision::TILEMASK_SWITCH) ? GameServer()->Collision()->IsSwitch(MapIndex) : 0;
+	switch(SwitchType)
 	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with shotgun");
-		m_Hit &= ~DISABLE_HIT_SHOTGUN;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_END && !(m_Hit&DISABLE_HIT_SHOTGUN) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_SHOTGUN)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with shotgun");
-		m_Hit |= DISABLE_HIT_SHOTGUN;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_START && m_Hit&DISABLE_HIT_GRENADE && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_GRENADE)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with grenade");
-		m_Hit &= ~DISABLE_HIT_GRENADE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_END && !(m_Hit&DISABLE_HIT_GRENADE) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_GRENADE)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with grenade");
-		m_Hit |= DISABLE_HIT_GRENADE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_START && m_Hit&DISABLE_HIT_RIFLE && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_RIFLE)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with rifle");
-		m_Hit &= ~DISABLE_HIT_RIFLE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_HIT_END && !(m_Hit&DISABLE_HIT_RIFLE) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_RIFLE)
-	{
-		GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with rifle");
-		m_Hit |= DISABLE_HIT_RIFLE;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_JUMP)
+	case TILE_SWITCHOPEN:
+		if(Team() != TEAM_SUPER)
+		{
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].SetStatus(Team(), true);
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = 0;
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHOPEN;
+		}
+		break;
+	case TILE_SWITCHTIMEDOPEN:
+		if(Team() != TEAM_SUPER)
+		{
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].SetStatus(Team(), true);
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex)*Server()->TickSpeed() ;
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHTIMEDOPEN;
+			GameServer()->Collision()->ScheduleSwitch(GameServer()->Collision()->GetSwitchNumber(MapIndex), Team());
+		}
+		break;
+	case TILE_SWITCHTIMEDCLOSE:
+		if(Team() != TEAM_SUPER)
+		{
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].SetStatus(Team(), false);
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex)*Server()->TickSpeed();
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHTIMEDCLOSE;
+			GameServer()->Collision()->ScheduleSwitch(GameServer()->Collision()->GetSwitchNumber(MapIndex), Team());
+		}
+		break;
+	case TILE_SWITCHCLOSE:
+		if(Team() != TEAM_SUPER)
+		{
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].SetStatus(Team(), false);
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_EndTick[Team()] = 0;
+			GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].m_Type[Team()] = TILE_SWITCHCLOSE;
+		}
+		break;
+	case TILE_FREEZE:
+		if(Team() != TEAM_SUPER)
+		{
+			if(GameServer()->Collision()->GetSwitchNumber(MapIndex) == 0 || GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].Status(Team()))
+				Freeze(GameServer()->Collision()->GetSwitchDelay(MapIndex));
+		}
+		break;
+	case TILE_DFREEZE:
+		if(Team() != TEAM_SUPER && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].Status(Team()))
+			m_DeepFreeze = true;
+		break;
+	case TILE_DUNFREEZE:
+		if(Team() != TEAM_SUPER && GameServer()->Collision()->m_pSwitchers[GameServer()->Collision()->GetSwitchNumber(MapIndex)].Status(Team()))
+			m_DeepFreeze = false;
+		break;
+	case TILE_HIT_START:
+		if(m_Hit&DISABLE_HIT_HAMMER && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_HAMMER)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can hammer hit others");
+			m_Hit &= ~DISABLE_HIT_HAMMER;
+			m_NeededFaketuning &= ~FAKETUNE_NOHAMMER;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+		}
+		else if(m_Hit&DISABLE_HIT_SHOTGUN && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_SHOTGUN)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with shotgun");
+			m_Hit &= ~DISABLE_HIT_SHOTGUN;
+		}
+		else if(m_Hit&DISABLE_HIT_GRENADE && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_GRENADE)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with grenade");
+			m_Hit &= ~DISABLE_HIT_GRENADE;
+		}
+		else if(m_Hit&DISABLE_HIT_RIFLE && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_RIFLE)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can shoot others with rifle");
+			m_Hit &= ~DISABLE_HIT_RIFLE;
+		}
+		break;
+	case TILE_HIT_END:
+		if(!(m_Hit&DISABLE_HIT_HAMMER) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_HAMMER)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't hammer hit others");
+			m_Hit |= DISABLE_HIT_HAMMER;
+			m_NeededFaketuning |= FAKETUNE_NOHAMMER;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone); // update tunings
+		}
+		else if(!(m_Hit&DISABLE_HIT_SHOTGUN) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_SHOTGUN)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with shotgun");
+			m_Hit |= DISABLE_HIT_SHOTGUN;
+		}
+		else if(!(m_Hit&DISABLE_HIT_GRENADE) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_GRENADE)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with grenade");
+			m_Hit |= DISABLE_HIT_GRENADE;
+		}
+		else if(!(m_Hit&DISABLE_HIT_RIFLE) && GameServer()->Collision()->GetSwitchDelay(MapIndex) == WEAPON_RIFLE)
+		{
+			GameServer()->SendChatTarget(GetPlayer()->GetCID(),"You can't shoot others with rifle");
+			m_Hit |= DISABLE_HIT_RIFLE;
+		}
+		break;
+	case TILE_JUMP:
 	{
 		int newJumps = GameServer()->Collision()->GetSwitchDelay(MapIndex);
 
@@ -1843,75 +1957,84 @@ void CCharacter::HandleTiles(int Index)
 
 			m_Core.m_Jumps = newJumps;
 		}
+		break;
 	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_PENALTY && !m_LastPenalty)
-	{
-		int min = GameServer()->Collision()->GetSwitchDelay(MapIndex);
-		int sec = GameServer()->Collision()->GetSwitchNumber(MapIndex);
-		int Team = Teams()->m_Core.Team(m_Core.m_Id);
+	case TILE_PENALTY:
+		if(!m_LastPenalty)
+		{
+			int min = GameServer()->Collision()->GetSwitchDelay(MapIndex);
+			int sec = GameServer()->Collision()->GetSwitchNumber(MapIndex);
+			int Team = Teams()->m_Core.Team(m_Core.m_Id);
 
-		m_StartTime -= (min * 60 + sec) * Server()->TickSpeed();
+			m_StartTime -= (min * 60 + sec) * Server()->TickSpeed();
 
-		if (Team != TEAM_FLOCK && Team != TEAM_SUPER)
-		{
-			for (int i = 0; i < MAX_CLIENTS; i++)
+			if (Team != TEAM_FLOCK && Team != TEAM_SUPER)
 			{
-				if(Teams()->m_Core.Team(i) == Team && i != m_Core.m_Id && GameServer()->m_apPlayers[i])
+				for (int i = 0; i < MAX_CLIENTS; i++)
 				{
-					CCharacter* pChar = GameServer()->m_apPlayers[i]->GetCharacter();
+					if(Teams()->m_Core.Team(i) == Team && i != m_Core.m_Id && GameServer()->m_apPlayers[i])
+					{
+						CCharacter* pChar = GameServer()->m_apPlayers[i]->GetCharacter();
 
-					if (pChar)
-						pChar->m_StartTime = m_StartTime;
+						if (pChar)
+							pChar->m_StartTime = m_StartTime;
+					}
 				}
 			}
-		}
 
-		m_LastPenalty = true;
-	}
-	else if(GameServer()->Collision()->IsSwitch(MapIndex) == TILE_BONUS && !m_LastBonus)
-	{
-		int min = GameServer()->Collision()->GetSwitchDelay(MapIndex);
-		int sec = GameServer()->Collision()->GetSwitchNumber(MapIndex);
-		int Team = Teams()->m_Core.Team(m_Core.m_Id);
+			m_LastPenalty = true;
+		}
+		break;
+	case TILE_BONUS:
+		if(!m_LastBonus)
+		{
+			int min = GameServer()->Collision()->GetSwitchDelay(MapIndex);
+			int sec = GameServer()->Collision()->GetSwitchNumber(MapIndex);
+			int Team = Teams()->m_Core.Team(m_Core.m_Id);
 
-		m_StartTime += (min * 60 + sec) * Server()->TickSpeed();
-		if (m_StartTime > Server()->Tick())
-			m_StartTime = Server()->Tick();
+			m_StartTime += (min * 60 + sec) * Server()->TickSpeed();
+			if (m_StartTime > Server()->Tick())
+				m_StartTime = Server()->Tick();
 
-		if (Team != TEAM_FLOCK && Team != TEAM_SUPER)
-		{
-			for (int i = 0; i < MAX_CLIENTS; i++)
+			if (Team != TEAM_FLOCK && Team != TEAM_SUPER)
 			{
-				if(Teams()->m_Core.Team(i) == Team && i != m_Core.m_Id && GameServer()->m_apPlayers[i])
+				for (int i = 0; i < MAX_CLIENTS; i++)
 				{
-					CCharacter* pChar = GameServer()->m_apPlayers[i]->GetCharacter();
+					if(Teams()->m_Core.Team(i) == Team && i != m_Core.m_Id && GameServer()->m_apPlayers[i])
+					{
+						CCharacter* pChar = GameServer()->m_apPlayers[i]->GetCharacter();
 
-					if (pChar)
-						pChar->m_StartTime = m_StartTime;
+						if (pChar)
+							pChar->m_StartTime = m_StartTime;
+					}
 				}
 			}
-		}
 
-		m_LastBonus = true;
+			m_LastBonus = true;
+		}
+		break;
 	}
 
-	if(GameServer()->Collision()->IsSwitch(MapIndex) != TILE_PENALTY)
+	if(SwitchType != TILE_PENALTY)
 	{
 		m_LastPenalty = false;
 	}
 
-	if(GameServer()->Collision()->IsSwitch(MapIndex) != TILE_BONUS)
+	if(SwitchType != TILE_BONUS)
 	{
 		m_LastBonus = false;
 	}
 
+	if(!(Mask&CCollision::TILEMASK_TELE))
+		return;
+
 	int z = GameServer()->Collision()->IsTeleport(MapIndex);
-	if(!g_Config.m_SvOldTeleportHook && !g_Config.m_SvOldTeleportWeapons && z && Controller->m_TeleOuts[z-1].size())
+	if(!g_Config.m_SvOldTeleportHook && !g_Config.m_SvOldTeleportWeapons && z && Controller->m_MapIndex.NumTeleOuts(z))
 	{
 		if (m_Super)
 			return;
-		int Num = Controller->m_TeleOuts[z-1].size();
-		m_Core.m_Pos = Controller->m_TeleOuts[z-1][(!Num)?Num:rand() % Num];
+		int Num = Controller->m_MapIndex.NumTeleOuts(z);
+		m_Core.m_Pos = Controller->m_MapIndex.TeleOuts(z)[rand() % Num];
 		if(!g_Config.m_SvTeleportHoldHook)
 		{
 			m_Core.m_HookedPlayer = -1;
@@ -1927,12 +2050,12 @@ void CCharacter::HandleTiles(int Index)
 		return;
 	}
 	int evilz = GameServer()->Collision()->IsEvilTeleport(MapIndex);
-	if(evilz && Controller->m_TeleOuts[evilz-1].size())
+	if(evilz && Controller->m_MapIndex.NumTeleOuts(evilz))
 	{
 		if (m_Super)
 			return;
-		int Num = Controller->m_TeleOuts[evilz-1].size();
-		m_Core.m_Pos = Controller->m_TeleOuts[evilz-1][(!Num)?Num:rand() % Num];
+		int Num = Controller->m_MapIndex.NumTeleOuts(evilz);
+		m_Core.m_Pos = Controller->m_MapIndex.TeleOuts(evilz)[rand() % Num];
 		if (!g_Config.m_SvOldTeleportHook && !g_Config.m_SvOldTeleportWeapons)
 		{
 			m_Core.m_Vel = vec2(0,0);
@@ -1960,13 +2083,13 @@ void CCharacter::HandleTiles(int Index)
 		// first check if there is a TeleCheckOut for the current recorded checkpoint, if not check previous checkpoints
 		for(int k=m_TeleCheckpoint-1; k >= 0; k--)
 		{
-			if(Controller->m_TeleCheckOuts[k].size())
+			if(Controller->m_MapIndex.NumTeleCheckOuts(k+1))
 			{
 				m_Core.m_HookedPlayer = -1;
 				m_Core.m_HookState = HOOK_RETRACTED;
 				m_Core.m_TriggeredEvents |= COREEVENT_HOOK_RETRACT;
-				int Num = Controller->m_TeleCheckOuts[k].size();
-				m_Core.m_Pos = Controller->m_TeleCheckOuts[k][(!Num)?Num:rand() % Num];
+				int Num = Controller->m_MapIndex.NumTeleCheckOuts(k+1);
+				m_Core.m_Pos = Controller->m_MapIndex.TeleCheckOuts(k+1)[rand() % Num];
 				GameWorld()->ReleaseHooked(GetPlayer()->GetCID());
 				m_Core.m_Vel = vec2(0,0);
 				m_Core.m_HookPos = m_Core.m_Pos;
@@ -1994,13 +2117,13 @@ void CCharacter::HandleTiles(int Index)
 		// first check if there is a TeleCheckOut for the current recorded checkpoint, if not check previous checkpoints
 		for(int k=m_TeleCheckpoint-1; k >= 0; k--)
 		{
-			if(Controller->m_TeleCheckOuts[k].size())
+			if(Controller->m_MapIndex.NumTeleCheckOuts(k+1))
 			{
 				m_Core.m_HookedPlayer = -1;
 				m_Core.m_HookState = HOOK_RETRACTED;
 				m_Core.m_TriggeredEvents |= COREEVENT_HOOK_RETRACT;
-				int Num = Controller->m_TeleCheckOuts[k].size();
-				m_Core.m_Pos = Controller->m_TeleCheckOuts[k][(!Num)?Num:rand() % Num];
+				int Num = Controller->m_MapIndex.NumTeleCheckOuts(k+1);
+				m_Core.m_Pos = Controller->m_MapIndex.TeleCheckOuts(k+1)[rand() % Num];
 				m_Core.m_HookPos = m_Core.m_Pos;
 				return;
 			}
@@ -2019,6 +2142,7 @@ void CCharacter::HandleTiles(int Index)
 	}
 }
 
+
 void CCharacter::HandleTuneLayer()
 {
 
@@ -2144,8 +2268,8 @@ void CCharacter::DDRaceTick()
 	}*/
 	
 	
-	if (GameServer()->Collision()->GetQuadAt("trainQuad", m_Core.m_Pos.x, m_Core.m_Pos.y) or
-		GameServer()->Collision()->GetQuadAt("acidQuad", m_Core.m_Pos.x, m_Core.m_Pos.y))
+	if (GameServer()->Collision()->InsideQuadSet(GameServer()->m_TrainQuadSet, m_Core.m_Pos) or
+		GameServer()->Collision()->InsideQuadSet(GameServer()->m_AcidQuadSet, m_Core.m_Pos))
 	{
 		CGameControllerWarioWare* controller = ((CGameControllerWarioWare*)GameServer()->m_pController);
 		float timeLeft = (controller->getTimeLength() - controller->getTimer()) / 1000.f;
@@ -159,6 +159,47 @@ private:
 
 
 	void HandleTiles(int Index);
+	void ClearTileIndices();
+
+	// game and front layer tiles acting on the character, looked up by tile
+	// index in HandleTiles and run in this order
+	enum
+	{
+		TILEHANDLER_FREEZE=0,
+		TILEHANDLER_DEEPFREEZE,
+		TILEHANDLER_ENDLESSHOOK,
+		TILEHANDLER_HIT,
+		TILEHANDLER_COLLIDE,
+		TILEHANDLER_HOOK,
+		TILEHANDLER_SUPERJUMP,
+		TILEHANDLER_WALLJUMP,
+		TILEHANDLER_JETPACK,
+		TILEHANDLER_SOLO,
+		TILEHANDLER_REFILLJUMPS,
+		TILEHANDLER_WARIOWARE, // after the stoppers
+		NUM_TILEHANDLERS
+	};
+	typedef void (CCharacter::*FTileHandler)();
+	struct CTileHandler
+	{
+		FTileHandler m_pfnHandler;
+		int m_aTiles[3];
+	};
+	static const CTileHandler ms_aTileHandlers[NUM_TILEHANDLERS];
+	static int TileHandlers(int Tile);
+	void HandleFreezeTiles();
+	void HandleDeepFreezeTiles();
+	void HandleEndlessHookTiles();
+	void HandleHitTiles();
+	void HandleCollideTiles();
+	void HandleHookTiles();
+	void HandleSuperJumpTiles();
+	void HandleWallJumpTiles();
+	void HandleJetpackTiles();
+	void HandleSoloTiles();
+	void HandleRefillJumpsTiles();
+	void HandleWarioWareTiles();
+
 	float m_Time;
 	int m_LastBroadcast;
 	void DDRaceInit();
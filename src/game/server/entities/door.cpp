@@ -64,6 +64,13 @@ void CDoor::Tick()
 
 }
 
+bool CDoor::GetSnapBounds(vec2 *pMin, vec2 *pMax)
+{
+	*pMin = vec2(min(m_Pos.x, m_To.x), min(m_Pos.y, m_To.y));
+	*pMax = vec2(max(m_Pos.x, m_To.x), max(m_Pos.y, m_To.y));
+	return true;
+}
+
 void CDoor::Snap(int SnappingClient)
 {
 	if (NetworkClipped(SnappingClient, m_Pos)
@@ -91,7 +98,7 @@ void CDoor::Snap(int SnappingClient)
 		return;
 
 	if (Char->IsAlive() && GameServer()->Collision()->m_NumSwitchers > 0
-			&& !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()]
+			&& !GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team())
 			&& (!Tick))
 		return;
 
@@ -101,7 +108,7 @@ void CDoor::Snap(int SnappingClient)
 		pObj->m_FromY = (int) m_Pos.y;
 	}
 	else if (Char->IsAlive() && GameServer()->Collision()->m_NumSwitchers > 0
-		&& GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()])
+		&& GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team()))
 	{
 		pObj->m_FromX = (int) m_To.x;
 		pObj->m_FromY = (int) m_To.y;
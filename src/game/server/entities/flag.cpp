@@ -31,6 +31,12 @@ void CFlag::TickPaused()
 		++m_GrabTick;
 }
 
+bool CFlag::GetSnapBounds(vec2 *pMin, vec2 *pMax)
+{
+	*pMin = *pMax = m_Pos;
+	return true;
+}
+
 void CFlag::Snap(int SnappingClient)
 {
 	if(NetworkClipped(SnappingClient))
@@ -25,6 +25,7 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool GetSnapBounds(vec2 *pMin, vec2 *pMax);
 };
 
 
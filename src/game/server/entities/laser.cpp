@@ -8,6 +8,8 @@
 #include <engine/shared/config.h>
 #include <game/server/teams.h>
 
+MACRO_ALLOC_SLAB_IMPL(CLaser, 64)
+
 CLaser::CLaser(CGameWorld *pGameWorld, vec2 Pos, vec2 Direction, float StartEnergy, int Owner, int Type)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER)
 {
@@ -156,10 +158,10 @@ void CLaser::DoBounce()
 			else
 				m_Energy -= distance(m_From, m_Pos) + GameServer()->TuningList()[m_TuneZone].m_LaserBounceCost;
 
-			if (Res&CCollision::COLFLAG_TELE && ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1].size())
+			if (Res&CCollision::COLFLAG_TELE && ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.NumTeleOuts(z))
 			{
-				int Num = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1].size();
-				m_TelePos = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1][(!Num)?Num:rand() % Num];
+				int Num = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.NumTeleOuts(z);
+				m_TelePos = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.TeleOuts(z)[rand() % Num];
 				m_WasTele = true;
 			}
 			else
@@ -212,6 +214,12 @@ void CLaser::TickPaused()
 	++m_EvalTick;
 }
 
+bool CLaser::GetSnapBounds(vec2 *pMin, vec2 *pMax)
+{
+	*pMin = *pMax = m_Pos;
+	return true;
+}
+
 void CLaser::Snap(int SnappingClient)
 {
 	if(NetworkClipped(SnappingClient))
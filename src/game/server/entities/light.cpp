@@ -32,7 +32,7 @@ bool CLight::HitCharacter()
 	{
 		CCharacter * Char = *i;
 		if (m_Layer == LAYER_SWITCH
-				&& !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()])
+				&& !GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team()))
 			continue;
 		Char->Freeze();
 	}
@@ -102,6 +102,13 @@ void CLight::Tick()
 
 }
 
+bool CLight::GetSnapBounds(vec2 *pMin, vec2 *pMax)
+{
+	*pMin = vec2(min(m_Pos.x, m_To.x), min(m_Pos.y, m_To.y));
+	*pMax = vec2(max(m_Pos.x, m_To.x), max(m_Pos.y, m_To.y));
+	return true;
+}
+
 void CLight::Snap(int SnappingClient)
 {
 	if (NetworkClipped(SnappingClient, m_Pos)
@@ -119,7 +126,7 @@ void CLight::Snap(int SnappingClient)
 
 	if (Char && Char->IsAlive()
 			&& m_Layer == LAYER_SWITCH
-			&& !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()]
+			&& !GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team())
 			&& (Tick))
 		return;
 
@@ -138,7 +145,7 @@ void CLight::Snap(int SnappingClient)
 		pObj->m_FromY = (int) m_Pos.y;
 	}
 	else if (Char && m_Layer == LAYER_SWITCH
-			&& GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()])
+			&& GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team()))
 	{
 		pObj->m_FromX = (int) m_To.x;
 		pObj->m_FromY = (int) m_To.y;
@@ -53,7 +53,7 @@ void CPickup::Tick()
 		CCharacter * pChr = apEnts[i];
 		if(pChr && pChr->IsAlive())
 		{
-			if(m_Layer == LAYER_SWITCH && !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[pChr->Team()]) continue;
+			if(m_Layer == LAYER_SWITCH && !GameServer()->Collision()->m_pSwitchers[m_Number].Status(pChr->Team())) continue;
 			bool sound = false;
 			// player picked us up, is someone was hooking us, let them go
 			switch (m_Type)
@@ -161,7 +161,7 @@ void CPickup::Snap(int SnappingClient)
 	int Tick = (Server()->Tick()%Server()->TickSpeed())%11;
 	if (Char && Char->IsAlive() &&
 			(m_Layer == LAYER_SWITCH &&
-					!GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[Char->Team()])
+					!GameServer()->Collision()->m_pSwitchers[m_Number].Status(Char->Team()))
 					&& (!Tick))
 		return;
 
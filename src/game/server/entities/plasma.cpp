@@ -82,6 +82,12 @@ void CPlasma::Tick()
 
 }
 
+bool CPlasma::GetSnapBounds(vec2 *pMin, vec2 *pMax)
+{
+	*pMin = *pMax = m_Pos;
+	return true;
+}
+
 void CPlasma::Snap(int SnappingClient)
 {
 	if (NetworkClipped(SnappingClient))
@@ -92,7 +98,7 @@ void CPlasma::Snap(int SnappingClient)
 
 	if (SnapChar && SnapChar->IsAlive()
 			&& (m_Layer == LAYER_SWITCH
-					&& !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[SnapChar->Team()])
+					&& !GameServer()->Collision()->m_pSwitchers[m_Number].Status(SnapChar->Team()))
 			&& (!Tick))
 		return;
 
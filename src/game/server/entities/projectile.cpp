@@ -9,6 +9,44 @@
 #include <engine/shared/config.h>
 #include <game/server/teams.h>
 
+#include <vector>
+
+MACRO_ALLOC_SLAB_IMPL(CProjectile, 64)
+
+// structure of arrays for the batched ballistic evaluation
+static struct CProjectileBatch
+{
+	std::vector<float> m_aPosX, m_aPosY;
+	std::vector<float> m_aDirX, m_aDirY;
+	std::vector<float> m_aCurvature, m_aSpeed;
+	std::vector<float> m_aPrevTime, m_aCurTime;
+	std::vector<float> m_aPrevX, m_aPrevY;
+	std::vector<float> m_aCurX, m_aCurY;
+
+	void Resize(int Num)
+	{
+		m_aPosX.resize(Num); m_aPosY.resize(Num);
+		m_aDirX.resize(Num); m_aDirY.resize(Num);
+		m_aCurvature.resize(Num); m_aSpeed.resize(Num);
+		m_aPrevTime.resize(Num); m_aCurTime.resize(Num);
+		m_aPrevX.resize(Num); m_aPrevY.resize(Num);
+		m_aCurX.resize(Num); m_aCurY.resize(Num);
+	}
+} s_ProjectileBatch;
+
+// same arithmetic as CalcPos, kept branch free so the compiler can vectorize it
+static void CalcPosBatch(int Num, const float *__restrict pPosX, const float *__restrict pPosY,
+	const float *__restrict pDirX, const float *__restrict pDirY, const float *__restrict pCurvature,
+	const float *__restrict pSpeed, const float *__restrict pTime, float *__restrict pOutX, float *__restrict pOutY)
+{
+	for(int i = 0; i < Num; i++)
+	{
+		float Time = pTime[i] * pSpeed[i];
+		pOutX[i] = pPosX[i] + pDirX[i]*Time;
+		pOutY[i] = pPosY[i] + pDirY[i]*Time + pCurvature[i]/10000*(Time*Time);
+	}
+}
+
 CProjectile::CProjectile
 	(
 		CGameWorld *pGameWorld,
@@ -53,6 +91,9 @@ CProjectile::CProjectile
 	m_FootBounceLoss = 50;
 	m_FillExtraInfo = true;
 
+	m_BatchTick = -1;
+	m_SnapPosTick = -1;
+
 	GameWorld()->InsertEntity(this);
 }
 
@@ -62,7 +103,7 @@ void CProjectile::Reset()
 		GameServer()->m_World.DestroyEntity(this);
 }
 
-vec2 CProjectile::GetPos(float Time)
+void CProjectile::GetTuning(float *pCurvature, float *pSpeed)
 {
 	float Curvature = 0;
 	float Speed = 0;
@@ -111,9 +152,68 @@ vec2 CProjectile::GetPos(float Time)
 			break;
 	}
 
+	*pCurvature = Curvature;
+	*pSpeed = Speed;
+}
+
+vec2 CProjectile::GetPos(float Time)
+{
+	float Curvature, Speed;
+	GetTuning(&Curvature, &Speed);
 	return CalcPos(m_Pos, m_Direction, Curvature, Speed, Time);
 }
 
+void CProjectile::TickBatch(CGameWorld *pGameWorld)
+{
+	CProjectileBatch &Batch = s_ProjectileBatch;
+	int Num = 0;
+	for(CEntity *pEnt = pGameWorld->FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pEnt; pEnt = pEnt->TypeNext())
+		Num++;
+	if(!Num)
+		return;
+	Batch.Resize(Num);
+
+	// gather
+	int Tick = pGameWorld->Server()->Tick();
+	int TickSpeed = pGameWorld->Server()->TickSpeed();
+	int i = 0;
+	for(CEntity *pEnt = pGameWorld->FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pEnt; pEnt = pEnt->TypeNext(), i++)
+	{
+		CProjectile *pProj = (CProjectile *)pEnt;
+		Batch.m_aPosX[i] = pProj->m_Pos.x;
+		Batch.m_aPosY[i] = pProj->m_Pos.y;
+		Batch.m_aDirX[i] = pProj->m_Direction.x;
+		Batch.m_aDirY[i] = pProj->m_Direction.y;
+		pProj->GetTuning(&Batch.m_aCurvature[i], &Batch.m_aSpeed[i]);
+		Batch.m_aPrevTime[i] = (Tick-pProj->m_StartTick-1)/(float)TickSpeed;
+		Batch.m_aCurTime[i] = (Tick-pProj->m_StartTick)/(float)TickSpeed;
+
+		pProj->m_BatchTick = Tick;
+		pProj->m_BatchIndex = i;
+		pProj->m_BatchStartTick = pProj->m_StartTick;
+	}
+
+	CalcPosBatch(Num, &Batch.m_aPosX[0], &Batch.m_aPosY[0], &Batch.m_aDirX[0], &Batch.m_aDirY[0],
+		&Batch.m_aCurvature[0], &Batch.m_aSpeed[0], &Batch.m_aPrevTime[0], &Batch.m_aPrevX[0], &Batch.m_aPrevY[0]);
+	CalcPosBatch(Num, &Batch.m_aPosX[0], &Batch.m_aPosY[0], &Batch.m_aDirX[0], &Batch.m_aDirY[0],
+		&Batch.m_aCurvature[0], &Batch.m_aSpeed[0], &Batch.m_aCurTime[0], &Batch.m_aCurX[0], &Batch.m_aCurY[0]);
+}
+
+void CProjectile::GetTickPos(vec2 *pPrevPos, vec2 *pCurPos)
+{
+	// only the projectile itself moves its trajectory, so the batch result
+	// stays valid unless it was spawned or bounced after the batch ran
+	if(m_BatchTick == Server()->Tick() && m_BatchStartTick == m_StartTick)
+	{
+		const CProjectileBatch &Batch = s_ProjectileBatch;
+		*pPrevPos = vec2(Batch.m_aPrevX[m_BatchIndex], Batch.m_aPrevY[m_BatchIndex]);
+		*pCurPos = vec2(Batch.m_aCurX[m_BatchIndex], Batch.m_aCurY[m_BatchIndex]);
+		return;
+	}
+
+	*pPrevPos = GetPos((Server()->Tick()-m_StartTick-1)/(float)Server()->TickSpeed());
+	*pCurPos = GetPos((Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed());
+}
 
 void CProjectile::Tick()
 {
@@ -121,13 +221,12 @@ void CProjectile::Tick()
 
 	if (m_FootMode && m_Type == WEAPON_GRENADE) // taken from teefoot mod
 	{
-		float PreviousTick = (Server()->Tick()-m_StartTick-1)/(float)Server()->TickSpeed();
 		float CurrentTick = (Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed();
 		float NextTick = (Server()->Tick()-m_StartTick+1)/(float)Server()->TickSpeed();
 		float TimeAlive = (Server()->Tick()-m_CreationTick)/(float)Server()->TickSpeed();
 
-		vec2 CurPosition = GetPos(CurrentTick);
-		vec2 PrevPosition = GetPos(PreviousTick);
+		vec2 CurPosition, PrevPosition;
+		GetTickPos(&PrevPosition, &CurPosition);
 		vec2 CollisionPosition(0,0);
 		vec2 FreePosition(0,0);
 
@@ -271,10 +370,8 @@ void CProjectile::Tick()
 		return;
 	}
 
-	float Pt = (Server()->Tick()-m_StartTick-1)/(float)Server()->TickSpeed();
-	float Ct = (Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed();
-	vec2 PrevPos = GetPos(Pt);
-	vec2 CurPos = GetPos(Ct);
+	vec2 PrevPos, CurPos;
+	GetTickPos(&PrevPos, &CurPos);
 	vec2 ColPos;
 	vec2 NewPos;
 	int Collide = GameServer()->Collision()->IntersectLine(PrevPos, CurPos, &ColPos, &NewPos, false);
@@ -337,7 +434,7 @@ void CProjectile::Tick()
 					(m_Owner != -1)? TeamMask : -1LL);
 			}
 		}
-		else if(pTargetChr && m_Freeze && ((m_Layer == LAYER_SWITCH && GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[pTargetChr->Team()]) || m_Layer != LAYER_SWITCH))
+		else if(pTargetChr && m_Freeze && ((m_Layer == LAYER_SWITCH && GameServer()->Collision()->m_pSwitchers[m_Number].Status(pTargetChr->Team())) || m_Layer != LAYER_SWITCH))
 		{
 			pTargetChr->Freeze();
 		}
@@ -393,10 +490,10 @@ void CProjectile::Tick()
 		z = GameServer()->Collision()->IsTeleport(x);
 	else
 		z = GameServer()->Collision()->IsTeleportWeapon(x);
-	if (z && ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1].size())
+	if (z && ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.NumTeleOuts(z))
 	{
-		int Num = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1].size();
-		m_Pos = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_TeleOuts[z-1][(!Num)?Num:rand() % Num];
+		int Num = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.NumTeleOuts(z);
+		m_Pos = ((CGameControllerWarioWare*)GameServer()->m_pController)->m_MapIndex.TeleOuts(z)[rand() % Num];
 		m_StartTick = Server()->Tick();
 	}
 }
@@ -416,16 +513,32 @@ void CProjectile::FillInfo(CNetObj_Projectile *pProj)
 	pProj->m_Type = m_Type;
 }
 
-void CProjectile::Snap(int SnappingClient)
+vec2 CProjectile::GetSnapPos()
+{
+	// the trajectory doesn't change between the snaps of one tick
+	if(m_SnapPosTick != Server()->Tick())
+	{
+		float Ct = (Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed();
+		m_SnapPos = GetPos(Ct);
+		m_SnapPosTick = Server()->Tick();
+	}
+	return m_SnapPos;
+}
+
+bool CProjectile::GetSnapBounds(vec2 *pMin, vec2 *pMax)
 {
-	float Ct = (Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed();
+	*pMin = *pMax = GetSnapPos();
+	return true;
+}
 
-	if(NetworkClipped(SnappingClient, GetPos(Ct)))
+void CProjectile::Snap(int SnappingClient)
+{
+	if(NetworkClipped(SnappingClient, GetSnapPos()))
 		return;
 
 	CCharacter* pSnapChar = GameServer()->GetPlayerChar(SnappingClient);
 	int Tick = (Server()->Tick()%Server()->TickSpeed())%((m_Explosive)?6:20);
-	if (pSnapChar && pSnapChar->IsAlive() && (m_Layer == LAYER_SWITCH && !GameServer()->Collision()->m_pSwitchers[m_Number].m_Status[pSnapChar->Team()] && (!Tick)))
+	if (pSnapChar && pSnapChar->IsAlive() && (m_Layer == LAYER_SWITCH && !GameServer()->Collision()->m_pSwitchers[m_Number].Status(pSnapChar->Team()) && (!Tick)))
 		return;
 
 	CCharacter *pOwnerChar = 0;
@@ -5,6 +5,8 @@
 
 class CProjectile : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 public:
 	CProjectile
 	(
@@ -26,15 +28,24 @@ public:
 	vec2 GetPos(float Time);
 	void FillInfo(CNetObj_Projectile *pProj);
 
+	// evaluates the prev/current positions of all projectiles in one pass,
+	// called by the world right before the projectiles tick
+	static void TickBatch(CGameWorld *pGameWorld);
+
 	virtual void Reset();
 	virtual void Tick();
 	virtual void TickPaused();
 	virtual void Snap(int SnappingClient);
+	virtual bool GetSnapBounds(vec2 *pMin, vec2 *pMax);
 
 	unsigned short m_CollisionsByX;
 	unsigned short m_CollisionByY;
 
 private:
+	void GetTuning(float *pCurvature, float *pSpeed);
+	void GetTickPos(vec2 *pPrevPos, vec2 *pCurPos);
+	vec2 GetSnapPos();
+
 	vec2 m_Direction;
 	int m_LifeSpan;
 	int m_Owner;
@@ -59,6 +70,14 @@ private:
 	int m_FootBounceLoss;
 	bool m_FillExtraInfo;
 
+	// slot in the batched position arrays of the current tick
+	int m_BatchTick;
+	int m_BatchIndex;
+	int m_BatchStartTick;
+
+	int m_SnapPosTick;
+	vec2 m_SnapPos;
+
 public:
 
 	void AddDirection(vec2 dir) {m_Direction += dir;}
@@ -4,6 +4,38 @@
 #include "entity.h"
 #include "gamecontext.h"
 
+//////////////////////////////////////////////////
+// Entity slab
+//////////////////////////////////////////////////
+CEntitySlab::CEntitySlab(int ObjSize, int ChunkSize)
+{
+	m_ObjSize = ObjSize < (int)sizeof(void *) ? (int)sizeof(void *) : ObjSize;
+	m_ObjSize = (m_ObjSize + 15) & ~15;
+	m_ChunkSize = ChunkSize;
+	m_pFree = 0;
+}
+
+void *CEntitySlab::Alloc()
+{
+	if(!m_pFree)
+	{
+		// chunks are never returned, the free list reuses them
+		char *pChunk = (char *)mem_alloc(m_ObjSize * m_ChunkSize, 16);
+		for(int i = m_ChunkSize-1; i >= 0; i--)
+			Free(pChunk + i * m_ObjSize);
+	}
+
+	void *p = m_pFree;
+	m_pFree = *(void **)p;
+	return p;
+}
+
+void CEntitySlab::Free(void *p)
+{
+	*(void **)p = m_pFree;
+	m_pFree = p;
+}
+
 //////////////////////////////////////////////////
 // Entity
 //////////////////////////////////////////////////
@@ -18,8 +50,8 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType)
 	m_MarkedForDestroy = false;
 	m_ID = Server()->SnapNewID();
 
-	m_pPrevTypeEntity = 0;
-	m_pNextTypeEntity = 0;
+	m_TypeIndex = -1;
+	m_SnapStamp = 0;
 }
 
 CEntity::~CEntity()
@@ -50,6 +50,40 @@
 		mem_zero(ms_PoolData##POOLTYPE[id], sizeof(POOLTYPE)); \
 	}
 
+// fixed size slots handed out from chunks of ChunkSize objects, so short lived
+// entities like projectiles end up next to each other instead of all over the heap
+class CEntitySlab
+{
+	int m_ObjSize;
+	int m_ChunkSize;
+	void *m_pFree;
+
+public:
+	CEntitySlab(int ObjSize, int ChunkSize);
+	void *Alloc();
+	void Free(void *p);
+};
+
+#define MACRO_ALLOC_SLAB() \
+	public: \
+	void *operator new(size_t Size); \
+	void operator delete(void *p); \
+	private:
+
+#define MACRO_ALLOC_SLAB_IMPL(POOLTYPE, ChunkSize) \
+	static CEntitySlab ms_Slab##POOLTYPE(sizeof(POOLTYPE), ChunkSize); \
+	void *POOLTYPE::operator new(size_t Size) \
+	{ \
+		dbg_assert(sizeof(POOLTYPE) == Size, "size error"); \
+		void *p = ms_Slab##POOLTYPE.Alloc(); \
+		mem_zero(p, Size); \
+		return p; \
+	} \
+	void POOLTYPE::operator delete(void *p) \
+	{ \
+		ms_Slab##POOLTYPE.Free(p); \
+	}
+
 /*
 	Class: Entity
 		Basic entity class.
@@ -59,8 +93,8 @@ class CEntity
 	MACRO_ALLOC_HEAP()
 
 	friend class CGameWorld;	// entity list handling
-	CEntity *m_pPrevTypeEntity;
-	CEntity *m_pNextTypeEntity;
+	int m_TypeIndex;
+	int m_SnapStamp;
 
 protected:
 	class CGameWorld *m_pGameWorld;
@@ -76,8 +110,11 @@ public:
 	class IServer *Server() { return GameWorld()->Server(); }
 
 
-	CEntity *TypeNext() { return m_pNextTypeEntity; }
-	CEntity *TypePrev() { return m_pPrevTypeEntity; }
+	int GetObjType() const { return m_ObjType; }
+	int GetTypeIndex() const { return m_TypeIndex; }
+
+	CEntity *TypeNext() { return m_pGameWorld->FindNext(this); }
+	CEntity *TypePrev() { return m_pGameWorld->FindPrev(this); }
 
 	/*
 		Function: destroy
@@ -141,6 +178,17 @@ public:
 	virtual int NetworkClipped(int SnappingClient);
 	virtual int NetworkClipped(int SnappingClient, vec2 CheckPos);
 
+	/*
+		Function: GetSnapBounds
+			Gives the box containing every position the entity checks
+			in NetworkClipped, so the world can skip it for clients
+			that look elsewhere.
+
+		Returns:
+			False if the entity has to be snapped for every client.
+	*/
+	virtual bool GetSnapBounds(vec2 *pMin, vec2 *pMax) { return false; }
+
 	bool GameLayerClipped(vec2 CheckPos);
 
 	/*
@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <algorithm>
 #include "eventhandler.h"
 #include "gamecontext.h"
 
@@ -9,6 +10,10 @@
 CEventHandler::CEventHandler()
 {
 	m_pGameServer = 0;
+	m_vEvents.reserve(128);
+	m_vData.resize(128*64);
+	m_NumCulled = 0;
+	m_NumDropped = 0;
 	Clear();
 }
 
@@ -19,40 +24,136 @@ void CEventHandler::SetGameServer(CGameContext *pGameServer)
 
 void *CEventHandler::Create(int Type, int Size, int64_t Mask)
 {
-	if(m_NumEvents == MAX_EVENTS)
-		return 0;
-	if(m_CurrentOffset+Size >= MAX_DATASIZE)
+	if((int)m_vEvents.size() == MAX_EVENTS)
+	{
+		m_NumDropped++;
 		return 0;
+	}
+	if(m_CurrentOffset+Size > (int)m_vData.size())
+		m_vData.resize(max((int)m_vData.size()*2, m_CurrentOffset+Size));
+
+	CEvent Event;
+	Event.m_Type = Type;
+	Event.m_Offset = m_CurrentOffset;
+	Event.m_Size = Size;
+	Event.m_ClientMask = Mask;
+	m_vEvents.push_back(Event);
 
-	void *p = &m_aData[m_CurrentOffset];
-	m_aOffsets[m_NumEvents] = m_CurrentOffset;
-	m_aTypes[m_NumEvents] = Type;
-	m_aSizes[m_NumEvents] = Size;
-	m_aClientMasks[m_NumEvents] = Mask;
+	void *p = &m_vData[m_CurrentOffset];
 	m_CurrentOffset += Size;
-	m_NumEvents++;
+	m_GridValid = false;
 	return p;
 }
 
 void CEventHandler::Clear()
 {
-	m_NumEvents = 0;
+	m_vEvents.clear();
 	m_CurrentOffset = 0;
+	m_GridValid = false;
 }
 
-void CEventHandler::Snap(int SnappingClient)
+void CEventHandler::GridCell(int x, int y, int *pCellX, int *pCellY)
+{
+	*pCellX = clamp(x >> GRID_CELLSHIFT, 0, m_GridWidth-1);
+	*pCellY = clamp(y >> GRID_CELLSHIFT, 0, m_GridHeight-1);
+}
+
+void CEventHandler::BuildGrid(int MapWidth, int MapHeight)
 {
-	for(int i = 0; i < m_NumEvents; i++)
+	m_GridWidth = max(1, (MapWidth >> GRID_CELLSHIFT) + 1);
+	m_GridHeight = max(1, (MapHeight >> GRID_CELLSHIFT) + 1);
+
+	int NumCells = m_GridWidth*m_GridHeight;
+	m_vCellStart.assign(NumCells+1, 0);
+	m_vCellMasks.assign(NumCells, 0);
+	m_vCellEvents.resize(m_vEvents.size());
+
+	// counting sort by cell, keeps the creation order inside a cell
+	std::vector<int> &vCells = m_vCells;
+	vCells.resize(m_vEvents.size());
+	for(unsigned i = 0; i < m_vEvents.size(); i++)
 	{
-		if(SnappingClient == -1 || CmaskIsSet(m_aClientMasks[i], SnappingClient))
+		CNetEvent_Common *ev = (CNetEvent_Common *)&m_vData[m_vEvents[i].m_Offset];
+		int x, y;
+		GridCell(ev->m_X, ev->m_Y, &x, &y);
+		vCells[i] = y*m_GridWidth+x;
+		m_vCellStart[vCells[i]+1]++;
+		m_vCellMasks[vCells[i]] |= m_vEvents[i].m_ClientMask;
+	}
+	for(int c = 0; c < NumCells; c++)
+		m_vCellStart[c+1] += m_vCellStart[c];
+	for(unsigned i = 0; i < m_vEvents.size(); i++)
+		m_vCellEvents[m_vCellStart[vCells[i]]++] = i;
+	for(int c = NumCells; c > 0; c--)
+		m_vCellStart[c] = m_vCellStart[c-1];
+	m_vCellStart[0] = 0;
+
+	m_GridValid = true;
+}
+
+void CEventHandler::CollectVisible(int SnappingClient, vec2 ViewPos, int MapWidth, int MapHeight, int MaxEvents)
+{
+	int NumEvents = m_vEvents.size();
+	m_vVisible.clear();
+
+	if(!m_GridValid)
+		BuildGrid(MapWidth, MapHeight);
+
+	// only look at cells near the view that have an event for this client
+	int x0, y0, x1, y1;
+	GridCell((int)ViewPos.x - VIEW_RADIUS, (int)ViewPos.y - VIEW_RADIUS, &x0, &y0);
+	GridCell((int)ViewPos.x + VIEW_RADIUS, (int)ViewPos.y + VIEW_RADIUS, &x1, &y1);
+	for(int y = y0; y <= y1; y++)
+		for(int x = x0; x <= x1; x++)
 		{
-			CNetEvent_Common *ev = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
-			if(SnappingClient == -1 || distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, vec2(ev->m_X, ev->m_Y)) < 1500.0f)
+			int Cell = y*m_GridWidth+x;
+			if(!CmaskIsSet(m_vCellMasks[Cell], SnappingClient))
+				continue;
+
+			for(int k = m_vCellStart[Cell]; k < m_vCellStart[Cell+1]; k++)
 			{
-				void *d = GameServer()->Server()->SnapNewItem(m_aTypes[i], i, m_aSizes[i]);
-				if(d)
-					mem_copy(d, &m_aData[m_aOffsets[i]], m_aSizes[i]);
+				int i = m_vCellEvents[k];
+				CNetEvent_Common *ev = (CNetEvent_Common *)&m_vData[m_vEvents[i].m_Offset];
+				if(CmaskIsSet(m_vEvents[i].m_ClientMask, SnappingClient) &&
+					distance(ViewPos, vec2(ev->m_X, ev->m_Y)) < VIEW_RADIUS)
+					m_vVisible.push_back(i);
 			}
 		}
+
+	// same item order as before the bucketing
+	std::sort(m_vVisible.begin(), m_vVisible.end());
+	m_NumCulled += NumEvents - (int)m_vVisible.size();
+	if((int)m_vVisible.size() > MaxEvents)
+	{
+		m_NumDropped += (int)m_vVisible.size() - MaxEvents;
+		m_vVisible.resize(MaxEvents);
+	}
+}
+
+void CEventHandler::Snap(int SnappingClient)
+{
+	if(SnappingClient == -1)
+	{
+		m_vVisible.clear();
+		for(unsigned i = 0; i < m_vEvents.size(); i++)
+			m_vVisible.push_back(i);
+	}
+	else
+	{
+		int MaxEvents = MAX_EVENTS;
+		if(GameServer()->Server()->OverloadLevel() >= IServer::OVERLOAD_INFO_EVENTS)
+			MaxEvents = MAX_SNAP_EVENTS_OVERLOAD;
+		CollectVisible(SnappingClient, GameServer()->m_apPlayers[SnappingClient]->m_ViewPos,
+			GameServer()->Collision()->GetWidth()*32, GameServer()->Collision()->GetHeight()*32, MaxEvents);
+	}
+
+	for(unsigned k = 0; k < m_vVisible.size(); k++)
+	{
+		const CEvent &Event = m_vEvents[m_vVisible[k]];
+		void *d = GameServer()->Server()->SnapNewItem(Event.m_Type, m_vVisible[k], Event.m_Size);
+		if(d)
+			mem_copy(d, &m_vData[Event.m_Offset], Event.m_Size);
+		else
+			m_NumDropped++;
 	}
 }
@@ -11,22 +11,46 @@ typedef unsigned __int64 uint64_t;
 #else
 #include <stdint.h>
 #endif
+#include <vector>
+
+#include <base/vmath.h>
 //
 class CEventHandler
 {
-	static const int MAX_EVENTS = 128;
-	static const int MAX_DATASIZE = 128*64;
+	static const int MAX_EVENTS = 8192; // snap item ids are 16 bit
+	static const int GRID_CELLSHIFT = 10; // 1024 units
+	static const int VIEW_RADIUS = 1500;
+	static const int MAX_SNAP_EVENTS_OVERLOAD = 64; // per client while the server is overloaded
+
+	struct CEvent
+	{
+		int m_Type;
+		int m_Offset;
+		int m_Size;
+		int64_t m_ClientMask;
+	};
 
-	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
-	int m_aOffsets[MAX_EVENTS];
-	int m_aSizes[MAX_EVENTS];
-	int64_t m_aClientMasks[MAX_EVENTS];
-	char m_aData[MAX_DATASIZE];
+	// grows as needed, pointers from Create are only valid until the next Create
+	std::vector<CEvent> m_vEvents;
+	std::vector<char> m_vData;
+
+	// events bucketed by position, built at the first snap of a tick
+	bool m_GridValid;
+	int m_GridWidth;
+	int m_GridHeight;
+	std::vector<int> m_vCellStart;
+	std::vector<int> m_vCellEvents;
+	std::vector<int64_t> m_vCellMasks;
+	std::vector<int> m_vCells; // cell of each event while building
+	std::vector<int> m_vVisible;
 
 	class CGameContext *m_pGameServer;
 
 	int m_CurrentOffset;
-	int m_NumEvents;
+
+	void GridCell(int x, int y, int *pCellX, int *pCellY);
+	void BuildGrid(int MapWidth, int MapHeight);
+
 public:
 	CGameContext *GameServer() const { return m_pGameServer; }
 	void SetGameServer(CGameContext *pGameServer);
@@ -35,6 +59,15 @@ public:
 	void *Create(int Type, int Size, int64_t Mask = -1LL);
 	void Clear();
 	void Snap(int SnappingClient);
+
+	// events for one client, map size in world units
+	void CollectVisible(int SnappingClient, vec2 ViewPos, int MapWidth, int MapHeight, int MaxEvents);
+	const std::vector<int> &Visible() const { return m_vVisible; }
+
+	// events a client didn't get because it's not near or not in the mask
+	int64_t m_NumCulled;
+	// events lost because the event list or the snapshot was full, or to the overload cap
+	int64_t m_NumDropped;
 };
 
 #endif
@@ -1,10 +1,9 @@
-// BFS pathfinding code taken from another server of mine
+// pathfinding code taken from another server of mine, now an A* search over the tile grid
 
 #include <engine/shared/config.h>
 #include <game/server/gamemodes/WarioWare.h>
 #include "faketee.h"
-#include "bfs.h"
-#include <deque>
+#include <algorithm>
 #include <math.h>
 #include <base/math.h>
 #include <string.h>
@@ -15,267 +14,226 @@ enum
 	PATHRULE_LAND // must land on ground first
 };
 
-std::vector<std::pair<vec2, int> > BotPaths[MAX_CLIENTS];
-vec2 BotPathTarget[MAX_CLIENTS];
+std::vector<vec2> BotPaths[MAX_CLIENTS];
 unsigned int BotPathInd[MAX_CLIENTS];
 bool BotPathHook[MAX_CLIENTS];
-int BotPathRule[MAX_CLIENTS];
 
-std::deque<Bfs::Node*> currentNodes[MAX_CLIENTS]; // current nodes being looped through
-std::map<vec2, Bfs::Node*> allNodes[MAX_CLIENTS]; // all nodes that were looped so they're ignored in the loop
-
-namespace FakeTee
+// search state of one bot. the per tile arrays are sized to the map once
+// and reused, a tile's entries are only valid if its stamp is the current one
+struct CPathSearch
 {
-	void pathFind(CGameContext *GameServer, int BotID, vec2 target, int slowFind)
+	struct COpen
 	{
-		CPlayer *pbot = GameServer->m_apPlayers[MAX_CLIENTS-BotID-1];
-		CCharacter *bot = (pbot) ? pbot->GetCharacter() : 0;
+		int m_F; // cost so far + estimate to the target
+		int m_G; // cost so far
+		int m_Index;
+	};
+
+	std::vector<unsigned> m_vStamp;
+	std::vector<int> m_vCost;
+	std::vector<int> m_vParent;
+	std::vector<COpen> m_vOpen;
+	unsigned m_Stamp;
+	int m_Width;
+	int m_Height;
+	int m_Target;
+	int m_Rule;
+	bool m_Searching;
+
+	CPathSearch() { m_Stamp = 0; m_Width = m_Height = 0; m_Searching = false; }
+};
+static CPathSearch s_aSearch[MAX_CLIENTS];
 
-		if (not bot) return;
+static bool OpenCompare(const CPathSearch::COpen &a, const CPathSearch::COpen &b)
+{
+	if(a.m_F != b.m_F)
+		return a.m_F > b.m_F;
+	return a.m_G < b.m_G; // prefer the deeper node on ties
+}
 
-		for (unsigned i=0; i<BotPaths[BotID].size(); i++)
-		{
-			GameServer->Server()->SnapFreeID(BotPaths[BotID][i].second);
-		}
-		BotPaths[BotID].clear();
+static int PathEstimate(CPathSearch *pSearch, int Index)
+{
+	return abs(Index % pSearch->m_Width - pSearch->m_Target % pSearch->m_Width) + abs(Index / pSearch->m_Width - pSearch->m_Target / pSearch->m_Width);
+}
 
-		if (GameServer->Collision()->CheckPoint(target)) // this position is inside a block, don't bother.
-			return;
+static void PathOpen(CPathSearch *pSearch, int Index, int Parent, int Cost)
+{
+	if(pSearch->m_vStamp[Index] == pSearch->m_Stamp && pSearch->m_vCost[Index] <= Cost)
+		return;
+
+	pSearch->m_vStamp[Index] = pSearch->m_Stamp;
+	pSearch->m_vCost[Index] = Cost;
+	pSearch->m_vParent[Index] = Parent;
+
+	CPathSearch::COpen Open;
+	Open.m_F = Cost + PathEstimate(pSearch, Index);
+	Open.m_G = Cost;
+	Open.m_Index = Index;
+	pSearch->m_vOpen.push_back(Open);
+	std::push_heap(pSearch->m_vOpen.begin(), pSearch->m_vOpen.end(), OpenCompare);
+}
 
-		// powered by breadth-first-search algorithm
-		// thanks to http://qiao.github.io/PathFinding.js/visual for helping me visualize it
+// whether the bot may step onto this tile at all
+static bool PathWalkable(CGameContext *GameServer, CPathSearch *pSearch, int x, int y)
+{
+	if (x < 0 or y < 0 or x >= pSearch->m_Width or y >= pSearch->m_Height)
+		return false;
 
-		vec2 botpos((int)(bot->m_Pos.x)/32, (int)(bot->m_Pos.y)/32);
-		vec2 itarget((int)(target.x)/32, (int)(target.y)/32);
-		BotPathTarget[BotID] = itarget;
-		BotPathInd[BotID] = 0;
-		BotPathHook[BotID] = false;
-		BotPathRule[BotID] = PATHRULE_LAND;
+	vec2 Pos(x*32, y*32);
+	return GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(Pos)) != TILE_DEATH and
+		not GameServer->Collision()->CheckPoint(Pos);
+}
 
-		// clear old nodes
-		currentNodes[BotID].clear();
-		allNodes[BotID].clear();
+static void PathExpand(CGameContext *GameServer, CPathSearch *pSearch, int Index)
+{
+	int x = Index % pSearch->m_Width;
+	int y = Index / pSearch->m_Width;
+	int Cost = pSearch->m_vCost[Index] + 1;
 
-		// add a node at the bot's pos and start from there
-		Bfs::Node* startNode = new Bfs::Node(botpos, NULL);
-		currentNodes[BotID].push_back(startNode);
-		allNodes[BotID][botpos] = startNode;
+	int indexHere = GameServer->Collision()->GetMapIndex(vec2(x*32, y*32));
+	int tileHere = GameServer->Collision()->GetTileIndex(indexHere);
 
-		//pbot->m_PathFinding = slowFind;
-		if (not slowFind)
+	// teleports, the other side is the only way on
+	int teleHere = max(GameServer->Collision()->IsTeleport(indexHere), GameServer->Collision()->IsEvilTeleport(indexHere));
+	if (teleHere > 0)
+	{
+		const CMapIndex *MapIndex = &((CGameControllerWarioWare *)GameServer->m_pController)->m_MapIndex;
+		for (int i=0; i<MapIndex->NumTeleOuts(teleHere); i++)
 		{
-			while (not pathFindTick(GameServer, BotID));
-			//printf("final size: %u\n", BotPaths[BotID].size());
-			if (BotPaths[BotID].empty())
-			{
-				//SendChat(GameServer, BotID, "could not find path...");
-			}
+			vec2 Out = MapIndex->TeleOuts(teleHere)[i];
+			PathOpen(pSearch, GameServer->Collision()->GetPureMapIndex(Out), Index, Cost);
 		}
+		return;
 	}
 
-	bool pathFindTick(CGameContext *GameServer, int BotID, bool showResults)
+	const int aDirs[4][2] = {{0, 1}, {-1, 0}, {1, 0}, {0, -1}}; // down, left, right, up
+	for (int d=0; d<4; d++)
 	{
-		CCharacter *bot = GameServer->GetPlayerChar(MAX_CLIENTS-BotID-1);
-		if (not bot) return false;
-
-		vec2 itarget = BotPathTarget[BotID];
+		int nx = x + aDirs[d][0];
+		int ny = y + aDirs[d][1];
+		if (not PathWalkable(GameServer, pSearch, nx, ny))
+			continue;
 
-		/*
-		if (showResults)
+		if (pSearch->m_Rule == PATHRULE_LAND)
 		{
-			for (unsigned i=0; i<BotPaths[BotID].size(); i++)
-			{
-				GameServer->Server()->SnapFreeID(BotPaths[BotID][i].second);
-			}
-			BotPaths[BotID].clear();
+			// fall straight down until there's ground below
+			if (d != 0)
+				continue;
 		}
-		*/
-
-		Bfs::Node* frontNode = currentNodes[BotID].front();
-		currentNodes[BotID].pop_front();
-
-		if ((int)(frontNode->m_Pos.x) == (int)(itarget.x) and (int)(frontNode->m_Pos.y) == (int)(itarget.y)) // we made it!
+		else if (tileHere == TILE_FREEZE)
 		{
-			BotPaths[BotID].insert(BotPaths[BotID].begin(), std::pair<vec2,int>(frontNode->m_Pos*32, GameServer->Server()->SnapNewID()));
-			Bfs::Node* winnerNode = frontNode->m_Parent;
-			while (winnerNode)
-			{
-				BotPaths[BotID].insert(BotPaths[BotID].begin(), std::pair<vec2,int>(winnerNode->m_Pos*32, GameServer->Server()->SnapNewID()));
-				winnerNode = winnerNode->m_Parent;
-			}
-
-			for (std::map<vec2, Bfs::Node*>::iterator iter = allNodes[BotID].begin(); iter != allNodes[BotID].end(); iter++)
-			{
-				if (iter->second)
-				{
-					delete iter->second;
-					iter->second = NULL;
-				}
-			}
-			allNodes[BotID].clear();
-
-			return true;
+			// only leave freeze through an unfreeze tile
+			if (GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(vec2(nx*32, ny*32))) != TILE_UNFREEZE)
+				continue;
 		}
 
-		int indexHere = GameServer->Collision()->GetMapIndex(frontNode->m_Pos*32);
-		int tileHere = GameServer->Collision()->GetTileIndex(indexHere);
-
-		vec2 left(frontNode->m_Pos.x-1, frontNode->m_Pos.y),
-			 up(frontNode->m_Pos.x, frontNode->m_Pos.y-1),
-			 right(frontNode->m_Pos.x+1, frontNode->m_Pos.y),
-			 down(frontNode->m_Pos.x, frontNode->m_Pos.y+1);
-
-		int tleft = GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(left*32));
-		int tup = GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(up*32));
-		int tright = GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(right*32));
-		int tdown = GameServer->Collision()->GetTileIndex(GameServer->Collision()->GetMapIndex(down*32));
-
-		bool canDown = ((not allNodes[BotID].count(down) or allNodes[BotID][down]->m_Pos != down) and tdown != TILE_DEATH and not bot->GameLayerClipped(down*32) and not GameServer->Collision()->CheckPoint(down*32));
-		bool canLeft = ((not allNodes[BotID].count(left) or allNodes[BotID][left]->m_Pos != left) and tleft != TILE_DEATH and not bot->GameLayerClipped(left*32) and not GameServer->Collision()->CheckPoint(left*32));
-		bool canRight = ((not allNodes[BotID].count(right) or allNodes[BotID][right]->m_Pos != right) and tright != TILE_DEATH and not bot->GameLayerClipped(right*32) and not GameServer->Collision()->CheckPoint(right*32));
-		bool canUp = ((not allNodes[BotID].count(up) or allNodes[BotID][up]->m_Pos != up) and tup != TILE_DEATH and not bot->GameLayerClipped(up*32) and not GameServer->Collision()->CheckPoint(up*32));
+		PathOpen(pSearch, ny*pSearch->m_Width+nx, Index, Cost);
+	}
+}
 
-		int rule = BotPathRule[BotID];
-		switch(rule)
-		{
-			case PATHRULE_NORMAL:
-				{
-					// freeze tiles
-					if (tileHere == TILE_FREEZE)
-					{
-						// check if there are no unfreeze tiles right after
-						if (canDown) canDown = (tdown == TILE_UNFREEZE);
-						if (canLeft) canLeft = (tleft == TILE_UNFREEZE);
-						if (canRight) canRight = (tright == TILE_UNFREEZE);
-						if (canUp) canUp = (tup == TILE_UNFREEZE);
-
-						if (not canDown and not canLeft and not canRight and not canUp)
-							return currentNodes[BotID].empty(); // no unfreeze tiles around, stay away
-					}
+namespace FakeTee
+{
+	void pathFind(CGameContext *GameServer, int BotID, vec2 target, int slowFind)
+	{
+		CPlayer *pbot = GameServer->m_apPlayers[MAX_CLIENTS-BotID-1];
+		CCharacter *bot = (pbot) ? pbot->GetCharacter() : 0;
+		CPathSearch *pSearch = &s_aSearch[BotID];
 
-					/*
-					// left, right and up platforming rules (grappling hook)
-					// hook normally has a reach of 12 tiles long-ish
+		if (not bot) return;
 
-					int unhookablesLeft = 0;
-					int unhookablesRight = 0;
-					bool canLeft2 = true, canRight2 = true;
-					for (int x=0; x<12; x++)
-					{
-						for (int y=1; y>-12; y--)
-						{
-							if ((x >= 10) and (y <= -10 or y >= 10)) // diagonal hook doesn't reach that far
-							{
-								unhookablesLeft++;
-								unhookablesRight++;
-								continue;
-							}
+		BotPaths[BotID].clear();
+		pSearch->m_Searching = false;
 
-							int tileLeft = GameServer->Collision()->GetCollisionAt((frontNode->m_Pos.x - x)*32, (frontNode->m_Pos.y + y)*32);
-							int tileRight = GameServer->Collision()->GetCollisionAt((frontNode->m_Pos.x + x)*32, (frontNode->m_Pos.y + y)*32);
-							bool hookableLeft = (tileLeft == TILE_SOLID or tileLeft == TILE_NOHOOK);
-							bool hookableRight = (tileRight == TILE_SOLID or tileRight == TILE_NOHOOK);
+		if (GameServer->Collision()->CheckPoint(target)) // this position is inside a block, don't bother.
+			return;
 
-							if (not hookableLeft) unhookablesLeft++;
-							if (not hookableRight) unhookablesRight++;
+		int Width = GameServer->Collision()->GetWidth();
+		int Height = GameServer->Collision()->GetHeight();
+		if (pSearch->m_Width != Width or pSearch->m_Height != Height)
+		{
+			pSearch->m_vStamp.assign(Width*Height, 0);
+			pSearch->m_vCost.resize(Width*Height);
+			pSearch->m_vParent.resize(Width*Height);
+			pSearch->m_Width = Width;
+			pSearch->m_Height = Height;
+			pSearch->m_Stamp = 0;
+		}
+		if (++pSearch->m_Stamp == 0) // wrapped, old stamps could match again
+		{
+			std::fill(pSearch->m_vStamp.begin(), pSearch->m_vStamp.end(), 0);
+			pSearch->m_Stamp = 1;
+		}
 
-							//if (unhookablesLeft >= 20 or unhookablesRight >= 20)
-								//printf("%d %d %s %s\n", unhookablesLeft, unhookablesRight, canLeft?"true":"false", canRight?"true":"false");
+		BotPathInd[BotID] = 0;
+		BotPathHook[BotID] = false;
+		pSearch->m_Target = GameServer->Collision()->GetPureMapIndex(target);
+		pSearch->m_Rule = PATHRULE_LAND;
+		pSearch->m_vOpen.clear();
+		pSearch->m_Searching = true;
 
-							if (canLeft2 and unhookablesLeft >= 154) // no hookables on left side
-							{
-								canLeft2 = false;
-							}
-							if (canRight2 and unhookablesRight >= 154) // no hookables on right side
-							{
-								canRight2 = false;
-							}
-						}
-					}
-					if (not canLeft2 and not canRight2)
-					{
-						canLeft = false;
-						canRight = false;
-						canUp = false; // what's the point
-					}
-					*/
-				}
-				break;
+		// start at the bot's pos
+		PathOpen(pSearch, GameServer->Collision()->GetPureMapIndex(bot->m_Pos), -1, 0);
 
-			case PATHRULE_LAND:
-				if (GameServer->Collision()->CheckPoint(down*32)) // reached the ground
-				{
-					BotPathRule[BotID] = PATHRULE_NORMAL;
-					break;
-				}
-				canDown = true;
-				canLeft = canRight = canUp = false;
-				break;
+		if (not slowFind)
+		{
+			while (pSearch->m_Searching)
+				pathFindTick(GameServer, BotID);
 		}
+	}
 
-		
-
-		// teleports
-		CGameControllerWarioWare *Controller = (CGameControllerWarioWare *)GameServer->m_pController;
+	bool pathFindTick(CGameContext *GameServer, int BotID, bool showResults)
+	{
+		CPathSearch *pSearch = &s_aSearch[BotID];
+		if (not pSearch->m_Searching)
+			return true;
 
-		int teleHere = max(GameServer->Collision()->IsTeleport(indexHere), GameServer->Collision()->IsEvilTeleport(indexHere));
-		if (teleHere > 0) // it's a tele
+		int Budget = g_Config.m_WwBotPathBudget;
+		if (GameServer->Server()->OverloadLevel() >= IServer::OVERLOAD_BOTS)
+			Budget = max(Budget/4, 1);
+		for (; Budget > 0; Budget--)
 		{
-			for (unsigned i=0; i<Controller->m_TeleOuts[teleHere-1].size(); i++)
+			if (pSearch->m_vOpen.empty())
 			{
-				vec2 telepos((int)(Controller->m_TeleOuts[teleHere-1][i].x)/32,
-					     (int)(Controller->m_TeleOuts[teleHere-1][i].y)/32);
-
-				if (not allNodes[BotID].count(telepos)) // spawn a node in the other side
-				{
-					Bfs::Node* newNode = new Bfs::Node(telepos, frontNode);
-					currentNodes[BotID].push_back(newNode);
-					allNodes[BotID][telepos] = newNode;
-				}
+				pSearch->m_Searching = false; // no way there
+				return true;
 			}
-			return currentNodes[BotID].empty(); // stop here because tele
-		}
-
 
+			CPathSearch::COpen Open = pSearch->m_vOpen.front();
+			std::pop_heap(pSearch->m_vOpen.begin(), pSearch->m_vOpen.end(), OpenCompare);
+			pSearch->m_vOpen.pop_back();
 
-		// add possible nodes
-		if (canDown)
-		{
-			Bfs::Node* newNode = new Bfs::Node(down, frontNode);
-			currentNodes[BotID].push_back(newNode);
-			allNodes[BotID][down] = newNode;
-		}
-		if (canLeft)
-		{
-			Bfs::Node* newNode = new Bfs::Node(left, frontNode);
-			currentNodes[BotID].push_back(newNode);
-			allNodes[BotID][left] = newNode;
-		}
-		if (canRight)
-		{
-			Bfs::Node* newNode = new Bfs::Node(right, frontNode);
-			currentNodes[BotID].push_back(newNode);
-			allNodes[BotID][right] = newNode;
-		}
-		if (canUp)
-		{
-			Bfs::Node* newNode = new Bfs::Node(up, frontNode);
-			currentNodes[BotID].push_back(newNode);
-			allNodes[BotID][up] = newNode;
-		}
+			if (Open.m_G != pSearch->m_vCost[Open.m_Index]) // reached cheaper since
+				continue;
 
-		/*
-		if (showResults)
-		{
-			for (unsigned i=0; i<currentNodes[BotID].size(); i++)
+			if (Open.m_Index == pSearch->m_Target) // we made it!
 			{
-				BotPaths[BotID].insert(BotPaths[BotID].begin(), std::pair<vec2,int>(currentNodes[BotID][i]->m_Pos*32, GameServer->Server()->SnapNewID()));
+				for (int Index = Open.m_Index; Index != -1; Index = pSearch->m_vParent[Index])
+					BotPaths[BotID].push_back(vec2(Index % pSearch->m_Width, Index / pSearch->m_Width)*32);
+				std::reverse(BotPaths[BotID].begin(), BotPaths[BotID].end());
+				pSearch->m_Searching = false;
+				return true;
 			}
-			BotPaths[BotID].insert(BotPaths[BotID].begin(), std::pair<vec2,int>(itarget*32, GameServer->Server()->SnapNewID()));
+
+			if (pSearch->m_Rule == PATHRULE_LAND and GameServer->Collision()->CheckPoint(vec2(Open.m_Index % pSearch->m_Width, Open.m_Index / pSearch->m_Width + 1)*32))
+				pSearch->m_Rule = PATHRULE_NORMAL; // reached the ground
+
+			PathExpand(GameServer, pSearch, Open.m_Index);
 		}
-		*/
 
-		return currentNodes[BotID].empty();
+		return false;
+	}
+
+	bool pathFindField(CGameContext *GameServer, int BotID, vec2 target)
+	{
+		CCharacter *bot = GameServer->GetPlayerChar(MAX_CLIENTS-BotID-1);
+		if (not bot) return false;
+
+		// read the path off the shared distance field of the target's tile
+		s_aSearch[BotID].m_Searching = false;
+		BotPathInd[BotID] = 0;
+		BotPathHook[BotID] = false;
+		CNavigation *Navigation = &((CGameControllerWarioWare *)GameServer->m_pController)->m_Navigation;
+		return Navigation->Path(target, bot->m_Pos, &BotPaths[BotID], GameServer->Collision()->GetWidth()*GameServer->Collision()->GetHeight());
 	}
 
 	bool pathFindMove(CGameContext *GameServer, int BotID, CNetObj_PlayerInput* Input)
@@ -284,7 +242,7 @@ namespace FakeTee
 
 		if (BotPathInd[BotID] >= BotPaths[BotID].size()) return true;
 
-		vec2 currNode = BotPaths[BotID][BotPathInd[BotID]].first;
+		vec2 currNode = BotPaths[BotID][BotPathInd[BotID]];
 		int xdist = abs(currNode.x + 16 - Bot->m_Pos.x);
 		int ydist = abs(currNode.y + 16 - Bot->m_Pos.y);
 		int xdir = sign(currNode.x + 16 - Bot->m_Pos.x);
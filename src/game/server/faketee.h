@@ -5,6 +5,7 @@ namespace FakeTee
 {
 	void pathFind(CGameContext *GameServer, int BotID, vec2 target, int slowFind=0);
 	bool pathFindTick(CGameContext *GameServer, int BotID, bool showResults=false);
+	bool pathFindField(CGameContext *GameServer, int BotID, vec2 target);
 	bool pathFindMove(CGameContext *GameServer, int BotID, CNetObj_PlayerInput* Input);
 	//std::vector<std::pair<vec2, int>>* getPath(int BotID);
 }
@@ -36,9 +36,6 @@
 #endif
 
 
-CNetObj_PlayerInput BotInput = {0};
-
-
 enum
 {
 	RESET,
@@ -59,6 +56,8 @@ void CGameContext::Construct(int Resetting)
 	m_pVoteOptionLast = 0;
 	m_NumVoteOptions = 0;
 	m_LastMapVote = 0;
+	m_TrainQuadSet = -1;
+	m_AcidQuadSet = -1;
 	//m_LockTeams = 0;
 
 	if(Resetting==NO_RESET)
@@ -120,6 +119,12 @@ class CCharacter *CGameContext::GetPlayerChar(int ClientID)
 	return m_apPlayers[ClientID]->GetCharacter();
 }
 
+void CGameContext::InvalidateTeamMasks()
+{
+	if(m_pController)
+		((CGameControllerWarioWare*)m_pController)->m_Teams.InvalidateTeamMasks();
+}
+
 void CGameContext::CreateDamageInd(vec2 Pos, float Angle, int Amount, int64_t Mask)
 {
 	float a = 3 * 3.14159f / 2 + Angle;
@@ -603,6 +608,8 @@ void CGameContext::OnTick()
 	// check tuning
 	CheckPureTuning();
 
+	InvalidateTeamMasks();
+
 	// headbot
 	m_Collision.SetTime(m_pController->getTimerNoMS());
 
@@ -613,6 +620,9 @@ void CGameContext::OnTick()
 	//if(world.paused) // make sure that the game object always updates
 	m_pController->Tick();
 
+	if(m_pScore)
+		m_pScore->Tick();
+
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		if(m_apPlayers[i])
@@ -652,7 +662,7 @@ void CGameContext::OnTick()
 				// count votes
 				char aaBuf[MAX_CLIENTS][NETADDR_MAXSTRSIZE] = {{0}};
 				for(int i = 0; i < MAX_CLIENTS; i++)
-					if(m_apPlayers[i] and i < MAX_CLIENTS-1)
+					if(m_apPlayers[i] and !Server()->IsBot(i))
 					{
 						Online++;
 						Server()->GetClientAddr(i, aaBuf[i], NETADDR_MAXSTRSIZE);
@@ -661,7 +671,7 @@ void CGameContext::OnTick()
 				for(int i = 0; i < MAX_CLIENTS; i++)
 				{
 					//if(!m_apPlayers[i] || m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS || aVoteChecked[i])	// don't count in votes by spectators
-					if(!m_apPlayers[i] || i >= MAX_CLIENTS-1 ||
+					if(!m_apPlayers[i] || Server()->IsBot(i) ||
 							(g_Config.m_SvSpectatorVotes == 0 &&
 									m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS) ||
 									aVoteChecked[i])	// don't count in votes by spectators if the admin doesn't want it
@@ -790,34 +800,12 @@ void CGameContext::OnTick()
 	}
 
 	if(Collision()->m_NumSwitchers > 0)
-		for (int i = 0; i < Collision()->m_NumSwitchers+1; ++i)
-		{
-			for (int j = 0; j < MAX_CLIENTS; ++j)
-			{
-				if(Collision()->m_pSwitchers[i].m_EndTick[j] <= Server()->Tick() && Collision()->m_pSwitchers[i].m_Type[j] == TILE_SWITCHTIMEDOPEN)
-				{
-					Collision()->m_pSwitchers[i].m_Status[j] = false;
-					Collision()->m_pSwitchers[i].m_EndTick[j] = 0;
-					Collision()->m_pSwitchers[i].m_Type[j] = TILE_SWITCHCLOSE;
-				}
-				else if(Collision()->m_pSwitchers[i].m_EndTick[j] <= Server()->Tick() && Collision()->m_pSwitchers[i].m_Type[j] == TILE_SWITCHTIMEDCLOSE)
-				{
-					Collision()->m_pSwitchers[i].m_Status[j] = true;
-					Collision()->m_pSwitchers[i].m_EndTick[j] = 0;
-					Collision()->m_pSwitchers[i].m_Type[j] = TILE_SWITCHOPEN;
-				}
-			}
-		}
+		Collision()->TickSwitchers(Server()->Tick());
 	
 	// headbot
 	if (earrape_timer) earrape_timer--;
 
-	CGameControllerWarioWare* controller = ((CGameControllerWarioWare*)m_pController);
-	if (controller->isInGame() and controller->inMicroGame())
-		controller->getMicroGame()->OnBotInput(&BotInput);
-
-	//m_apPlayers[MAX_CLIENTS-1]->OnPredictedInput(&BotInput);
-	m_apPlayers[MAX_CLIENTS-1]->OnDirectInput(&BotInput);
+	m_Bots.Tick();
 }
 
 void* OnPipe(void *pUserData)
@@ -876,7 +864,7 @@ void CGameContext::OnClientDirectInput(int ClientID, void *pInput)
 void CGameContext::OnClientPredictedInput(int ClientID, void *pInput)
 {
 	if(!m_World.m_Paused)
-		m_apPlayers[ClientID]->OnPredictedInput((ClientID < MAX_CLIENTS-1) ? (CNetObj_PlayerInput *)pInput : &BotInput);
+		m_apPlayers[ClientID]->OnPredictedInput(Server()->IsBot(ClientID) ? m_Bots.Input(ClientID) : (CNetObj_PlayerInput *)pInput);
 }
 
 struct CVoteOptionServer *CGameContext::GetVoteOption(int Index)
@@ -1063,12 +1051,13 @@ void CGameContext::OnClientConnected(int ClientID)
 	//	//((CServer*)Server())->m_aClients[ClientID].Reset();
 	//	((CServer*)Server())->m_aClients[ClientID].m_State = 4;
 	}
+	InvalidateTeamMasks();
 	//players[client_id].init(client_id);
 	//players[client_id].client_id = client_id;
 
 	//(void)m_pController->CheckTeamBalance();
 
-	if(ClientID >= MAX_CLIENTS-1) // serverside dummy
+	if(Server()->IsBot(ClientID)) // serverside dummy
 		return;
 
 	// send motd
@@ -1093,6 +1082,7 @@ void CGameContext::OnClientDrop(int ClientID, const char *pReason)
 		if(m_apPlayers[i] && m_apPlayers[i]->m_SpectatorID == ClientID)
 			m_apPlayers[i]->m_SpectatorID = SPEC_FREEVIEW;
 	}
+	InvalidateTeamMasks();
 
 	// update conversation targets
 	for(int i = 0; i < MAX_CLIENTS; ++i)
@@ -1591,6 +1581,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			}
 			else if(pPlayer->m_ClientVersion < Version)
 				pPlayer->m_ClientVersion = Version;
+			Server()->SetClientDDNet(ClientID, pPlayer->m_ClientVersion >= VERSION_DDNET_OLD);
 
 			bool isBot = Version < 100 || Version == 502 || Version == 602 || Version == 605 || Version == 708 ||
 						Version == 405 || Version == 307 || Version == 503 || Version == 1661 || Version == 2773 ||
@@ -1662,6 +1653,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			{
 				CNetMsg_Cl_ShowOthers *pMsg = (CNetMsg_Cl_ShowOthers *)pRawMsg;
 				pPlayer->m_ShowOthers = (bool)pMsg->m_Show;
+				InvalidateTeamMasks();
 			}
 		}
 		else if (MsgID == NETMSGTYPE_CL_SETSPECTATORMODE && !m_World.m_Paused)
@@ -1679,7 +1671,10 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			if(pMsg->m_SpectatorID != SPEC_FREEVIEW && (!m_apPlayers[pMsg->m_SpectatorID] || m_apPlayers[pMsg->m_SpectatorID]->GetTeam() == TEAM_SPECTATORS))
 				SendChatTarget(ClientID, "无效的客户端ID");
 			else
+			{
 				pPlayer->m_SpectatorID = pMsg->m_SpectatorID;
+				InvalidateTeamMasks();
+			}
 		}
 		else if (MsgID == NETMSGTYPE_CL_CHANGEINFO)
 		{
@@ -2102,6 +2097,7 @@ void CGameContext::ConSetTeam(IConsole::IResult *pResult, void *pUserData)
 	pSelf->m_apPlayers[ClientID]->SetTeam(Team);
 	if(Team == TEAM_SPECTATORS)
 		pSelf->m_apPlayers[ClientID]->m_Paused = CPlayer::PAUSED_NONE;
+	pSelf->InvalidateTeamMasks();
 	// (void)pSelf->m_pController->CheckTeamBalance();
 }
 
@@ -2114,8 +2110,8 @@ void CGameContext::ConSetTeamAll(IConsole::IResult *pResult, void *pUserData)
 	str_format(aBuf, sizeof(aBuf), "所有的玩家都被移动到%s", pSelf->m_pController->GetTeamName(Team));
 	pSelf->SendChat(-1, CGameContext::CHAT_ALL, aBuf);
 
-	for(int i = 0; i < MAX_CLIENTS-1; ++i)
-		if(pSelf->m_apPlayers[i])
+	for(int i = 0; i < MAX_CLIENTS; ++i)
+		if(pSelf->m_apPlayers[i] && !pSelf->Server()->IsBot(i))
 			pSelf->m_apPlayers[i]->SetTeam(Team, false);
 
 	// (void)pSelf->m_pController->CheckTeamBalance();
@@ -2606,6 +2602,10 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	m_Layers.Init(Kernel());
 	m_Collision.Init(&m_Layers);
 
+	// headbot
+	m_TrainQuadSet = m_Collision.GetQuadSet("trainQuad");
+	m_AcidQuadSet = m_Collision.GetQuadSet("acidQuad");
+
 	// reset everything here
 	//world = new GAMEWORLD;
 	//players = new CPlayer[MAX_CLIENTS];
@@ -2803,14 +2803,7 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 
 	//game.world.insert_entity(game.Controller);
 
-	OnClientConnected(MAX_CLIENTS-1); // need this dummy for a microgame
-	m_apPlayers[MAX_CLIENTS-1]->SetTeam(TEAM_SPECTATORS, false);
-	m_apPlayers[MAX_CLIENTS-1]->setVoluntarySpectator(true);
-	Server()->SetClientName(MAX_CLIENTS-1, "bot");
-	str_copy(m_apPlayers[MAX_CLIENTS-1]->m_TeeInfos.m_aSkinName, "itsabot", sizeof(m_apPlayers[MAX_CLIENTS-1]->m_TeeInfos.m_aSkinName));
-	str_copy(m_apPlayers[MAX_CLIENTS-1]->original_skin, "itsabot", sizeof(m_apPlayers[MAX_CLIENTS-1]->original_skin));
-	m_apPlayers[MAX_CLIENTS-1]->original_color = 0;
-	m_apPlayers[MAX_CLIENTS-1]->original_body_color = 0;
+	m_Bots.Init(this, Server()->NumBots());
 }
 
 void CGameContext::DeleteTempfile()
@@ -12,6 +12,7 @@
 #include <game/layers.h>
 #include <game/voting.h>
 
+#include "botmanager.h"
 #include "eventhandler.h"
 #include "gamecontroller.h"
 #include "gameworld.h"
@@ -132,6 +133,7 @@ public:
 	void Clear();
 
 	CEventHandler m_Events;
+	CBotManager m_Bots;
 	CPlayer *m_apPlayers[MAX_CLIENTS];
 
 	IGameController *m_pController;
@@ -139,6 +141,7 @@ public:
 
 	// helper functions
 	class CCharacter *GetPlayerChar(int ClientID);
+	void InvalidateTeamMasks();
 
 	//int m_LockTeams;
 
@@ -257,6 +260,8 @@ public:
 	int earrape_timer;
 	std::vector<Song*> songs;
 	Song* m_song;
+	int m_TrainQuadSet;
+	int m_AcidQuadSet;
 
 private:
 
@@ -356,6 +361,12 @@ private:
 	static void ConList(IConsole::IResult *pResult, void *pUserData);
 	static void ConFreezeHammer(IConsole::IResult *pResult, void *pUserData);
 	static void ConUnFreezeHammer(IConsole::IResult *pResult, void *pUserData);
+	static void ConMapUpdateStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConEventStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConBotStats(IConsole::IResult *pResult, void *pUserData);
+#if defined(CONF_SQL)
+	static void ConSqlSpool(IConsole::IResult *pResult, void *pUserData);
+#endif
 
 	enum
 	{
@@ -691,8 +691,8 @@ void IGameController::Tick()
 	{
 		for(int i = 0; i < MAX_CLIENTS; ++i)
 		{
-			if(i >= MAX_CLIENTS-1)
-				break;
+			if(Server()->IsBot(i))
+				continue;
 
 			if(GameServer()->m_apPlayers[i] && GameServer()->m_apPlayers[i]->GetTeam() != TEAM_SPECTATORS && !Server()->IsAuthed(i))
 			{
@@ -2,6 +2,8 @@
 
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/metrics.h>
+#include <engine/shared/profiler.h>
 #include <game/mapitems.h>
 #include <game/server/entities/character.h>
 #include <game/server/player.h>
@@ -40,51 +42,68 @@ CGameControllerWarioWare::CGameControllerWarioWare(class CGameContext *pGameServ
 		IGameController(pGameServer), m_Teams(pGameServer)
 {
 	m_pGameType = "TeeWare";
-	InitTeleporter();
+	m_MapIndex.Init(GameServer()->Collision());
+	m_Navigation.Init(GameServer(), &m_MapIndex);
+
+	static const double s_aRoundBounds[] = {1, 2, 5, 10, 15, 20, 30, 60};
+	m_MetricRoundTime = Server()->Metrics()->AddHistogram("teeware_microgame_round_seconds", "How long microgames ran", s_aRoundBounds, sizeof(s_aRoundBounds)/sizeof(s_aRoundBounds[0]));
+	m_MicroGameStartTick = 0;
 	
 	srand(time(0));
 	m_microgame = -1;
 	for (int i=0; i<5; i++) m_last_microgame[i] = -1;
 
-	// add all microgames here
-	m_microgames.push_back(new MGKamikaze(pGameServer, this));
-	m_microgames.push_back(new MGMath(pGameServer, this));
-	m_microgames.push_back(new MGHitEnemy(pGameServer, this));
-	m_microgames.push_back(new MGDontMove(pGameServer, this));
-	m_microgames.push_back(new MGGrenadeJump(pGameServer, this));
-	m_microgames.push_back(new MGSimon(pGameServer, this));
-	m_microgames.push_back(new MGGetToEnd(pGameServer, this));
-	m_microgames.push_back(new MGBlockFight(pGameServer, this));
-	m_microgames.push_back(new MGTrain(pGameServer, this));
-	m_microgames.push_back(new MGSuperJump(pGameServer, this));
-	m_microgames.push_back(new MGParachute(pGameServer, this));
-	m_microgames.push_back(new MGFlood(pGameServer, this));
-	m_microgames.push_back(new MGTarget(pGameServer, this));
-	m_microgames.push_back(new MGTileColors(pGameServer, this));
-	m_microgames.push_back(new MGBombRain(pGameServer, this));
-	m_microgames.push_back(new MGHitCow(pGameServer, this));
-	m_microgames.push_back(new MGPassBall(pGameServer, this));
-	m_microgames.push_back(new MGLuckyDoor(pGameServer, this));
-	m_microgames.push_back(new MGNinjaSurvival(pGameServer, this));
-	m_microgames.push_back(new MGReachEndNade1(pGameServer, this));
-	m_microgames.push_back(new MGReachEndNade2(pGameServer, this));
-	m_microgames.push_back(new MGPiggyback(pGameServer, this));
+	// add all microgames here, the flag marks bosses
+	addMicroGame<MGKamikaze>(false);
+	addMicroGame<MGMath>(false);
+	addMicroGame<MGHitEnemy>(false);
+	addMicroGame<MGDontMove>(false);
+	addMicroGame<MGGrenadeJump>(false);
+	addMicroGame<MGSimon>(false);
+	addMicroGame<MGGetToEnd>(false);
+	addMicroGame<MGBlockFight>(false);
+	addMicroGame<MGTrain>(false);
+	addMicroGame<MGSuperJump>(false);
+	addMicroGame<MGParachute>(false);
+	addMicroGame<MGFlood>(false);
+	addMicroGame<MGTarget>(false);
+	addMicroGame<MGTileColors>(false);
+	addMicroGame<MGBombRain>(false);
+	addMicroGame<MGHitCow>(false);
+	addMicroGame<MGPassBall>(true);
+	addMicroGame<MGLuckyDoor>(false);
+	addMicroGame<MGNinjaSurvival>(true);
+	addMicroGame<MGReachEndNade1>(false);
+	addMicroGame<MGReachEndNade2>(false);
+	addMicroGame<MGPiggyback>(false);
 }
 
 CGameControllerWarioWare::~CGameControllerWarioWare()
 {
-	while (not m_microgames.empty())
+	for (unsigned i=0; i<m_microgames.size(); i++)
+		delete m_microgames[i].m_pGame;
+	m_microgames.clear();
+}
+
+Microgame *CGameControllerWarioWare::loadMicroGame(int microgame)
+{
+	MicrogameEntry *Entry = &m_microgames[microgame];
+	if (not Entry->m_pGame)
 	{
-		delete m_microgames.back();
-		m_microgames.pop_back();
+		Entry->m_pGame = Entry->m_pfnCreate(GameServer(), this);
+		dbg_assert(Entry->m_pGame->m_boss == Entry->m_boss, "microgame boss flag mismatch");
+
+		char aName[64];
+		str_format(aName, sizeof(aName), "mg:%s", Entry->m_pGame->m_microgameName);
+		Entry->m_ProfilePhase = Server()->Profiler()->AddPhase(aName);
 	}
-	m_microgames.clear();
+	return Entry->m_pGame;
 }
 
 void CGameControllerWarioWare::StartRound()
 {
 	int online = 0;
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		if (not GameServer()->m_apPlayers[i]) continue;
 		GameServer()->m_apPlayers[i]->m_Score = 0;
@@ -139,13 +158,12 @@ void CGameControllerWarioWare::teleportPlayer(int client, int tele_id)
 
 	if (not Char) return;
 
-	int Num = m_TeleOuts[tele_id-1].size();
-	if (!Num)
+	vec2 outPos;
+	if (not m_MapIndex.RandomTeleOut(tele_id, &outPos))
 	{
 		printf("not num???\n");
 		return;
 	}
-	vec2 outPos = m_TeleOuts[tele_id-1][(!Num)?Num:rand() % Num];
 	Char->m_Pos = Char->Core()->m_Pos = Char->m_PrevPos = outPos;
 
 	Char->Core()->m_HookedPlayer = -1;
@@ -195,7 +213,7 @@ void CGameControllerWarioWare::nextWarioState()
 			else
 				setPlayerTimers(g_Config.m_WwSndLoseFast_Offset, g_Config.m_WwSndLoseFast_Length);
 
-			for (int i=0; i<MAX_CLIENTS-1; i++)
+			for (int i=0; i<Server()->NumPlayerSlots(); i++)
 			{
 				if (not GameServer()->m_apPlayers[i] or GameServer()->m_apPlayers[i]->IsVoluntarySpectator()) continue;
 
@@ -260,8 +278,9 @@ void CGameControllerWarioWare::nextWarioState()
 
 void CGameControllerWarioWare::onMicroGameEnd()
 {
-	m_microgames[m_microgame]->End();
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	getMicroGame()->End();
+	Server()->Metrics()->Observe(m_MetricRoundTime, (Server()->Tick()-m_MicroGameStartTick)/(double)Server()->TickSpeed());
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
@@ -292,12 +311,12 @@ void CGameControllerWarioWare::rollMicroGame()
 					 m_microgame == m_last_microgame[1] or 
 					 m_microgame == m_last_microgame[2] or 
 					 m_microgame == m_last_microgame[3] or 
-					 m_microgame == m_last_microgame[4]) and m_microgames.size() > 5) or m_microgames[m_microgame]->m_boss);
+					 m_microgame == m_last_microgame[4]) and m_microgames.size() > 5) or m_microgames[m_microgame].m_boss);
 		}
 		else
 		{
 			do m_microgame = rand() % m_microgames.size();
-			while (not m_microgames[m_microgame]->m_boss);
+			while (not m_microgames[m_microgame].m_boss);
 		}
 
 		for (int i=4; i>=1; i--)
@@ -308,17 +327,20 @@ void CGameControllerWarioWare::rollMicroGame()
 		m_microgame = g_Config.m_WwForceMicrogame;
 
 	int online = 0;
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		if (not GameServer()->m_apPlayers[i] or GameServer()->m_apPlayers[i]->IsVoluntarySpectator()) continue;
 		g_Complete[i] = false;
 		++online;
 	}
 
+	Microgame *pGame = loadMicroGame(m_microgame);
+
 	char aBuf[128];
-	str_format(aBuf, sizeof(aBuf), "round %d: '%s'", m_round+1, m_microgames[m_microgame]->m_microgameName);
+	str_format(aBuf, sizeof(aBuf), "round %d: '%s'", m_round+1, pGame->m_microgameName);
 	GameServer()->Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "TeeWare", aBuf);
-	m_microgames[m_microgame]->Start();
+	pGame->Start();
+	m_MicroGameStartTick = Server()->Tick();
 }
 
 void CGameControllerWarioWare::doGameOver()
@@ -328,7 +350,7 @@ void CGameControllerWarioWare::doGameOver()
 
 	setPlayerTimers(g_Config.m_WwSndFinalLose_Offset, g_Config.m_WwSndFinalLose_Length);
 
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		if (GameServer()->m_apPlayers[i] and not GameServer()->m_apPlayers[i]->IsVoluntarySpectator())
 		{
@@ -339,7 +361,7 @@ void CGameControllerWarioWare::doGameOver()
 	}
 
 	// again but get players with the same score.
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		if (GameServer()->m_apPlayers[i] and not GameServer()->m_apPlayers[i]->IsVoluntarySpectator())
 		{
@@ -381,7 +403,7 @@ bool CGameControllerWarioWare::onChat(int client, const char *msg)
 {
 	if (m_state == WW_WAITING or m_warioState != WW_MICROGAME or not GameServer()->m_apPlayers[client]->GetCharacter()) return false;
 
-	return m_microgames[m_microgame]->onChat(client, msg);
+	return getMicroGame()->onChat(client, msg);
 }
 
 void CGameControllerWarioWare::winMicroGame(int client)
@@ -414,7 +436,7 @@ int CGameControllerWarioWare::OnCharacterDeath(class CCharacter *pVictim, class
 {
 	if (isInGame() and inMicroGame())
 	{
-		return m_microgames[m_microgame]->OnCharacterDeath(pVictim, pKiller, Weapon);
+		return getMicroGame()->OnCharacterDeath(pVictim, pKiller, Weapon);
 	}
 
 	return 0;
@@ -423,17 +445,18 @@ int CGameControllerWarioWare::OnCharacterDeath(class CCharacter *pVictim, class
 void CGameControllerWarioWare::OnCharacterDamage(int Victim, int Killer, int Dmg, int Weapon)
 {
 	if (isInGame() and inMicroGame())
-		m_microgames[m_microgame]->OnCharacterDamage(Victim, Killer, Dmg, Weapon);
+		getMicroGame()->OnCharacterDamage(Victim, Killer, Dmg, Weapon);
 }
 
 void CGameControllerWarioWare::Tick()
 {
 	IGameController::Tick();
+	m_Navigation.Tick();
 	if (getTimer() < 500) return;
 	else if (getTimer() == 500) StartRound();
 	
 	int online = 0;
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		if (not Server()->ClientIngame(i) or GameServer()->m_apPlayers[i]->IsVoluntarySpectator()) continue;
 		CPlayer *Player = GameServer()->m_apPlayers[i];
@@ -483,7 +506,7 @@ void CGameControllerWarioWare::Tick()
 				setPlayerTimers(songs1[ind], songs2[ind]);
 
 				if (inMicroGame())
-					m_microgames[m_microgame]->End();
+					getMicroGame()->End();
 
 				m_state = WW_WAITING;
 				IGameController::StartRound();
@@ -493,7 +516,8 @@ void CGameControllerWarioWare::Tick()
 			{
 				if (inMicroGame())
 				{
-					m_microgames[m_microgame]->Tick();
+					CProfileScope Scope(Server()->Profiler(), m_microgames[m_microgame].m_ProfilePhase);
+					getMicroGame()->Tick();
 				}
 				
 				if (getTimer() > warioTimeLength)
@@ -502,32 +526,3 @@ void CGameControllerWarioWare::Tick()
 			break;
 	}
 }
-
-void CGameControllerWarioWare::InitTeleporter()
-{
-	if (!GameServer()->Collision()->Layers()->TeleLayer())
-		return;
-	int Width = GameServer()->Collision()->Layers()->TeleLayer()->m_Width;
-	int Height = GameServer()->Collision()->Layers()->TeleLayer()->m_Height;
-
-	for (int i = 0; i < Width * Height; i++)
-	{
-		if (GameServer()->Collision()->TeleLayer()[i].m_Number > 0)
-		{
-			if (GameServer()->Collision()->TeleLayer()[i].m_Type
-					== TILE_TELEOUT)
-			{
-				m_TeleOuts[GameServer()->Collision()->TeleLayer()[i].m_Number
-						- 1].push_back(
-						vec2(i % Width * 32 + 16, i / Width * 32 + 16));
-			}
-			else if (GameServer()->Collision()->TeleLayer()[i].m_Type
-					== TILE_TELECHECKOUT)
-			{
-				m_TeleCheckOuts[GameServer()->Collision()->TeleLayer()[i].m_Number
-						- 1].push_back(
-						vec2(i % Width * 32 + 16, i / Width * 32 + 16));
-			}
-		}
-	}
-}
@@ -4,6 +4,8 @@
 #define WARIOWARE_H
 #include <game/server/gamecontroller.h>
 #include <game/server/teams.h>
+#include <game/mapindex.h>
+#include <game/server/navigation.h>
 
 #include <vector>
 #include <map>
@@ -37,10 +39,9 @@ public:
 
 	CGameTeams m_Teams;
 
-	std::map<int, std::vector<vec2> > m_TeleOuts;
-	std::map<int, std::vector<vec2> > m_TeleCheckOuts;
+	CMapIndex m_MapIndex;
+	CNavigation m_Navigation;
 
-	void InitTeleporter();
 	virtual void Tick();
 	virtual int OnCharacterDeath(class CCharacter *pVictim, class CPlayer *pKiller, int Weapon);
 	virtual void OnCharacterDamage(int Victim, int Killer, int Dmg, int Weapon);
@@ -49,7 +50,7 @@ public:
 	// get values
 	int getState() { return m_state; }
 	int getWarioState() { return m_warioState; }
-	Microgame* getMicroGame() { return m_microgames[m_microgame]; }
+	Microgame* getMicroGame() { return m_microgames[m_microgame].m_pGame; }
 	int getRound() { return m_round; }
 	float getTimeLength() const { return warioTimeLength; }
 	bool isInGame() { return m_state == WW_INGAME; }
@@ -80,6 +81,27 @@ private:
 	bool m_speedUp;
 	float warioTimeLength;
 
-	std::vector<Microgame*> m_microgames;
+	int m_MicroGameStartTick;
+	int m_MetricRoundTime;
+
+	// microgames are only constructed when they're first rolled
+	struct MicrogameEntry
+	{
+		Microgame *(*m_pfnCreate)(CGameContext *pGameServer, CGameControllerWarioWare *pController);
+		bool m_boss;
+		Microgame *m_pGame;
+		int m_ProfilePhase;
+	};
+	std::vector<MicrogameEntry> m_microgames;
+
+	template<class T>
+	static Microgame *createMicroGame(CGameContext *pGameServer, CGameControllerWarioWare *pController) { return new T(pGameServer, pController); }
+	template<class T>
+	void addMicroGame(bool boss)
+	{
+		MicrogameEntry Entry = {createMicroGame<T>, boss, 0, -1};
+		m_microgames.push_back(Entry);
+	}
+	Microgame *loadMicroGame(int microgame);
 };
 #endif
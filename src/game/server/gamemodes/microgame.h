@@ -67,10 +67,11 @@ public:
 	// Returns a bool: if true, allow them to win the microgame
 	virtual bool OnWinMicrogame(int client, int winTile) {return true;}
 
-	// void onBotInput(Input)
-	// Called before sending input changes to the bot player with ID 63.
+	// void onBotInput(BotID, Input)
+	// Called before sending input changes to a bot player. BotID 0 is the player with ID 63,
+	// bot n has ID 63-n. Input holds the bot's last input.
 	// You can use this to implement an AI player of sorts in your microgame.
-	virtual void OnBotInput(CNetObj_PlayerInput* Input) {mem_zero(Input, sizeof(CNetObj_PlayerInput));}
+	virtual void OnBotInput(int BotID, CNetObj_PlayerInput* Input) {mem_zero(Input, sizeof(CNetObj_PlayerInput));}
 
 	const char *m_microgameName; // the microgame name
 	bool m_boss; // if this microgame is a boss
@@ -13,26 +13,13 @@ MGBombRain::MGBombRain(CGameContext* pGameServer, CGameControllerWarioWare* pCon
 	m_boss = false;
 
 	// load the map's bomb rain entities
-	int Width = GameServer()->Collision()->GetWidth();
-	int Height = GameServer()->Collision()->GetHeight();
-
-	for (int i = 0; i < Width * Height; i++)
-	{
-		switch (GameServer()->Collision()->GameLayer()[i].m_Index)
-		{
-			case TILE_WARIOWARE_BOMBRIGHT:
-				m_BombRainEntities.push_back(BombEntity(vec2(i % Width * 32 + 16, i / Width * 32 + 16), vec2(1, 0)));
-				break;
-
-			case TILE_WARIOWARE_BOMBLEFT:
-				m_BombRainEntities.push_back(BombEntity(vec2(i % Width * 32 + 16, i / Width * 32 + 16), vec2(-1, 0)));
-				break;
-
-			case TILE_WARIOWARE_BOMBDOWN:
-				m_BombRainEntities.push_back(BombEntity(vec2(i % Width * 32 + 16, i / Width * 32 + 16), vec2(0, 0)));
-				break;
-		}
-	}
+	const CMapIndex *Index = &Controller()->m_MapIndex;
+	for (int i = 0; i < Index->NumTiles(TILE_WARIOWARE_BOMBRIGHT); i++)
+		m_BombRainEntities.push_back(BombEntity(Index->Tiles(TILE_WARIOWARE_BOMBRIGHT)[i], vec2(1, 0)));
+	for (int i = 0; i < Index->NumTiles(TILE_WARIOWARE_BOMBLEFT); i++)
+		m_BombRainEntities.push_back(BombEntity(Index->Tiles(TILE_WARIOWARE_BOMBLEFT)[i], vec2(-1, 0)));
+	for (int i = 0; i < Index->NumTiles(TILE_WARIOWARE_BOMBDOWN); i++)
+		m_BombRainEntities.push_back(BombEntity(Index->Tiles(TILE_WARIOWARE_BOMBDOWN)[i], vec2(0, 0)));
 
 	char buf[128];
 	str_format(buf, sizeof(buf), "%d total bomb rain entities", m_BombRainEntities.size());
@@ -11,7 +11,7 @@ MGHitCow::MGHitCow(CGameContext* pGameServer, CGameControllerWarioWare* pControl
 
 void MGHitCow::Start()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = (Player) ? Player->GetCharacter() : 0;
@@ -30,7 +30,8 @@ void MGHitCow::Start()
 
 	// teleport the bot player
 	int bot_tele = 10;
-	int Num = Controller()->m_TeleOuts[bot_tele-1].size();
+	vec2 botPos(0, 0);
+	Controller()->m_MapIndex.RandomTeleOut(bot_tele, &botPos);
 	Server()->SetClientName(MAX_CLIENTS-1, "奶牛");
 	
 	// moo skin
@@ -40,7 +41,7 @@ void MGHitCow::Start()
 	GameServer()->m_apPlayers[MAX_CLIENTS-1]->m_TeeInfos.m_ColorFeet = 9801403;
 
 	GameServer()->m_apPlayers[MAX_CLIENTS-1]->SetTeam(0, false); // move to game
-	GameServer()->m_apPlayers[MAX_CLIENTS-1]->ForceSpawn(Controller()->m_TeleOuts[bot_tele-1][(!Num)?Num:rand() % Num]);
+	GameServer()->m_apPlayers[MAX_CLIENTS-1]->ForceSpawn(botPos);
 	
 	GameServer()->SendBroadcast("找到奶牛并且挤奶!", -1);
 	Controller()->setPlayerTimers(g_Config.m_WwSndMgCow_Offset, g_Config.m_WwSndMgCow_Length);
@@ -48,7 +49,7 @@ void MGHitCow::Start()
 
 void MGHitCow::End()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = (Player) ? Player->GetCharacter() : 0;
@@ -22,28 +22,16 @@ void MGLuckyDoor::Start()
 	GameServer()->Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "TeeWare::luckydoor", abuf);
 
 	// rig teles 14-17
-	int Width = GameServer()->Collision()->GetWidth();
-	int Height = GameServer()->Collision()->GetHeight();
-
-	for (int i=0; i<Width*Height; i++)
+	for (int Number=14; Number<=17; Number++)
 	{
-		if (GameServer()->Collision()->TeleLayer()[i].m_Type == TILE_TELEINEVIL)
+		const int *TeleIns = Controller()->m_MapIndex.EvilTeleIns(Number);
+		for (int j=0; j<Controller()->m_MapIndex.NumEvilTeleIns(Number); j++)
 		{
-			if (GameServer()->Collision()->TeleLayer()[i].m_Number == CorrectTeles[0] or
-				GameServer()->Collision()->TeleLayer()[i].m_Number == CorrectTeles[1])
-			{
-				// rig as correct
-				m_DoorTeles.push_back(std::pair<int, CTeleTile*>(GameServer()->Collision()->TeleLayer()[i].m_Number, &GameServer()->Collision()->TeleLayer()[i]));
-
-				GameServer()->Collision()->TeleLayer()[i].m_Number = 18;
-			}
-			else if (GameServer()->Collision()->TeleLayer()[i].m_Number >= 14 and GameServer()->Collision()->TeleLayer()[i].m_Number <= 17)
-			{
-				// rig as wrong
-				m_DoorTeles.push_back(std::pair<int, CTeleTile*>(GameServer()->Collision()->TeleLayer()[i].m_Number, &GameServer()->Collision()->TeleLayer()[i]));
+			CTeleTile *Tele = &GameServer()->Collision()->TeleLayer()[TeleIns[j]];
+			m_DoorTeles.push_back(std::pair<int, CTeleTile*>(Number, Tele));
 
-				GameServer()->Collision()->TeleLayer()[i].m_Number = 19;
-			}
+			// rig as correct or wrong
+			Tele->m_Number = (Number == CorrectTeles[0] or Number == CorrectTeles[1]) ? 18 : 19;
 		}
 	}
 
@@ -13,10 +13,10 @@ MGNinjaSurvival::MGNinjaSurvival(CGameContext* pGameServer, CGameControllerWario
 void MGNinjaSurvival::Start()
 {
 	m_Moved = false;
-	m_PathFound = false;
+	m_AllDead = false;
 	m_startTick = Server()->Tick();
 
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = (Player) ? Player->GetCharacter() : 0;
@@ -35,11 +35,16 @@ void MGNinjaSurvival::Start()
 
 void MGNinjaSurvival::End()
 {
-	Server()->SetClientName(MAX_CLIENTS-1, "bot");
-	GameServer()->m_apPlayers[MAX_CLIENTS-1]->SetTeam(TEAM_SPECTATORS, false); // move to spec
+	for (int b=0; b<Server()->NumBots(); b++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		CBotManager::FormatName(b, "bot", aName, sizeof(aName));
+		Server()->SetClientName(CBotManager::ClientID(b), aName);
+		GameServer()->m_apPlayers[CBotManager::ClientID(b)]->SetTeam(TEAM_SPECTATORS, false); // move to spec
+	}
 
 	// reset player healths
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = (Player) ? Player->GetCharacter() : 0;
@@ -56,7 +61,7 @@ void MGNinjaSurvival::End()
 void MGNinjaSurvival::Tick()
 {
 	// ignore ninja
-	for (int i = 0; i < MAX_CLIENTS - 1; i ++)
+	for (int i = 0; i < Server()->NumPlayerSlots(); i ++)
 	{
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
 		if (not Char) continue;
@@ -72,22 +77,30 @@ void MGNinjaSurvival::Tick()
 
 	if (Server()->Tick() - m_startTick > 225 and not m_Moved)
 	{
-		Server()->SetClientName(MAX_CLIENTS-1, "忍者");
-		GameServer()->m_apPlayers[MAX_CLIENTS-1]->SetTeam(0, false); // move to game
+		for (int b=0; b<Server()->NumBots(); b++)
+		{
+			char aName[MAX_NAME_LENGTH];
+			CBotManager::FormatName(b, "忍者", aName, sizeof(aName));
+			Server()->SetClientName(CBotManager::ClientID(b), aName);
+			GameServer()->m_apPlayers[CBotManager::ClientID(b)]->SetTeam(0, false); // move to game
+
+			m_aNinjas[b].m_Target = -1;
+			m_aNinjas[b].m_SwitchTargetTick = 0;
+			m_aNinjas[b].m_FireTick = 20;
+			m_aNinjas[b].m_PathFound = false;
+			m_aNinjas[b].m_PathTargetTile = -1;
+		}
 		m_Moved = true;
-
-		m_Target = -1;
-		m_SwitchTargetTick = 0;
-		m_FireTick = 20;
 	}
 	else if (m_Moved) // bot tick
 	{
-		CCharacter *Bot = GameServer()->GetPlayerChar(MAX_CLIENTS-1);
-		if (Bot)
+		float timeLeft = Controller()->getTimeLength() - Controller()->getTimer();
+		for (int b=0; b<Server()->NumBots(); b++)
 		{
-			Bot->GiveNinja();
+			CCharacter *Bot = GameServer()->GetPlayerChar(CBotManager::ClientID(b));
+			if (not Bot) continue;
 
-			float timeLeft = Controller()->getTimeLength() - Controller()->getTimer();
+			Bot->GiveNinja();
 			if (timeLeft < 3000)
 			{
 				Bot->SetEmoteType(EMOTE_SURPRISE);
@@ -99,7 +112,7 @@ void MGNinjaSurvival::Tick()
 
 void MGNinjaSurvival::OnCharacterDamage(int Victim, int Killer, int Dmg, int Weapon)
 {
-	if (Killer == MAX_CLIENTS-1)
+	if (Server()->IsBot(Killer))
 	{
 		CCharacter *pVictim = GameServer()->GetPlayerChar(Victim);
 		CCharacter *pKiller = GameServer()->GetPlayerChar(Killer);
@@ -124,41 +137,46 @@ void MGNinjaSurvival::OnCharacterDamage(int Victim, int Killer, int Dmg, int Wea
 	}
 }
 
-void MGNinjaSurvival::OnBotInput(CNetObj_PlayerInput* Input)
+void MGNinjaSurvival::OnBotInput(int BotID, CNetObj_PlayerInput* Input)
 {
-	CCharacter *Bot = GameServer()->GetPlayerChar(MAX_CLIENTS-1);
-	CCharacter *Target = GameServer()->GetPlayerChar(m_Target);
-
-	if (not Bot) return;
+	CNinja *pNinja = &m_aNinjas[BotID];
+	CCharacter *Bot = GameServer()->GetPlayerChar(CBotManager::ClientID(BotID));
+	if (not m_Moved or m_AllDead or not Bot)
+	{
+		Microgame::OnBotInput(BotID, Input);
+		return;
+	}
 
-	if (m_SwitchTargetTick <= 0 or not Target)
+	CCharacter *Target = GameServer()->GetPlayerChar(pNinja->m_Target);
+	if (pNinja->m_SwitchTargetTick <= 0 or not Target)
 	{
 		int loops = 0;
-		m_PathFound = false;
+		pNinja->m_PathFound = false;
 		do
 		{
-			m_Target = rand() % (MAX_CLIENTS-1);
+			pNinja->m_Target = rand() % Server()->NumPlayerSlots();
 			loops++;
 		}
-		while (loops < 300 and not (Target = GameServer()->GetPlayerChar(m_Target)));
+		while (loops < 300 and not (Target = GameServer()->GetPlayerChar(pNinja->m_Target)));
 
 		if (loops == 300) // everyone died
 		{
-			for (int i=0; i<MAX_CLIENTS-1; i++)
+			for (int i=0; i<Server()->NumPlayerSlots(); i++)
 			{
 				if (not GameServer()->m_apPlayers[i] or GameServer()->m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS)
 					continue;
 
 				GameServer()->m_apPlayers[i]->Respawn();
 			}
+			m_AllDead = true;
 			Controller()->nextWarioState(); // force the microgame to end
 			return;
 		}
 
-		m_SwitchTargetTick = 175; // 3.5 secs
+		pNinja->m_SwitchTargetTick = 175; // 3.5 secs
 	}
 
-	m_SwitchTargetTick--;
+	pNinja->m_SwitchTargetTick--;
 
 	bool Wall = (GameServer()->Collision()->IntersectLine(Bot->m_Pos, Target->m_Pos, NULL, NULL, false) != 0);
 	int dirX = sign(Target->m_Pos.x - Bot->m_Pos.x);
@@ -166,31 +184,40 @@ void MGNinjaSurvival::OnBotInput(CNetObj_PlayerInput* Input)
 
 	if (not Wall)
 	{
-		m_PathFound = false;
+		pNinja->m_PathFound = false;
 		Input->m_Hook = 0;
 		Input->m_Direction = dirX;
 		Input->m_TargetX = Target->m_Pos.x - Bot->m_Pos.x;
 		Input->m_TargetY = Target->m_Pos.y - Bot->m_Pos.y;
 
-		m_FireTick = (Wall) ? 25 : m_FireTick-1;
-		if (m_FireTick <= 0)
+		pNinja->m_FireTick = (Wall) ? 25 : pNinja->m_FireTick-1;
+		if (pNinja->m_FireTick <= 0)
 		{
 			Input->m_Fire = 1;
-			m_FireTick = 40;
+			pNinja->m_FireTick = 40;
 		}
 		else
 			Input->m_Fire = 0;
 	}
 	else
 	{
-		if (not m_PathFound)
+		// only head for a new tile once the target got a few tiles away from the planned one,
+		// the old path is followed until the new field is built
+		int Width = GameServer()->Collision()->GetWidth();
+		int TargetTile = GameServer()->Collision()->GetPureMapIndex(Target->m_Pos);
+		if (pNinja->m_PathTargetTile < 0 or abs(TargetTile % Width - pNinja->m_PathTargetTile % Width) + abs(TargetTile / Width - pNinja->m_PathTargetTile / Width) > REPLAN_TILES)
 		{
-			FakeTee::pathFind(GameServer(), 0, Target->m_Pos);
-			m_PathFound = true;
+			pNinja->m_PathTargetTile = TargetTile;
+			pNinja->m_PathFound = false;
 		}
-		else
+
+		vec2 PathTarget = vec2(pNinja->m_PathTargetTile % Width, pNinja->m_PathTargetTile / Width) * 32;
+		CNavigation *Navigation = &Controller()->m_Navigation;
+		if (not pNinja->m_PathFound and Navigation->Prepare(PathTarget))
 		{
-			FakeTee::pathFindMove(GameServer(), 0, Input);
+			FakeTee::pathFindField(GameServer(), BotID, PathTarget);
+			pNinja->m_PathFound = true;
 		}
+		FakeTee::pathFindMove(GameServer(), BotID, Input);
 	}
 }
@@ -22,17 +22,28 @@ public:
 	void Tick();
 
 	void OnCharacterDamage(int Victim, int Killer, int Dmg, int Weapon);
-	void OnBotInput(CNetObj_PlayerInput* Input);
+	void OnBotInput(int BotID, CNetObj_PlayerInput* Input);
 
 private:
-	bool m_Moved; // there is a delay before the bot is moved ingame, to sync with music. this bool makes sure the bot isn't moved twice.
+	enum
+	{
+		REPLAN_TILES=3, // how far the target may get from the planned tile
+	};
+
+	bool m_Moved; // there is a delay before the bots are moved ingame, to sync with music. this bool makes sure they aren't moved twice.
+	bool m_AllDead; // the microgame was ended early, the other bots don't end it again
 	int m_startTick;
 
-	// AI stuff
-	int m_FireTick; // ticks to wait before firing. give the player time to react!
-	int m_Target; // current player target
-	int m_SwitchTargetTick; // ticks before switching to another target
-	bool m_PathFound; // if executed pathfind function
+	// AI stuff, every bot is a ninja with its own target
+	struct CNinja
+	{
+		int m_FireTick; // ticks to wait before firing. give the player time to react!
+		int m_Target; // current player target
+		int m_SwitchTargetTick; // ticks before switching to another target
+		bool m_PathFound; // if the path to m_PathTargetTile is loaded
+		int m_PathTargetTile; // map index the bot plans towards, -1 if none
+	};
+	CNinja m_aNinjas[MAX_CLIENTS];
 };
 
 #endif // _MICROGAME_NINJASURVIVAL_H
\ No newline at end of file
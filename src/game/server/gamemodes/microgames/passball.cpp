@@ -9,26 +9,18 @@ MGPassBall::MGPassBall(CGameContext* pGameServer, CGameControllerWarioWare* pCon
 	m_boss = true;
 
 	// load the map's ball spawn and team separator entities
-	int Width = GameServer()->Collision()->GetWidth();
-	int Height = GameServer()->Collision()->GetHeight();
+	const CMapIndex *Index = &Controller()->m_MapIndex;
+	const vec2 *BallSpawns = Index->Tiles(TILE_WARIOWARE_BALLSPAWN);
+	m_BallSpawns.assign(BallSpawns, BallSpawns + Index->NumTiles(TILE_WARIOWARE_BALLSPAWN));
 
 	std::vector<vec2> teamseps;
 	float sepLeft = 0, sepRight = 0;
 
-	for (int i = 0; i < Width * Height; i++)
+	for (int i = 0; i < Index->NumTiles(TILE_WARIOWARE_BALLTEAMSEP); i++)
 	{
-		switch (GameServer()->Collision()->GameLayer()[i].m_Index)
-		{
-			case TILE_WARIOWARE_BALLSPAWN:
-				m_BallSpawns.push_back(vec2(i % Width * 32 + 16, i / Width * 32 + 16));
-				break;
-
-			case TILE_WARIOWARE_BALLTEAMSEP:
-				teamseps.push_back(vec2(i % Width * 32 + 16, i / Width * 32 + 16));
-				sepLeft = (sepLeft > 0) ? min(sepLeft, teamseps.back().x) : teamseps.back().x;
-				sepRight = (sepRight > 0) ? max(sepRight, teamseps.back().x) : teamseps.back().x;
-				break;
-		}
+		teamseps.push_back(Index->Tiles(TILE_WARIOWARE_BALLTEAMSEP)[i]);
+		sepLeft = (sepLeft > 0) ? min(sepLeft, teamseps.back().x) : teamseps.back().x;
+		sepRight = (sepRight > 0) ? max(sepRight, teamseps.back().x) : teamseps.back().x;
 	}
 
 	for (unsigned int i=0; i<teamseps.size(); i++)
@@ -19,7 +19,7 @@ void MGPiggyback::Start()
 	m_pinkys.clear();
 	m_piggybackingWho.clear();
 
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
@@ -84,7 +84,7 @@ void MGPiggyback::Start()
 
 void MGPiggyback::End()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CPlayer *Player = GameServer()->m_apPlayers[i];
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
@@ -12,16 +12,8 @@ MGReachEndNade2::MGReachEndNade2(CGameContext* pGameServer, CGameControllerWario
 	m_boss = false;
 
 	// load the map's nade spawn entities
-	int Width = GameServer()->Collision()->GetWidth();
-	int Height = GameServer()->Collision()->GetHeight();
-
-	for (int i = 0; i < Width * Height; i++)
-	{
-		if (GameServer()->Collision()->GameLayer()[i].m_Index == TILE_WARIOWARE_REACHEND_NADESPAWN)
-		{
-			m_NadeSpawnEntities.push_back(vec2(i % Width * 32 + 16, i / Width * 32 + 16));
-		}
-	}
+	const vec2 *Spawns = Controller()->m_MapIndex.Tiles(TILE_WARIOWARE_REACHEND_NADESPAWN);
+	m_NadeSpawnEntities.assign(Spawns, Spawns + Controller()->m_MapIndex.NumTiles(TILE_WARIOWARE_REACHEND_NADESPAWN));
 
 	char buf[128];
 	str_format(buf, sizeof(buf), "%d total nade spawn entities", m_NadeSpawnEntities.size());
@@ -30,7 +22,7 @@ MGReachEndNade2::MGReachEndNade2(CGameContext* pGameServer, CGameControllerWario
 
 void MGReachEndNade2::Start()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
 		if (not Char) continue;
@@ -48,7 +40,7 @@ void MGReachEndNade2::Start()
 
 void MGReachEndNade2::End()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
 		if (not Char) continue;
@@ -14,7 +14,7 @@ MGTarget::MGTarget(CGameContext* pGameServer, CGameControllerWarioWare* pControl
 
 void MGTarget::Start()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
 		if (not Char) continue;
@@ -33,10 +33,11 @@ void MGTarget::Start()
 	// teleport the bot player (the target)
 	m_UseWeapon = rand() % 4;
 	int bot_tele = 7;
-	int Num = Controller()->m_TeleOuts[bot_tele-1].size();
+	vec2 botPos(0, 0);
+	Controller()->m_MapIndex.RandomTeleOut(bot_tele, &botPos);
 	Server()->SetClientName(MAX_CLIENTS-1, "打我");
 	GameServer()->m_apPlayers[MAX_CLIENTS-1]->SetTeam(0, false); // move to game
-	GameServer()->m_apPlayers[MAX_CLIENTS-1]->ForceSpawn(Controller()->m_TeleOuts[bot_tele-1][(!Num)?Num:rand() % Num]);
+	GameServer()->m_apPlayers[MAX_CLIENTS-1]->ForceSpawn(botPos);
 
 	char aBuf[128];
 	str_format(aBuf, sizeof(aBuf), "用你的%s射击目标!", weaponNames[m_UseWeapon]);
@@ -46,7 +47,7 @@ void MGTarget::Start()
 
 void MGTarget::End()
 {
-	for (int i=0; i<MAX_CLIENTS-1; i++)
+	for (int i=0; i<Server()->NumPlayerSlots(); i++)
 	{
 		CCharacter *Char = GameServer()->GetPlayerChar(i);
 		if (not Char) continue;
@@ -4,7 +4,10 @@
 #include "gameworld.h"
 #include "entity.h"
 #include "gamecontext.h"
+#include "entities/projectile.h"
+#include "teams.h"
 #include <algorithm>
+#include <functional>
 #include <utility>
 #include <engine/shared/config.h>
 
@@ -19,15 +22,36 @@ CGameWorld::CGameWorld()
 	m_Paused = false;
 	m_ResetRequested = false;
 	for(int i = 0; i < NUM_ENTTYPES; i++)
-		m_apFirstEntityTypes[i] = 0;
+	{
+		m_apEntities[i].reserve(64);
+	}
+
+	m_MapRoster = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aMapAnchor[i] = vec2(0, 0);
+		m_aMapViewAnchor[i] = vec2(0, 0);
+		m_aMapRadius[i] = -1.0f;
+		m_aMapValid[i] = false;
+	}
+	m_MapUpdateTime = 0;
+	m_MapUpdates = 0;
+	m_MapUpdateComputed = 0;
+	m_MapUpdateSkipped = 0;
+
+	m_SnapGridTick = -1;
+	m_SnapGridWidth = 0;
+	m_SnapGridHeight = 0;
+	m_SnapStamp = 0;
 }
 
 CGameWorld::~CGameWorld()
 {
 	// delete all entities
 	for(int i = 0; i < NUM_ENTTYPES; i++)
-		while(m_apFirstEntityTypes[i])
-			delete m_apFirstEntityTypes[i];
+		for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+			if(m_apEntities[i][j])
+				delete m_apEntities[i][j];
 }
 
 void CGameWorld::SetGameServer(CGameContext *pGameServer)
@@ -38,7 +62,37 @@ void CGameWorld::SetGameServer(CGameContext *pGameServer)
 
 CEntity *CGameWorld::FindFirst(int Type)
 {
-	return Type < 0 || Type >= NUM_ENTTYPES ? 0 : m_apFirstEntityTypes[Type];
+	if(Type < 0 || Type >= NUM_ENTTYPES)
+		return 0;
+
+	for(int i = (int)m_apEntities[Type].size()-1; i >= 0; i--)
+		if(m_apEntities[Type][i])
+			return m_apEntities[Type][i];
+	return 0;
+}
+
+CEntity *CGameWorld::FindNext(CEntity *pEnt)
+{
+	if(pEnt->m_TypeIndex < 0)
+		return 0;
+
+	std::vector<CEntity *> &vpEnts = m_apEntities[pEnt->m_ObjType];
+	for(int i = pEnt->m_TypeIndex-1; i >= 0; i--)
+		if(vpEnts[i])
+			return vpEnts[i];
+	return 0;
+}
+
+CEntity *CGameWorld::FindPrev(CEntity *pEnt)
+{
+	if(pEnt->m_TypeIndex < 0)
+		return 0;
+
+	std::vector<CEntity *> &vpEnts = m_apEntities[pEnt->m_ObjType];
+	for(int i = pEnt->m_TypeIndex+1; i < (int)vpEnts.size(); i++)
+		if(vpEnts[i])
+			return vpEnts[i];
+	return 0;
 }
 
 int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max, int Type)
@@ -47,8 +101,13 @@ int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max,
 		return 0;
 
 	int Num = 0;
-	for(CEntity *pEnt = m_apFirstEntityTypes[Type];	pEnt; pEnt = pEnt->m_pNextTypeEntity)
+	std::vector<CEntity *> &vpEnts = m_apEntities[Type];
+	for(int i = (int)vpEnts.size()-1; i >= 0; i--)
 	{
+		CEntity *pEnt = vpEnts[i];
+		if(!pEnt)
+			continue;
+
 		if(distance(pEnt->m_Pos, Pos) < Radius+pEnt->m_ProximityRadius)
 		{
 			if(ppEnts)
@@ -65,16 +124,14 @@ int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max,
 void CGameWorld::InsertEntity(CEntity *pEnt)
 {
 #ifdef CONF_DEBUG
-	for(CEntity *pCur = m_apFirstEntityTypes[pEnt->m_ObjType]; pCur; pCur = pCur->m_pNextTypeEntity)
-		dbg_assert(pCur != pEnt, "err");
+	dbg_assert(pEnt->m_TypeIndex == -1, "err");
 #endif
+	if(pEnt->m_TypeIndex != -1)
+		return;
 
 	// insert it
-	if(m_apFirstEntityTypes[pEnt->m_ObjType])
-		m_apFirstEntityTypes[pEnt->m_ObjType]->m_pPrevTypeEntity = pEnt;
-	pEnt->m_pNextTypeEntity = m_apFirstEntityTypes[pEnt->m_ObjType];
-	pEnt->m_pPrevTypeEntity = 0x0;
-	m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt;
+	pEnt->m_TypeIndex = m_apEntities[pEnt->m_ObjType].size();
+	m_apEntities[pEnt->m_ObjType].push_back(pEnt);
 }
 
 void CGameWorld::DestroyEntity(CEntity *pEnt)
@@ -85,47 +142,161 @@ void CGameWorld::DestroyEntity(CEntity *pEnt)
 void CGameWorld::RemoveEntity(CEntity *pEnt)
 {
 	// not in the list
-	if(!pEnt->m_pNextTypeEntity && !pEnt->m_pPrevTypeEntity && m_apFirstEntityTypes[pEnt->m_ObjType] != pEnt)
+	if(pEnt->m_TypeIndex < 0)
 		return;
 
-	// remove
-	if(pEnt->m_pPrevTypeEntity)
-		pEnt->m_pPrevTypeEntity->m_pNextTypeEntity = pEnt->m_pNextTypeEntity;
-	else
-		m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt->m_pNextTypeEntity;
-	if(pEnt->m_pNextTypeEntity)
-		pEnt->m_pNextTypeEntity->m_pPrevTypeEntity = pEnt->m_pPrevTypeEntity;
+	// leave a hole, traversals skip it until the next compaction
+	m_apEntities[pEnt->m_ObjType][pEnt->m_TypeIndex] = 0;
+	m_avHoles[pEnt->m_ObjType].push_back(pEnt->m_TypeIndex);
+	pEnt->m_TypeIndex = -1;
+}
+
+void CGameWorld::CompactEntities(int Type)
+{
+	std::vector<int> &vHoles = m_avHoles[Type];
+	if(vHoles.empty())
+		return;
+
+	// move the last entity into each hole, highest holes first,
+	// so the entity taken from the back is never a hole itself
+	std::sort(vHoles.begin(), vHoles.end(), std::greater<int>());
+	std::vector<CEntity *> &vpEnts = m_apEntities[Type];
+	for(unsigned i = 0; i < vHoles.size(); i++)
+	{
+		CEntity *pLast = vpEnts.back();
+		vpEnts.pop_back();
+		if(vHoles[i] < (int)vpEnts.size())
+		{
+			vpEnts[vHoles[i]] = pLast;
+			pLast->m_TypeIndex = vHoles[i];
+		}
+	}
+	vHoles.clear();
+}
+
+void CGameWorld::SnapGridCell(vec2 Pos, int *pX, int *pY)
+{
+	*pX = clamp((int)floorf(Pos.x) >> SNAPGRID_CELLSHIFT, 0, m_SnapGridWidth-1);
+	*pY = clamp((int)floorf(Pos.y) >> SNAPGRID_CELLSHIFT, 0, m_SnapGridHeight-1);
+}
+
+static bool SnapOrderCompare(CEntity *pA, CEntity *pB)
+{
+	// same order as a full traversal: by type, from the back
+	if(pA->GetObjType() != pB->GetObjType())
+		return pA->GetObjType() < pB->GetObjType();
+	return pA->GetTypeIndex() > pB->GetTypeIndex();
+}
 
-	// keep list traversing valid
-	if(m_pNextTraverseEntity == pEnt)
-		m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+void CGameWorld::BuildSnapGrid()
+{
+	m_SnapGridTick = Server()->Tick();
+	m_SnapGridWidth = max(1, ((GameServer()->Collision()->GetWidth()*32) >> SNAPGRID_CELLSHIFT) + 1);
+	m_SnapGridHeight = max(1, ((GameServer()->Collision()->GetHeight()*32) >> SNAPGRID_CELLSHIFT) + 1);
+
+	int NumCells = m_SnapGridWidth*m_SnapGridHeight;
+	m_aSnapGridStart.assign(NumCells+1, 0);
+	m_apSnapAlways.clear();
+	m_SnapStamp = 0;
+
+	// count, then fill each cell's range of the flat array
+	for(int Pass = 0; Pass < 2; Pass++)
+	{
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+			for(int j = 0; j < (int)m_apEntities[i].size(); j++)
+			{
+				CEntity *pEnt = m_apEntities[i][j];
+				if(!pEnt)
+					continue;
+				pEnt->m_SnapStamp = 0;
+
+				vec2 Min, Max;
+				if(!pEnt->GetSnapBounds(&Min, &Max))
+				{
+					if(Pass == 0)
+						m_apSnapAlways.push_back(pEnt);
+					continue;
+				}
+
+				int x0, y0, x1, y1;
+				SnapGridCell(Min, &x0, &y0);
+				SnapGridCell(Max, &x1, &y1);
+				for(int y = y0; y <= y1; y++)
+					for(int x = x0; x <= x1; x++)
+					{
+						if(Pass == 0)
+							m_aSnapGridStart[y*m_SnapGridWidth+x+1]++;
+						else
+							m_apSnapGrid[m_aSnapGridStart[y*m_SnapGridWidth+x]++] = pEnt;
+					}
+			}
 
-	pEnt->m_pNextTypeEntity = 0;
-	pEnt->m_pPrevTypeEntity = 0;
+		if(Pass == 0)
+		{
+			for(int c = 0; c < NumCells; c++)
+				m_aSnapGridStart[c+1] += m_aSnapGridStart[c];
+			m_apSnapGrid.resize(m_aSnapGridStart[NumCells]);
+		}
+		else
+		{
+			// filling advanced every start to the next cell's start
+			for(int c = NumCells; c > 0; c--)
+				m_aSnapGridStart[c] = m_aSnapGridStart[c-1];
+			m_aSnapGridStart[0] = 0;
+		}
+	}
 }
 
 //
 void CGameWorld::Snap(int SnappingClient)
 {
-	for(int i = 0; i < NUM_ENTTYPES; i++)
-		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+	if(SnappingClient == -1 || !GameServer()->m_apPlayers[SnappingClient])
+	{
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+			for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+				if(m_apEntities[i][j])
+					m_apEntities[i][j]->Snap(SnappingClient);
+		return;
+	}
+
+	if(m_SnapGridTick != Server()->Tick())
+		BuildSnapGrid();
+
+	// collect what lies in the cells around the view, the entities
+	// still do their exact NetworkClipped test in Snap
+	vec2 ViewPos = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos;
+	int x0, y0, x1, y1;
+	SnapGridCell(ViewPos - vec2(1000.0f, 800.0f), &x0, &y0);
+	SnapGridCell(ViewPos + vec2(1000.0f, 800.0f), &x1, &y1);
+
+	m_SnapStamp++;
+	m_apSnapVisible.assign(m_apSnapAlways.begin(), m_apSnapAlways.end());
+	for(int y = y0; y <= y1; y++)
+		for(int x = x0; x <= x1; x++)
 		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Snap(SnappingClient);
-			pEnt = m_pNextTraverseEntity;
+			int Cell = y*m_SnapGridWidth+x;
+			for(int k = m_aSnapGridStart[Cell]; k < m_aSnapGridStart[Cell+1]; k++)
+			{
+				CEntity *pEnt = m_apSnapGrid[k];
+				if(pEnt->m_SnapStamp == m_SnapStamp)
+					continue;
+				pEnt->m_SnapStamp = m_SnapStamp;
+				m_apSnapVisible.push_back(pEnt);
+			}
 		}
+
+	std::sort(m_apSnapVisible.begin(), m_apSnapVisible.end(), SnapOrderCompare);
+	for(unsigned i = 0; i < m_apSnapVisible.size(); i++)
+		m_apSnapVisible[i]->Snap(SnappingClient);
 }
 
 void CGameWorld::Reset()
 {
 	// reset all entities
 	for(int i = 0; i < NUM_ENTTYPES; i++)
-		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
-		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Reset();
-			pEnt = m_pNextTraverseEntity;
-		}
+		for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+			if(m_apEntities[i][j])
+				m_apEntities[i][j]->Reset();
 	RemoveEntities();
 
 	GameServer()->m_pController->PostReset();
@@ -138,16 +309,18 @@ void CGameWorld::RemoveEntities()
 {
 	// destroy objects marked for destruction
 	for(int i = 0; i < NUM_ENTTYPES; i++)
-		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+	{
+		for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
 		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			if(pEnt->m_MarkedForDestroy)
+			CEntity *pEnt = m_apEntities[i][j];
+			if(pEnt && pEnt->m_MarkedForDestroy)
 			{
 				RemoveEntity(pEnt);
 				pEnt->Destroy();
 			}
-			pEnt = m_pNextTraverseEntity;
 		}
+		CompactEntities(i);
+	}
 }
 
 bool distCompare(std::pair<float,int> a, std::pair<float,int> b)
@@ -155,88 +328,173 @@ bool distCompare(std::pair<float,int> a, std::pair<float,int> b)
 	return (a.first < b.first);
 }
 
-void CGameWorld::UpdatePlayerMaps()
+void CGameWorld::UpdatePlayerMap(int ClientID, const bool *pIngame, CCharacter **apChars)
 {
-	if (Server()->Tick() % g_Config.m_SvMapUpdateRate != 0) return;
+	int i = ClientID;
+	int* map = Server()->GetIdMap(i);
+	CPlayer *pPlayer = GameServer()->m_apPlayers[i];
+
+	// copypasted chunk from character.cpp Snap() follows, the part not depending on the target
+	CCharacter* SnapChar = apChars[i];
+	bool HideSolo = SnapChar && !SnapChar->m_Super &&
+		!pPlayer->m_Paused && pPlayer->GetTeam() != -1 &&
+		(pPlayer->m_ClientVersion == VERSION_VANILLA ||
+			(pPlayer->m_ClientVersion >= VERSION_DDRACE && !pPlayer->m_ShowOthers));
+
+	// compute reverse map
+	int rMap[MAX_CLIENTS];
+	for (int j = 0; j < MAX_CLIENTS; j++)
+	{
+		rMap[j] = -1;
+	}
+	for (int j = 0; j < VANILLA_MAX_CLIENTS; j++)
+	{
+		if (map[j] == -1) continue;
+		if (!pIngame[map[j]]) map[j] = -1;
+		else rMap[map[j]] = j;
+	}
 
+	// compute distances
 	std::pair<float,int> dist[MAX_CLIENTS];
-	for (int i = 0; i < MAX_CLIENTS; i++)
+	for (int j = 0; j < MAX_CLIENTS; j++)
 	{
-		if (!Server()->ClientIngame(i)) continue;
-		int* map = Server()->GetIdMap(i);
-
-		// compute distances
-		for (int j = 0; j < MAX_CLIENTS; j++)
+		dist[j].second = j;
+		if (!pIngame[j])
 		{
-			dist[j].second = j;
-			if (!Server()->ClientIngame(j) || !GameServer()->m_apPlayers[j])
-			{
-				dist[j].first = 1e10;
-				continue;
-			}
-			CCharacter* ch = GameServer()->m_apPlayers[j]->GetCharacter();
-			if (!ch)
-			{
-				dist[j].first = 1e9;
-				continue;
-			}
-			// copypasted chunk from character.cpp Snap() follows
-			CCharacter* SnapChar = GameServer()->GetPlayerChar(i);
-			if(SnapChar && !SnapChar->m_Super &&
-				!GameServer()->m_apPlayers[i]->m_Paused && GameServer()->m_apPlayers[i]->GetTeam() != -1 &&
-				!ch->CanCollide(i) &&
-				(!GameServer()->m_apPlayers[i] ||
-					GameServer()->m_apPlayers[i]->m_ClientVersion == VERSION_VANILLA ||
-					(GameServer()->m_apPlayers[i]->m_ClientVersion >= VERSION_DDRACE &&
-					!GameServer()->m_apPlayers[i]->m_ShowOthers
-					)
-				)
-			)
-				dist[j].first = 1e8;
-			else
-				dist[j].first = 0;
-
-			dist[j].first += distance(GameServer()->m_apPlayers[i]->m_ViewPos, GameServer()->m_apPlayers[j]->GetCharacter()->m_Pos);
+			dist[j].first = 1e10;
+			continue;
+		}
+		CCharacter* ch = apChars[j];
+		if (!ch)
+		{
+			dist[j].first = 1e9;
+			continue;
 		}
+		if (HideSolo && !ch->CanCollide(i))
+			dist[j].first = 1e8;
+		else
+			dist[j].first = 0;
 
-		// always send the player himself
-		dist[i].first = 0;
+		dist[j].first += distance(pPlayer->m_ViewPos, ch->m_Pos);
+
+		// keep players that are already mapped unless someone is clearly closer,
+		// vanilla clients see every slot change as flicker
+		if (rMap[j] != -1)
+			dist[j].first = max(dist[j].first - MAPUPDATE_HYSTERESIS, 0.0f);
+	}
 
-		// compute reverse map
-		int rMap[MAX_CLIENTS];
-		for (int j = 0; j < MAX_CLIENTS; j++)
+	// always send the player himself
+	dist[i].first = 0;
+
+	std::nth_element(&dist[0], &dist[VANILLA_MAX_CLIENTS - 1], &dist[MAX_CLIENTS], distCompare);
+
+	// whoever is nearer than the first player left out can change the map by moving
+	float Boundary = dist[VANILLA_MAX_CLIENTS - 1].first;
+	m_aMapRadius[i] = Boundary > 5e9 ? -1.0f : Boundary + MAPUPDATE_HYSTERESIS + 2*MAPUPDATE_MOVE;
+	m_aMapViewAnchor[i] = pPlayer->m_ViewPos;
+	m_aMapValid[i] = true;
+
+	int mapc = 0;
+	int demand = 0;
+	for (int j = 0; j < VANILLA_MAX_CLIENTS - 1; j++)
+	{
+		int k = dist[j].second;
+		if (rMap[k] != -1 || dist[j].first > 5e9) continue;
+		while (mapc < VANILLA_MAX_CLIENTS && map[mapc] != -1) mapc++;
+		if (mapc < VANILLA_MAX_CLIENTS - 1)
+			map[mapc] = k;
+		else
+			demand++;
+	}
+	for (int j = MAX_CLIENTS - 1; j > VANILLA_MAX_CLIENTS - 2; j--)
+	{
+		int k = dist[j].second;
+		if (rMap[k] != -1 && demand-- > 0)
+			map[rMap[k]] = -1;
+	}
+	map[VANILLA_MAX_CLIENTS - 1] = -1; // player with empty name to say chat msgs
+	Server()->UpdateReverseIdMap(i);
+}
+
+void CGameWorld::UpdatePlayerMaps()
+{
+	if (Server()->Tick() % g_Config.m_SvMapUpdateRate != 0) return;
+
+	int64 StartTime = time_get_impl();
+
+	// gather everything that doesn't depend on the pair once
+	bool aIngame[MAX_CLIENTS];
+	CCharacter *apChars[MAX_CLIENTS];
+	unsigned Roster = 2166136261u;
+	for (int j = 0; j < MAX_CLIENTS; j++)
+	{
+		CPlayer *pPlayer = GameServer()->m_apPlayers[j];
+		aIngame[j] = Server()->ClientIngame(j) && pPlayer;
+		apChars[j] = aIngame[j] ? pPlayer->GetCharacter() : 0;
+
+		// anything that changes who can see whom redoes all maps
+		int State = 0;
+		if (aIngame[j])
 		{
-			rMap[j] = -1;
+			State = 1 | (pPlayer->GetTeam()+1) << 1 | (pPlayer->m_Paused ? 1 : 0) << 3 |
+				(pPlayer->m_ShowOthers ? 1 : 0) << 4 | (pPlayer->m_ClientVersion >= VERSION_DDRACE ? 1 : 0) << 5;
+			if (apChars[j])
+				State |= 1 << 6 | (apChars[j]->m_Super ? 1 : 0) << 7 | (apChars[j]->Team()+1) << 8 |
+					(apChars[j]->Teams()->m_Core.GetSolo(j) ? 1 : 0) << 16;
 		}
-		for (int j = 0; j < VANILLA_MAX_CLIENTS; j++)
+		Roster = (Roster ^ State) * 16777619u;
+	}
+	bool RosterChanged = Roster != m_MapRoster;
+	m_MapRoster = Roster;
+
+	// players that moved noticeably since they last triggered an update
+	int aMoved[MAX_CLIENTS];
+	vec2 aMovedFrom[MAX_CLIENTS];
+	int NumMoved = 0;
+	for (int j = 0; j < MAX_CLIENTS; j++)
+	{
+		if (!apChars[j])
+			continue;
+		if (distance(apChars[j]->m_Pos, m_aMapAnchor[j]) > MAPUPDATE_MOVE)
 		{
-			if (map[j] == -1) continue;
-			if (dist[map[j]].first > 5e9) map[j] = -1;
-			else rMap[map[j]] = j;
+			aMoved[NumMoved] = j;
+			aMovedFrom[NumMoved++] = m_aMapAnchor[j];
+			m_aMapAnchor[j] = apChars[j]->m_Pos;
 		}
+	}
 
-		std::nth_element(&dist[0], &dist[VANILLA_MAX_CLIENTS - 1], &dist[MAX_CLIENTS], distCompare);
+	for (int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if (!aIngame[i])
+		{
+			m_aMapValid[i] = false;
+			continue;
+		}
+		// ddnet clients know all 64 ids
+		if (Server()->IsDDNetClient(i))
+			continue;
 
-		int mapc = 0;
-		int demand = 0;
-		for (int j = 0; j < VANILLA_MAX_CLIENTS - 1; j++)
+		bool Dirty = RosterChanged || !m_aMapValid[i] || !g_Config.m_SvMapUpdateIncremental ||
+			distance(GameServer()->m_apPlayers[i]->m_ViewPos, m_aMapViewAnchor[i]) > MAPUPDATE_MOVE;
+		for (int m = 0; m < NumMoved && !Dirty; m++)
 		{
-			int k = dist[j].second;
-			if (rMap[k] != -1 || dist[j].first > 5e9) continue;
-			while (mapc < VANILLA_MAX_CLIENTS && map[mapc] != -1) mapc++;
-			if (mapc < VANILLA_MAX_CLIENTS - 1)
-				map[mapc] = k;
-			else
-				demand++;
+			int j = aMoved[m];
+			if (distance(m_aMapViewAnchor[i], aMovedFrom[m]) < m_aMapRadius[i] ||
+				distance(m_aMapViewAnchor[i], m_aMapAnchor[j]) < m_aMapRadius[i])
+				Dirty = true;
 		}
-		for (int j = MAX_CLIENTS - 1; j > VANILLA_MAX_CLIENTS - 2; j--)
+
+		if (!Dirty)
 		{
-			int k = dist[j].second;
-			if (rMap[k] != -1 && demand-- > 0)
-				map[rMap[k]] = -1;
+			m_MapUpdateSkipped++;
+			continue;
 		}
-		map[VANILLA_MAX_CLIENTS - 1] = -1; // player with empty name to say chat msgs
+		UpdatePlayerMap(i, aIngame, apChars);
+		m_MapUpdateComputed++;
 	}
+
+	m_MapUpdateTime += time_get_impl() - StartTime;
+	m_MapUpdates++;
 }
 
 void CGameWorld::Tick()
@@ -248,38 +506,32 @@ void CGameWorld::Tick()
 	{
 		if(GameServer()->m_pController->IsForceBalanced())
 			GameServer()->SendChat(-1, CGameContext::CHAT_ALL, "Teams have been balanced");
+		CProjectile::TickBatch(this);
+
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
-			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
-			{
-				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-				pEnt->Tick();
-				pEnt = m_pNextTraverseEntity;
-			}
+			for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+				if(m_apEntities[i][j])
+					m_apEntities[i][j]->Tick();
 
 		for(int i = 0; i < NUM_ENTTYPES; i++)
-			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
-			{
-				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-				pEnt->TickDefered();
-				pEnt = m_pNextTraverseEntity;
-			}
+			for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+				if(m_apEntities[i][j])
+					m_apEntities[i][j]->TickDefered();
 	}
 	else
 	{
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
-			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
-			{
-				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-				pEnt->TickPaused();
-				pEnt = m_pNextTraverseEntity;
-			}
+			for(int j = (int)m_apEntities[i].size()-1; j >= 0; j--)
+				if(m_apEntities[i][j])
+					m_apEntities[i][j]->TickPaused();
 	}
 
 	RemoveEntities();
 
-	UpdatePlayerMaps();
+	if(Server()->OverloadLevel() < IServer::OVERLOAD_PLAYER_MAPS || Server()->Tick()%4 == 0)
+		UpdatePlayerMaps();
 }
 
 // TODO: should be more general
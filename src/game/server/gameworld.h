@@ -6,6 +6,7 @@
 #include <game/gamecore.h>
 
 #include <list>
+#include <vector>
 
 class CEntity;
 class CCharacter;
@@ -31,14 +32,48 @@ public:
 private:
 	void Reset();
 	void RemoveEntities();
+	void CompactEntities(int Type);
 
-	CEntity *m_pNextTraverseEntity;
-	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
+	// pointers to the live entities of each type, traversed from the back.
+	// removed entities leave a hole so slots don't move while anything
+	// iterates over them, RemoveEntities fills the holes with the last entities
+	std::vector<CEntity *> m_apEntities[NUM_ENTTYPES];
+	std::vector<int> m_avHoles[NUM_ENTTYPES];
+
+	// coarse grid of the entities' snap bounds, rebuilt once per snap tick
+	enum
+	{
+		SNAPGRID_CELLSHIFT = 9, // 512 units, 16 tiles
+	};
+	int m_SnapGridTick;
+	int m_SnapGridWidth;
+	int m_SnapGridHeight;
+	int m_SnapStamp;
+	std::vector<int> m_aSnapGridStart;
+	std::vector<CEntity *> m_apSnapGrid;
+	std::vector<CEntity *> m_apSnapAlways;
+	std::vector<CEntity *> m_apSnapVisible;
+
+	void SnapGridCell(vec2 Pos, int *pX, int *pY);
+	void BuildSnapGrid();
 
 	class CGameContext *m_pGameServer;
 	class IServer *m_pServer;
 
 	void UpdatePlayerMaps();
+	void UpdatePlayerMap(int ClientID, const bool *pIngame, CCharacter **apChars);
+
+	// incremental id map updates
+	enum
+	{
+		MAPUPDATE_MOVE = 128, // how far things move before maps are redone
+		MAPUPDATE_HYSTERESIS = 100, // head start of already mapped players
+	};
+	unsigned m_MapRoster;
+	vec2 m_aMapAnchor[MAX_CLIENTS];
+	vec2 m_aMapViewAnchor[MAX_CLIENTS];
+	float m_aMapRadius[MAX_CLIENTS];
+	bool m_aMapValid[MAX_CLIENTS];
 
 public:
 	class CGameContext *GameServer() { return m_pGameServer; }
@@ -53,7 +88,15 @@ public:
 
 	void SetGameServer(CGameContext *pGameServer);
 
+	// id map update cost, see map_update_stats
+	int64 m_MapUpdateTime;
+	int m_MapUpdates;
+	int m_MapUpdateComputed;
+	int m_MapUpdateSkipped;
+
 	CEntity *FindFirst(int Type);
+	CEntity *FindNext(CEntity *pEnt);
+	CEntity *FindPrev(CEntity *pEnt);
 
 	/*
 		Function: find_entities
@@ -0,0 +1,232 @@
+#include <engine/shared/config.h>
+#include <game/mapindex.h>
+#include <game/mapitems.h>
+
+#include "gamecontext.h"
+#include "navigation.h"
+
+CNavigation::CNavigation()
+{
+	m_pGameServer = 0;
+	m_pMapIndex = 0;
+	m_Width = 0;
+	m_Height = 0;
+	m_UseCounter = 0;
+	m_NumFieldsBuilt = 0;
+}
+
+void CNavigation::Init(CGameContext *pGameServer, const CMapIndex *pMapIndex)
+{
+	m_pGameServer = pGameServer;
+	m_pMapIndex = pMapIndex;
+
+	CCollision *pCollision = pGameServer->Collision();
+	m_Width = pCollision->GetWidth();
+	m_Height = pCollision->GetHeight();
+	m_vFields.clear();
+
+	// same tile rules as the FakeTee pathfinder
+	CTeleTile *pTele = pCollision->TeleLayer();
+	m_vTileFlags.assign(m_Width*m_Height, 0);
+	for(int i = 0; i < m_Width*m_Height; i++)
+	{
+		vec2 Pos(i % m_Width * 32, i / m_Width * 32);
+		int Tile = pCollision->GetTileIndex(pCollision->GetMapIndex(Pos));
+		if(Tile != TILE_DEATH && !pCollision->CheckPoint(Pos))
+			m_vTileFlags[i] |= TILEFLAG_WALKABLE;
+		if(Tile == TILE_FREEZE)
+			m_vTileFlags[i] |= TILEFLAG_FREEZE;
+		else if(Tile == TILE_UNFREEZE)
+			m_vTileFlags[i] |= TILEFLAG_UNFREEZE;
+		if(pTele && pTele[i].m_Number > 0 && (pTele[i].m_Type == TILE_TELEIN || pTele[i].m_Type == TILE_TELEINEVIL))
+			m_vTileFlags[i] |= TILEFLAG_TELEIN;
+	}
+}
+
+int CNavigation::TeleIn(int Index) const
+{
+	return m_pGameServer->Collision()->TeleLayer()[Index].m_Number;
+}
+
+void CNavigation::StartField(CField *pField, int Target)
+{
+	pField->m_Target = Target;
+	pField->m_vDist.assign(m_Width*m_Height, (unsigned short)UNREACHABLE);
+	pField->m_vQueue.clear();
+	pField->m_QueuePos = 0;
+	pField->m_Complete = !(m_vTileFlags[Target]&TILEFLAG_WALKABLE);
+	m_NumFieldsBuilt++;
+
+	if(pField->m_Complete)
+		return;
+	pField->m_vQueue.push_back(Target);
+	pField->m_vDist[Target] = 0;
+}
+
+int CNavigation::ExpandField(CField *pField, int Budget)
+{
+	// every move costs one step, so a breadth first pass backwards
+	// from the target gives the same distances as dijkstra
+	CTeleTile *pTele = m_pGameServer->Collision()->TeleLayer();
+	const int aDirs[4][2] = {{0, 1}, {-1, 0}, {1, 0}, {0, -1}};
+	int Used = 0;
+	for(; Used < Budget && pField->m_QueuePos < pField->m_vQueue.size(); Used++)
+	{
+		int u = pField->m_vQueue[pField->m_QueuePos++];
+		int Dist = min((int)pField->m_vDist[u]+1, UNREACHABLE-1);
+		int x = u % m_Width;
+		int y = u / m_Width;
+
+		// tiles that can step onto u
+		for(int d = 0; d < 4; d++)
+		{
+			int vx = x - aDirs[d][0];
+			int vy = y - aDirs[d][1];
+			if(vx < 0 || vy < 0 || vx >= m_Width || vy >= m_Height)
+				continue;
+			int v = vy*m_Width+vx;
+			int Flags = m_vTileFlags[v];
+			if(!(Flags&TILEFLAG_WALKABLE) || (Flags&TILEFLAG_TELEIN) || pField->m_vDist[v] != UNREACHABLE)
+				continue;
+			if((Flags&TILEFLAG_FREEZE) && !(m_vTileFlags[u]&TILEFLAG_UNFREEZE))
+				continue;
+			pField->m_vDist[v] = Dist;
+			pField->m_vQueue.push_back(v);
+		}
+
+		// tele ins that lead to u
+		if(pTele && pTele[u].m_Type == TILE_TELEOUT && pTele[u].m_Number > 0)
+		{
+			int Number = pTele[u].m_Number;
+			for(int k = 0; k < 2; k++)
+			{
+				int Num = k ? m_pMapIndex->NumEvilTeleIns(Number) : m_pMapIndex->NumTeleIns(Number);
+				const int *pIns = k ? m_pMapIndex->EvilTeleIns(Number) : m_pMapIndex->TeleIns(Number);
+				for(int i = 0; i < Num; i++)
+				{
+					int v = pIns[i];
+					if(!(m_vTileFlags[v]&TILEFLAG_WALKABLE) || pField->m_vDist[v] != UNREACHABLE)
+						continue;
+					pField->m_vDist[v] = Dist;
+					pField->m_vQueue.push_back(v);
+				}
+			}
+		}
+	}
+
+	if(pField->m_QueuePos == pField->m_vQueue.size())
+	{
+		pField->m_Complete = true;
+		std::vector<int>().swap(pField->m_vQueue);
+	}
+	return Used;
+}
+
+CNavigation::CField *CNavigation::GetField(int Target)
+{
+	m_UseCounter++;
+	for(unsigned i = 0; i < m_vFields.size(); i++)
+	{
+		if(m_vFields[i].m_Target == Target)
+		{
+			m_vFields[i].m_LastUse = m_UseCounter;
+			return &m_vFields[i];
+		}
+	}
+
+	// replace the least recently used field when the cache is full
+	CField *pField;
+	if((int)m_vFields.size() < g_Config.m_WwNavFields)
+	{
+		m_vFields.push_back(CField());
+		pField = &m_vFields.back();
+	}
+	else
+	{
+		pField = &m_vFields[0];
+		for(unsigned i = 1; i < m_vFields.size(); i++)
+			if(m_vFields[i].m_LastUse < pField->m_LastUse)
+				pField = &m_vFields[i];
+	}
+
+	StartField(pField, Target);
+	pField->m_LastUse = m_UseCounter;
+	return pField;
+}
+
+void CNavigation::Tick()
+{
+	int Budget = g_Config.m_WwBotPathBudget;
+	if(m_pGameServer && m_pGameServer->Server()->OverloadLevel() >= IServer::OVERLOAD_BOTS)
+		Budget = max(Budget/4, 1);
+
+	// the most recently requested fields first
+	while(Budget > 0)
+	{
+		CField *pField = 0;
+		for(unsigned i = 0; i < m_vFields.size(); i++)
+			if(!m_vFields[i].m_Complete && (!pField || m_vFields[i].m_LastUse > pField->m_LastUse))
+				pField = &m_vFields[i];
+		if(!pField)
+			break;
+		Budget -= ExpandField(pField, Budget);
+	}
+}
+
+bool CNavigation::Prepare(vec2 Target)
+{
+	if(!m_Width)
+		return false;
+	return GetField(m_pGameServer->Collision()->GetPureMapIndex(Target))->m_Complete;
+}
+
+bool CNavigation::Path(vec2 Target, vec2 Pos, std::vector<vec2> *pPath, int MaxSteps)
+{
+	pPath->clear();
+	if(!m_Width)
+		return false;
+
+	const CField *pField = GetField(m_pGameServer->Collision()->GetPureMapIndex(Target));
+	int u = m_pGameServer->Collision()->GetPureMapIndex(Pos);
+	if(!pField->m_Complete || pField->m_vDist[u] == UNREACHABLE)
+		return false;
+
+	// walk downhill, the moves are the same ones the field was built from
+	const int aDirs[4][2] = {{0, 1}, {-1, 0}, {1, 0}, {0, -1}};
+	pPath->push_back(vec2(u % m_Width, u / m_Width)*32);
+	while(pField->m_vDist[u] > 0 && (int)pPath->size() < MaxSteps)
+	{
+		int Best = -1;
+		if(m_vTileFlags[u]&TILEFLAG_TELEIN)
+		{
+			int Number = TeleIn(u);
+			for(int i = 0; i < m_pMapIndex->NumTeleOuts(Number); i++)
+			{
+				int v = m_pGameServer->Collision()->GetPureMapIndex(m_pMapIndex->TeleOuts(Number)[i]);
+				if(Best == -1 || pField->m_vDist[v] < pField->m_vDist[Best])
+					Best = v;
+			}
+		}
+		else
+		{
+			for(int d = 0; d < 4; d++)
+			{
+				int vx = u % m_Width + aDirs[d][0];
+				int vy = u / m_Width + aDirs[d][1];
+				if(vx < 0 || vy < 0 || vx >= m_Width || vy >= m_Height)
+					continue;
+				int v = vy*m_Width+vx;
+				if((m_vTileFlags[u]&TILEFLAG_FREEZE) && !(m_vTileFlags[v]&TILEFLAG_UNFREEZE))
+					continue;
+				if(Best == -1 || pField->m_vDist[v] < pField->m_vDist[Best])
+					Best = v;
+			}
+		}
+
+		if(Best == -1 || pField->m_vDist[Best] >= pField->m_vDist[u])
+			break;
+		u = Best;
+		pPath->push_back(vec2(u % m_Width, u / m_Width)*32);
+	}
+	return true;
+}
@@ -0,0 +1,66 @@
+#ifndef GAME_SERVER_NAVIGATION_H
+#define GAME_SERVER_NAVIGATION_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+/*
+	Distance fields for bot navigation. A field holds, for every tile, the
+	number of steps to one target tile over the same moves the bot
+	pathfinder uses (walking, jumping, leaving freeze through unfreeze and
+	teleporters). Fields are built per target tile on request, spread over
+	several ticks, and shared by every bot heading there.
+*/
+class CNavigation
+{
+	enum
+	{
+		TILEFLAG_WALKABLE=1,
+		TILEFLAG_FREEZE=2,
+		TILEFLAG_UNFREEZE=4,
+		TILEFLAG_TELEIN=8,
+
+		UNREACHABLE=0xffff,
+	};
+
+	struct CField
+	{
+		int m_Target;
+		int m_LastUse;
+		bool m_Complete;
+		unsigned m_QueuePos;
+		std::vector<int> m_vQueue; // emptied once the field is complete
+		std::vector<unsigned short> m_vDist;
+	};
+
+	class CGameContext *m_pGameServer;
+	const class CMapIndex *m_pMapIndex;
+	int m_Width;
+	int m_Height;
+	std::vector<unsigned char> m_vTileFlags;
+	std::vector<CField> m_vFields;
+	int m_UseCounter;
+
+	void StartField(CField *pField, int Target);
+	int ExpandField(CField *pField, int Budget);
+	CField *GetField(int Target);
+	int TeleIn(int Index) const;
+
+public:
+	CNavigation();
+
+	void Init(class CGameContext *pGameServer, const class CMapIndex *pMapIndex);
+	// builds the requested fields further, at most ww_bot_path_budget tiles per tick
+	void Tick();
+
+	// starts building the field of Target's tile if needed, true once it is complete
+	bool Prepare(vec2 Target);
+	// tile positions from Pos to Target, at most MaxSteps long, false until
+	// the field is complete or if Pos can't reach Target
+	bool Path(vec2 Target, vec2 Pos, std::vector<vec2> *pPath, int MaxSteps);
+
+	int m_NumFieldsBuilt;
+};
+
+#endif
@@ -30,6 +30,8 @@ CPlayer::CPlayer(CGameContext *pGameServer, int ClientID, int Team)
 	m_LockInfo = false;
 	m_TimerToSpawn = -1.f;
 	m_SetTimerOnSpawn = false;
+	m_ClientInfoVersion = -1;
+	m_ClientInfoTick = -1;
 	Reset();
 }
 
@@ -58,6 +60,7 @@ void CPlayer::Reset()
 		idMap[i] = -1;
 	}
 	idMap[0] = m_ClientID;
+	Server()->UpdateReverseIdMap(m_ClientID);
 
 	// DDRace
 
@@ -113,6 +116,7 @@ void CPlayer::Reset()
 	GameServer()->Score()->PlayerData(m_ClientID)->Reset();
 
 	m_ClientVersion = VERSION_VANILLA;
+	Server()->SetClientDDNet(m_ClientID, false);
 	m_VersionSpam = 0;
 	m_ShowOthers = g_Config.m_SvShowOthersDefault;
 	m_ShowAll = g_Config.m_SvShowAllDefault;
@@ -149,7 +153,7 @@ void CPlayer::Reset()
 
 void CPlayer::Tick()
 {
-	if(m_ClientID < MAX_CLIENTS-1)
+	if(!Server()->IsBot(m_ClientID))
 		if(!Server()->ClientIngame(m_ClientID))
 			return;
 
@@ -213,6 +217,7 @@ void CPlayer::Tick()
 				{
 					if(m_ForcePauseTime == 0)
 					m_Paused = PAUSED_NONE;
+					GameServer()->InvalidateTeamMasks();
 					ProcessPause();
 				}
 				else if(m_Paused == PAUSED_PAUSED && m_NextPauseTick < Server()->Tick())
@@ -273,7 +278,7 @@ void CPlayer::PostTick()
 
 void CPlayer::PostPostTick()
 {
-	if(m_ClientID < MAX_CLIENTS-1)
+	if(!Server()->IsBot(m_ClientID))
 		if(!Server()->ClientIngame(m_ClientID))
 			return;
 
@@ -296,7 +301,7 @@ void CPlayer::PostPostTick()
 
 void CPlayer::Snap(int SnappingClient)
 {
-	if(m_ClientID < MAX_CLIENTS-1)
+	if(!Server()->IsBot(m_ClientID))
 		if(!Server()->ClientIngame(m_ClientID))
 			return;
 
@@ -308,22 +313,11 @@ void CPlayer::Snap(int SnappingClient)
 	if(!pClientInfo)
 		return;
 
-	StrToInts(&pClientInfo->m_Name0, 4, Server()->ClientName(m_ClientID));
-	StrToInts(&pClientInfo->m_Clan0, 3, Server()->ClientClan(m_ClientID));
-	pClientInfo->m_Country = Server()->ClientCountry(m_ClientID);
+	UpdateClientInfo();
 	if (m_StolenSkin && SnappingClient != m_ClientID && g_Config.m_SvSkinStealAction == 1)
-	{
-		StrToInts(&pClientInfo->m_Skin0, 6, "pinky");
-		pClientInfo->m_UseCustomColor = 0;
-		pClientInfo->m_ColorBody = m_TeeInfos.m_ColorBody;
-		pClientInfo->m_ColorFeet = m_TeeInfos.m_ColorFeet;
-	} else
-	{
-		StrToInts(&pClientInfo->m_Skin0, 6, m_TeeInfos.m_aSkinName);
-		pClientInfo->m_UseCustomColor = m_TeeInfos.m_UseCustomColor;
-		pClientInfo->m_ColorBody = m_TeeInfos.m_ColorBody;
-		pClientInfo->m_ColorFeet = m_TeeInfos.m_ColorFeet;
-	}
+		mem_copy(pClientInfo, &m_StolenClientInfo, sizeof(CNetObj_ClientInfo));
+	else
+		mem_copy(pClientInfo, &m_ClientInfo, sizeof(CNetObj_ClientInfo));
 
 	CNetObj_PlayerInfo *pPlayerInfo = static_cast<CNetObj_PlayerInfo *>(Server()->SnapNewItem(NETOBJTYPE_PLAYERINFO, id, sizeof(CNetObj_PlayerInfo)));
 	if(!pPlayerInfo)
@@ -359,8 +353,6 @@ void CPlayer::FakeSnap(int SnappingClient)
 {
 	// This is problematic when it's sent before we know whether it's a non-64-player-client
 	// Then we can't spectate players at the start
-	IServer::CClientInfo info;
-	Server()->GetClientInfo(SnappingClient, &info);
 	CGameContext *GameContext = (CGameContext *) GameServer();
 	if (SnappingClient > -1 && GameContext->m_apPlayers[SnappingClient] && GameContext->m_apPlayers[SnappingClient]->m_ClientVersion >= VERSION_DDNET_OLD)
 		return;
@@ -372,9 +364,36 @@ void CPlayer::FakeSnap(int SnappingClient)
 	if(!pClientInfo)
 		return;
 
+	UpdateClientInfo();
 	StrToInts(&pClientInfo->m_Name0, 4, " ");
-	StrToInts(&pClientInfo->m_Clan0, 3, Server()->ClientClan(m_ClientID));
-	StrToInts(&pClientInfo->m_Skin0, 6, m_TeeInfos.m_aSkinName);
+	mem_copy(&pClientInfo->m_Clan0, &m_ClientInfo.m_Clan0, 3*sizeof(int));
+	mem_copy(&pClientInfo->m_Skin0, &m_ClientInfo.m_Skin0, 6*sizeof(int));
+}
+
+void CPlayer::UpdateClientInfo()
+{
+	// skins are written directly by lots of code, so compare them once per tick
+	if(m_ClientInfoTick == Server()->Tick())
+		return;
+	m_ClientInfoTick = Server()->Tick();
+
+	int Version = Server()->ClientInfoVersion(m_ClientID);
+	if(Version == m_ClientInfoVersion && mem_comp(&m_ClientInfoTee, &m_TeeInfos, sizeof(CTeeInfo)) == 0)
+		return;
+	m_ClientInfoVersion = Version;
+	mem_copy(&m_ClientInfoTee, &m_TeeInfos, sizeof(CTeeInfo));
+
+	StrToInts(&m_ClientInfo.m_Name0, 4, Server()->ClientName(m_ClientID));
+	StrToInts(&m_ClientInfo.m_Clan0, 3, Server()->ClientClan(m_ClientID));
+	m_ClientInfo.m_Country = Server()->ClientCountry(m_ClientID);
+	StrToInts(&m_ClientInfo.m_Skin0, 6, m_TeeInfos.m_aSkinName);
+	m_ClientInfo.m_UseCustomColor = m_TeeInfos.m_UseCustomColor;
+	m_ClientInfo.m_ColorBody = m_TeeInfos.m_ColorBody;
+	m_ClientInfo.m_ColorFeet = m_TeeInfos.m_ColorFeet;
+
+	mem_copy(&m_StolenClientInfo, &m_ClientInfo, sizeof(CNetObj_ClientInfo));
+	StrToInts(&m_StolenClientInfo.m_Skin0, 6, "pinky");
+	m_StolenClientInfo.m_UseCustomColor = 0;
 }
 
 void CPlayer::OnDisconnect(const char *pReason)
@@ -547,6 +566,7 @@ void CPlayer::SetTeam(int Team, bool DoChatMsg)
 				GameServer()->m_apPlayers[i]->m_SpectatorID = SPEC_FREEVIEW;
 		}
 	}
+	GameServer()->InvalidateTeamMasks();
 
 	Server()->ExpireServerInfo();
 }
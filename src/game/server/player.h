@@ -124,6 +124,14 @@ private:
 	CGameContext *GameServer() const { return m_pGameServer; }
 	IServer *Server() const;
 
+	// wire encoded client info, shared by all snapping clients
+	void UpdateClientInfo();
+	CNetObj_ClientInfo m_ClientInfo;
+	CNetObj_ClientInfo m_StolenClientInfo; // "pinky" variant for stolen skins
+	CTeeInfo m_ClientInfoTee;
+	int m_ClientInfoVersion;
+	int m_ClientInfoTick;
+
 	//
 	bool m_Spawning;
 	bool m_WeakHookSpawn;
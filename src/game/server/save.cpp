@@ -98,6 +98,7 @@ void CSaveTee::load(CCharacter* pchr, int Team)
 
 	pchr->Teams()->SetForceCharacterTeam(pchr->m_pPlayer->GetCID(), Team);
 	pchr->Teams()->m_Core.SetSolo(pchr->m_pPlayer->GetCID(), m_IsSolo);
+	pchr->Teams()->InvalidateTeamMasks();
 	pchr->Teams()->SetFinished(pchr->m_pPlayer->GetCID(), m_TeeFinished);
 
 	for(int i = 0; i< NUM_WEAPONS; i++)
@@ -249,7 +250,7 @@ int CSaveTeam::save(int Team)
 
 			for(int i=1; i < m_pController->GameServer()->Collision()->m_NumSwitchers+1; i++)
 			{
-				m_Switchers[i].m_Status = m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Status[Team];
+				m_Switchers[i].m_Status = m_pController->GameServer()->Collision()->m_pSwitchers[i].Status(Team);
 				if(m_pController->GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team])
 					m_Switchers[i].m_EndTime = m_pController->Server()->Tick() - m_pController->GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team];
 				else
@@ -300,10 +301,12 @@ int CSaveTeam::load(int Team)
 	if(m_pController->GameServer()->Collision()->m_NumSwitchers)
 		for(int i=1; i < m_pController->GameServer()->Collision()->m_NumSwitchers+1; i++)
 		{
-			m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Status[Team] = m_Switchers[i].m_Status;
+			m_pController->GameServer()->Collision()->m_pSwitchers[i].SetStatus(Team, m_Switchers[i].m_Status);
 			if(m_Switchers[i].m_EndTime)
 				m_pController->GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team] = m_pController->Server()->Tick() - m_Switchers[i].m_EndTime;
 			m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Type[Team] = m_Switchers[i].m_Type;
+			if(m_Switchers[i].m_Type == TILE_SWITCHTIMEDOPEN || m_Switchers[i].m_Type == TILE_SWITCHTIMEDCLOSE)
+				m_pController->GameServer()->Collision()->ScheduleSwitch(i, Team);
 		}
 	return 0;
 }
@@ -43,6 +43,9 @@ public:
 
 	CPlayerData *PlayerData(int ID) { return &m_aPlayerData[ID]; }
 
+	// called every tick on the game thread
+	virtual void Tick() {}
+
 	virtual void MapInfo(int ClientID, const char* MapName) = 0;
 	virtual void MapVote(int ClientID, const char* MapName) = 0;
 	virtual void CheckBirthday(int ClientID) = 0;
@@ -65,6 +68,9 @@ public:
 
 	virtual void SaveTeam(int Team, const char* Code, int ClientID, const char* Server) = 0;
 	virtual void LoadTeam(const char* Code, int ClientID) = 0;
+
+	// finishes that are not in the database yet
+	virtual void PrintSpool(IConsole *pConsole) { pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "score", "scores are written directly, nothing is spooled"); }
 };
 
 #endif
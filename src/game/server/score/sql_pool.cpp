@@ -0,0 +1,282 @@
+#if defined(CONF_SQL)
+#include <engine/shared/config.h>
+
+#include "sql_pool.h"
+
+CSqlConnection::CSqlConnection()
+{
+	m_pDriver = 0;
+	m_pConnection = 0;
+	m_pStatement = 0;
+	m_pResults = 0;
+	m_LastUse = 0;
+	m_Broken = false;
+}
+
+CSqlConnection::~CSqlConnection()
+{
+	Disconnect();
+}
+
+bool CSqlConnection::Check()
+{
+	try
+	{
+		delete m_pStatement->executeQuery("SELECT 1;");
+		return true;
+	}
+	catch (sql::SQLException &e)
+	{
+		dbg_msg("SQL", "connection lost: %s", e.what());
+		return false;
+	}
+}
+
+bool CSqlConnection::Connect()
+{
+	if(m_pConnection)
+	{
+		bool NeedCheck = m_Broken || time_get() > m_LastUse + time_freq()*CHECK_INTERVAL;
+		if(!NeedCheck || Check())
+		{
+			m_Broken = false;
+			m_LastUse = time_get();
+			return true;
+		}
+		Disconnect();
+	}
+
+	try
+	{
+		char aBuf[256];
+
+		sql::ConnectOptionsMap connection_properties;
+		connection_properties["hostName"]      = sql::SQLString(g_Config.m_SvSqlIp);
+		connection_properties["port"]          = g_Config.m_SvSqlPort;
+		connection_properties["userName"]      = sql::SQLString(g_Config.m_SvSqlUser);
+		connection_properties["password"]      = sql::SQLString(g_Config.m_SvSqlPw);
+		connection_properties["OPT_RECONNECT"] = true;
+
+		// Create connection
+		m_pDriver = get_driver_instance();
+		m_pConnection = m_pDriver->connect(connection_properties);
+
+		// Create Statement
+		m_pStatement = m_pConnection->createStatement();
+
+		// Create database if not exists
+		if(g_Config.m_SvSqlCreateTables)
+		{
+			str_format(aBuf, sizeof(aBuf), "CREATE DATABASE IF NOT EXISTS %s", g_Config.m_SvSqlDatabase);
+			m_pStatement->execute(aBuf);
+		}
+
+		// Connect to specific database
+		m_pConnection->setSchema(g_Config.m_SvSqlDatabase);
+		dbg_msg("SQL", "SQL connection established");
+		m_Broken = false;
+		m_LastUse = time_get();
+		return true;
+	}
+	catch (sql::SQLException &e)
+	{
+		dbg_msg("SQL", "MySQL Error: %s", e.what());
+	}
+	catch (const std::exception& ex)
+	{
+		dbg_msg("SQL", "1 %s", ex.what());
+	}
+	catch (...)
+	{
+		dbg_msg("SQL", "Unknown Error cause by the MySQL/C++ Connector, my advice compile server_debug and use it");
+	}
+
+	dbg_msg("SQL", "ERROR: SQL connection failed");
+	Disconnect();
+	return false;
+}
+
+void CSqlConnection::Disconnect()
+{
+	try
+	{
+		for(std::map<std::string, sql::PreparedStatement *>::iterator it = m_PreparedStatements.begin(); it != m_PreparedStatements.end(); ++it)
+			delete it->second;
+		delete m_pStatement;
+		delete m_pConnection;
+	}
+	catch (sql::SQLException &e)
+	{
+		dbg_msg("SQL", "ERROR: No SQL connection");
+	}
+	m_PreparedStatements.clear();
+	m_pStatement = 0;
+	m_pConnection = 0;
+}
+
+sql::PreparedStatement *CSqlConnection::Prepare(const char *pQuery)
+{
+	std::map<std::string, sql::PreparedStatement *>::iterator it = m_PreparedStatements.find(pQuery);
+	if(it != m_PreparedStatements.end())
+		return it->second;
+
+	sql::PreparedStatement *pStatement = m_pConnection->prepareStatement(pQuery);
+	m_PreparedStatements[pQuery] = pStatement;
+	return pStatement;
+}
+
+void CSqlConnection::Begin()
+{
+	m_pConnection->setAutoCommit(false);
+}
+
+void CSqlConnection::Commit()
+{
+	m_pConnection->commit();
+	m_pConnection->setAutoCommit(true);
+}
+
+void CSqlConnection::Rollback()
+{
+	try
+	{
+		m_pConnection->rollback();
+		m_pConnection->setAutoCommit(true);
+	}
+	catch (sql::SQLException &e)
+	{
+		dbg_msg("SQL", "ERROR: rollback failed: %s", e.what());
+	}
+	m_Broken = true;
+}
+
+CSqlPool::CSqlPool()
+{
+	m_QueueSize = 0;
+	m_NumQueued = 0;
+}
+
+CSqlPool::~CSqlPool()
+{
+	Shutdown();
+}
+
+void CSqlPool::Init(int NumWorkers, int QueueSize)
+{
+	if(!m_vpWorkers.empty())
+		return;
+
+	m_QueueSize = QueueSize;
+	semaphore_init(&m_Semaphore);
+	for(int i = 0; i < NumWorkers; i++)
+	{
+		CWorker *pWorker = new CWorker;
+		pWorker->m_pPool = this;
+		pWorker->m_pThread = thread_init(WorkerThread, pWorker);
+		m_vpWorkers.push_back(pWorker);
+	}
+}
+
+void CSqlPool::Shutdown()
+{
+	if(m_vpWorkers.empty())
+		return;
+
+	// one extra wakeup per worker, they leave once the queue is empty
+	for(unsigned i = 0; i < m_vpWorkers.size(); i++)
+		semaphore_signal(&m_Semaphore);
+	for(unsigned i = 0; i < m_vpWorkers.size(); i++)
+	{
+		thread_wait(m_vpWorkers[i]->m_pThread);
+		delete m_vpWorkers[i];
+	}
+	m_vpWorkers.clear();
+	semaphore_destroy(&m_Semaphore);
+
+	CLockScope ls(m_DoneLock);
+	for(unsigned i = 0; i < m_vpDone.size(); i++)
+		delete m_vpDone[i];
+	m_vpDone.clear();
+}
+
+void CSqlPool::WorkerThread(void *pUser)
+{
+	CWorker *pWorker = (CWorker *)pUser;
+	pWorker->m_pPool->RunLoop(&pWorker->m_Connection);
+}
+
+void CSqlPool::RunLoop(CSqlConnection *pSql)
+{
+	while(true)
+	{
+		semaphore_wait(&m_Semaphore);
+
+		ISqlJob *pJob = 0;
+		{
+			CLockScope ls(m_Lock);
+			for(int i = 0; i < NUM_PRIORITIES && !pJob; i++)
+			{
+				if(!m_aQueues[i].empty())
+				{
+					pJob = m_aQueues[i].front();
+					m_aQueues[i].pop_front();
+					m_NumQueued--;
+				}
+			}
+		}
+		if(!pJob)
+			return;
+
+		try
+		{
+			pJob->Run(pSql);
+		}
+		catch (sql::SQLException &e)
+		{
+			dbg_msg("SQL", "MySQL Error: %s", e.what());
+			pSql->SetBroken();
+		}
+
+		CLockScope ls(m_DoneLock);
+		m_vpDone.push_back(pJob);
+	}
+}
+
+bool CSqlPool::Add(ISqlJob *pJob, int Priority)
+{
+	if(m_vpWorkers.empty())
+		return false;
+
+	{
+		CLockScope ls(m_Lock);
+		if(m_NumQueued >= m_QueueSize * (NUM_PRIORITIES - Priority) / NUM_PRIORITIES)
+			return false;
+		m_aQueues[Priority].push_back(pJob);
+		m_NumQueued++;
+	}
+	semaphore_signal(&m_Semaphore);
+	return true;
+}
+
+void CSqlPool::Update()
+{
+	std::vector<ISqlJob *> vpDone;
+	{
+		CLockScope ls(m_DoneLock);
+		vpDone.swap(m_vpDone);
+	}
+
+	for(unsigned i = 0; i < vpDone.size(); i++)
+	{
+		vpDone[i]->Done();
+		delete vpDone[i];
+	}
+}
+
+int CSqlPool::NumQueued()
+{
+	CLockScope ls(m_Lock);
+	return m_NumQueued;
+}
+
+#endif
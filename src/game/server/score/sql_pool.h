@@ -0,0 +1,127 @@
+#ifndef GAME_SERVER_SCORE_SQL_POOL_H
+#define GAME_SERVER_SCORE_SQL_POOL_H
+
+#include <base/lock.h>
+#include <base/system.h>
+
+#include <mysql_connection.h>
+
+#include <cppconn/driver.h>
+#include <cppconn/exception.h>
+#include <cppconn/prepared_statement.h>
+#include <cppconn/resultset.h>
+#include <cppconn/statement.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+	A connection owned by one worker. It is kept open between jobs,
+	connections that sat idle for a while or failed last time are
+	checked before they are handed out again. Prepared statements are
+	cached per connection and dropped on reconnect.
+*/
+class CSqlConnection
+{
+	enum
+	{
+		CHECK_INTERVAL=30, // seconds
+	};
+
+	sql::Driver *m_pDriver;
+	sql::Connection *m_pConnection;
+	std::map<std::string, sql::PreparedStatement *> m_PreparedStatements;
+	int64 m_LastUse;
+	bool m_Broken;
+
+	bool Check();
+
+public:
+	sql::Statement *m_pStatement;
+	sql::ResultSet *m_pResults;
+
+	CSqlConnection();
+	~CSqlConnection();
+
+	bool Connect();
+	void Disconnect();
+	// check the connection before the next job
+	void SetBroken() { m_Broken = true; }
+
+	// prepared once per connection, owned by it
+	sql::PreparedStatement *Prepare(const char *pQuery);
+
+	void Begin();
+	void Commit();
+	// never throws, the connection is checked again afterwards
+	void Rollback();
+};
+
+class ISqlJob
+{
+public:
+	virtual ~ISqlJob() {}
+	// on a worker, with its connection
+	virtual void Run(CSqlConnection *pSql) = 0;
+	// back on the game thread, the pool deletes the job afterwards
+	virtual void Done() = 0;
+};
+
+/*
+	A fixed number of workers, each with its own connection, serving one
+	bounded queue. Lower priorities are turned away earlier, so saves
+	still fit in when queries pile up. Finished jobs wait in a completion
+	queue until the game thread picks them up with Update().
+*/
+class CSqlPool
+{
+public:
+	enum
+	{
+		PRIORITY_SAVE=0,
+		PRIORITY_LOAD,
+		PRIORITY_QUERY,
+		NUM_PRIORITIES,
+	};
+
+private:
+	struct CWorker
+	{
+		CSqlPool *m_pPool;
+		CSqlConnection m_Connection;
+		void *m_pThread;
+	};
+
+	std::vector<CWorker *> m_vpWorkers;
+	int m_QueueSize;
+
+	CLock m_Lock;
+	SEMAPHORE m_Semaphore;
+	std::deque<ISqlJob *> m_aQueues[NUM_PRIORITIES] GUARDED_BY(m_Lock);
+	int m_NumQueued GUARDED_BY(m_Lock);
+
+	CLock m_DoneLock;
+	std::vector<ISqlJob *> m_vpDone GUARDED_BY(m_DoneLock);
+
+	static void WorkerThread(void *pUser);
+	void RunLoop(CSqlConnection *pSql);
+
+public:
+	CSqlPool();
+	~CSqlPool();
+
+	void Init(int NumWorkers, int QueueSize);
+	// runs everything still queued, completions are dropped
+	void Shutdown();
+
+	// false if the queue is full for this priority, the job stays with the caller then
+	bool Add(ISqlJob *pJob, int Priority);
+	// game thread, runs Done() of the finished jobs
+	void Update();
+
+	int NumQueued();
+};
+
+#endif
@@ -5,15 +5,23 @@
 #include <string.h>
 #include <fstream>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <string>
 
 #include <engine/shared/config.h>
+#include <engine/storage.h>
 #include "../entities/character.h"
 #include "../gamemodes/DDRace.h"
 #include "sql_score.h"
 #include <engine/shared/console.h>
 #include "../save.h"
 
-static LOCK gs_SqlLock = 0;
+// times used to be written with two decimals
+static double RoundTime(float Time)
+{
+	return round(Time * 100.0) / 100.0;
+}
 
 CSqlScore::CSqlScore(CGameContext *pGameServer) : m_pGameServer(pGameServer),
 		m_pServer(pGameServer->Server()),
@@ -24,145 +32,96 @@ CSqlScore::CSqlScore(CGameContext *pGameServer) : m_pGameServer(pGameServer),
 		m_pIp(g_Config.m_SvSqlIp),
 		m_Port(g_Config.m_SvSqlPort)
 {
-	m_pDriver = NULL;
 	str_copy(m_aMap, g_Config.m_SvMap, sizeof(m_aMap));
 	ClearString(m_aMap);
 
-	if(gs_SqlLock == 0)
-		gs_SqlLock = lock_create();
-
 	Init();
+	m_Spool.Open(GameServer()->aKernel()->RequestInterface<IStorage>(), g_Config.m_SvSqlSpool);
+	m_NextFlush = 0;
+	m_Pool.Init(g_Config.m_SvSqlWorkers, g_Config.m_SvSqlQueueSize);
 }
 
 CSqlScore::~CSqlScore()
 {
-	lock_wait(gs_SqlLock);
-	lock_unlock(gs_SqlLock);
-
-	try
-	{
-		delete m_pStatement;
-		delete m_pConnection;
-		dbg_msg("SQL", "SQL connection disconnected");
-	}
-	catch (sql::SQLException &e)
-	{
-		dbg_msg("SQL", "ERROR: No SQL connection");
-	}
+	// lets queued saves finish, their replies are dropped
+	// finishes that were not written stay in the spool
+	m_Pool.Shutdown();
+	dbg_msg("SQL", "SQL connection disconnected");
 }
 
-bool CSqlScore::Connect()
+void CSqlScore::Tick()
 {
-	if (m_pDriver != NULL && m_pConnection != NULL)
-	{
-		try
-		{
-			// Connect to specific database
-			m_pConnection->setSchema(m_pDatabase);
-		}
-		catch (sql::SQLException &e)
-		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
-			dbg_msg("SQL", aBuf);
-
-			dbg_msg("SQL", "ERROR: SQL connection failed");
-			return false;
-		}
-		return true;
-	}
+	m_Pool.Update();
 
-	try
-	{
-		char aBuf[256];
-
-		m_pDriver = 0;
-		m_pConnection = 0;
-		m_pStatement = 0;
-
-		sql::ConnectOptionsMap connection_properties;
-		connection_properties["hostName"]      = sql::SQLString(m_pIp);
-		connection_properties["port"]          = m_Port;
-		connection_properties["userName"]      = sql::SQLString(m_pUser);
-		connection_properties["password"]      = sql::SQLString(m_pPass);
-		connection_properties["OPT_RECONNECT"] = true;
+	if(time_get() < m_NextFlush)
+		return;
+	m_NextFlush = time_get() + time_freq() * g_Config.m_SvSqlBatchInterval / 1000;
 
-		// Create connection
-		m_pDriver = get_driver_instance();
-		m_pConnection = m_pDriver->connect(connection_properties);
+	std::vector<CSqlSpoolEntry> vEntries;
+	if(!m_Spool.Take(&vEntries, g_Config.m_SvSqlBatchSize))
+		return;
 
-		// Create Statement
-		m_pStatement = m_pConnection->createStatement();
+	CSqlSpoolFlush *Tmp = new CSqlSpoolFlush();
+	Tmp->m_vEntries.swap(vEntries);
+	if(!AddJob(Tmp, CSqlPool::PRIORITY_SAVE, FlushSpoolThread, FlushSpoolDone))
+		m_Spool.Release();
+}
 
-		// Create database if not exists
-		if(g_Config.m_SvSqlCreateTables)
-		{
-			str_format(aBuf, sizeof(aBuf), "CREATE DATABASE IF NOT EXISTS %s", m_pDatabase);
-			m_pStatement->execute(aBuf);
-		}
+void CSqlScore::PrintSpool(IConsole *pConsole)
+{
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "%d finishes spooled, %d being written, %d requests queued", m_Spool.Num(), m_Spool.NumTaken(), m_Pool.NumQueued());
+	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+}
 
-		// Connect to specific database
-		m_pConnection->setSchema(m_pDatabase);
-		dbg_msg("SQL", "SQL connection established");
+bool CSqlScore::AddJob(CSqlData *pData, int Priority, void (*pfnThread)(CSqlConnection *pSql, void *pUser), void (*pfnDone)(CSqlData *pData))
+{
+	pData->m_pSqlData = this;
+	pData->m_pfnThread = pfnThread;
+	pData->m_pfnDone = pfnDone;
+	if(m_Pool.Add(pData, Priority))
 		return true;
-	}
-	catch (sql::SQLException &e)
-	{
-		char aBuf[256];
-		str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
-		dbg_msg("SQL", aBuf);
 
-		dbg_msg("SQL", "ERROR: SQL connection failed");
-		return false;
-	}
-	catch (const std::exception& ex)
-	{
-		// ...
-		dbg_msg("SQL", "1 %s",ex.what());
-
-	}
-	catch (const std::string& ex)
-	{
-		// ...
-		dbg_msg("SQL", "2 %s",ex.c_str());
-	}
-	catch( int )
-	{
-		dbg_msg("SQL", "3 %s");
-	}
-	catch( float )
-	{
-		dbg_msg("SQL", "4 %s");
-	}
+	dbg_msg("SQL", "ERROR: queue is full, dropping request (priority=%d)", Priority);
+	if(Priority != CSqlPool::PRIORITY_SAVE && pData->m_ClientID >= 0)
+		GameServer()->SendChatTarget(pData->m_ClientID, "The database is busy, try again later");
+	delete pData;
+	return false;
+}
 
-	catch( char[] )
-	{
-		dbg_msg("SQL", "5 %s");
-	}
+void CSqlData::AddLine(int Mode, int Target, const char *pText)
+{
+	CLine Line;
+	Line.m_Mode = Mode;
+	Line.m_Target = Target;
+	str_copy(Line.m_aText, pText, sizeof(Line.m_aText));
+	m_vLines.push_back(Line);
+}
 
-	catch( char )
-	{
-		dbg_msg("SQL", "6 %s");
-	}
-	catch (...)
+void CSqlData::Done()
+{
+	CGameContext *pGameServer = m_pSqlData->GameServer();
+	for(unsigned i = 0; i < m_vLines.size(); i++)
 	{
-		dbg_msg("SQL", "Unknown Error cause by the MySQL/C++ Connector, my advice compile server_debug and use it");
-
-		dbg_msg("SQL", "ERROR: SQL connection failed");
-		return false;
+		const CLine *pLine = &m_vLines[i];
+		if(pLine->m_Mode == LINE_TARGET)
+			pGameServer->SendChatTarget(pLine->m_Target, pLine->m_aText);
+		else if(pLine->m_Mode == LINE_ALL)
+			pGameServer->SendChat(-1, CGameContext::CHAT_ALL, pLine->m_aText, pLine->m_Target);
+		else
+			pGameServer->SendChatTeam(pLine->m_Target, pLine->m_aText);
 	}
-	return false;
-}
 
-void CSqlScore::Disconnect()
-{
+	if(m_pfnDone)
+		m_pfnDone(this);
 }
 
 // create tables... should be done only once
 void CSqlScore::Init()
 {
-	// create connection
-	if(Connect())
+	// runs before the workers start, so nothing queries missing tables
+	CSqlConnection Sql;
+	if(Sql.Connect())
 	{
 		try
 		{
@@ -171,36 +130,36 @@ void CSqlScore::Init()
 			if(g_Config.m_SvSqlCreateTables)
 			{
 				str_format(aBuf, sizeof(aBuf), "CREATE TABLE IF NOT EXISTS %s_race (Map VARCHAR(128) BINARY NOT NULL, Name VARCHAR(%d) BINARY NOT NULL, Timestamp TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP , Time FLOAT DEFAULT 0, Server CHAR(4), cp1 FLOAT DEFAULT 0, cp2 FLOAT DEFAULT 0, cp3 FLOAT DEFAULT 0, cp4 FLOAT DEFAULT 0, cp5 FLOAT DEFAULT 0, cp6 FLOAT DEFAULT 0, cp7 FLOAT DEFAULT 0, cp8 FLOAT DEFAULT 0, cp9 FLOAT DEFAULT 0, cp10 FLOAT DEFAULT 0, cp11 FLOAT DEFAULT 0, cp12 FLOAT DEFAULT 0, cp13 FLOAT DEFAULT 0, cp14 FLOAT DEFAULT 0, cp15 FLOAT DEFAULT 0, cp16 FLOAT DEFAULT 0, cp17 FLOAT DEFAULT 0, cp18 FLOAT DEFAULT 0, cp19 FLOAT DEFAULT 0, cp20 FLOAT DEFAULT 0, cp21 FLOAT DEFAULT 0, cp22 FLOAT DEFAULT 0, cp23 FLOAT DEFAULT 0, cp24 FLOAT DEFAULT 0, cp25 FLOAT DEFAULT 0, KEY (Map, Name)) CHARACTER SET utf8 ;", m_pPrefix, MAX_NAME_LENGTH);
-				m_pStatement->execute(aBuf);
+				Sql.m_pStatement->execute(aBuf);
 
 				str_format(aBuf, sizeof(aBuf), "CREATE TABLE IF NOT EXISTS %s_teamrace (Map VARCHAR(128) BINARY NOT NULL, Name VARCHAR(%d) BINARY NOT NULL, Timestamp TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP, Time FLOAT DEFAULT 0, ID VARBINARY(16) NOT NULL, KEY Map (Map)) CHARACTER SET utf8 ;", m_pPrefix, MAX_NAME_LENGTH);
-				m_pStatement->execute(aBuf);
+				Sql.m_pStatement->execute(aBuf);
 
 				str_format(aBuf, sizeof(aBuf), "CREATE TABLE IF NOT EXISTS %s_maps (Map VARCHAR(128) BINARY NOT NULL, Server VARCHAR(32) BINARY NOT NULL, Mapper VARCHAR(128) BINARY NOT NULL, Points INT DEFAULT 0, Stars INT DEFAULT 0, Timestamp TIMESTAMP, UNIQUE KEY Map (Map)) CHARACTER SET utf8 ;", m_pPrefix);
-				m_pStatement->execute(aBuf);
+				Sql.m_pStatement->execute(aBuf);
 
 				str_format(aBuf, sizeof(aBuf), "CREATE TABLE IF NOT EXISTS %s_saves (Savegame TEXT CHARACTER SET utf8 BINARY NOT NULL, Map VARCHAR(128) BINARY NOT NULL, Code VARCHAR(128) BINARY NOT NULL, Timestamp TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP, Server CHAR(4), UNIQUE KEY (Map, Code)) CHARACTER SET utf8 ;", m_pPrefix);
-				m_pStatement->execute(aBuf);
+				Sql.m_pStatement->execute(aBuf);
 
 				str_format(aBuf, sizeof(aBuf), "CREATE TABLE IF NOT EXISTS %s_points (Name VARCHAR(%d) BINARY NOT NULL, Points INT DEFAULT 0, UNIQUE KEY Name (Name)) CHARACTER SET utf8 ;", m_pPrefix, MAX_NAME_LENGTH);
-				m_pStatement->execute(aBuf);
+				Sql.m_pStatement->execute(aBuf);
 
 				dbg_msg("SQL", "Tables were created successfully");
 			}
 
 			// get the best time
 			str_format(aBuf, sizeof(aBuf), "SELECT Time FROM %s_race WHERE Map='%s' ORDER BY `Time` ASC LIMIT 0, 1;", m_pPrefix, m_aMap);
-			m_pResults = m_pStatement->executeQuery(aBuf);
+			Sql.m_pResults = Sql.m_pStatement->executeQuery(aBuf);
 
-			if(m_pResults->next())
+			if(Sql.m_pResults->next())
 			{
-				((CGameControllerDDRace*)GameServer()->m_pController)->m_CurrentRecord = (float)m_pResults->getDouble("Time");
+				((CGameControllerDDRace*)GameServer()->m_pController)->m_CurrentRecord = (float)Sql.m_pResults->getDouble("Time");
 
 				dbg_msg("SQL", "Getting best time on server done");
 			}
 
 			// delete statement
-			delete m_pResults;
+			delete Sql.m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -209,20 +168,15 @@ void CSqlScore::Init()
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Tables were NOT created");
 		}
-
-		// disconnect from database
-		Disconnect();
 	}
 }
 
-void CSqlScore::CheckBirthdayThread(void *pUser)
+void CSqlScore::CheckBirthdayThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -234,18 +188,18 @@ void CSqlScore::CheckBirthdayThread(void *pUser)
 			char aBuf[512];
 
 			str_format(aBuf, sizeof(aBuf), "select year(Current) - year(Stamp) as YearsAgo from (select CURRENT_TIMESTAMP as Current, min(Timestamp) as Stamp from %s_race WHERE Name='%s') as l where dayofmonth(Current) = dayofmonth(Stamp) and month(Current) = month(Stamp) and year(Current) > year(Stamp);", pData->m_pSqlData->m_pPrefix, pData->m_aName);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
-			if(pData->m_pSqlData->m_pResults->next())
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
+			if(pSql->m_pResults->next())
 			{
-				int yearsAgo = (int)pData->m_pSqlData->m_pResults->getInt("YearsAgo");
+				int yearsAgo = (int)pSql->m_pResults->getInt("YearsAgo");
 				str_format(aBuf, sizeof(aBuf), "Happy DDNet birthday to %s for finishing their first map %d year%s ago!", originalName, yearsAgo, yearsAgo > 1 ? "s" : "");
-				pData->m_pSqlData->GameServer()->SendChat(-1, CGameContext::CHAT_ALL, aBuf, pData->m_ClientID);
+				pData->SendChatAll(aBuf, pData->m_ClientID);
 			}
 
 			dbg_msg("SQL", "Checking birthday done");
 
 			// delete statement and results
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -253,15 +207,9 @@ void CSqlScore::CheckBirthdayThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not check birthday");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::CheckBirthday(int ClientID)
@@ -269,56 +217,46 @@ void CSqlScore::CheckBirthday(int ClientID)
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aName, Server()->ClientName(ClientID), MAX_NAME_LENGTH);
-	Tmp->m_pSqlData = this;
 
-	void *CheckThread = thread_init(CheckBirthdayThread, Tmp);
-	thread_detach(CheckThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, CheckBirthdayThread);
 }
 
 
 // update stuff
-void CSqlScore::LoadScoreThread(void *pUser)
+void CSqlScore::LoadScoreThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	pData->m_Found = false;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
-			// check strings
-			pData->m_pSqlData->ClearString(pData->m_aName);
-
 			char aBuf[512];
-
-			str_format(aBuf, sizeof(aBuf), "SELECT * FROM %s_race WHERE Map='%s' AND Name='%s' ORDER BY time ASC LIMIT 1;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aName);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
-			if(pData->m_pSqlData->m_pResults->next())
+			str_format(aBuf, sizeof(aBuf), "SELECT * FROM %s_race WHERE Map=? AND Name=? ORDER BY time ASC LIMIT 1;", pData->m_pSqlData->m_pPrefix);
+			sql::PreparedStatement *pStatement = pSql->Prepare(aBuf);
+			pStatement->setString(1, pData->m_pSqlData->m_aMap);
+			pStatement->setString(2, pData->m_aName);
+			pSql->m_pResults = pStatement->executeQuery();
+			if(pSql->m_pResults->next())
 			{
 				// get the best time
-				float time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-				pData->m_pSqlData->PlayerData(pData->m_ClientID)->m_BestTime = time;
-				pData->m_pSqlData->PlayerData(pData->m_ClientID)->m_CurrentTime = time;
-				if(pData->m_pSqlData->m_pGameServer->m_apPlayers[pData->m_ClientID])
-					pData->m_pSqlData->m_pGameServer->m_apPlayers[pData->m_ClientID]->m_Score = -time;
+				pData->m_Found = true;
+				pData->m_Time = (float)pSql->m_pResults->getDouble("Time");
 
 				char aColumn[8];
-				if(g_Config.m_SvCheckpointSave)
+				for(int i = 0; i < NUM_CHECKPOINTS; i++)
 				{
-					for(int i = 0; i < NUM_CHECKPOINTS; i++)
-					{
-						str_format(aColumn, sizeof(aColumn), "cp%d", i+1);
-						pData->m_pSqlData->PlayerData(pData->m_ClientID)->m_aBestCpTime[i] = (float)pData->m_pSqlData->m_pResults->getDouble(aColumn);
-					}
+					str_format(aColumn, sizeof(aColumn), "cp%d", i+1);
+					pData->m_aCpCurrent[i] = (float)pSql->m_pResults->getDouble(aColumn);
 				}
 			}
 
 			dbg_msg("SQL", "Getting best time done");
 
 			// delete statement and results
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -326,15 +264,30 @@ void CSqlScore::LoadScoreThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not update account");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
+}
 
-	delete pData;
+void CSqlScore::LoadScoreDone(CSqlData *pUser)
+{
+	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	CSqlScore *pSelf = pData->m_pSqlData;
+
+	// the player might have left in the meantime
+	CPlayer *pPlayer = pSelf->GameServer()->m_apPlayers[pData->m_ClientID];
+	if(!pData->m_Found || !pPlayer || str_comp(pSelf->Server()->ClientName(pData->m_ClientID), pData->m_aName) != 0)
+		return;
 
-	lock_unlock(gs_SqlLock);
+	CPlayerData *pPlayerData = pSelf->PlayerData(pData->m_ClientID);
+	pPlayerData->m_BestTime = pData->m_Time;
+	pPlayerData->m_CurrentTime = pData->m_Time;
+	pPlayer->m_Score = -pData->m_Time;
+	if(g_Config.m_SvCheckpointSave)
+	{
+		for(int i = 0; i < NUM_CHECKPOINTS; i++)
+			pPlayerData->m_aBestCpTime[i] = pData->m_aCpCurrent[i];
+	}
 }
 
 void CSqlScore::LoadScore(int ClientID)
@@ -342,134 +295,112 @@ void CSqlScore::LoadScore(int ClientID)
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aName, Server()->ClientName(ClientID), MAX_NAME_LENGTH);
-	Tmp->m_pSqlData = this;
 
-	void *LoadThread = thread_init(LoadScoreThread, Tmp);
-	thread_detach(LoadThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_LOAD, LoadScoreThread, LoadScoreDone);
 }
 
-void CSqlScore::SaveTeamScoreThread(void *pUser)
+void CSqlScore::SaveTeamTime(CSqlConnection *pSql, const CSqlSpoolEntry *pEntry)
 {
-	lock_wait(gs_SqlLock);
+	char aBuf[2300];
+	char aUpdateID[17];
+	aUpdateID[0] = 0;
 
-	CSqlTeamScoreData *pData = (CSqlTeamScoreData *)pUser;
-
-	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	char aaNames[MAX_CLIENTS][MAX_NAME_LENGTH * 2];
+	mem_zero(aaNames, sizeof(aaNames));
+	for(int i = 0; i < pEntry->m_Size; i++)
 	{
-		try
-		{
-			char aBuf[2300];
-			char aUpdateID[17];
-			aUpdateID[0] = 0;
-
-			for(unsigned int i = 0; i < pData->m_Size; i++)
-			{
-				pData->m_pSqlData->ClearString(pData->m_aNames[i]);
-			}
+		str_copy(aaNames[i], pEntry->m_aaNames[i], sizeof(aaNames[i]));
+		ClearString(aaNames[i], MAX_NAME_LENGTH);
+	}
 
-			str_format(aBuf, sizeof(aBuf), "SELECT Name, l.ID, Time FROM ((SELECT ID FROM %s_teamrace WHERE Map = '%s' AND Name = '%s') as l) LEFT JOIN %s_teamrace as r ON l.ID = r.ID ORDER BY ID;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aNames[0], pData->m_pSqlData->m_pPrefix);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+	str_format(aBuf, sizeof(aBuf), "SELECT Name, l.ID, Time FROM ((SELECT ID FROM %s_teamrace WHERE Map = '%s' AND Name = '%s') as l) LEFT JOIN %s_teamrace as r ON l.ID = r.ID ORDER BY ID;", m_pPrefix, pEntry->m_aMap, aaNames[0], m_pPrefix);
+	pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if (pData->m_pSqlData->m_pResults->rowsCount() > 0)
-			{
-				char aID[17];
-				char aID2[17];
-				char aName[64];
-				unsigned int Count = 0;
-				bool ValidNames = true;
+	if (pSql->m_pResults->rowsCount() > 0)
+	{
+		char aID[17];
+		char aID2[17];
+		char aName[64];
+		int Count = 0;
+		bool ValidNames = true;
 
-				pData->m_pSqlData->m_pResults->first();
-				float Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-				strcpy(aID, pData->m_pSqlData->m_pResults->getString("ID").c_str());
+		pSql->m_pResults->first();
+		float Time = (float)pSql->m_pResults->getDouble("Time");
+		strcpy(aID, pSql->m_pResults->getString("ID").c_str());
 
-				do
+		do
+		{
+			strcpy(aID2, pSql->m_pResults->getString("ID").c_str());
+			strcpy(aName, pSql->m_pResults->getString("Name").c_str());
+			ClearString(aName);
+			if (str_comp(aID, aID2) != 0)
+			{
+				if (ValidNames && Count == pEntry->m_Size)
 				{
-					strcpy(aID2, pData->m_pSqlData->m_pResults->getString("ID").c_str());
-					strcpy(aName, pData->m_pSqlData->m_pResults->getString("Name").c_str());
-					pData->m_pSqlData->ClearString(aName);
-					if (str_comp(aID, aID2) != 0)
+					if (pEntry->m_Time < Time)
+						strcpy(aUpdateID, aID);
+					else
 					{
-						if (ValidNames && Count == pData->m_Size)
-						{
-							if (pData->m_Time < Time)
-								strcpy(aUpdateID, aID);
-							else
-								goto end;
-							break;
-						}
-
-						Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-						ValidNames = true;
-						Count = 0;
-						strcpy(aID, aID2);
+						delete pSql->m_pResults;
+						return;
 					}
+					break;
+				}
 
-					if (!ValidNames)
-						continue;
+				Time = (float)pSql->m_pResults->getDouble("Time");
+				ValidNames = true;
+				Count = 0;
+				strcpy(aID, aID2);
+			}
 
-					ValidNames = false;
+			if (!ValidNames)
+				continue;
 
-					for(unsigned int i = 0; i < pData->m_Size; i++)
-					{
-						if (str_comp(aName, pData->m_aNames[i]) == 0)
-						{
-							ValidNames = true;
-							Count++;
-							break;
-						}
-					}
-				} while (pData->m_pSqlData->m_pResults->next());
+			ValidNames = false;
 
-				if (ValidNames && Count == pData->m_Size)
+			for(int i = 0; i < pEntry->m_Size; i++)
+			{
+				if (str_comp(aName, aaNames[i]) == 0)
 				{
-					if (pData->m_Time < Time)
-						strcpy(aUpdateID, aID);
-					else
-						goto end;
+					ValidNames = true;
+					Count++;
+					break;
 				}
 			}
+		} while (pSql->m_pResults->next());
 
-			if (aUpdateID[0])
-			{
-				str_format(aBuf, sizeof(aBuf), "UPDATE %s_teamrace SET Time='%.2f' WHERE ID = '%s';", pData->m_pSqlData->m_pPrefix, pData->m_Time, aUpdateID);
-				dbg_msg("SQL", aBuf);
-				pData->m_pSqlData->m_pStatement->execute(aBuf);
-			}
+		if (ValidNames && Count == pEntry->m_Size)
+		{
+			if (pEntry->m_Time < Time)
+				strcpy(aUpdateID, aID);
 			else
 			{
-				pData->m_pSqlData->m_pStatement->execute("SET @id = UUID();");
-
-				for(unsigned int i = 0; i < pData->m_Size; i++)
-				{
-				// if no entry found... create a new one
-					str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_teamrace(Map, Name, Timestamp, Time, ID) VALUES ('%s', '%s', CURRENT_TIMESTAMP(), '%.2f', @id);", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aNames[i], pData->m_Time);
-					dbg_msg("SQL", aBuf);
-					pData->m_pSqlData->m_pStatement->execute(aBuf);
-				}
+				delete pSql->m_pResults;
+				return;
 			}
+		}
+	}
 
-			end:
-			dbg_msg("SQL", "Updating team time done");
+	delete pSql->m_pResults;
 
-			// delete results statement
-			delete pData->m_pSqlData->m_pResults;
-		}
-		catch (sql::SQLException &e)
+	if (aUpdateID[0])
+	{
+		str_format(aBuf, sizeof(aBuf), "UPDATE %s_teamrace SET Time='%.2f' WHERE ID = '%s';", m_pPrefix, pEntry->m_Time, aUpdateID);
+		dbg_msg("SQL", aBuf);
+		pSql->m_pStatement->execute(aBuf);
+	}
+	else
+	{
+		pSql->m_pStatement->execute("SET @id = UUID();");
+
+		for(int i = 0; i < pEntry->m_Size; i++)
 		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
+			// if no entry found... create a new one
+			str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_teamrace(Map, Name, Timestamp, Time, ID) VALUES ('%s', '%s', FROM_UNIXTIME(%d), '%.2f', @id);", m_pPrefix, pEntry->m_aMap, aaNames[i], pEntry->m_Timestamp, pEntry->m_Time);
 			dbg_msg("SQL", aBuf);
-			dbg_msg("SQL", "ERROR: Could not update time");
+			pSql->m_pStatement->execute(aBuf);
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::MapVote(int ClientID, const char* MapName)
@@ -477,20 +408,17 @@ void CSqlScore::MapVote(int ClientID, const char* MapName)
 	CSqlMapData *Tmp = new CSqlMapData();
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aMap, MapName, 128);
-	Tmp->m_pSqlData = this;
 
-	void *VoteThread = thread_init(MapVoteThread, Tmp);
-	thread_detach(VoteThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, MapVoteThread, MapVoteDone);
 }
 
-void CSqlScore::MapVoteThread(void *pUser)
+void CSqlScore::MapVoteThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlMapData *pData = (CSqlMapData *)pUser;
+	pData->m_Found = false;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		char originalMap[128];
 		strcpy(originalMap,pData->m_aMap);
@@ -503,59 +431,22 @@ void CSqlScore::MapVoteThread(void *pUser)
 		{
 			char aBuf[768];
 			str_format(aBuf, sizeof(aBuf), "SELECT Map, Server FROM %s_maps WHERE Map LIKE '%s' COLLATE utf8_general_ci ORDER BY CASE WHEN Map = '%s' THEN 0 ELSE 1 END, CASE WHEN Map LIKE '%s%%' THEN 0 ELSE 1 END, LENGTH(Map), Map LIMIT 1;", pData->m_pSqlData->m_pPrefix, pData->m_aMap, clearMap, clearMap);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
-
-			CPlayer *pPlayer = pData->m_pSqlData->m_pGameServer->m_apPlayers[pData->m_ClientID];
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			int64 Now = pData->m_pSqlData->Server()->Tick();
-			int Timeleft = 0;
-
-			if(!pPlayer)
-				goto end;
-
-			Timeleft = pPlayer->m_LastVoteCall + pData->m_pSqlData->Server()->TickSpeed()*g_Config.m_SvVoteDelay - Now;
-
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
 				str_format(aBuf, sizeof(aBuf), "No map like \"%s\" found. Try adding a '%%' at the start if you don't know the first character. Example: /map %%castle for \"Out of Castle\"", originalMap);
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-			}
-			else if(pPlayer->m_LastVoteCall && Timeleft > 0)
-			{
-				char aChatmsg[512] = {0};
-				str_format(aChatmsg, sizeof(aChatmsg), "You must wait %d seconds before making another vote", (Timeleft/pData->m_pSqlData->Server()->TickSpeed())+1);
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aChatmsg);
-			}
-			else if(time_get() < pData->m_pSqlData->GameServer()->m_LastMapVote + (time_freq() * g_Config.m_SvVoteMapTimeDelay))
-			{
-				char chatmsg[512] = {0};
-				str_format(chatmsg, sizeof(chatmsg), "There's a %d second delay between map-votes, please wait %d seconds.", g_Config.m_SvVoteMapTimeDelay,((pData->m_pSqlData->GameServer()->m_LastMapVote+(g_Config.m_SvVoteMapTimeDelay * time_freq()))/time_freq())-(time_get()/time_freq()));
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, chatmsg);
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
-				char aMap[128];
-				strcpy(aMap, pData->m_pSqlData->m_pResults->getString("Map").c_str());
-				char aServer[32];
-				strcpy(aServer, pData->m_pSqlData->m_pResults->getString("Server").c_str());
-
-				for(char *p = aServer; *p; p++)
-					*p = tolower(*p);
-
-				char aCmd[256];
-				str_format(aCmd, sizeof(aCmd), "sv_reset_file types/%s/flexreset.cfg; change_map \"%s\"", aServer, aMap);
-				char aChatmsg[512];
-				str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", pData->m_pSqlData->GameServer()->Server()->ClientName(pData->m_ClientID), aMap, "/map");
-
-				pData->m_pSqlData->GameServer()->m_VoteKick = false;
-				pData->m_pSqlData->GameServer()->m_VoteSpec = false;
-				pData->m_pSqlData->GameServer()->m_LastMapVote = time_get();
-				pData->m_pSqlData->GameServer()->CallVote(pData->m_ClientID, aMap, aCmd, "/map", aChatmsg);
+				pSql->m_pResults->next();
+				pData->m_Found = true;
+				str_copy(pData->m_aMap, pSql->m_pResults->getString("Map").c_str(), sizeof(pData->m_aMap));
+				str_copy(pData->m_aServer, pSql->m_pResults->getString("Server").c_str(), sizeof(pData->m_aServer));
 			}
 
-			end:
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -563,13 +454,51 @@ void CSqlScore::MapVoteThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not update time");
+			pSql->SetBroken();
 		}
-
-		pData->m_pSqlData->Disconnect();
 	}
+}
 
-	delete pData;
-	lock_unlock(gs_SqlLock);
+void CSqlScore::MapVoteDone(CSqlData *pUser)
+{
+	CSqlMapData *pData = (CSqlMapData *)pUser;
+	CGameContext *pGameServer = pData->m_pSqlData->GameServer();
+	IServer *pServer = pData->m_pSqlData->Server();
+
+	CPlayer *pPlayer = pGameServer->m_apPlayers[pData->m_ClientID];
+	if(!pData->m_Found || !pPlayer)
+		return;
+
+	int64 Now = pServer->Tick();
+	int Timeleft = pPlayer->m_LastVoteCall + pServer->TickSpeed()*g_Config.m_SvVoteDelay - Now;
+
+	if(pPlayer->m_LastVoteCall && Timeleft > 0)
+	{
+		char aChatmsg[512] = {0};
+		str_format(aChatmsg, sizeof(aChatmsg), "You must wait %d seconds before making another vote", (Timeleft/pServer->TickSpeed())+1);
+		pGameServer->SendChatTarget(pData->m_ClientID, aChatmsg);
+	}
+	else if(time_get() < pGameServer->m_LastMapVote + (time_freq() * g_Config.m_SvVoteMapTimeDelay))
+	{
+		char chatmsg[512] = {0};
+		str_format(chatmsg, sizeof(chatmsg), "There's a %d second delay between map-votes, please wait %d seconds.", g_Config.m_SvVoteMapTimeDelay,((pGameServer->m_LastMapVote+(g_Config.m_SvVoteMapTimeDelay * time_freq()))/time_freq())-(time_get()/time_freq()));
+		pGameServer->SendChatTarget(pData->m_ClientID, chatmsg);
+	}
+	else
+	{
+		for(char *p = pData->m_aServer; *p; p++)
+			*p = tolower(*p);
+
+		char aCmd[256];
+		str_format(aCmd, sizeof(aCmd), "sv_reset_file types/%s/flexreset.cfg; change_map \"%s\"", pData->m_aServer, pData->m_aMap);
+		char aChatmsg[512];
+		str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", pServer->ClientName(pData->m_ClientID), pData->m_aMap, "/map");
+
+		pGameServer->m_VoteKick = false;
+		pGameServer->m_VoteSpec = false;
+		pGameServer->m_LastMapVote = time_get();
+		pGameServer->CallVote(pData->m_ClientID, pData->m_aMap, aCmd, "/map", aChatmsg);
+	}
 }
 
 void CSqlScore::MapInfo(int ClientID, const char* MapName)
@@ -577,20 +506,16 @@ void CSqlScore::MapInfo(int ClientID, const char* MapName)
 	CSqlMapData *Tmp = new CSqlMapData();
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aMap, MapName, 128);
-	Tmp->m_pSqlData = this;
 
-	void *InfoThread = thread_init(MapInfoThread, Tmp);
-	thread_detach(InfoThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, MapInfoThread);
 }
 
-void CSqlScore::MapInfoThread(void *pUser)
+void CSqlScore::MapInfoThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlMapData *pData = (CSqlMapData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		char originalMap[128];
 		strcpy(originalMap,pData->m_aMap);
@@ -603,28 +528,28 @@ void CSqlScore::MapInfoThread(void *pUser)
 		{
 			char aBuf[1024];
 			str_format(aBuf, sizeof(aBuf), "SELECT l.Map, l.Server, Mapper, Points, Stars, (select count(Name) from %s_race where Map = l.Map) as Finishes, (select count(distinct Name) from %s_race where Map = l.Map) as Finishers, (select round(avg(Time)) from %s_race where Map = l.Map) as Average, UNIX_TIMESTAMP(l.Timestamp) as Stamp, UNIX_TIMESTAMP(CURRENT_TIMESTAMP)-UNIX_TIMESTAMP(l.Timestamp) as Ago FROM (SELECT * FROM %s_maps WHERE Map LIKE '%s' COLLATE utf8_general_ci ORDER BY CASE WHEN Map = '%s' THEN 0 ELSE 1 END, CASE WHEN Map LIKE '%s%%' THEN 0 ELSE 1 END, LENGTH(Map), Map LIMIT 1) as l;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_pPrefix, pData->m_aMap, clearMap, clearMap);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
 				str_format(aBuf, sizeof(aBuf), "No map like \"%s\" found.", originalMap);
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
-				int points = (int)pData->m_pSqlData->m_pResults->getInt("Points");
-				int stars = (int)pData->m_pSqlData->m_pResults->getInt("Stars");
-				int finishes = (int)pData->m_pSqlData->m_pResults->getInt("Finishes");
-				int finishers = (int)pData->m_pSqlData->m_pResults->getInt("Finishers");
-				int average = (int)pData->m_pSqlData->m_pResults->getInt("Average");
+				pSql->m_pResults->next();
+				int points = (int)pSql->m_pResults->getInt("Points");
+				int stars = (int)pSql->m_pResults->getInt("Stars");
+				int finishes = (int)pSql->m_pResults->getInt("Finishes");
+				int finishers = (int)pSql->m_pResults->getInt("Finishers");
+				int average = (int)pSql->m_pResults->getInt("Average");
 				char aMap[128];
-				strcpy(aMap, pData->m_pSqlData->m_pResults->getString("Map").c_str());
+				strcpy(aMap, pSql->m_pResults->getString("Map").c_str());
 				char aServer[32];
-				strcpy(aServer, pData->m_pSqlData->m_pResults->getString("Server").c_str());
+				strcpy(aServer, pSql->m_pResults->getString("Server").c_str());
 				char aMapper[128];
-				strcpy(aMapper, pData->m_pSqlData->m_pResults->getString("Mapper").c_str());
-				int stamp = (int)pData->m_pSqlData->m_pResults->getInt("Stamp");
-				int ago = (int)pData->m_pSqlData->m_pResults->getInt("Ago");
+				strcpy(aMapper, pSql->m_pResults->getString("Mapper").c_str());
+				int stamp = (int)pSql->m_pResults->getInt("Stamp");
+				int ago = (int)pSql->m_pResults->getInt("Ago");
 
 				char pAgoString[40] = "\0";
 				char pReleasedString[60] = "\0";
@@ -655,8 +580,8 @@ void CSqlScore::MapInfoThread(void *pUser)
 				str_format(aBuf, sizeof(aBuf), "\"%s\" by %s on %s (%s, %d %s, %d %s by %d %s%s%s)", aMap, aMapper, aServer, aStars, points, points == 1 ? "point" : "points", finishes, finishes == 1 ? "finish" : "finishes", finishers, finishers == 1 ? "tee" : "tees", pAverageString, pReleasedString);
 			}
 
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-			delete pData->m_pSqlData->m_pResults;
+			pData->SendChatTarget(pData->m_ClientID, aBuf);
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -664,79 +589,178 @@ void CSqlScore::MapInfoThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not update time");
+			pSql->SetBroken();
 		}
-
-		pData->m_pSqlData->Disconnect();
 	}
 
-	delete pData;
-	lock_unlock(gs_SqlLock);
 }
 
-void CSqlScore::SaveScoreThread(void *pUser)
+void CSqlScore::FlushSpoolThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
-	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	CSqlSpoolFlush *pData = (CSqlSpoolFlush *)pUser;
+	CSqlScore *pSelf = pData->m_pSqlData;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(!pSql->Connect())
+		return;
+
+	try
 	{
-		try
-		{
-			char aBuf[768];
+		char aBuf[1024];
+		sql::PreparedStatement *pStatement;
+		std::vector<const CSqlSpoolEntry *> vpRaces;
+		std::set<std::string> Finished;
+		std::map<std::string, int> MapPoints;
+		std::map<std::string, int> Points;
 
-			// check strings
-			pData->m_pSqlData->ClearString(pData->m_aName);
+		pSql->Begin();
 
-			str_format(aBuf, sizeof(aBuf), "SELECT * FROM %s_race WHERE Map='%s' AND Name='%s' ORDER BY time ASC LIMIT 1;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aName);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
-			if(!pData->m_pSqlData->m_pResults->next())
+		for(unsigned i = 0; i < pData->m_vEntries.size(); i++)
+		{
+			const CSqlSpoolEntry *pEntry = &pData->m_vEntries[i];
+			if(pEntry->m_Type == CSqlSpoolEntry::TYPE_TEAMRACE)
 			{
-				delete pData->m_pSqlData->m_pResults;
-
-				str_format(aBuf, sizeof(aBuf), "SELECT Points FROM %s_maps WHERE Map ='%s'", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap);
-				pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
-
-				if(pData->m_pSqlData->m_pResults->rowsCount() == 1)
+				pSelf->SaveTeamTime(pSql, pEntry);
+				continue;
+			}
+			vpRaces.push_back(pEntry);
+
+			// points only for the first finish, also within this batch
+			std::string Key = std::string(pEntry->m_aMap) + "\n" + pEntry->m_aaNames[0];
+			if(!Finished.insert(Key).second)
+				continue;
+
+			str_format(aBuf, sizeof(aBuf), "SELECT Name FROM %s_race WHERE Map=? AND Name=? LIMIT 1;", pSelf->m_pPrefix);
+			pStatement = pSql->Prepare(aBuf);
+			pStatement->setString(1, pEntry->m_aMap);
+			pStatement->setString(2, pEntry->m_aaNames[0]);
+			pSql->m_pResults = pStatement->executeQuery();
+			bool FinishedBefore = pSql->m_pResults->next();
+			delete pSql->m_pResults;
+			if(FinishedBefore)
+				continue;
+
+			std::map<std::string, int>::iterator it = MapPoints.find(pEntry->m_aMap);
+			if(it == MapPoints.end())
+			{
+				str_format(aBuf, sizeof(aBuf), "SELECT Points FROM %s_maps WHERE Map=?;", pSelf->m_pPrefix);
+				pStatement = pSql->Prepare(aBuf);
+				pStatement->setString(1, pEntry->m_aMap);
+				pSql->m_pResults = pStatement->executeQuery();
+				int MapPoint = -1;
+				if(pSql->m_pResults->rowsCount() == 1)
 				{
-					pData->m_pSqlData->m_pResults->next();
-					int points = (int)pData->m_pSqlData->m_pResults->getInt("Points");
-					if (points == 1)
-						str_format(aBuf, sizeof(aBuf), "You earned %d point for finishing this map!", points);
-					else
-						str_format(aBuf, sizeof(aBuf), "You earned %d points for finishing this map!", points);
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-
-					str_format(aBuf, sizeof(aBuf), "INSERT INTO %s_points(Name, Points) VALUES ('%s', '%d') ON duplicate key UPDATE Name=VALUES(Name), Points=Points+VALUES(Points);", pData->m_pSqlData->m_pPrefix, pData->m_aName, points);
-					pData->m_pSqlData->m_pStatement->execute(aBuf);
+					pSql->m_pResults->next();
+					MapPoint = (int)pSql->m_pResults->getInt("Points");
 				}
+				delete pSql->m_pResults;
+				it = MapPoints.insert(std::make_pair(std::string(pEntry->m_aMap), MapPoint)).first;
 			}
+			if(it->second < 0)
+				continue;
 
-			delete pData->m_pSqlData->m_pResults;
+			Points[pEntry->m_aaNames[0]] += it->second;
 
-			// if no entry found... create a new one
-			str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_race(Map, Name, Timestamp, Time, Server, cp1, cp2, cp3, cp4, cp5, cp6, cp7, cp8, cp9, cp10, cp11, cp12, cp13, cp14, cp15, cp16, cp17, cp18, cp19, cp20, cp21, cp22, cp23, cp24, cp25) VALUES ('%s', '%s', CURRENT_TIMESTAMP(), '%.2f', '%s', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f');", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aName, pData->m_Time, g_Config.m_SvSqlServerName, pData->m_aCpCurrent[0], pData->m_aCpCurrent[1], pData->m_aCpCurrent[2], pData->m_aCpCurrent[3], pData->m_aCpCurrent[4], pData->m_aCpCurrent[5], pData->m_aCpCurrent[6], pData->m_aCpCurrent[7], pData->m_aCpCurrent[8], pData->m_aCpCurrent[9], pData->m_aCpCurrent[10], pData->m_aCpCurrent[11], pData->m_aCpCurrent[12], pData->m_aCpCurrent[13], pData->m_aCpCurrent[14], pData->m_aCpCurrent[15], pData->m_aCpCurrent[16], pData->m_aCpCurrent[17], pData->m_aCpCurrent[18], pData->m_aCpCurrent[19], pData->m_aCpCurrent[20], pData->m_aCpCurrent[21], pData->m_aCpCurrent[22], pData->m_aCpCurrent[23], pData->m_aCpCurrent[24]);
-			dbg_msg("SQL", aBuf);
-			pData->m_pSqlData->m_pStatement->execute(aBuf);
+			CSqlSpoolFlush::CEarned Earned;
+			Earned.m_ClientID = pEntry->m_ClientID;
+			str_copy(Earned.m_aName, pEntry->m_aaNames[0], sizeof(Earned.m_aName));
+			Earned.m_Points = it->second;
+			pData->m_vEarned.push_back(Earned);
+		}
 
-			dbg_msg("SQL", "Updating time done");
+		if(!Points.empty())
+		{
+			std::string Query;
+			str_format(aBuf, sizeof(aBuf), "INSERT INTO %s_points(Name, Points) VALUES ", pSelf->m_pPrefix);
+			Query = aBuf;
+			for(unsigned i = 0; i < Points.size(); i++)
+				Query += i ? ", (?, ?)" : "(?, ?)";
+			Query += " ON duplicate key UPDATE Name=VALUES(Name), Points=Points+VALUES(Points);";
+
+			// one prepared statement per batch size, bounded by sv_sql_batch_size
+			pStatement = pSql->Prepare(Query.c_str());
+			int Column = 1;
+			for(std::map<std::string, int>::iterator it = Points.begin(); it != Points.end(); ++it)
+			{
+				pStatement->setString(Column++, it->first);
+				pStatement->setInt(Column++, it->second);
+			}
+			pStatement->execute();
 		}
-		catch (sql::SQLException &e)
+
+		if(!vpRaces.empty())
 		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
-			dbg_msg("SQL", aBuf);
-			dbg_msg("SQL", "ERROR: Could not update time");
+			std::string Query;
+			str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_race(Map, Name, Timestamp, Time, Server, cp1, cp2, cp3, cp4, cp5, cp6, cp7, cp8, cp9, cp10, cp11, cp12, cp13, cp14, cp15, cp16, cp17, cp18, cp19, cp20, cp21, cp22, cp23, cp24, cp25) VALUES ", pSelf->m_pPrefix);
+			Query = aBuf;
+			for(unsigned i = 0; i < vpRaces.size(); i++)
+			{
+				Query += i ? ", (?, ?, FROM_UNIXTIME(?), ?, ?" : "(?, ?, FROM_UNIXTIME(?), ?, ?";
+				for(int c = 0; c < NUM_CHECKPOINTS; c++)
+					Query += ", ?";
+				Query += ")";
+			}
+			Query += ";";
+
+			pStatement = pSql->Prepare(Query.c_str());
+			int Column = 1;
+			for(unsigned i = 0; i < vpRaces.size(); i++)
+			{
+				const CSqlSpoolEntry *pEntry = vpRaces[i];
+				pStatement->setString(Column++, pEntry->m_aMap);
+				pStatement->setString(Column++, pEntry->m_aaNames[0]);
+				pStatement->setInt(Column++, pEntry->m_Timestamp);
+				pStatement->setDouble(Column++, RoundTime(pEntry->m_Time));
+				pStatement->setString(Column++, pEntry->m_aServer);
+				for(int c = 0; c < NUM_CHECKPOINTS; c++)
+					pStatement->setDouble(Column++, RoundTime(pEntry->m_aCpCurrent[c]));
+			}
+			pStatement->execute();
 		}
 
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
+		pSql->Commit();
+		pSelf->m_Spool.Commit();
+		pData->m_Flushed = true;
+
+		dbg_msg("SQL", "Updating %d times done", (int)pData->m_vEntries.size());
 	}
+	catch (sql::SQLException &e)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
+		dbg_msg("SQL", aBuf);
+		dbg_msg("SQL", "ERROR: Could not update times, they stay spooled");
+		pSql->Rollback();
+		pData->m_vEarned.clear();
+	}
+}
 
-	delete pData;
+void CSqlScore::FlushSpoolDone(CSqlData *pUser)
+{
+	CSqlSpoolFlush *pData = (CSqlSpoolFlush *)pUser;
+	CSqlScore *pSelf = pData->m_pSqlData;
+
+	if(!pData->m_Flushed)
+	{
+		pSelf->m_Spool.Release();
+		pSelf->m_NextFlush = time_get() + time_freq() * RETRY_DELAY;
+		return;
+	}
 
-	lock_unlock(gs_SqlLock);
+	char aBuf[128];
+	for(unsigned i = 0; i < pData->m_vEarned.size(); i++)
+	{
+		const CSqlSpoolFlush::CEarned *pEarned = &pData->m_vEarned[i];
+		// the finisher may have left since
+		if(pEarned->m_ClientID < 0 || !pSelf->Server()->ClientIngame(pEarned->m_ClientID) || str_comp(pSelf->Server()->ClientName(pEarned->m_ClientID), pEarned->m_aName) != 0)
+			continue;
+
+		if (pEarned->m_Points == 1)
+			str_format(aBuf, sizeof(aBuf), "You earned %d point for finishing this map!", pEarned->m_Points);
+		else
+			str_format(aBuf, sizeof(aBuf), "You earned %d points for finishing this map!", pEarned->m_Points);
+		pSelf->GameServer()->SendChatTarget(pEarned->m_ClientID, aBuf);
+	}
 }
 
 void CSqlScore::SaveScore(int ClientID, float Time, float CpTime[NUM_CHECKPOINTS])
@@ -744,16 +768,21 @@ void CSqlScore::SaveScore(int ClientID, float Time, float CpTime[NUM_CHECKPOINTS
 	CConsole* pCon = (CConsole*)GameServer()->Console();
 	if(pCon->m_Cheated)
 		return;
-	CSqlScoreData *Tmp = new CSqlScoreData();
-	Tmp->m_ClientID = ClientID;
-	str_copy(Tmp->m_aName, Server()->ClientName(ClientID), MAX_NAME_LENGTH);
-	Tmp->m_Time = Time;
+	CSqlSpoolEntry Entry;
+	mem_zero(&Entry, sizeof(Entry));
+	Entry.m_Type = CSqlSpoolEntry::TYPE_RACE;
+	Entry.m_Timestamp = time_timestamp();
+	Entry.m_ClientID = ClientID;
+	str_copy(Entry.m_aMap, m_aMap, sizeof(Entry.m_aMap));
+	str_copy(Entry.m_aServer, g_Config.m_SvSqlServerName, sizeof(Entry.m_aServer));
+	Entry.m_Time = Time;
 	for(int i = 0; i < NUM_CHECKPOINTS; i++)
-		Tmp->m_aCpCurrent[i] = CpTime[i];
-	Tmp->m_pSqlData = this;
+		Entry.m_aCpCurrent[i] = CpTime[i];
+	Entry.m_Size = 1;
+	str_copy(Entry.m_aaNames[0], Server()->ClientName(ClientID), MAX_NAME_LENGTH);
 
-	void *SaveThread = thread_init(SaveScoreThread, Tmp);
-	thread_detach(SaveThread);
+	// written with the next batch
+	m_Spool.Add(&Entry);
 }
 
 void CSqlScore::SaveTeamScore(int* aClientIDs, unsigned int Size, float Time)
@@ -761,28 +790,27 @@ void CSqlScore::SaveTeamScore(int* aClientIDs, unsigned int Size, float Time)
 	CConsole* pCon = (CConsole*)GameServer()->Console();
 	if(pCon->m_Cheated)
 		return;
-	CSqlTeamScoreData *Tmp = new CSqlTeamScoreData();
+	CSqlSpoolEntry Entry;
+	mem_zero(&Entry, sizeof(Entry));
+	Entry.m_Type = CSqlSpoolEntry::TYPE_TEAMRACE;
+	Entry.m_Timestamp = time_timestamp();
+	Entry.m_ClientID = -1;
+	str_copy(Entry.m_aMap, m_aMap, sizeof(Entry.m_aMap));
+	str_copy(Entry.m_aServer, g_Config.m_SvSqlServerName, sizeof(Entry.m_aServer));
+	Entry.m_Time = Time;
+	Entry.m_Size = Size;
 	for(unsigned int i = 0; i < Size; i++)
-	{
-		Tmp->m_aClientIDs[i] = aClientIDs[i];
-		str_copy(Tmp->m_aNames[i], Server()->ClientName(aClientIDs[i]), MAX_NAME_LENGTH);
-	}
-	Tmp->m_Size = Size;
-	Tmp->m_Time = Time;
-	Tmp->m_pSqlData = this;
+		str_copy(Entry.m_aaNames[i], Server()->ClientName(aClientIDs[i]), MAX_NAME_LENGTH);
 
-	void *SaveTeamThread = thread_init(SaveTeamScoreThread, Tmp);
-	thread_detach(SaveTeamThread);
+	m_Spool.Add(&Entry);
 }
 
-void CSqlScore::ShowTeamRankThread(void *pUser)
+void CSqlScore::ShowTeamRankThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -796,31 +824,31 @@ void CSqlScore::ShowTeamRankThread(void *pUser)
 			char aNames[2300];
 			aNames[0] = '\0';
 
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 			str_format(aBuf, sizeof(aBuf), "SELECT Rank, Name, Time FROM (SELECT Rank, l2.ID FROM ((SELECT ID, (@pos := @pos+1) pos, (@rank := IF(@prev = Time,@rank,@pos)) rank, (@prev := Time) Time FROM (SELECT ID, Time FROM %s_teamrace WHERE Map = '%s' GROUP BY ID ORDER BY Time) as ll) as l2) LEFT JOIN %s_teamrace as r2 ON l2.ID = r2.ID WHERE Map = '%s' AND Name = '%s' ORDER BY Rank LIMIT 1) as l LEFT JOIN %s_teamrace as r ON l.ID = r.ID ORDER BY Name;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aName, pData->m_pSqlData->m_pPrefix);
 
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			int Rows = pData->m_pSqlData->m_pResults->rowsCount();
+			int Rows = pSql->m_pResults->rowsCount();
 
 			if(Rows < 1)
 			{
 				str_format(aBuf, sizeof(aBuf), "%s has no team ranks", originalName);
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->first();
+				pSql->m_pResults->first();
 
-				float Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-				int Rank = (int)pData->m_pSqlData->m_pResults->getInt("Rank");
+				float Time = (float)pSql->m_pResults->getDouble("Time");
+				int Rank = (int)pSql->m_pResults->getInt("Rank");
 
 				for(int Row = 0; Row < Rows; Row++)
 				{
-					strcat(aNames, pData->m_pSqlData->m_pResults->getString("Name").c_str());
-					pData->m_pSqlData->m_pResults->next();
+					strcat(aNames, pSql->m_pResults->getString("Name").c_str());
+					pSql->m_pResults->next();
 
 					if (Row < Rows - 2)
 						strcat(aNames, ", ");
@@ -828,24 +856,24 @@ void CSqlScore::ShowTeamRankThread(void *pUser)
 						strcat(aNames, " & ");
 				}
 
-				pData->m_pSqlData->m_pResults->first();
+				pSql->m_pResults->first();
 
 				if(g_Config.m_SvHideScore)
 				{
 					str_format(aBuf, sizeof(aBuf), "Your team time: %02d:%05.02f", (int)(Time/60), Time-((int)Time/60*60));
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+					pData->SendChatTarget(pData->m_ClientID, aBuf);
 				}
 				else
 				{
 					str_format(aBuf, sizeof(aBuf), "%d. %s Team time: %02d:%05.02f, requested by %s", Rank, aNames, (int)(Time/60), Time-((int)Time/60*60), pData->m_aRequestingPlayer);
-					pData->m_pSqlData->GameServer()->SendChat(-1, CGameContext::CHAT_ALL, aBuf, pData->m_ClientID);
+					pData->SendChatAll(aBuf, pData->m_ClientID);
 				}
 			}
 
 			dbg_msg("SQL", "Showing teamrank done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -853,42 +881,34 @@ void CSqlScore::ShowTeamRankThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show team rank");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
-void CSqlScore::ShowTeamTop5Thread(void *pUser)
+void CSqlScore::ShowTeamTop5Thread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
 			// check sort methode
 			char aBuf[512];
 
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @previd := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @previd := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 			str_format(aBuf, sizeof(aBuf), "SELECT ID, Name, Time, rank FROM (SELECT r.ID, Name, rank, l.Time FROM ((SELECT ID, rank, Time FROM (SELECT ID, (@pos := IF(@previd = ID,@pos,@pos+1)) pos, (@previd := ID), (@rank := IF(@prev = Time,@rank,@pos)) rank, (@prev := Time) Time FROM (SELECT ID, MIN(Time) as Time FROM %s_teamrace WHERE Map = '%s' GROUP BY ID ORDER BY `Time` ASC) as all_top_times) as a LIMIT %d, 5) as l) LEFT JOIN %s_teamrace as r ON l.ID = r.ID ORDER BY Time ASC, r.ID, Name ASC) as a;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_Num-1, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
 			// show teamtop5
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "------- Team Top 5 -------");
+			pData->SendChatTarget(pData->m_ClientID, "------- Team Top 5 -------");
 
-			int Rows = pData->m_pSqlData->m_pResults->rowsCount();
+			int Rows = pSql->m_pResults->rowsCount();
 
 			if (Rows >= 1) {
 				char aID[17];
@@ -902,52 +922,52 @@ void CSqlScore::ShowTeamTop5Thread(void *pUser)
 				aNames[0] = '\0';
 				aCuts[0] = -1;
 
-				pData->m_pSqlData->m_pResults->first();
-				strcpy(aID, pData->m_pSqlData->m_pResults->getString("ID").c_str());
+				pSql->m_pResults->first();
+				strcpy(aID, pSql->m_pResults->getString("ID").c_str());
 				for(int Row = 0; Row < Rows; Row++)
 				{
-					strcpy(aID2, pData->m_pSqlData->m_pResults->getString("ID").c_str());
+					strcpy(aID2, pSql->m_pResults->getString("ID").c_str());
 					if (str_comp(aID, aID2) != 0)
 					{
 						strcpy(aID, aID2);
 						aCuts[CutPos++] = Row - 1;
 					}
-					pData->m_pSqlData->m_pResults->next();
+					pSql->m_pResults->next();
 				}
 				aCuts[CutPos] = Rows - 1;
 
 				CutPos = 0;
-				pData->m_pSqlData->m_pResults->first();
+				pSql->m_pResults->first();
 				for(int Row = 0; Row < Rows; Row++)
 				{
-					strcat(aNames, pData->m_pSqlData->m_pResults->getString("Name").c_str());
+					strcat(aNames, pSql->m_pResults->getString("Name").c_str());
 
 					if (Row < aCuts[CutPos] - 1)
 						strcat(aNames, ", ");
 					else if (Row < aCuts[CutPos])
 						strcat(aNames, " & ");
 
-					Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-					Rank = (float)pData->m_pSqlData->m_pResults->getInt("rank");
+					Time = (float)pSql->m_pResults->getDouble("Time");
+					Rank = (float)pSql->m_pResults->getInt("rank");
 
 					if (Row == aCuts[CutPos])
 					{
 						str_format(aBuf, sizeof(aBuf), "%d. %s Team Time: %02d:%05.2f", Rank, aNames, (int)(Time/60), Time-((int)Time/60*60));
-						pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+						pData->SendChatTarget(pData->m_ClientID, aBuf);
 						CutPos++;
 						aNames[0] = '\0';
 					}
 
-					pData->m_pSqlData->m_pResults->next();
+					pSql->m_pResults->next();
 				}
 			}
 
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "-------------------------------");
+			pData->SendChatTarget(pData->m_ClientID, "-------------------------------");
 
 			dbg_msg("SQL", "Showing teamtop5 done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -955,25 +975,17 @@ void CSqlScore::ShowTeamTop5Thread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show teamtop5");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
-void CSqlScore::ShowRankThread(void *pUser)
+void CSqlScore::ShowRankThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -985,40 +997,40 @@ void CSqlScore::ShowRankThread(void *pUser)
 			// check sort methode
 			char aBuf[600];
 
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 			str_format(aBuf, sizeof(aBuf), "SELECT Rank, Name, Time FROM (SELECT Name, (@pos := @pos+1) pos, (@rank := IF(@prev = Time,@rank, @pos)) rank, (@prev := Time) Time FROM (SELECT Name, min(Time) as Time FROM %s_race WHERE Map = '%s' GROUP BY Name ORDER BY `Time` ASC) as a) as b WHERE Name = '%s';", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_aName);
 
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
 				str_format(aBuf, sizeof(aBuf), "%s is not ranked", originalName);
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
+				pSql->m_pResults->next();
 
-				float Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-				int Rank = (int)pData->m_pSqlData->m_pResults->getInt("Rank");
+				float Time = (float)pSql->m_pResults->getDouble("Time");
+				int Rank = (int)pSql->m_pResults->getInt("Rank");
 				if(g_Config.m_SvHideScore)
 				{
 					str_format(aBuf, sizeof(aBuf), "Your time: %02d:%05.2f", (int)(Time/60), Time-((int)Time/60*60));
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+					pData->SendChatTarget(pData->m_ClientID, aBuf);
 				}
 				else
 				{
-					str_format(aBuf, sizeof(aBuf), "%d. %s Time: %02d:%05.2f, requested by %s", Rank, pData->m_pSqlData->m_pResults->getString("Name").c_str(), (int)(Time/60), Time-((int)Time/60*60), pData->m_aRequestingPlayer);
-					pData->m_pSqlData->GameServer()->SendChat(-1, CGameContext::CHAT_ALL, aBuf, pData->m_ClientID);
+					str_format(aBuf, sizeof(aBuf), "%d. %s Time: %02d:%05.2f, requested by %s", Rank, pSql->m_pResults->getString("Name").c_str(), (int)(Time/60), Time-((int)Time/60*60), pData->m_aRequestingPlayer);
+					pData->SendChatAll(aBuf, pData->m_ClientID);
 				}
 			}
 
 			dbg_msg("SQL", "Showing rank done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1026,15 +1038,9 @@ void CSqlScore::ShowRankThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show rank");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::ShowTeamRank(int ClientID, const char* pName, bool Search)
@@ -1044,10 +1050,8 @@ void CSqlScore::ShowTeamRank(int ClientID, const char* pName, bool Search)
 	str_copy(Tmp->m_aName, pName, MAX_NAME_LENGTH);
 	Tmp->m_Search = Search;
 	str_format(Tmp->m_aRequestingPlayer, sizeof(Tmp->m_aRequestingPlayer), "%s", Server()->ClientName(ClientID));
-	Tmp->m_pSqlData = this;
 
-	void *TeamRankThread = thread_init(ShowTeamRankThread, Tmp);
-	thread_detach(TeamRankThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTeamRankThread);
 }
 
 void CSqlScore::ShowRank(int ClientID, const char* pName, bool Search)
@@ -1057,50 +1061,46 @@ void CSqlScore::ShowRank(int ClientID, const char* pName, bool Search)
 	str_copy(Tmp->m_aName, pName, MAX_NAME_LENGTH);
 	Tmp->m_Search = Search;
 	str_format(Tmp->m_aRequestingPlayer, sizeof(Tmp->m_aRequestingPlayer), "%s", Server()->ClientName(ClientID));
-	Tmp->m_pSqlData = this;
 
-	void *RankThread = thread_init(ShowRankThread, Tmp);
-	thread_detach(RankThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowRankThread);
 }
 
-void CSqlScore::ShowTop5Thread(void *pUser)
+void CSqlScore::ShowTop5Thread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
 			// check sort methode
 			char aBuf[512];
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 			str_format(aBuf, sizeof(aBuf), "SELECT Name, Time, rank FROM (SELECT Name, (@pos := @pos+1) pos, (@rank := IF(@prev = Time,@rank, @pos)) rank, (@prev := Time) Time FROM (SELECT Name, min(Time) as Time FROM %s_race WHERE Map = '%s' GROUP BY Name ORDER BY `Time` ASC) as a) as b LIMIT %d, 5;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_Num-1);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
 			// show top5
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "----------- Top 5 -----------");
+			pData->SendChatTarget(pData->m_ClientID, "----------- Top 5 -----------");
 
 			int Rank = 0;
 			float Time = 0;
-			while(pData->m_pSqlData->m_pResults->next())
+			while(pSql->m_pResults->next())
 			{
-				Time = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
-				Rank = (float)pData->m_pSqlData->m_pResults->getInt("rank");
-				str_format(aBuf, sizeof(aBuf), "%d. %s Time: %02d:%05.2f", Rank, pData->m_pSqlData->m_pResults->getString("Name").c_str(), (int)(Time/60), Time-((int)Time/60*60));
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				Time = (float)pSql->m_pResults->getDouble("Time");
+				Rank = (float)pSql->m_pResults->getInt("rank");
+				str_format(aBuf, sizeof(aBuf), "%d. %s Time: %02d:%05.2f", Rank, pSql->m_pResults->getString("Name").c_str(), (int)(Time/60), Time-((int)Time/60*60));
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 				//Rank++;
 			}
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "-------------------------------");
+			pData->SendChatTarget(pData->m_ClientID, "-------------------------------");
 
 			dbg_msg("SQL", "Showing top5 done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1108,24 +1108,17 @@ void CSqlScore::ShowTop5Thread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show top5");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
-void CSqlScore::ShowTimesThread(void *pUser)
+void CSqlScore::ShowTimesThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -1140,28 +1133,29 @@ void CSqlScore::ShowTimesThread(void *pUser)
 			else// last 5 times of server
 				str_format(aBuf, sizeof(aBuf), "SELECT Name, Time, UNIX_TIMESTAMP(CURRENT_TIMESTAMP)-UNIX_TIMESTAMP(Timestamp) as Ago, UNIX_TIMESTAMP(Timestamp) as Stamp FROM %s_race WHERE Map = '%s' ORDER BY Ago ASC LIMIT %d, 5;", pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_aMap, pData->m_Num-1);
 
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
 			// show top5
-			if(pData->m_pSqlData->m_pResults->rowsCount() == 0)
+			if(pSql->m_pResults->rowsCount() == 0)
 			{
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "There are no times in the specified range");
-				goto end;
+				pData->SendChatTarget(pData->m_ClientID, "There are no times in the specified range");
+				delete pSql->m_pResults;
+				return;
 			}
 
-			str_format(aBuf, sizeof(aBuf), "------------ Last Times No %d - %d ------------",pData->m_Num,pData->m_Num + pData->m_pSqlData->m_pResults->rowsCount() - 1);
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+			str_format(aBuf, sizeof(aBuf), "------------ Last Times No %d - %d ------------",pData->m_Num,pData->m_Num + pSql->m_pResults->rowsCount() - 1);
+			pData->SendChatTarget(pData->m_ClientID, aBuf);
 
 			float pTime = 0;
 			int pSince = 0;
 			int pStamp = 0;
 
-			while(pData->m_pSqlData->m_pResults->next())
+			while(pSql->m_pResults->next())
 			{
 				char pAgoString[40] = "\0";
-				pSince = (int)pData->m_pSqlData->m_pResults->getInt("Ago");
-				pStamp = (int)pData->m_pSqlData->m_pResults->getInt("Stamp");
-				pTime = (float)pData->m_pSqlData->m_pResults->getDouble("Time");
+				pSince = (int)pSql->m_pResults->getInt("Ago");
+				pStamp = (int)pSql->m_pResults->getInt("Stamp");
+				pTime = (float)pSql->m_pResults->getDouble("Time");
 
 				agoTimeToString(pSince,pAgoString);
 
@@ -1175,18 +1169,18 @@ void CSqlScore::ShowTimesThread(void *pUser)
 				else // last 5 times of the server
 				{
 					if(pStamp == 0) // stamp is 00:00:00 cause it's an old entry from old times where there where no stamps yet
-						str_format(aBuf, sizeof(aBuf), "%s, %02d:%05.02f s, don't know when", pData->m_pSqlData->m_pResults->getString("Name").c_str(), (int)(pTime/60), pTime-((int)pTime/60*60));
+						str_format(aBuf, sizeof(aBuf), "%s, %02d:%05.02f s, don't know when", pSql->m_pResults->getString("Name").c_str(), (int)(pTime/60), pTime-((int)pTime/60*60));
 					else
-						str_format(aBuf, sizeof(aBuf), "%s, %s ago, %02d:%05.02f s", pData->m_pSqlData->m_pResults->getString("Name").c_str(), pAgoString, (int)(pTime/60), pTime-((int)pTime/60*60));
+						str_format(aBuf, sizeof(aBuf), "%s, %s ago, %02d:%05.02f s", pSql->m_pResults->getString("Name").c_str(), pAgoString, (int)(pTime/60), pTime-((int)pTime/60*60));
 				}
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "----------------------------------------------------");
+			pData->SendChatTarget(pData->m_ClientID, "----------------------------------------------------");
 
 			dbg_msg("SQL", "Showing times done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1194,14 +1188,10 @@ void CSqlScore::ShowTimesThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show times");
+			pSql->SetBroken();
 		}
-		end:
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-	delete pData;
 
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::ShowTeamTop5(IConsole::IResult *pResult, int ClientID, void *pUserData, int Debut)
@@ -1209,10 +1199,8 @@ void CSqlScore::ShowTeamTop5(IConsole::IResult *pResult, int ClientID, void *pUs
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_Num = Debut;
 	Tmp->m_ClientID = ClientID;
-	Tmp->m_pSqlData = this;
 
-	void *TeamTop5Thread = thread_init(ShowTeamTop5Thread, Tmp);
-	thread_detach(TeamTop5Thread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTeamTop5Thread);
 }
 
 void CSqlScore::ShowTop5(IConsole::IResult *pResult, int ClientID, void *pUserData, int Debut)
@@ -1220,10 +1208,8 @@ void CSqlScore::ShowTop5(IConsole::IResult *pResult, int ClientID, void *pUserDa
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_Num = Debut;
 	Tmp->m_ClientID = ClientID;
-	Tmp->m_pSqlData = this;
 
-	void *Top5Thread = thread_init(ShowTop5Thread, Tmp);
-	thread_detach(Top5Thread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTop5Thread);
 }
 
 void CSqlScore::ShowTimes(int ClientID, int Debut)
@@ -1231,11 +1217,9 @@ void CSqlScore::ShowTimes(int ClientID, int Debut)
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_Num = Debut;
 	Tmp->m_ClientID = ClientID;
-	Tmp->m_pSqlData = this;
 	Tmp->m_Search = false;
 
-	void *TimesThread = thread_init(ShowTimesThread, Tmp);
-	thread_detach(TimesThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTimesThread);
 }
 
 void CSqlScore::ShowTimes(int ClientID, const char* pName, int Debut)
@@ -1244,11 +1228,9 @@ void CSqlScore::ShowTimes(int ClientID, const char* pName, int Debut)
 	Tmp->m_Num = Debut;
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aName, pName, MAX_NAME_LENGTH);
-	Tmp->m_pSqlData = this;
 	Tmp->m_Search = true;
 
-	void *TimesThread = thread_init(ShowTimesThread, Tmp);
-	thread_detach(TimesThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTimesThread);
 }
 
 void CSqlScore::FuzzyString(char *pString)
@@ -1382,14 +1364,12 @@ void CSqlScore::agoTimeToString(int agoTime, char agoString[])
 	}
 }
 
-void CSqlScore::ShowPointsThread(void *pUser)
+void CSqlScore::ShowPointsThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -1398,32 +1378,32 @@ void CSqlScore::ShowPointsThread(void *pUser)
 			strcpy(originalName,pData->m_aName);
 			pData->m_pSqlData->ClearString(pData->m_aName);
 
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 
 			char aBuf[512];
 			str_format(aBuf, sizeof(aBuf), "select Rank, Name, Points from (select (@pos := @pos+1) pos, (@rank := IF(@prev = Points,@rank,@pos)) Rank, Points, Name from (select (@prev := Points) Points, Name from %s_points order by Points desc) as ll) as l where Name = '%s';", pData->m_pSqlData->m_pPrefix, pData->m_aName);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
 				str_format(aBuf, sizeof(aBuf), "%s has not collected any points so far", originalName);
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
-				int count = (int)pData->m_pSqlData->m_pResults->getInt("Points");
-				int rank = (int)pData->m_pSqlData->m_pResults->getInt("rank");
-				str_format(aBuf, sizeof(aBuf), "%d. %s Points: %d, requested by %s", rank, pData->m_pSqlData->m_pResults->getString("Name").c_str(), count, pData->m_aRequestingPlayer);
-				pData->m_pSqlData->GameServer()->SendChat(-1, CGameContext::CHAT_ALL, aBuf, pData->m_ClientID);
+				pSql->m_pResults->next();
+				int count = (int)pSql->m_pResults->getInt("Points");
+				int rank = (int)pSql->m_pResults->getInt("rank");
+				str_format(aBuf, sizeof(aBuf), "%d. %s Points: %d, requested by %s", rank, pSql->m_pResults->getString("Name").c_str(), count, pData->m_aRequestingPlayer);
+				pData->SendChatAll(aBuf, pData->m_ClientID);
 			}
 
 			dbg_msg("SQL", "Showing points done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1431,15 +1411,9 @@ void CSqlScore::ShowPointsThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show points");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::ShowPoints(int ClientID, const char* pName, bool Search)
@@ -1449,45 +1423,41 @@ void CSqlScore::ShowPoints(int ClientID, const char* pName, bool Search)
 	str_copy(Tmp->m_aName, pName, MAX_NAME_LENGTH);
 	Tmp->m_Search = Search;
 	str_format(Tmp->m_aRequestingPlayer, sizeof(Tmp->m_aRequestingPlayer), "%s", Server()->ClientName(ClientID));
-	Tmp->m_pSqlData = this;
 
-	void *PointsThread = thread_init(ShowPointsThread, Tmp);
-	thread_detach(PointsThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowPointsThread);
 }
 
-void CSqlScore::ShowTopPointsThread(void *pUser)
+void CSqlScore::ShowTopPointsThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
 			char aBuf[512];
-			pData->m_pSqlData->m_pStatement->execute("SET @prev := NULL;");
-			pData->m_pSqlData->m_pStatement->execute("SET @rank := 1;");
-			pData->m_pSqlData->m_pStatement->execute("SET @pos := 0;");
+			pSql->m_pStatement->execute("SET @prev := NULL;");
+			pSql->m_pStatement->execute("SET @rank := 1;");
+			pSql->m_pStatement->execute("SET @pos := 0;");
 			str_format(aBuf, sizeof(aBuf), "select Rank, Name, Points from (select (@pos := @pos+1) pos, (@rank := IF(@prev = Points,@rank,@pos)) Rank, Points, Name from (select (@prev := Points) Points, Name from %s_points order by Points desc) as ll) as l LIMIT %d, 5;", pData->m_pSqlData->m_pPrefix, pData->m_Num-1);
 
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
 			// show top points
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "-------- Top Points --------");
+			pData->SendChatTarget(pData->m_ClientID, "-------- Top Points --------");
 
-			while(pData->m_pSqlData->m_pResults->next())
+			while(pSql->m_pResults->next())
 			{
-				str_format(aBuf, sizeof(aBuf), "%d. %s Points: %d", pData->m_pSqlData->m_pResults->getInt("rank"), pData->m_pSqlData->m_pResults->getString("Name").c_str(), pData->m_pSqlData->m_pResults->getInt("Points"));
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+				str_format(aBuf, sizeof(aBuf), "%d. %s Points: %d", pSql->m_pResults->getInt("rank"), pSql->m_pResults->getString("Name").c_str(), pSql->m_pResults->getInt("Points"));
+				pData->SendChatTarget(pData->m_ClientID, aBuf);
 			}
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "-------------------------------");
+			pData->SendChatTarget(pData->m_ClientID, "-------------------------------");
 
 			dbg_msg("SQL", "Showing toppoints done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1495,15 +1465,9 @@ void CSqlScore::ShowTopPointsThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not show toppoints");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
 void CSqlScore::ShowTopPoints(IConsole::IResult *pResult, int ClientID, void *pUserData, int Debut)
@@ -1511,20 +1475,17 @@ void CSqlScore::ShowTopPoints(IConsole::IResult *pResult, int ClientID, void *pU
 	CSqlScoreData *Tmp = new CSqlScoreData();
 	Tmp->m_Num = Debut;
 	Tmp->m_ClientID = ClientID;
-	Tmp->m_pSqlData = this;
 
-	void *TopPointsThread = thread_init(ShowTopPointsThread, Tmp);
-	thread_detach(TopPointsThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, ShowTopPointsThread);
 }
 
-void CSqlScore::RandomMapThread(void *pUser)
+void CSqlScore::RandomMapThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	pData->m_Found = false;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -1533,26 +1494,23 @@ void CSqlScore::RandomMapThread(void *pUser)
 				str_format(aBuf, sizeof(aBuf), "select * from %s_maps where Server = \"%s\" and Stars = \"%d\" order by RAND() limit 1;", pData->m_pSqlData->m_pPrefix, g_Config.m_SvServerType, pData->m_Num);
 			else
 				str_format(aBuf, sizeof(aBuf), "select * from %s_maps where Server = \"%s\" order by RAND() limit 1;", pData->m_pSqlData->m_pPrefix, g_Config.m_SvServerType);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "No maps found on this server!");
+				pData->SendChatTarget(pData->m_ClientID, "No maps found on this server!");
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
-				char aMap[128];
-				strcpy(aMap, pData->m_pSqlData->m_pResults->getString("Map").c_str());
-
-				str_format(aBuf, sizeof(aBuf), "change_map \"%s\"", aMap);
-				pData->m_pSqlData->GameServer()->Console()->ExecuteLine(aBuf);
+				pSql->m_pResults->next();
+				pData->m_Found = true;
+				str_copy(pData->m_aMap, pSql->m_pResults->getString("Map").c_str(), sizeof(pData->m_aMap));
 			}
 
 			dbg_msg("SQL", "Voting random map done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1560,25 +1518,18 @@ void CSqlScore::RandomMapThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not vote random map");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-
-	delete pData;
-
-	lock_unlock(gs_SqlLock);
 }
 
-void CSqlScore::RandomUnfinishedMapThread(void *pUser)
+void CSqlScore::RandomUnfinishedMapThread(CSqlConnection *pSql, void *pUser)
 {
-	lock_wait(gs_SqlLock);
-
 	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	pData->m_Found = false;
 
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
@@ -1591,26 +1542,23 @@ void CSqlScore::RandomUnfinishedMapThread(void *pUser)
 				str_format(aBuf, sizeof(aBuf), "select * from %s_maps where Server = \"%s\" and Stars = \"%d\" and not exists (select * from %s_race where Name = \"%s\" and %s_race.Map = %s_maps.Map) order by RAND() limit 1;", pData->m_pSqlData->m_pPrefix, g_Config.m_SvServerType, pData->m_Num, pData->m_pSqlData->m_pPrefix, pData->m_aName, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_pPrefix);
 			else
 				str_format(aBuf, sizeof(aBuf), "select * from %s_maps where Server = \"%s\" and not exists (select * from %s_race where Name = \"%s\" and %s_race.Map = %s_maps.Map) order by RAND() limit 1;", pData->m_pSqlData->m_pPrefix, g_Config.m_SvServerType, pData->m_pSqlData->m_pPrefix, pData->m_aName, pData->m_pSqlData->m_pPrefix, pData->m_pSqlData->m_pPrefix);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if(pData->m_pSqlData->m_pResults->rowsCount() != 1)
+			if(pSql->m_pResults->rowsCount() != 1)
 			{
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "You have no unfinished maps on this server!");
+				pData->SendChatTarget(pData->m_ClientID, "You have no unfinished maps on this server!");
 			}
 			else
 			{
-				pData->m_pSqlData->m_pResults->next();
-				char aMap[128];
-				strcpy(aMap, pData->m_pSqlData->m_pResults->getString("Map").c_str());
-
-				str_format(aBuf, sizeof(aBuf), "change_map \"%s\"", aMap);
-				pData->m_pSqlData->GameServer()->Console()->ExecuteLine(aBuf);
+				pSql->m_pResults->next();
+				pData->m_Found = true;
+				str_copy(pData->m_aMap, pSql->m_pResults->getString("Map").c_str(), sizeof(pData->m_aMap));
 			}
 
 			dbg_msg("SQL", "Voting random unfinished map done");
 
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1618,15 +1566,20 @@ void CSqlScore::RandomUnfinishedMapThread(void *pUser)
 			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf);
 			dbg_msg("SQL", "ERROR: Could not vote random unfinished map");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
+}
 
-	delete pData;
+void CSqlScore::RandomMapDone(CSqlData *pUser)
+{
+	CSqlScoreData *pData = (CSqlScoreData *)pUser;
+	if(!pData->m_Found)
+		return;
 
-	lock_unlock(gs_SqlLock);
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "change_map \"%s\"", pData->m_aMap);
+	pData->m_pSqlData->GameServer()->Console()->ExecuteLine(aBuf);
 }
 
 void CSqlScore::RandomMap(int ClientID, int stars)
@@ -1635,10 +1588,8 @@ void CSqlScore::RandomMap(int ClientID, int stars)
 	Tmp->m_Num = stars;
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aName, GameServer()->Server()->ClientName(ClientID), MAX_NAME_LENGTH);
-	Tmp->m_pSqlData = this;
 
-	void *RandomThread = thread_init(RandomMapThread, Tmp);
-	thread_detach(RandomThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, RandomMapThread, RandomMapDone);
 }
 
 void CSqlScore::RandomUnfinishedMap(int ClientID, int stars)
@@ -1647,19 +1598,17 @@ void CSqlScore::RandomUnfinishedMap(int ClientID, int stars)
 	Tmp->m_Num = stars;
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_aName, GameServer()->Server()->ClientName(ClientID), MAX_NAME_LENGTH);
-	Tmp->m_pSqlData = this;
 
-	void *RandomUnfinishedThread = thread_init(RandomUnfinishedMapThread, Tmp);
-	thread_detach(RandomUnfinishedThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_QUERY, RandomUnfinishedMapThread, RandomMapDone);
 }
 
 void CSqlScore::SaveTeam(int Team, const char* Code, int ClientID, const char* Server)
 {
-	if((g_Config.m_SvTeam == 3 || (Team > 0 && Team < MAX_CLIENTS)) && ((CGameControllerDDRace*)(GameServer()->m_pController))->m_Teams.Count(Team) > 0)
+	CGameControllerDDRace *pController = (CGameControllerDDRace*)(GameServer()->m_pController);
+	if((g_Config.m_SvTeam == 3 || (Team > 0 && Team < MAX_CLIENTS)) && pController->m_Teams.Count(Team) > 0)
 	{
-		if(((CGameControllerDDRace*)(GameServer()->m_pController))->m_Teams.GetSaving(Team))
+		if(pController->m_Teams.GetSaving(Team))
 			return;
-		((CGameControllerDDRace*)(GameServer()->m_pController))->m_Teams.SetSaving(Team, true);
 	}
 	else
 	{
@@ -1667,23 +1616,51 @@ void CSqlScore::SaveTeam(int Team, const char* Code, int ClientID, const char* S
 		return;
 	}
 
+	// the workers must not touch the world, so the team is taken right away
+	CSaveTeam *pSavedTeam = new CSaveTeam(GameServer()->m_pController);
+	int Num = pSavedTeam->save(Team);
+	switch (Num)
+	{
+		case 1:
+			GameServer()->SendChatTarget(ClientID, "You have to be in a Team (from 1-63)");
+			break;
+		case 2:
+			GameServer()->SendChatTarget(ClientID, "Could not find your Team");
+			break;
+		case 3:
+			GameServer()->SendChatTarget(ClientID, "Unable to find all Characters");
+			break;
+		case 4:
+			GameServer()->SendChatTarget(ClientID, "Your team is not started yet");
+			break;
+	}
+	if(Num)
+	{
+		delete pSavedTeam;
+		return;
+	}
+
 	CSqlTeamSave *Tmp = new CSqlTeamSave();
 	Tmp->m_Team = Team;
 	Tmp->m_ClientID = ClientID;
 	str_copy(Tmp->m_Code, Code, 32);
 	str_copy(Tmp->m_Server, Server, sizeof(Tmp->m_Server));
-	Tmp->m_pSqlData = this;
+	str_copy(Tmp->m_aTeamString, pSavedTeam->GetString(), sizeof(Tmp->m_aTeamString));
+	delete pSavedTeam;
 
-	void *SaveThread = thread_init(SaveTeamThread, Tmp);
-	thread_detach(SaveThread);
+	pController->m_Teams.SetSaving(Team, true);
+	if(!AddJob(Tmp, CSqlPool::PRIORITY_SAVE, SaveTeamThread, SaveTeamDone))
+	{
+		pController->m_Teams.SetSaving(Team, false);
+		GameServer()->SendChatTarget(ClientID, "The database is busy, try again later");
+	}
 }
 
-void CSqlScore::SaveTeamThread(void *pUser)
+void CSqlScore::SaveTeamThread(CSqlConnection *pSql, void *pUser)
 {
-	CSaveTeam* SavedTeam = 0;
 	CSqlTeamSave *pData = (CSqlTeamSave *)pUser;
+	pData->m_Saved = false;
 
-	char TeamString[65536];
 	int Team = pData->m_Team;
 	char OriginalCode[32];
 	str_copy(OriginalCode, pData->m_Code, sizeof(OriginalCode));
@@ -1691,66 +1668,37 @@ void CSqlScore::SaveTeamThread(void *pUser)
 	char Map[128];
 	str_copy(Map, g_Config.m_SvMap, 128);
 	pData->m_pSqlData->ClearString(Map, sizeof(Map));
+	pData->m_pSqlData->ClearString(pData->m_aTeamString, sizeof(pData->m_aTeamString));
 
-	int Num = -1;
-
-	if((g_Config.m_SvTeam == 3 || (Team > 0 && Team < MAX_CLIENTS)) && ((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.Count(Team) > 0)
-	{
-		SavedTeam = new CSaveTeam(pData->m_pSqlData->GameServer()->m_pController);
-		Num = SavedTeam->save(Team);
-		switch (Num)
-		{
-			case 1:
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "You have to be in a Team (from 1-63)");
-				break;
-			case 2:
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "Could not find your Team");
-				break;
-			case 3:
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "Unable to find all Characters");
-				break;
-			case 4:
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "Your team is not started yet");
-				break;
-		}
-		if(!Num)
-		{
-			str_copy(TeamString, SavedTeam->GetString(), sizeof(TeamString));
-			pData->m_pSqlData->ClearString(TeamString, sizeof(TeamString));
-		}
-	}
-	else
-		pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "You have to be in a Team (from 1-63)");
-
-	lock_wait(gs_SqlLock);
 	// Connect to database
-	if(!Num && pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
 			char aBuf[512];
 			str_format(aBuf, sizeof(aBuf), "select Savegame from %s_saves where Code = '%s' and Map = '%s';",  pData->m_pSqlData->m_pPrefix, pData->m_Code, Map);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if (pData->m_pSqlData->m_pResults->rowsCount() == 0)
+			if (pSql->m_pResults->rowsCount() == 0)
 			{
 				// delete results and statement
-				delete pData->m_pSqlData->m_pResults;
+				delete pSql->m_pResults;
 
 				char aBuf[65536];
-				str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_saves(Savegame, Map, Code, Timestamp, Server) VALUES ('%s', '%s', '%s', CURRENT_TIMESTAMP(), '%s')",  pData->m_pSqlData->m_pPrefix, TeamString, Map, pData->m_Code, pData->m_Server);
+				str_format(aBuf, sizeof(aBuf), "INSERT IGNORE INTO %s_saves(Savegame, Map, Code, Timestamp, Server) VALUES ('%s', '%s', '%s', CURRENT_TIMESTAMP(), '%s')",  pData->m_pSqlData->m_pPrefix, pData->m_aTeamString, Map, pData->m_Code, pData->m_Server);
 				dbg_msg("SQL", aBuf);
-				pData->m_pSqlData->m_pStatement->execute(aBuf);
+				pSql->m_pStatement->execute(aBuf);
 
 				char aBuf2[256];
 				str_format(aBuf2, sizeof(aBuf2), "Team successfully saved. Use '/load %s' to continue", OriginalCode);
-				pData->m_pSqlData->GameServer()->SendChatTeam(Team, aBuf2);
-				((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.KillSavedTeam(Team);
+				pData->SendChatTeam(Team, aBuf2);
+				pData->m_Saved = true;
 			}
 			else
 			{
+				delete pSql->m_pResults;
 				dbg_msg("SQL", "ERROR: This save-code already exists");
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "This save-code already exists");
+				pData->SendChatTarget(pData->m_ClientID, "This save-code already exists");
 			}
 		}
 		catch (sql::SQLException &e)
@@ -1759,25 +1707,24 @@ void CSqlScore::SaveTeamThread(void *pUser)
 			str_format(aBuf2, sizeof(aBuf2), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf2);
 			dbg_msg("SQL", "ERROR: Could not save the team");
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "MySQL Error: Could not save the team");
+			pData->SendChatTarget(pData->m_ClientID, "MySQL Error: Could not save the team");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
-	else if(!Num)
+	else
 	{
 		dbg_msg("SQL", "connection failed");
-		pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "ERROR: Unable to connect to SQL-Server");
+		pData->SendChatTarget(pData->m_ClientID, "ERROR: Unable to connect to SQL-Server");
 	}
+}
 
-	((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.SetSaving(Team, false);
-
-	delete pData;
-	if(SavedTeam)
-		delete SavedTeam;
-
-	lock_unlock(gs_SqlLock);
+void CSqlScore::SaveTeamDone(CSqlData *pUser)
+{
+	CSqlTeamSave *pData = (CSqlTeamSave *)pUser;
+	CGameControllerDDRace *pController = (CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController);
+	if(pData->m_Saved)
+		pController->m_Teams.KillSavedTeam(pData->m_Team);
+	pController->m_Teams.SetSaving(pData->m_Team, false);
 }
 
 void CSqlScore::LoadTeam(const char* Code, int ClientID)
@@ -1785,120 +1732,56 @@ void CSqlScore::LoadTeam(const char* Code, int ClientID)
 	CSqlTeamLoad *Tmp = new CSqlTeamLoad();
 	str_copy(Tmp->m_Code, Code, 32);
 	Tmp->m_ClientID = ClientID;
-	Tmp->m_pSqlData = this;
 
-	void *LoadThread = thread_init(LoadTeamThread, Tmp);
-	thread_detach(LoadThread);
+	AddJob(Tmp, CSqlPool::PRIORITY_LOAD, LoadTeamThread, LoadTeamDone);
 }
 
-void CSqlScore::LoadTeamThread(void *pUser)
+void CSqlScore::LoadTeamThread(CSqlConnection *pSql, void *pUser)
 {
-	CSaveTeam* SavedTeam;
 	CSqlTeamLoad *pData = (CSqlTeamLoad *)pUser;
-
-	SavedTeam = new CSaveTeam(pData->m_pSqlData->GameServer()->m_pController);
+	pData->m_Found = false;
 
 	pData->m_pSqlData->ClearString(pData->m_Code, sizeof(pData->m_Code));
-	char Map[128];
-	str_copy(Map, g_Config.m_SvMap, 128);
-	pData->m_pSqlData->ClearString(Map, sizeof(Map));
-	int Num;
+	str_copy(pData->m_aMap, g_Config.m_SvMap, sizeof(pData->m_aMap));
+	pData->m_pSqlData->ClearString(pData->m_aMap, sizeof(pData->m_aMap));
 
-	lock_wait(gs_SqlLock);
 	// Connect to database
-	if(pData->m_pSqlData->Connect())
+	if(pSql->Connect())
 	{
 		try
 		{
 			char aBuf[768];
-			str_format(aBuf, sizeof(aBuf), "select Savegame, Server, UNIX_TIMESTAMP(CURRENT_TIMESTAMP)-UNIX_TIMESTAMP(Timestamp) as Ago from %s_saves where Code = '%s' and Map = '%s';",  pData->m_pSqlData->m_pPrefix, pData->m_Code, Map);
-			pData->m_pSqlData->m_pResults = pData->m_pSqlData->m_pStatement->executeQuery(aBuf);
+			str_format(aBuf, sizeof(aBuf), "select Savegame, Server, UNIX_TIMESTAMP(CURRENT_TIMESTAMP)-UNIX_TIMESTAMP(Timestamp) as Ago from %s_saves where Code = '%s' and Map = '%s';",  pData->m_pSqlData->m_pPrefix, pData->m_Code, pData->m_aMap);
+			pSql->m_pResults = pSql->m_pStatement->executeQuery(aBuf);
 
-			if (pData->m_pSqlData->m_pResults->rowsCount() > 0)
+			if (pSql->m_pResults->rowsCount() > 0)
 			{
-				pData->m_pSqlData->m_pResults->first();
+				pSql->m_pResults->first();
 				char ServerName[5];
-				str_copy(ServerName, pData->m_pSqlData->m_pResults->getString("Server").c_str(), sizeof(ServerName));
+				str_copy(ServerName, pSql->m_pResults->getString("Server").c_str(), sizeof(ServerName));
+				int since = (int)pSql->m_pResults->getInt("Ago");
+
 				if(str_comp(ServerName, g_Config.m_SvSqlServerName))
 				{
 					str_format(aBuf, sizeof(aBuf), "You have to be on the '%s' server to load this savegame", ServerName);
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-					goto end;
+					pData->SendChatTarget(pData->m_ClientID, aBuf);
 				}
-
-				pData->m_pSqlData->m_pResults->getInt("Ago");
-				int since = (int)pData->m_pSqlData->m_pResults->getInt("Ago");
-
-				if(since < g_Config.m_SvSaveGamesDelay)
+				else if(since < g_Config.m_SvSaveGamesDelay)
 				{
 					str_format(aBuf, sizeof(aBuf), "You have to wait %d seconds until you can load this savegame", g_Config.m_SvSaveGamesDelay - since);
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-					goto end;
+					pData->SendChatTarget(pData->m_ClientID, aBuf);
 				}
-
-				Num = SavedTeam->LoadString(pData->m_pSqlData->m_pResults->getString("Savegame").c_str());
-
-				if(Num)
-					pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "Unable to load savegame: data corrupted");
 				else
 				{
-
-					bool found = false;
-					for (int i = 0; i < SavedTeam->GetMembersCount(); i++)
-					{
-						if(str_comp(SavedTeam->SavedTees[i].GetName(), pData->m_pSqlData->Server()->ClientName(pData->m_ClientID)) == 0)
-						{ found = true; break; }
-					}
-					if (!found)
-						pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "You don't belong to this team");
-					else
-					{
-
-						int n;
-						for(n = 1; n<64; n++)
-						{
-							if(((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.Count(n) == 0)
-								break;
-						}
-
-						if(((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.Count(n) > 0)
-						{
-							n = ((CGameControllerDDRace*)(pData->m_pSqlData->GameServer()->m_pController))->m_Teams.m_Core.Team(pData->m_ClientID); // if all Teams are full your the only one in your team
-						}
-
-						Num = SavedTeam->load(n);
-
-						if(Num == 1)
-						{
-							pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "You have to be in a team (from 1-63)");
-						}
-						else if(Num >= 10 && Num < 100)
-						{
-							char aBuf[256];
-							str_format(aBuf, sizeof(aBuf), "Unable to find player: '%s'", SavedTeam->SavedTees[Num-10].GetName());
-							pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-						}
-						else if(Num >= 100)
-						{
-							char aBuf[256];
-							str_format(aBuf, sizeof(aBuf), "%s is racing right now, Team can't be loaded if a Tee is racing already", SavedTeam->SavedTees[Num-100].GetName());
-							pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
-						}
-						else
-						{
-							pData->m_pSqlData->GameServer()->SendChatTeam(n, "Loading successfully done");
-							char aBuf[512];
-							str_format(aBuf, sizeof(aBuf), "DELETE from %s_saves where Code='%s' and Map='%s';", pData->m_pSqlData->m_pPrefix, pData->m_Code, Map);
-							pData->m_pSqlData->m_pStatement->execute(aBuf);
-						}
-					}
+					str_copy(pData->m_aTeamString, pSql->m_pResults->getString("Savegame").c_str(), sizeof(pData->m_aTeamString));
+					pData->m_Found = true;
 				}
 			}
 			else
-				pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "No such savegame for this map");
-			end:
+				pData->SendChatTarget(pData->m_ClientID, "No such savegame for this map");
+
 			// delete results and statement
-			delete pData->m_pSqlData->m_pResults;
+			delete pSql->m_pResults;
 		}
 		catch (sql::SQLException &e)
 		{
@@ -1906,22 +1789,110 @@ void CSqlScore::LoadTeamThread(void *pUser)
 			str_format(aBuf2, sizeof(aBuf2), "MySQL Error: %s", e.what());
 			dbg_msg("SQL", aBuf2);
 			dbg_msg("SQL", "ERROR: Could not load the team");
-			pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "MySQL Error: Could not load the team");
+			pData->SendChatTarget(pData->m_ClientID, "MySQL Error: Could not load the team");
+			pSql->SetBroken();
 		}
-
-		// disconnect from database
-		pData->m_pSqlData->Disconnect();
 	}
 	else
 	{
 		dbg_msg("SQL", "connection failed");
-		pData->m_pSqlData->GameServer()->SendChatTarget(pData->m_ClientID, "ERROR: Unable to connect to SQL-Server");
+		pData->SendChatTarget(pData->m_ClientID, "ERROR: Unable to connect to SQL-Server");
 	}
+}
 
-	delete pData;
-	delete SavedTeam;
+void CSqlScore::LoadTeamDone(CSqlData *pUser)
+{
+	CSqlTeamLoad *pData = (CSqlTeamLoad *)pUser;
+	if(!pData->m_Found)
+		return;
+
+	CSqlScore *pSelf = pData->m_pSqlData;
+	CGameControllerDDRace *pController = (CGameControllerDDRace*)(pSelf->GameServer()->m_pController);
+	CSaveTeam *pSavedTeam = new CSaveTeam(pSelf->GameServer()->m_pController);
+
+	int Num = pSavedTeam->LoadString(pData->m_aTeamString);
+	if(Num)
+		pSelf->GameServer()->SendChatTarget(pData->m_ClientID, "Unable to load savegame: data corrupted");
+	else
+	{
+		bool found = false;
+		for (int i = 0; i < pSavedTeam->GetMembersCount(); i++)
+		{
+			if(str_comp(pSavedTeam->SavedTees[i].GetName(), pSelf->Server()->ClientName(pData->m_ClientID)) == 0)
+			{ found = true; break; }
+		}
+		if (!found)
+			pSelf->GameServer()->SendChatTarget(pData->m_ClientID, "You don't belong to this team");
+		else
+		{
+			int n;
+			for(n = 1; n<64; n++)
+			{
+				if(pController->m_Teams.Count(n) == 0)
+					break;
+			}
+
+			if(pController->m_Teams.Count(n) > 0)
+			{
+				n = pController->m_Teams.m_Core.Team(pData->m_ClientID); // if all Teams are full your the only one in your team
+			}
+
+			Num = pSavedTeam->load(n);
+
+			if(Num == 1)
+			{
+				pSelf->GameServer()->SendChatTarget(pData->m_ClientID, "You have to be in a team (from 1-63)");
+			}
+			else if(Num >= 10 && Num < 100)
+			{
+				char aBuf[256];
+				str_format(aBuf, sizeof(aBuf), "Unable to find player: '%s'", pSavedTeam->SavedTees[Num-10].GetName());
+				pSelf->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+			}
+			else if(Num >= 100)
+			{
+				char aBuf[256];
+				str_format(aBuf, sizeof(aBuf), "%s is racing right now, Team can't be loaded if a Tee is racing already", pSavedTeam->SavedTees[Num-100].GetName());
+				pSelf->GameServer()->SendChatTarget(pData->m_ClientID, aBuf);
+			}
+			else
+			{
+				pSelf->GameServer()->SendChatTeam(n, "Loading successfully done");
+
+				CSqlTeamLoad *Tmp = new CSqlTeamLoad();
+				str_copy(Tmp->m_Code, pData->m_Code, sizeof(Tmp->m_Code));
+				str_copy(Tmp->m_aMap, pData->m_aMap, sizeof(Tmp->m_aMap));
+				pSelf->AddJob(Tmp, CSqlPool::PRIORITY_SAVE, DeleteSaveThread);
+			}
+		}
+	}
+
+	delete pSavedTeam;
+}
+
+// code and map are escaped already
+void CSqlScore::DeleteSaveThread(CSqlConnection *pSql, void *pUser)
+{
+	CSqlTeamLoad *pData = (CSqlTeamLoad *)pUser;
 
-	lock_unlock(gs_SqlLock);
+	// Connect to database
+	if(pSql->Connect())
+	{
+		try
+		{
+			char aBuf[512];
+			str_format(aBuf, sizeof(aBuf), "DELETE from %s_saves where Code='%s' and Map='%s';", pData->m_pSqlData->m_pPrefix, pData->m_Code, pData->m_aMap);
+			pSql->m_pStatement->execute(aBuf);
+		}
+		catch (sql::SQLException &e)
+		{
+			char aBuf[256];
+			str_format(aBuf, sizeof(aBuf), "MySQL Error: %s", e.what());
+			dbg_msg("SQL", aBuf);
+			dbg_msg("SQL", "ERROR: Could not delete the savegame");
+			pSql->SetBroken();
+		}
+	}
 }
 
 #endif
@@ -4,23 +4,27 @@
 #ifndef GAME_SERVER_SQLSCORE_H
 #define GAME_SERVER_SQLSCORE_H
 
-#include <mysql_connection.h>
-
-#include <cppconn/driver.h>
-#include <cppconn/exception.h>
-#include <cppconn/statement.h>
+#include <vector>
 
 #include "../score.h"
+#include "sql_pool.h"
+#include "sql_spool.h"
 
 class CSqlScore: public IScore
 {
+	friend struct CSqlData;
+
+	enum
+	{
+		RETRY_DELAY=5, // seconds after a failed batch
+	};
+
 	CGameContext *m_pGameServer;
 	IServer *m_pServer;
 
-	sql::Driver *m_pDriver;
-	sql::Connection *m_pConnection;
-	sql::Statement *m_pStatement;
-	sql::ResultSet *m_pResults;
+	CSqlPool m_Pool;
+	CSqlSpool m_Spool;
+	int64 m_NextFlush;
 
 	// copy of config vars
 	const char* m_pDatabase;
@@ -40,28 +44,38 @@ class CSqlScore: public IScore
 		return m_pServer;
 	}
 
-	static void MapInfoThread(void *pUser);
-	static void MapVoteThread(void *pUser);
-	static void CheckBirthdayThread(void *pUser);
-	static void LoadScoreThread(void *pUser);
-	static void SaveScoreThread(void *pUser);
-	static void SaveTeamScoreThread(void *pUser);
-	static void ShowRankThread(void *pUser);
-	static void ShowTop5Thread(void *pUser);
-	static void ShowTeamRankThread(void *pUser);
-	static void ShowTeamTop5Thread(void *pUser);
-	static void ShowTimesThread(void *pUser);
-	static void ShowPointsThread(void *pUser);
-	static void ShowTopPointsThread(void *pUser);
-	static void RandomMapThread(void *pUser);
-	static void RandomUnfinishedMapThread(void *pUser);
-	static void SaveTeamThread(void *pUser);
-	static void LoadTeamThread(void *pUser);
+	static void MapInfoThread(CSqlConnection *pSql, void *pUser);
+	static void MapVoteThread(CSqlConnection *pSql, void *pUser);
+	static void CheckBirthdayThread(CSqlConnection *pSql, void *pUser);
+	static void LoadScoreThread(CSqlConnection *pSql, void *pUser);
+	static void FlushSpoolThread(CSqlConnection *pSql, void *pUser);
+	static void ShowRankThread(CSqlConnection *pSql, void *pUser);
+	static void ShowTop5Thread(CSqlConnection *pSql, void *pUser);
+	static void ShowTeamRankThread(CSqlConnection *pSql, void *pUser);
+	static void ShowTeamTop5Thread(CSqlConnection *pSql, void *pUser);
+	static void ShowTimesThread(CSqlConnection *pSql, void *pUser);
+	static void ShowPointsThread(CSqlConnection *pSql, void *pUser);
+	static void ShowTopPointsThread(CSqlConnection *pSql, void *pUser);
+	static void RandomMapThread(CSqlConnection *pSql, void *pUser);
+	static void RandomUnfinishedMapThread(CSqlConnection *pSql, void *pUser);
+	static void SaveTeamThread(CSqlConnection *pSql, void *pUser);
+	static void LoadTeamThread(CSqlConnection *pSql, void *pUser);
+	static void DeleteSaveThread(CSqlConnection *pSql, void *pUser);
+
+	// game thread parts of the jobs above
+	static void LoadScoreDone(struct CSqlData *pUser);
+	static void FlushSpoolDone(struct CSqlData *pUser);
+	static void MapVoteDone(struct CSqlData *pUser);
+	static void RandomMapDone(struct CSqlData *pUser);
+	static void SaveTeamDone(struct CSqlData *pUser);
+	static void LoadTeamDone(struct CSqlData *pUser);
 
 	void Init();
+	// throws, so the whole batch is rolled back
+	void SaveTeamTime(CSqlConnection *pSql, const CSqlSpoolEntry *pEntry);
 
-	bool Connect();
-	void Disconnect();
+	// takes ownership of pData, false if the queue had no room for it
+	bool AddJob(struct CSqlData *pData, int Priority, void (*pfnThread)(CSqlConnection *pSql, void *pUser), void (*pfnDone)(struct CSqlData *pData) = 0);
 
 	void FuzzyString(char *pString);
 	// anti SQL injection
@@ -74,6 +88,7 @@ public:
 	CSqlScore(CGameContext *pGameServer);
 	~CSqlScore();
 
+	virtual void Tick();
 	virtual void CheckBirthday(int ClientID);
 	virtual void LoadScore(int ClientID);
 	virtual void MapInfo(int ClientID, const char* MapName);
@@ -96,20 +111,55 @@ public:
 	virtual void RandomUnfinishedMap(int ClientID, int stars);
 	virtual void SaveTeam(int Team, const char* Code, int ClientID, const char* Server);
 	virtual void LoadTeam(const char* Code, int ClientID);
+	virtual void PrintSpool(IConsole *pConsole);
 	static void agoTimeToString(int agoTime, char agoString[]);
 };
 
-struct CSqlMapData
+// base of all jobs, the chat lines are sent from the game thread once the job is done
+struct CSqlData : public ISqlJob
 {
+	struct CLine
+	{
+		int m_Mode;
+		int m_Target;
+		char m_aText[512];
+	};
+
+	enum
+	{
+		LINE_TARGET=0,
+		LINE_ALL,
+		LINE_TEAM,
+	};
+
 	CSqlScore *m_pSqlData;
 	int m_ClientID;
+	void (*m_pfnThread)(CSqlConnection *pSql, void *pUser);
+	void (*m_pfnDone)(CSqlData *pData);
+	std::vector<CLine> m_vLines;
+
+	CSqlData() : m_pSqlData(0), m_ClientID(-1), m_pfnThread(0), m_pfnDone(0) {}
+
+	virtual void Run(CSqlConnection *pSql) { m_pfnThread(pSql, this); }
+	virtual void Done();
+
+	void SendChatTarget(int ClientID, const char *pText) { AddLine(LINE_TARGET, ClientID, pText); }
+	void SendChatAll(const char *pText, int SpamProtectionClientID) { AddLine(LINE_ALL, SpamProtectionClientID, pText); }
+	void SendChatTeam(int Team, const char *pText) { AddLine(LINE_TEAM, Team, pText); }
+	void AddLine(int Mode, int Target, const char *pText);
+};
+
+struct CSqlMapData : public CSqlData
+{
 	char m_aMap[128];
+
+	// map vote result
+	bool m_Found;
+	char m_aServer[32];
 };
 
-struct CSqlScoreData
+struct CSqlScoreData : public CSqlData
 {
-	CSqlScore *m_pSqlData;
-	int m_ClientID;
 #if defined(CONF_FAMILY_WINDOWS)
 	char m_aName[16]; // Don't edit this, or all your teeth will fall http://bugs.mysql.com/bug.php?id=50046
 #else
@@ -121,40 +171,43 @@ struct CSqlScoreData
 	int m_Num;
 	bool m_Search;
 	char m_aRequestingPlayer[MAX_NAME_LENGTH];
+
+	// load score and random map results
+	bool m_Found;
+	char m_aMap[128];
 };
 
-struct CSqlTeamScoreData
+struct CSqlSpoolFlush : public CSqlData
 {
-	CSqlScore *m_pSqlData;
-	unsigned int m_Size;
-	int m_aClientIDs[MAX_CLIENTS];
-#if defined(CONF_FAMILY_WINDOWS)
-	char m_aNames[16][MAX_CLIENTS]; // Don't edit this, or all your teeth will fall http://bugs.mysql.com/bug.php?id=50046
-#else
-	char m_aNames[MAX_NAME_LENGTH * 2 - 1][MAX_CLIENTS];
-#endif
+	struct CEarned
+	{
+		int m_ClientID;
+		char m_aName[MAX_NAME_LENGTH];
+		int m_Points;
+	};
 
-	float m_Time;
-	float m_aCpCurrent[NUM_CHECKPOINTS];
-	int m_Num;
-	bool m_Search;
-	char m_aRequestingPlayer[MAX_NAME_LENGTH];
+	std::vector<CSqlSpoolEntry> m_vEntries;
+	std::vector<CEarned> m_vEarned;
+	bool m_Flushed;
+
+	CSqlSpoolFlush() : m_Flushed(false) {}
 };
 
-struct CSqlTeamSave
+struct CSqlTeamSave : public CSqlData
 {
 	int m_Team;
-	int m_ClientID;
 	char m_Code[128];
 	char m_Server[5];
-	CSqlScore *m_pSqlData;
+	char m_aTeamString[65536]; // taken on the game thread when the save is requested
+	bool m_Saved;
 };
 
-struct CSqlTeamLoad
+struct CSqlTeamLoad : public CSqlData
 {
 	char m_Code[128];
-	int m_ClientID;
-	CSqlScore *m_pSqlData;
+	char m_aMap[128];
+	bool m_Found;
+	char m_aTeamString[65536];
 };
 
 #endif
@@ -0,0 +1,255 @@
+#if defined(CONF_SQL)
+#include <base/math.h>
+
+#include <engine/storage.h>
+
+#include "sql_spool.h"
+
+CSqlSpool::CSqlSpool()
+{
+	m_pStorage = 0;
+	m_aFilename[0] = 0;
+	m_NumTaken = 0;
+	m_File = 0;
+	m_pThread = 0;
+	m_Quit = false;
+}
+
+CSqlSpool::~CSqlSpool()
+{
+	if(m_pThread)
+	{
+		{
+			CLockScope ls(m_Lock);
+			m_Quit = true;
+		}
+		semaphore_signal(&m_Semaphore);
+		thread_wait(m_pThread);
+		semaphore_destroy(&m_Semaphore);
+	}
+	if(m_File)
+		io_close(m_File);
+}
+
+void CSqlSpool::FillHeader(CHeader *pHeader)
+{
+	mem_zero(pHeader, sizeof(*pHeader));
+	mem_copy(pHeader->m_aMagic, "SQSP", sizeof(pHeader->m_aMagic));
+	pHeader->m_Version = VERSION;
+	pHeader->m_EntrySize = sizeof(CSqlSpoolEntry);
+}
+
+void CSqlSpool::Open(IStorage *pStorage, const char *pFilename)
+{
+	m_pStorage = pStorage;
+	str_copy(m_aFilename, pFilename, sizeof(m_aFilename));
+
+	CHeader Wanted;
+	FillHeader(&Wanted);
+
+	std::deque<CSqlSpoolEntry> Entries;
+	IOHANDLE File = m_pStorage->OpenFile(m_aFilename, IOFLAG_READ, IStorage::TYPE_SAVE);
+	if(File)
+	{
+		CHeader Header;
+		if(io_read(File, &Header, sizeof(Header)) == sizeof(Header) && mem_comp(&Header, &Wanted, sizeof(Header)) == 0)
+		{
+			int Type;
+			while(io_read(File, &Type, sizeof(Type)) == sizeof(Type))
+			{
+				if(Type == RECORD_ENTRY)
+				{
+					CSqlSpoolEntry Entry;
+					if(io_read(File, &Entry, sizeof(Entry)) != sizeof(Entry))
+						break;
+					Entry.m_ClientID = -1;
+					Entries.push_back(Entry);
+				}
+				else if(Type == RECORD_COMMIT)
+				{
+					int Num;
+					if(io_read(File, &Num, sizeof(Num)) != sizeof(Num))
+						break;
+					Entries.erase(Entries.begin(), Entries.begin() + clamp(Num, 0, (int)Entries.size()));
+				}
+				else
+					break;
+			}
+			io_close(File);
+			if(!Entries.empty())
+				dbg_msg("SQL", "replaying %d spooled saves from '%s'", (int)Entries.size(), m_aFilename);
+		}
+		else
+		{
+			// keep it around instead of sending garbage
+			io_close(File);
+			char aBuf[IO_MAX_PATH_LENGTH];
+			str_format(aBuf, sizeof(aBuf), "%s.bad", m_aFilename);
+			m_pStorage->RenameFile(m_aFilename, aBuf, IStorage::TYPE_SAVE);
+			dbg_msg("SQL", "spool '%s' has an unknown format, moved to '%s'", m_aFilename, aBuf);
+		}
+	}
+
+	// also cuts off a record that was only half written
+	Rewrite(&Entries);
+
+	{
+		CLockScope ls(m_Lock);
+		m_Entries.swap(Entries);
+		m_Quit = false;
+	}
+	semaphore_init(&m_Semaphore);
+	m_pThread = thread_init(WriterThread, this);
+}
+
+void CSqlSpool::Rewrite(const std::deque<CSqlSpoolEntry> *pEntries)
+{
+	if(m_File)
+	{
+		io_close(m_File);
+		m_File = 0;
+	}
+
+	char aTmp[IO_MAX_PATH_LENGTH];
+	str_format(aTmp, sizeof(aTmp), "%s.tmp", m_aFilename);
+	IOHANDLE File = m_pStorage->OpenFile(aTmp, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		dbg_msg("SQL", "ERROR: could not write spool '%s', saves are only kept in memory", aTmp);
+		return;
+	}
+
+	CHeader Header;
+	FillHeader(&Header);
+	int Type = RECORD_ENTRY;
+	bool Ok = io_write(File, &Header, sizeof(Header)) == sizeof(Header);
+	for(unsigned i = 0; i < pEntries->size() && Ok; i++)
+		Ok = io_write(File, &Type, sizeof(Type)) == sizeof(Type) &&
+			io_write(File, &(*pEntries)[i], sizeof(CSqlSpoolEntry)) == sizeof(CSqlSpoolEntry);
+	Ok = io_sync(File) == 0 && Ok;
+	io_close(File);
+
+	if(!Ok || !m_pStorage->RenameFile(aTmp, m_aFilename, IStorage::TYPE_SAVE))
+	{
+		dbg_msg("SQL", "ERROR: could not replace spool '%s', saves are only kept in memory", m_aFilename);
+		return;
+	}
+
+	m_File = m_pStorage->OpenFile(m_aFilename, IOFLAG_APPEND, IStorage::TYPE_SAVE);
+}
+
+bool CSqlSpool::WriteRecord(const CRecord *pRecord)
+{
+	if(io_write(m_File, &pRecord->m_Type, sizeof(pRecord->m_Type)) != sizeof(pRecord->m_Type))
+		return false;
+	if(pRecord->m_Type == RECORD_COMMIT)
+		return io_write(m_File, &pRecord->m_NumCommitted, sizeof(pRecord->m_NumCommitted)) == sizeof(pRecord->m_NumCommitted);
+	return io_write(m_File, &pRecord->m_Entry, sizeof(pRecord->m_Entry)) == sizeof(pRecord->m_Entry);
+}
+
+void CSqlSpool::WriterThread(void *pUser)
+{
+	((CSqlSpool *)pUser)->RunLoop();
+}
+
+void CSqlSpool::RunLoop()
+{
+	bool Compacted = true;
+	while(1)
+	{
+		semaphore_wait(&m_Semaphore);
+
+		std::deque<CRecord> Records;
+		bool Drained;
+		bool Quit;
+		{
+			CLockScope ls(m_Lock);
+			Records.swap(m_Records);
+			Drained = m_Entries.empty();
+			Quit = m_Quit;
+		}
+
+		// nothing left that isn't committed, start over with an empty file
+		if(Drained)
+		{
+			if(!Compacted || !Records.empty())
+			{
+				std::deque<CSqlSpoolEntry> Empty;
+				Rewrite(&Empty);
+				Compacted = true;
+			}
+		}
+		else if(m_File && !Records.empty())
+		{
+			bool Ok = true;
+			for(unsigned i = 0; i < Records.size() && Ok; i++)
+				Ok = WriteRecord(&Records[i]);
+			if(!Ok || io_sync(m_File) != 0)
+				dbg_msg("SQL", "ERROR: could not append to spool '%s'", m_aFilename);
+			Compacted = false;
+		}
+
+		if(Quit)
+			break;
+	}
+}
+
+void CSqlSpool::Add(const CSqlSpoolEntry *pEntry)
+{
+	CRecord Record;
+	Record.m_Type = RECORD_ENTRY;
+	Record.m_NumCommitted = 0;
+	Record.m_Entry = *pEntry;
+	{
+		CLockScope ls(m_Lock);
+		m_Entries.push_back(*pEntry);
+		m_Records.push_back(Record);
+	}
+	if(m_pThread)
+		semaphore_signal(&m_Semaphore);
+}
+
+bool CSqlSpool::Take(std::vector<CSqlSpoolEntry> *pvEntries, int Max)
+{
+	CLockScope ls(m_Lock);
+	if(m_NumTaken || m_Entries.empty())
+		return false;
+
+	m_NumTaken = min((int)m_Entries.size(), Max);
+	pvEntries->assign(m_Entries.begin(), m_Entries.begin() + m_NumTaken);
+	return true;
+}
+
+void CSqlSpool::Commit()
+{
+	{
+		CLockScope ls(m_Lock);
+		CRecord Record;
+		Record.m_Type = RECORD_COMMIT;
+		Record.m_NumCommitted = m_NumTaken;
+		m_Records.push_back(Record);
+		m_Entries.erase(m_Entries.begin(), m_Entries.begin() + m_NumTaken);
+		m_NumTaken = 0;
+	}
+	semaphore_signal(&m_Semaphore);
+}
+
+void CSqlSpool::Release()
+{
+	CLockScope ls(m_Lock);
+	m_NumTaken = 0;
+}
+
+int CSqlSpool::Num()
+{
+	CLockScope ls(m_Lock);
+	return m_Entries.size();
+}
+
+int CSqlSpool::NumTaken()
+{
+	CLockScope ls(m_Lock);
+	return m_NumTaken;
+}
+
+#endif
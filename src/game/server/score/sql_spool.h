@@ -0,0 +1,106 @@
+#ifndef GAME_SERVER_SCORE_SQL_SPOOL_H
+#define GAME_SERVER_SCORE_SQL_SPOOL_H
+
+#include <base/lock.h>
+#include <base/system.h>
+
+#include <deque>
+#include <vector>
+
+#include "../score.h"
+
+// one finish, kept as it is written to disk
+struct CSqlSpoolEntry
+{
+	enum
+	{
+		TYPE_RACE=0,
+		TYPE_TEAMRACE,
+	};
+
+	int m_Type;
+	int m_Timestamp; // unix time of the finish
+	char m_aMap[128];
+	char m_aServer[8];
+	float m_Time;
+	float m_aCpCurrent[NUM_CHECKPOINTS];
+	int m_Size; // names used, 1 for race
+	char m_aaNames[MAX_CLIENTS][MAX_NAME_LENGTH];
+	int m_ClientID; // only valid for this run, -1 after a replay
+};
+
+/*
+	Saves waiting for the database. Every entry is appended to a local
+	file before anything is sent, whatever is left in it is replayed on
+	the next start. Workers take the oldest entries as one batch, only
+	one batch is out at a time, and a commit record with its size is
+	appended once it is in the database. The file only shrinks when
+	everything in it is committed. All file access and syncing happens
+	on the spool's own thread, Add() only queues. A crash between the
+	database commit and the commit record sends that batch again.
+*/
+class CSqlSpool
+{
+	enum
+	{
+		VERSION=2,
+
+		// every record starts with its type
+		RECORD_ENTRY=0, // followed by a CSqlSpoolEntry
+		RECORD_COMMIT, // followed by the number of oldest entries that are done
+	};
+
+	struct CHeader
+	{
+		char m_aMagic[4];
+		int m_Version;
+		int m_EntrySize;
+	};
+
+	struct CRecord
+	{
+		int m_Type;
+		int m_NumCommitted;
+		CSqlSpoolEntry m_Entry;
+	};
+
+	CLock m_Lock;
+	class IStorage *m_pStorage;
+	char m_aFilename[IO_MAX_PATH_LENGTH];
+	std::deque<CSqlSpoolEntry> m_Entries GUARDED_BY(m_Lock);
+	int m_NumTaken GUARDED_BY(m_Lock);
+
+	// only the writer thread uses the file once it runs
+	IOHANDLE m_File;
+	void *m_pThread;
+	SEMAPHORE m_Semaphore;
+	std::deque<CRecord> m_Records GUARDED_BY(m_Lock);
+	bool m_Quit GUARDED_BY(m_Lock);
+
+	void FillHeader(CHeader *pHeader);
+	void Rewrite(const std::deque<CSqlSpoolEntry> *pEntries);
+	bool WriteRecord(const CRecord *pRecord);
+
+	static void WriterThread(void *pUser);
+	void RunLoop();
+
+public:
+	CSqlSpool();
+	~CSqlSpool();
+
+	// loads what an earlier run left behind
+	void Open(class IStorage *pStorage, const char *pFilename);
+	void Add(const CSqlSpoolEntry *pEntry);
+
+	// false if a batch is already out or nothing is waiting
+	bool Take(std::vector<CSqlSpoolEntry> *pvEntries, int Max);
+	// the batch is in the database
+	void Commit();
+	// the batch failed, it goes out again
+	void Release();
+
+	int Num();
+	int NumTaken();
+};
+
+#endif
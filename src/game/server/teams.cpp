@@ -6,11 +6,14 @@
 CGameTeams::CGameTeams(CGameContext *pGameContext) :
 		m_pGameContext(pGameContext)
 {
+	mem_zero(m_aaTeamMaskGeneration, sizeof(m_aaTeamMaskGeneration));
+	m_TeamMaskGeneration = 1;
 	Reset();
 }
 
 void CGameTeams::Reset()
 {
+	InvalidateTeamMasks();
 	m_Core.Reset();
 	for (int i = 0; i < MAX_CLIENTS; ++i)
 	{
@@ -188,6 +191,7 @@ void CGameTeams::SetForceCharacterTeam(int ClientID, int Team)
 	}
 
 	m_Core.Team(ClientID, Team);
+	InvalidateTeamMasks();
 
 	if (m_Core.Team(ClientID) != TEAM_SUPER)
 		m_MembersCount[m_Core.Team(ClientID)]++;
@@ -199,7 +203,7 @@ void CGameTeams::SetForceCharacterTeam(int ClientID, int Team)
 		if (GameServer()->Collision()->m_NumSwitchers > 0) {
 			for (int i = 0; i < GameServer()->Collision()->m_NumSwitchers+1; ++i)
 			{
-				GameServer()->Collision()->m_pSwitchers[i].m_Status[Team] = GameServer()->Collision()->m_pSwitchers[i].m_Initial;
+				GameServer()->Collision()->m_pSwitchers[i].SetStatus(Team, GameServer()->Collision()->m_pSwitchers[i].m_Initial);
 				GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team] = 0;
 				GameServer()->Collision()->m_pSwitchers[i].m_Type[Team] = TILE_SWITCHOPEN;
 			}
@@ -215,6 +219,7 @@ void CGameTeams::SetForceCharacterTeam(int ClientID, int Team)
 void CGameTeams::ForceLeaveTeam(int ClientID)
 {
 	m_TeeFinished[ClientID] = false;
+	InvalidateTeamMasks();
 
 	if (m_Core.Team(ClientID) != TEAM_FLOCK
 			&& m_Core.Team(ClientID) != TEAM_SUPER
@@ -275,13 +280,34 @@ bool CGameTeams::TeamFinished(int Team)
 }
 
 int64_t CGameTeams::TeamMask(int Team, int ExceptID, int Asker)
+{
+	if (Team < 0 || Team > MAX_CLIENTS || Asker < -1 || Asker >= MAX_CLIENTS)
+	{
+		int64_t Mask = BuildTeamMask(Team, Asker);
+		if (ExceptID >= 0 && ExceptID < MAX_CLIENTS)
+			Mask &= ~(1LL << ExceptID);
+		return Mask;
+	}
+
+	// the same masks are asked for by every sound and effect of a tick
+	if (m_aaTeamMaskGeneration[Team][Asker+1] != m_TeamMaskGeneration)
+	{
+		m_aaTeamMask[Team][Asker+1] = BuildTeamMask(Team, Asker);
+		m_aaTeamMaskGeneration[Team][Asker+1] = m_TeamMaskGeneration;
+	}
+
+	int64_t Mask = m_aaTeamMask[Team][Asker+1];
+	if (ExceptID >= 0 && ExceptID < MAX_CLIENTS)
+		Mask &= ~(1LL << ExceptID); // Explicitly excluded
+	return Mask;
+}
+
+int64_t CGameTeams::BuildTeamMask(int Team, int Asker)
 {
 	int64_t Mask = 0;
 
 	for (int i = 0; i < MAX_CLIENTS; ++i)
 	{
-		if (i == ExceptID)
-			continue; // Explicitly excluded
 		if (!GetPlayer(i))
 			continue; // Player doesn't exist
 
@@ -596,6 +622,7 @@ void CGameTeams::OnFinish(CPlayer* Player)
 void CGameTeams::OnCharacterSpawn(int ClientID)
 {
 	m_Core.SetSolo(ClientID, false);
+	InvalidateTeamMasks();
 
 	if (m_Core.Team(ClientID) >= TEAM_SUPER || !m_TeamLocked[m_Core.Team(ClientID)])
 		SetForceCharacterTeam(ClientID, 0);
@@ -604,6 +631,7 @@ void CGameTeams::OnCharacterSpawn(int ClientID)
 void CGameTeams::OnCharacterDeath(int ClientID, int Weapon)
 {
 	m_Core.SetSolo(ClientID, false);
+	InvalidateTeamMasks();
 
 	int Team = m_Core.Team(ClientID);
 	bool Locked = TeamLocked(Team) && Weapon != WEAPON_GAME;
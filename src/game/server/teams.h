@@ -13,6 +13,12 @@ class CGameTeams
 	bool m_TeamLocked[MAX_CLIENTS];
 	bool m_IsSaving[MAX_CLIENTS];
 
+	// TeamMask without ExceptID per (team, asker), valid while the generation matches
+	int64_t m_aaTeamMask[MAX_CLIENTS+1][MAX_CLIENTS+1];
+	unsigned m_aaTeamMaskGeneration[MAX_CLIENTS+1][MAX_CLIENTS+1];
+	unsigned m_TeamMaskGeneration;
+	int64_t BuildTeamMask(int Team, int Asker);
+
 	class CGameContext * m_pGameContext;
 
 public:
@@ -58,6 +64,9 @@ public:
 	bool TeamFinished(int Team);
 
 	int64_t TeamMask(int Team, int ExceptID = -1, int Asker = -1);
+	// drops the cached masks, call when team, solo, spectate, pause,
+	// show others or alive state of a player changes
+	void InvalidateTeamMasks() { m_TeamMaskGeneration++; }
 
 	int Count(int Team) const;
 
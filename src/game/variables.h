@@ -161,6 +161,7 @@ MACRO_CONFIG_INT(SvTeleportHoldHook, sv_teleport_hold_hook, 0, 0, 1, CFGFLAG_SER
 MACRO_CONFIG_INT(SvTeleportLoseWeapons, sv_teleport_lose_weapons, 0, 0, 1, CFGFLAG_SERVER|CFGFLAG_GAME, "Lose weapons when teleported (useful for some race maps)");
 
 MACRO_CONFIG_INT(SvMapUpdateRate, sv_mapupdaterate, 5, 1, 100, CFGFLAG_SERVER, "64 player id <-> vanilla id players map update rate")
+MACRO_CONFIG_INT(SvMapUpdateIncremental, sv_mapupdate_incremental, 1, 0, 1, CFGFLAG_SERVER, "Only recompute the id maps of vanilla clients whose surroundings changed")
 
 MACRO_CONFIG_INT(SvSkinStealAction, sv_skinstealaction, 0, 0, 1, CFGFLAG_SERVER, "How to punish skin stealing (currently only 1 = force pinky)")
 
@@ -174,6 +175,9 @@ MACRO_CONFIG_INT(SvRescueDelay, sv_rescue_delay, 5, 0, 1000, CFGFLAG_SERVER, "Nu
 // WarioWare
 MACRO_CONFIG_INT(WwForceMicrogame, ww_force_microgame, -1, -1, 21, CFGFLAG_SERVER, "force a specific microgame to always play")
 MACRO_CONFIG_INT(WwMaxRounds, ww_max_rounds, 20, 1, 200, CFGFLAG_SERVER, "maximum microgame rounds, speedup halfway there, boss stage on final round")
+MACRO_CONFIG_INT(WwBotPathBudget, ww_bot_path_budget, 2000, 1, 1000000, CFGFLAG_SERVER, "tiles the bot pathfinder may expand per tick")
+MACRO_CONFIG_INT(WwNavFields, ww_nav_fields, 16, 1, 256, CFGFLAG_SERVER, "bot navigation distance fields kept in memory")
+MACRO_CONFIG_INT(WwBotTickBudget, ww_bot_tick_budget, 2000, 0, 1000000, CFGFLAG_SERVER, "microseconds per tick the bots may spend on their inputs (0 = no limit)")
 
 MACRO_CONFIG_INT(WwSndWaiting1_Offset, ww_snd_waiting1_offset,  1000, 0, 2147483647, CFGFLAG_SERVER, "'waiting for players 1' music offset in ms")
 MACRO_CONFIG_INT(WwSndWaiting1_Length, ww_snd_waiting1_length, 48000, 0, 2147483647, CFGFLAG_SERVER, "'waiting for players 1' music length in ms")
@@ -0,0 +1,819 @@
+/*
+	Spectator relay. Reads the live demo stream of a game server
+	(sv_demo_stream_port) and serves it to spectating 0.6 and DDNet
+	clients, so watchers cost the relay instead of the game server.
+	Every client is put into the snapshot as a local spectator, the
+	camera follows its own input or the player it picked.
+*/
+#include <base/hash.h>
+#include <base/math.h>
+#include <base/system.h>
+#include <base/uuid.h>
+
+#include <engine/message.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+#include <game/version.h>
+
+#include <mastersrv/mastersrv.h>
+
+#include <vector>
+
+enum
+{
+	SERVERCAP_CURVERSION=5,
+	SERVERCAPFLAG_DDNET=1<<0,
+};
+
+class CSpecRelay
+{
+	struct CClient
+	{
+		enum
+		{
+			STATE_EMPTY=0,
+			STATE_AUTH,
+			STATE_CONNECTING,
+			STATE_READY,
+			STATE_INGAME,
+		};
+
+		int m_State;
+		int m_LastAckedSnapshot;
+		int m_LastInputTick;
+		int m_SpectatorID;
+		int m_ViewX;
+		int m_ViewY;
+		CSnapshotStorage m_Snapshots;
+	};
+
+	enum
+	{
+		STREAM_HEADER=0,
+		STREAM_MAP,
+		STREAM_CHUNKS,
+	};
+
+	CNetServer m_NetServer;
+	CClient m_aClients[MAX_CLIENTS];
+	CSnapshotDelta m_SnapshotDelta;
+	CSnapshotBuilder m_SnapshotBuilder;
+	CNetObjHandler m_NetObjHandler;
+	const char *m_pName;
+
+	// stream
+	NETADDR m_StreamAddr;
+	NETSOCKET m_StreamSocket;
+	bool m_StreamConnected;
+	int64 m_NextConnect;
+	int m_StreamState;
+	std::vector<unsigned char> m_vStreamData;
+	int m_StreamPos;
+
+	// current map and game state as seen on the stream
+	char m_aNetVersion[64];
+	char m_aMapName[64];
+	unsigned m_MapCrc;
+	std::vector<unsigned char> m_vMap;
+	SHA256_DIGEST m_MapSha256;
+	bool m_HaveMap;
+
+	int m_Tick;
+	int m_StreamTick; // last tickmarker
+	int m_PendingTick; // tickmarker without its snapshot yet
+	unsigned char m_aSnapshot[CSnapshot::MAX_SIZE];
+	int m_SnapshotSize;
+	int64 m_TickBase;
+	int m_TickBaseTick;
+
+	static int NewClientCallback(int ClientID, void *pUser);
+	static int NewClientNoAuthCallback(int ClientID, bool Reset, void *pUser);
+	static int ClientRejoinCallback(int ClientID, void *pUser);
+	static int DelClientCallback(int ClientID, const char *pReason, void *pUser);
+
+	void SendMsg(CMsgPacker *pMsg, int Flags, int ClientID);
+	void SendMap(int ClientID);
+	void SendMapData(int ClientID, int Chunk);
+	void SendServerInfo(const NETADDR *pAddr, int Token);
+	void ProcessClientPacket(CNetChunk *pPacket);
+
+	void ConnectStream();
+	void CloseStream();
+	bool ProcessStream();
+	void OnStreamMap();
+	void OnStreamSnapshot(int Tick);
+	void OnStreamMessage(const void *pData, int Size);
+	void SendSnapshot(int ClientID, int LocalID);
+
+	int64 TickStartTime(int Tick) const { return m_TickBase + (Tick-m_TickBaseTick)*time_freq()/SERVER_TICK_SPEED; }
+
+public:
+	CSpecRelay();
+	bool Init(const char *pStream, int Port, const char *pName);
+	void Run();
+};
+
+CSpecRelay::CSpecRelay()
+{
+	m_StreamConnected = false;
+	m_NextConnect = 0;
+	m_HaveMap = false;
+	m_Tick = -1;
+	m_StreamTick = -1;
+	m_PendingTick = -1;
+	m_SnapshotSize = 0;
+	m_TickBase = 0;
+	m_TickBaseTick = 0;
+	m_aNetVersion[0] = 0;
+	m_aMapName[0] = 0;
+	m_MapCrc = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aClients[i].m_State = CClient::STATE_EMPTY;
+		m_aClients[i].m_Snapshots.Init();
+	}
+
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		m_SnapshotDelta.SetStaticsize(i, m_NetObjHandler.GetObjSize(i));
+}
+
+bool CSpecRelay::Init(const char *pStream, int Port, const char *pName)
+{
+	m_pName = pName;
+
+	if(net_host_lookup(pStream, &m_StreamAddr, NETTYPE_ALL))
+	{
+		dbg_msg("specrelay", "couldn't resolve stream address '%s'", pStream);
+		return false;
+	}
+
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_ALL;
+	BindAddr.port = Port;
+	if(!m_NetServer.Open(BindAddr, 0, MAX_CLIENTS, MAX_CLIENTS, 0))
+	{
+		BindAddr.type = NETTYPE_IPV4;
+		if(!m_NetServer.Open(BindAddr, 0, MAX_CLIENTS, MAX_CLIENTS, 0))
+		{
+			dbg_msg("specrelay", "couldn't open socket. port %d might already be in use", Port);
+			return false;
+		}
+	}
+	m_NetServer.SetCallbacks(NewClientCallback, NewClientNoAuthCallback, ClientRejoinCallback, DelClientCallback, this);
+
+	dbg_msg("specrelay", "relaying %s on port %d", pStream, Port);
+	return true;
+}
+
+int CSpecRelay::NewClientCallback(int ClientID, void *pUser)
+{
+	CSpecRelay *pThis = (CSpecRelay *)pUser;
+	CClient *pClient = &pThis->m_aClients[ClientID];
+	pClient->m_State = CClient::STATE_AUTH;
+	pClient->m_LastAckedSnapshot = -1;
+	pClient->m_LastInputTick = -1;
+	pClient->m_SpectatorID = SPEC_FREEVIEW;
+	pClient->m_ViewX = 0;
+	pClient->m_ViewY = 0;
+	pClient->m_Snapshots.PurgeAll();
+	return 0;
+}
+
+int CSpecRelay::NewClientNoAuthCallback(int ClientID, bool Reset, void *pUser)
+{
+	CSpecRelay *pThis = (CSpecRelay *)pUser;
+	if(Reset)
+		NewClientCallback(ClientID, pUser);
+	pThis->m_aClients[ClientID].m_State = CClient::STATE_CONNECTING;
+	pThis->SendMap(ClientID);
+	return 0;
+}
+
+int CSpecRelay::ClientRejoinCallback(int ClientID, void *pUser)
+{
+	CSpecRelay *pThis = (CSpecRelay *)pUser;
+	NewClientCallback(ClientID, pUser);
+	pThis->m_aClients[ClientID].m_State = CClient::STATE_CONNECTING;
+	pThis->SendMap(ClientID);
+	return 0;
+}
+
+int CSpecRelay::DelClientCallback(int ClientID, const char *pReason, void *pUser)
+{
+	CSpecRelay *pThis = (CSpecRelay *)pUser;
+	char aAddrStr[NETADDR_MAXSTRSIZE];
+	net_addr_str(pThis->m_NetServer.ClientAddr(ClientID), aAddrStr, sizeof(aAddrStr), true);
+	dbg_msg("specrelay", "client dropped. cid=%d addr=%s reason='%s'", ClientID, aAddrStr, pReason);
+	pThis->m_aClients[ClientID].m_State = CClient::STATE_EMPTY;
+	pThis->m_aClients[ClientID].m_Snapshots.PurgeAll();
+	return 0;
+}
+
+void CSpecRelay::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
+{
+	CNetChunk Packet;
+	mem_zero(&Packet, sizeof(Packet));
+	Packet.m_ClientID = ClientID;
+	Packet.m_pData = pMsg->Data();
+	Packet.m_DataSize = pMsg->Size();
+	Packet.m_Flags = Flags;
+	m_NetServer.Send(&Packet);
+}
+
+void CSpecRelay::SendMap(int ClientID)
+{
+	if(!m_HaveMap)
+		return;
+
+	// DDNet message NETMSG_MAP_DETAILS
+	CMsgPacker MsgDDNet(0, true, false);
+	Uuid Uuid = CalculateUuid("map-details@ddnet.tw");
+	MsgDDNet.AddRaw(&Uuid, sizeof(Uuid));
+	MsgDDNet.AddString(m_aMapName, 0);
+	MsgDDNet.AddRaw(&m_MapSha256.data, sizeof(m_MapSha256.data));
+	MsgDDNet.AddInt(m_MapCrc);
+	MsgDDNet.AddInt(m_vMap.size());
+	MsgDDNet.AddString("", 0);
+	SendMsg(&MsgDDNet, NETSENDFLAG_VITAL, ClientID);
+
+	CMsgPacker Msg(NETMSG_MAP_CHANGE, true);
+	Msg.AddString(m_aMapName, 0);
+	Msg.AddInt(m_MapCrc);
+	Msg.AddInt(m_vMap.size());
+	SendMsg(&Msg, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, ClientID);
+}
+
+void CSpecRelay::SendMapData(int ClientID, int Chunk)
+{
+	unsigned ChunkSize = 1024-128;
+	unsigned Offset = Chunk*ChunkSize;
+	int Last = 0;
+
+	// drop faulty map data requests
+	if(Chunk < 0 || Offset > m_vMap.size())
+		return;
+
+	if(Offset+ChunkSize >= m_vMap.size())
+	{
+		ChunkSize = m_vMap.size()-Offset;
+		Last = 1;
+	}
+
+	CMsgPacker Msg(NETMSG_MAP_DATA, true);
+	Msg.AddInt(Last);
+	Msg.AddInt(m_MapCrc);
+	Msg.AddInt(Chunk);
+	Msg.AddInt(ChunkSize);
+	Msg.AddRaw(m_vMap.data()+Offset, ChunkSize);
+	SendMsg(&Msg, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, ClientID);
+}
+
+void CSpecRelay::SendServerInfo(const NETADDR *pAddr, int Token)
+{
+	int NumClients = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(m_aClients[i].m_State != CClient::STATE_EMPTY)
+			NumClients++;
+
+	CPacker p;
+	char aBuf[128];
+	p.Reset();
+	p.AddRaw(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO));
+	str_format(aBuf, sizeof(aBuf), "%d", Token);
+	p.AddString(aBuf, 6);
+	p.AddString(GAME_VERSION, 32);
+	p.AddString(m_pName, 64);
+	p.AddString(m_aMapName, 32);
+	p.AddString("relay", 16);
+	p.AddString("0", 2); // flags
+	p.AddString("0", 3); // num players
+	p.AddString("0", 3); // max players
+	str_format(aBuf, sizeof(aBuf), "%d", min(NumClients, (int)VANILLA_MAX_CLIENTS));
+	p.AddString(aBuf, 3);
+	str_format(aBuf, sizeof(aBuf), "%d", (int)VANILLA_MAX_CLIENTS);
+	p.AddString(aBuf, 3);
+
+	CNetChunk Packet;
+	Packet.m_ClientID = -1;
+	Packet.m_Address = *pAddr;
+	Packet.m_Flags = NETSENDFLAG_CONNLESS;
+	Packet.m_pData = p.Data();
+	Packet.m_DataSize = p.Size();
+	m_NetServer.Send(&Packet);
+}
+
+void CSpecRelay::ProcessClientPacket(CNetChunk *pPacket)
+{
+	int ClientID = pPacket->m_ClientID;
+	CClient *pClient = &m_aClients[ClientID];
+	CUnpacker Unpacker;
+	Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+
+	// unpack msgid and system flag
+	int Msg = Unpacker.GetInt();
+	int Sys = Msg&1;
+	Msg >>= 1;
+	bool Vital = (pPacket->m_Flags&NET_CHUNKFLAG_VITAL) != 0;
+
+	if(Unpacker.Error())
+		return;
+
+	if(!Sys)
+	{
+		// spectators can't talk, only pick who to watch
+		if(Msg == NETMSGTYPE_CL_STARTINFO && Vital && pClient->m_State == CClient::STATE_READY)
+		{
+			CMsgPacker Msg(NETMSGTYPE_SV_READYTOENTER);
+			SendMsg(&Msg, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, ClientID);
+		}
+		else if(Msg == NETMSGTYPE_CL_SETSPECTATORMODE && Vital)
+		{
+			CNetMsg_Cl_SetSpectatorMode *pMsg = (CNetMsg_Cl_SetSpectatorMode *)m_NetObjHandler.SecureUnpackMsg(Msg, &Unpacker);
+			if(pMsg)
+				pClient->m_SpectatorID = pMsg->m_SpectatorID;
+		}
+		return;
+	}
+
+	if(Msg == NETMSG_INFO)
+	{
+		if(!Vital || pClient->m_State != CClient::STATE_AUTH)
+			return;
+
+		if(!m_HaveMap)
+		{
+			m_NetServer.Drop(ClientID, "The relay isn't connected to a game yet");
+			return;
+		}
+
+		const char *pVersion = Unpacker.GetString(CUnpacker::SANITIZE_CC);
+		if(str_comp(pVersion, m_aNetVersion) != 0)
+		{
+			char aReason[256];
+			str_format(aReason, sizeof(aReason), "Wrong version. Server is running '%s' and client '%s'", m_aNetVersion, pVersion);
+			m_NetServer.Drop(ClientID, aReason);
+			return;
+		}
+
+		pClient->m_State = CClient::STATE_CONNECTING;
+
+		CMsgPacker Msg(0, true, false);
+		Uuid Uuid = CalculateUuid("capabilities@ddnet.tw");
+		Msg.AddRaw(&Uuid, sizeof(Uuid));
+		Msg.AddInt(SERVERCAP_CURVERSION);
+		Msg.AddInt(SERVERCAPFLAG_DDNET);
+		SendMsg(&Msg, NETSENDFLAG_VITAL, ClientID);
+
+		SendMap(ClientID);
+	}
+	else if(Msg == NETMSG_REQUEST_MAP_DATA)
+	{
+		if(Vital && pClient->m_State >= CClient::STATE_CONNECTING)
+			SendMapData(ClientID, Unpacker.GetInt());
+	}
+	else if(Msg == NETMSG_READY)
+	{
+		if(Vital && pClient->m_State == CClient::STATE_CONNECTING)
+		{
+			pClient->m_State = CClient::STATE_READY;
+			CMsgPacker Msg(NETMSG_CON_READY, true);
+			SendMsg(&Msg, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, ClientID);
+		}
+	}
+	else if(Msg == NETMSG_ENTERGAME)
+	{
+		if(Vital && pClient->m_State == CClient::STATE_READY)
+		{
+			char aAddrStr[NETADDR_MAXSTRSIZE];
+			net_addr_str(m_NetServer.ClientAddr(ClientID), aAddrStr, sizeof(aAddrStr), true);
+			dbg_msg("specrelay", "spectator entered. cid=%d addr=%s", ClientID, aAddrStr);
+			pClient->m_State = CClient::STATE_INGAME;
+		}
+	}
+	else if(Msg == NETMSG_INPUT)
+	{
+		pClient->m_LastAckedSnapshot = Unpacker.GetInt();
+		int IntendedTick = Unpacker.GetInt();
+		int Size = Unpacker.GetInt();
+		if(Unpacker.Error() || Size/4 > MAX_INPUT_SIZE)
+			return;
+
+		if(IntendedTick > pClient->m_LastInputTick && m_Tick >= 0)
+		{
+			int TimeLeft = ((TickStartTime(IntendedTick)-time_get())*1000) / time_freq();
+			CMsgPacker Msg(NETMSG_INPUTTIMING, true);
+			Msg.AddInt(IntendedTick);
+			Msg.AddInt(TimeLeft);
+			SendMsg(&Msg, 0, ClientID);
+		}
+		pClient->m_LastInputTick = IntendedTick;
+
+		// free view follows the cursor
+		int aInput[MAX_INPUT_SIZE] = {0};
+		for(int i = 0; i < Size/4; i++)
+			aInput[i] = Unpacker.GetInt();
+		if(!Unpacker.Error() && Size >= (int)sizeof(CNetObj_PlayerInput))
+		{
+			CNetObj_PlayerInput *pInput = (CNetObj_PlayerInput *)aInput;
+			pClient->m_ViewX = pInput->m_TargetX;
+			pClient->m_ViewY = pInput->m_TargetY;
+		}
+	}
+	else if(Msg == NETMSG_PING)
+	{
+		CMsgPacker Msg(NETMSG_PING_REPLY, true);
+		SendMsg(&Msg, 0, ClientID);
+	}
+}
+
+void CSpecRelay::ConnectStream()
+{
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = m_StreamAddr.type;
+	m_StreamSocket = net_tcp_create(BindAddr);
+	if(!m_StreamSocket)
+		return;
+	if(net_tcp_connect(m_StreamSocket, &m_StreamAddr) != 0)
+	{
+		net_tcp_close(m_StreamSocket);
+		return;
+	}
+	net_set_non_blocking(m_StreamSocket);
+
+	dbg_msg("specrelay", "connected to the demo stream");
+	m_StreamConnected = true;
+	m_StreamState = STREAM_HEADER;
+	m_vStreamData.clear();
+	m_StreamPos = 0;
+	m_StreamTick = -1;
+	m_PendingTick = -1;
+	m_Tick = -1;
+}
+
+void CSpecRelay::CloseStream()
+{
+	dbg_msg("specrelay", "lost the demo stream");
+	net_tcp_close(m_StreamSocket);
+	m_StreamConnected = false;
+	m_NextConnect = time_get()+time_freq();
+}
+
+bool CSpecRelay::ProcessStream()
+{
+	const unsigned char *pData = m_vStreamData.empty() ? 0 : &m_vStreamData[m_StreamPos];
+	int Size = m_vStreamData.size()-m_StreamPos;
+
+	if(m_StreamState == STREAM_HEADER)
+	{
+		if(Size < (int)(sizeof(CDemoHeader)+sizeof(CTimelineMarkers)))
+			return false;
+
+		CDemoHeader Header;
+		mem_copy(&Header, pData, sizeof(Header));
+		if(mem_comp(Header.m_aMarker, "TWDEMO", 7) != 0)
+		{
+			CloseStream();
+			return false;
+		}
+
+		unsigned MapSize = (Header.m_aMapSize[0]<<24) | (Header.m_aMapSize[1]<<16) | (Header.m_aMapSize[2]<<8) | Header.m_aMapSize[3];
+		unsigned MapCrc = (Header.m_aMapCrc[0]<<24) | (Header.m_aMapCrc[1]<<16) | (Header.m_aMapCrc[2]<<8) | Header.m_aMapCrc[3];
+		m_HaveMap = m_HaveMap && MapCrc == m_MapCrc && MapSize == m_vMap.size() && str_comp(Header.m_aMapName, m_aMapName) == 0;
+		str_copy(m_aNetVersion, Header.m_aNetversion, sizeof(m_aNetVersion));
+		str_copy(m_aMapName, Header.m_aMapName, sizeof(m_aMapName));
+		m_MapCrc = MapCrc;
+		m_vMap.resize(MapSize);
+
+		m_StreamPos += sizeof(CDemoHeader)+sizeof(CTimelineMarkers);
+		m_StreamState = STREAM_MAP;
+		return true;
+	}
+
+	if(m_StreamState == STREAM_MAP)
+	{
+		if(Size < (int)m_vMap.size())
+			return false;
+
+		if(!m_HaveMap)
+		{
+			mem_copy(&m_vMap[0], pData, m_vMap.size());
+			OnStreamMap();
+		}
+		m_StreamPos += m_vMap.size();
+		m_StreamState = STREAM_CHUNKS;
+		return true;
+	}
+
+	int Type, ChunkSize, Tick = m_StreamTick;
+	int HeaderSize = CDemoPlayer::UnpackChunkHeader(pData, Size, &Type, &ChunkSize, &Tick);
+	if(!HeaderSize || Size < HeaderSize+ChunkSize)
+		return false;
+	pData += HeaderSize;
+	m_StreamPos += HeaderSize+ChunkSize;
+
+	if(Type&CHUNKTYPEFLAG_TICKMARKER)
+	{
+		// a tick without a snapshot chunk didn't change anything
+		if(m_PendingTick >= 0 && m_SnapshotSize)
+			OnStreamSnapshot(m_PendingTick);
+		m_StreamTick = Tick;
+		m_PendingTick = Tick;
+		return true;
+	}
+
+	unsigned char aData[CSnapshot::MAX_SIZE];
+	int DataSize = ChunkSize ? CDemoPlayer::DecompressChunk(pData, ChunkSize, aData, sizeof(aData)) : 0;
+	if(DataSize < 0)
+	{
+		CloseStream();
+		return false;
+	}
+
+	if(Type == CHUNKTYPE_SNAPSHOT)
+	{
+		mem_copy(m_aSnapshot, aData, DataSize);
+		m_SnapshotSize = DataSize;
+		OnStreamSnapshot(m_PendingTick);
+		m_PendingTick = -1;
+	}
+	else if(Type == CHUNKTYPE_DELTA)
+	{
+		unsigned char aSnapshot[CSnapshot::MAX_SIZE];
+		int SnapSize = m_SnapshotSize ? m_SnapshotDelta.UnpackDelta((CSnapshot *)m_aSnapshot, (CSnapshot *)aSnapshot, aData, DataSize) : -1;
+		if(SnapSize < 0)
+		{
+			dbg_msg("specrelay", "error during unpacking of delta, err=%d", SnapSize);
+			CloseStream();
+			return false;
+		}
+		mem_copy(m_aSnapshot, aSnapshot, SnapSize);
+		m_SnapshotSize = SnapSize;
+		OnStreamSnapshot(m_PendingTick);
+		m_PendingTick = -1;
+	}
+	else if(Type == CHUNKTYPE_MESSAGE)
+		OnStreamMessage(aData, DataSize);
+	return true;
+}
+
+void CSpecRelay::OnStreamMap()
+{
+	m_MapSha256 = sha256(&m_vMap[0], m_vMap.size());
+	m_HaveMap = true;
+	m_SnapshotSize = 0;
+	dbg_msg("specrelay", "map '%s' crc=%08x size=%d", m_aMapName, m_MapCrc, (int)m_vMap.size());
+
+	// send everybody over to the new map
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClients[i].m_State <= CClient::STATE_AUTH)
+			continue;
+		m_aClients[i].m_State = CClient::STATE_CONNECTING;
+		m_aClients[i].m_LastAckedSnapshot = -1;
+		m_aClients[i].m_Snapshots.PurgeAll();
+		SendMap(i);
+	}
+}
+
+void CSpecRelay::OnStreamSnapshot(int Tick)
+{
+	if(Tick < 0 || Tick <= m_Tick)
+		return;
+
+	// resync the tick clock when the stream jumped
+	int64 Now = time_get();
+	if(m_Tick < 0 || Tick < m_TickBaseTick || absolute(TickStartTime(Tick)-Now) > time_freq()/4)
+	{
+		m_TickBase = Now;
+		m_TickBaseTick = Tick;
+	}
+	m_Tick = Tick;
+
+	// the spectators need a free slot in the player list
+	CSnapshot *pSnap = (CSnapshot *)m_aSnapshot;
+	int LocalID = -1;
+	for(int ID = 0; ID < MAX_CLIENTS && LocalID < 0; ID++)
+		if(pSnap->GetItemIndex((NETOBJTYPE_PLAYERINFO<<16)|ID) < 0)
+			LocalID = ID;
+	if(LocalID < 0)
+		return;
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(m_aClients[i].m_State == CClient::STATE_INGAME)
+			SendSnapshot(i, LocalID);
+}
+
+void CSpecRelay::SendSnapshot(int ClientID, int LocalID)
+{
+	CClient *pClient = &m_aClients[ClientID];
+	CSnapshot *pSnap = (CSnapshot *)m_aSnapshot;
+
+	m_SnapshotBuilder.Init();
+	for(int i = 0; i < pSnap->NumItems(); i++)
+	{
+		CSnapshotItem *pItem = pSnap->GetItem(i);
+		int Size = pSnap->GetItemSize(i);
+		void *pData = m_SnapshotBuilder.NewItem(pItem->Type(), pItem->ID(), Size);
+		if(pData)
+			mem_copy(pData, pItem->Data(), Size);
+	}
+
+	CNetObj_PlayerInfo *pPlayerInfo = (CNetObj_PlayerInfo *)m_SnapshotBuilder.NewItem(NETOBJTYPE_PLAYERINFO, LocalID, sizeof(CNetObj_PlayerInfo));
+	if(pPlayerInfo)
+	{
+		pPlayerInfo->m_Local = 1;
+		pPlayerInfo->m_ClientID = LocalID;
+		pPlayerInfo->m_Team = TEAM_SPECTATORS;
+		pPlayerInfo->m_Score = 0;
+		pPlayerInfo->m_Latency = 0;
+	}
+
+	int ViewX = pClient->m_ViewX;
+	int ViewY = pClient->m_ViewY;
+	int SpectatorID = pClient->m_SpectatorID;
+	if(SpectatorID != SPEC_FREEVIEW)
+	{
+		int Index = pSnap->GetItemIndex((NETOBJTYPE_CHARACTER<<16)|(SpectatorID&0xffff));
+		if(Index >= 0)
+		{
+			CNetObj_Character *pChar = (CNetObj_Character *)pSnap->GetItem(Index)->Data();
+			ViewX = pChar->m_X;
+			ViewY = pChar->m_Y;
+		}
+		else
+			SpectatorID = SPEC_FREEVIEW;
+	}
+
+	CNetObj_SpectatorInfo *pSpectatorInfo = (CNetObj_SpectatorInfo *)m_SnapshotBuilder.NewItem(NETOBJTYPE_SPECTATORINFO, LocalID, sizeof(CNetObj_SpectatorInfo));
+	if(pSpectatorInfo)
+	{
+		pSpectatorInfo->m_SpectatorID = SpectatorID;
+		pSpectatorInfo->m_X = ViewX;
+		pSpectatorInfo->m_Y = ViewY;
+	}
+
+	char aData[CSnapshot::MAX_SIZE];
+	CSnapshot *pData = (CSnapshot *)aData;
+	int SnapshotSize = m_SnapshotBuilder.Finish(pData);
+	int Crc = pData->Crc();
+
+	// keep 3 seconds worth of snapshots
+	pClient->m_Snapshots.PurgeUntil(m_Tick-SERVER_TICK_SPEED*3);
+	pClient->m_Snapshots.Add(m_Tick, time_get(), SnapshotSize, pData, 0);
+
+	// find snapshot that we can preform delta against
+	static CSnapshot EmptySnap;
+	EmptySnap.Clear();
+	CSnapshot *pDeltashot = &EmptySnap;
+	int DeltaTick = -1;
+	if(pClient->m_Snapshots.Get(pClient->m_LastAckedSnapshot, 0, &pDeltashot, 0) >= 0)
+		DeltaTick = pClient->m_LastAckedSnapshot;
+	else
+		pDeltashot = &EmptySnap;
+
+	char aDeltaData[CSnapshot::MAX_SIZE];
+	char aCompData[CSnapshot::MAX_SIZE];
+	int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+	if(!DeltaSize)
+	{
+		CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+		Msg.AddInt(m_Tick);
+		Msg.AddInt(m_Tick-DeltaTick);
+		SendMsg(&Msg, NETSENDFLAG_FLUSH, ClientID);
+		return;
+	}
+
+	int CompSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
+	if(CompSize < 0)
+		return;
+
+	const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	int NumPackets = (CompSize+MaxSize-1)/MaxSize;
+	for(int n = 0, Left = CompSize; Left; n++)
+	{
+		int Chunk = Left < MaxSize ? Left : MaxSize;
+		Left -= Chunk;
+
+		if(NumPackets == 1)
+		{
+			CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+			Msg.AddInt(m_Tick);
+			Msg.AddInt(m_Tick-DeltaTick);
+			Msg.AddInt(Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
+			SendMsg(&Msg, NETSENDFLAG_FLUSH, ClientID);
+		}
+		else
+		{
+			CMsgPacker Msg(NETMSG_SNAP, true);
+			Msg.AddInt(m_Tick);
+			Msg.AddInt(m_Tick-DeltaTick);
+			Msg.AddInt(NumPackets);
+			Msg.AddInt(n);
+			Msg.AddInt(Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
+			SendMsg(&Msg, NETSENDFLAG_FLUSH, ClientID);
+		}
+	}
+}
+
+void CSpecRelay::OnStreamMessage(const void *pData, int Size)
+{
+	CNetChunk Packet;
+	mem_zero(&Packet, sizeof(Packet));
+	Packet.m_pData = pData;
+	Packet.m_DataSize = Size;
+	Packet.m_Flags = NETSENDFLAG_VITAL;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClients[i].m_State != CClient::STATE_INGAME)
+			continue;
+		Packet.m_ClientID = i;
+		m_NetServer.Send(&Packet);
+	}
+}
+
+void CSpecRelay::Run()
+{
+	while(1)
+	{
+		if(!m_StreamConnected && time_get() > m_NextConnect)
+		{
+			ConnectStream();
+			if(!m_StreamConnected)
+				m_NextConnect = time_get()+time_freq();
+		}
+
+		if(m_StreamConnected)
+		{
+			unsigned char aBuf[16*1024];
+			while(m_StreamConnected)
+			{
+				int Bytes = net_tcp_recv(m_StreamSocket, aBuf, sizeof(aBuf));
+				if(Bytes == 0 || (Bytes < 0 && !net_would_block()))
+					CloseStream();
+				if(Bytes <= 0)
+					break;
+				m_vStreamData.insert(m_vStreamData.end(), aBuf, aBuf+Bytes);
+			}
+
+			while(m_StreamConnected && ProcessStream())
+				;
+
+			if(m_StreamPos > 0)
+			{
+				m_vStreamData.erase(m_vStreamData.begin(), m_vStreamData.begin()+m_StreamPos);
+				m_StreamPos = 0;
+			}
+		}
+
+		m_NetServer.Update();
+
+		CNetChunk Packet;
+		SECURITY_TOKEN ResponseToken;
+		while(m_NetServer.Recv(&Packet, &ResponseToken))
+		{
+			if(Packet.m_ClientID == -1)
+			{
+				if(Packet.m_DataSize == sizeof(SERVERBROWSE_GETINFO)+1 &&
+					mem_comp(Packet.m_pData, SERVERBROWSE_GETINFO, sizeof(SERVERBROWSE_GETINFO)) == 0)
+					SendServerInfo(&Packet.m_Address, ((unsigned char *)Packet.m_pData)[sizeof(SERVERBROWSE_GETINFO)]);
+			}
+			else
+				ProcessClientPacket(&Packet);
+		}
+
+		net_socket_read_wait(m_NetServer.Socket(), 2000);
+	}
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	if(argc < 2)
+	{
+		dbg_msg("specrelay", "usage: %s stream_host:port [port] [name] (default port: 8310)", argv[0]); // ignore_convention
+		return 1;
+	}
+
+	dbg_logger_stdout();
+	net_init();
+	CNetBase::Init();
+	secure_random_init();
+
+	static CSpecRelay s_Relay;
+	if(!s_Relay.Init(argv[1], argc > 2 ? str_toint(argv[2]) : 8310, argc > 3 ? argv[3] : "spectator relay")) // ignore_convention
+		return 1;
+	s_Relay.Run();
+	return 0;
+}
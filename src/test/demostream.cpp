@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <engine/message.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/demostream.h>
+#include <engine/shared/network.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+
+#include <vector>
+
+// reads until nothing more arrives for 100ms
+static void Receive(NETSOCKET Socket, std::vector<unsigned char> *pvData)
+{
+	while(net_socket_read_wait(Socket, 100000) > 0)
+	{
+		unsigned char aBuf[1024];
+		int Bytes = net_tcp_recv(Socket, aBuf, sizeof(aBuf));
+		if(Bytes <= 0)
+			return;
+		pvData->insert(pvData->end(), aBuf, aBuf+Bytes);
+	}
+}
+
+TEST(DemoStream, ChatReachesReader)
+{
+	CNetBase::Init();
+	static CSnapshotDelta s_SnapshotDelta;
+	CNetObjHandler NetObjHandler;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		s_SnapshotDelta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+
+	NETADDR Addr;
+	ASSERT_EQ(net_addr_from_str(&Addr, "127.0.0.1:18390"), 0);
+	CDemoStream Stream;
+	ASSERT_TRUE(Stream.Open(Addr, &s_SnapshotDelta));
+
+	unsigned char aMap[64];
+	for(unsigned i = 0; i < sizeof(aMap); i++)
+		aMap[i] = i;
+	Stream.SetMap("0.6 626fce9a778df4d4", "test", 0x1234, aMap, sizeof(aMap));
+
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_IPV4;
+	NETSOCKET Reader = net_tcp_create(BindAddr);
+	ASSERT_EQ(net_tcp_connect(Reader, &Addr), 0);
+
+	// accept, then send the header and the map
+	for(int i = 0; i < 100 && !Stream.Active(); i++)
+	{
+		Stream.Update();
+		thread_sleep(1);
+	}
+	ASSERT_TRUE(Stream.Active());
+
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	CNetObj_GameInfo *pGame = (CNetObj_GameInfo *)Builder.NewItem(NETOBJTYPE_GAMEINFO, 0, sizeof(CNetObj_GameInfo));
+	ASSERT_TRUE(pGame);
+	mem_zero(pGame, sizeof(*pGame));
+	char aSnapshot[CSnapshot::MAX_SIZE];
+	int SnapshotSize = Builder.Finish(aSnapshot);
+	Stream.OnSnapshot(100, aSnapshot, SnapshotSize);
+
+	// packed like a broadcast from the server
+	CNetMsg_Sv_Chat Msg;
+	Msg.m_Team = 0;
+	Msg.m_ClientID = -1;
+	Msg.m_pMessage = "hello relay";
+	CMsgPacker Packer(Msg.MsgID());
+	ASSERT_FALSE(Msg.Pack(&Packer));
+	Stream.OnMessage(Packer.Data(), Packer.Size());
+	Stream.Update();
+
+	std::vector<unsigned char> vData;
+	Receive(Reader, &vData);
+	net_tcp_close(Reader);
+	Stream.Shutdown();
+
+	int Pos = sizeof(CDemoHeader)+sizeof(CTimelineMarkers)+sizeof(aMap);
+	ASSERT_GE((int)vData.size(), Pos);
+	EXPECT_EQ(mem_comp(&vData[sizeof(CDemoHeader)+sizeof(CTimelineMarkers)], aMap, sizeof(aMap)), 0);
+
+	bool KeyFrame = false;
+	bool Chat = false;
+	int Tick = -1;
+	while(Pos < (int)vData.size())
+	{
+		int Type, ChunkSize;
+		int HeaderSize = CDemoPlayer::UnpackChunkHeader(&vData[Pos], vData.size()-Pos, &Type, &ChunkSize, &Tick);
+		ASSERT_GT(HeaderSize, 0);
+		ASSERT_LE(Pos+HeaderSize+ChunkSize, (int)vData.size());
+		Pos += HeaderSize;
+		if(Type&CHUNKTYPEFLAG_TICKMARKER)
+		{
+			EXPECT_TRUE(Type&CHUNKTICKFLAG_KEYFRAME);
+			EXPECT_EQ(Tick, 100);
+			continue;
+		}
+
+		unsigned char aData[CSnapshot::MAX_SIZE];
+		int DataSize = CDemoPlayer::DecompressChunk(&vData[Pos], ChunkSize, aData, sizeof(aData));
+		Pos += ChunkSize;
+		if(Type == CHUNKTYPE_SNAPSHOT)
+		{
+			EXPECT_FALSE(Chat);
+			EXPECT_EQ(DataSize, SnapshotSize);
+			KeyFrame = true;
+		}
+		else if(Type == CHUNKTYPE_MESSAGE)
+		{
+			// the chunk is padded with zeros
+			ASSERT_GE(DataSize, Packer.Size());
+			EXPECT_EQ(mem_comp(aData, Packer.Data(), Packer.Size()), 0);
+			Chat = true;
+		}
+	}
+	EXPECT_TRUE(KeyFrame);
+	EXPECT_TRUE(Chat);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <game/generated/protocol.h>
+#include <game/server/eventhandler.h>
+
+static void CreateEvent(CEventHandler *pEvents, int x, int y, int64_t Mask)
+{
+	CNetEvent_Common *pEvent = (CNetEvent_Common *)pEvents->Create(NETEVENTTYPE_COMMON, sizeof(CNetEvent_Common), Mask);
+	pEvent->m_X = x;
+	pEvent->m_Y = y;
+}
+
+TEST(EventHandler, TwoClientsInDifferentCells)
+{
+	CEventHandler Events;
+	CreateEvent(&Events, 100, 100, -1LL);
+	CreateEvent(&Events, 8000, 8000, -1LL);
+	CreateEvent(&Events, 200, 100, 1LL<<1);
+
+	// the first client builds the grid
+	Events.CollectVisible(0, vec2(100, 100), 10000, 10000, 64);
+	ASSERT_EQ(Events.Visible().size(), 1u);
+	EXPECT_EQ(Events.Visible()[0], 0);
+
+	Events.CollectVisible(1, vec2(8000, 8000), 10000, 10000, 64);
+	ASSERT_EQ(Events.Visible().size(), 1u);
+	EXPECT_EQ(Events.Visible()[0], 1);
+
+	Events.CollectVisible(1, vec2(150, 100), 10000, 10000, 64);
+	ASSERT_EQ(Events.Visible().size(), 2u);
+	EXPECT_EQ(Events.Visible()[0], 0);
+	EXPECT_EQ(Events.Visible()[1], 2);
+
+	EXPECT_EQ(Events.m_NumCulled, 2 + 2 + 1);
+}
+
+TEST(EventHandler, RebuildAfterCreate)
+{
+	CEventHandler Events;
+	CreateEvent(&Events, 100, 100, -1LL);
+	Events.CollectVisible(0, vec2(100, 100), 10000, 10000, 64);
+	ASSERT_EQ(Events.Visible().size(), 1u);
+
+	CreateEvent(&Events, 5000, 5000, -1LL);
+	Events.CollectVisible(0, vec2(5000, 5000), 10000, 10000, 64);
+	ASSERT_EQ(Events.Visible().size(), 1u);
+	EXPECT_EQ(Events.Visible()[0], 1);
+}
+
+TEST(EventHandler, MaxEvents)
+{
+	CEventHandler Events;
+	for(int i = 0; i < 10; i++)
+		CreateEvent(&Events, 100 + i, 100, -1LL);
+	Events.CollectVisible(0, vec2(100, 100), 10000, 10000, 4);
+	ASSERT_EQ(Events.Visible().size(), 4u);
+	for(int i = 0; i < 4; i++)
+		EXPECT_EQ(Events.Visible()[i], i);
+	EXPECT_EQ(Events.m_NumCulled, 0);
+	EXPECT_EQ(Events.m_NumDropped, 6);
+}
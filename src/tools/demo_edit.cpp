@@ -0,0 +1,51 @@
+#include <base/system.h>
+
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+
+#include <game/generated/protocol.h>
+#include <game/version.h>
+
+/*
+	Offline demo editing, so long demos don't stall the server.
+	"slice" copies the ticks from start to end, "index" copies the whole
+	demo, which gives older files a keyframe index.
+*/
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	bool Slice = argc >= 5 && str_comp(argv[1], "slice") == 0; // ignore_convention
+	bool Index = argc == 4 && str_comp(argv[1], "index") == 0; // ignore_convention
+	if(!Slice && !Index)
+	{
+		dbg_msg("demo_edit", "usage: %s slice <demo> <file> <start> [end]", argv[0]); // ignore_convention
+		dbg_msg("demo_edit", "       %s index <demo> <file>", argv[0]); // ignore_convention
+		return 1;
+	}
+
+	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_SERVER, argc, argv); // ignore_convention
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+	if(!pStorage || !pConsole)
+		return 1;
+
+	// deltas leave out the size of items with a static size
+	static CSnapshotDelta s_SnapshotDelta;
+	CNetObjHandler NetObjHandler;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		s_SnapshotDelta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+
+	int StartTick = Slice ? str_toint(argv[4]) : -1; // ignore_convention
+	int EndTick = Slice && argc > 5 ? str_toint(argv[5]) : -1; // ignore_convention
+
+	CDemoEditor DemoEditor;
+	DemoEditor.Init(GAME_NETVERSION, &s_SnapshotDelta, pConsole, pStorage);
+	DemoEditor.Slice(argv[2], argv[3], StartTick, EndTick); // ignore_convention
+
+	delete pConsole;
+	delete pStorage;
+	return 0;
+}